@@ -1,6 +1,8 @@
 
 #include <strings.h>
+#ifndef _GNU_SOURCE
 #define _GNU_SOURCE
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,12 +15,14 @@ extern "C" {
 #endif
 
 static inline cache_t *create_cache(const char *trace_path, const char *eviction_algo, const uint64_t cache_size,
-                                    const char *eviction_params, const bool consider_obj_metadata) {
+                                    const char *eviction_params, const bool consider_obj_metadata,
+                                    const int64_t n_obj) {
   common_cache_params_t cc_params = {
       .cache_size = cache_size,
       .default_ttl = 86400 * 300,
       .hashpower = 24,
       .consider_obj_metadata = consider_obj_metadata,
+      .n_obj = n_obj,
   };
   cache_t *cache;
 
@@ -29,6 +33,12 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
     cache = LRU_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "fifo") == 0) {
     cache = FIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "promo-queue") == 0) {
+    cache = PromoQueue_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "twoq-promo") == 0) {
+    cache = TwoQ_promo_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "arc-promo") == 0) {
+    cache = ARC_promo_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "twoq-delay") == 0) {
     cache = TwoQ_Delay_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "twoq-batch") == 0) {
@@ -92,7 +102,7 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
     } else {
       const char *window_size = strstr(eviction_params, "window-size=");
       if (window_size == NULL) {
-        char *new_params = malloc(strlen(eviction_params) + 20);
+        char *new_params = (char *)malloc(strlen(eviction_params) + 20);
         sprintf(new_params, "%s,window-size=0.01", eviction_params);
         cache = WTinyLFU_init(cc_params, new_params);
       } else {
@@ -232,13 +242,15 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
 
 static inline cache_t *create_cache_with_version_num(const char *trace_path, const char *eviction_algo,
                                                      const uint64_t cache_size, const char *eviction_params,
-                                                     const bool consider_obj_metadata, const int version_num) {
+                                                     const bool consider_obj_metadata, const int version_num,
+                                                     const int64_t n_obj) {
   common_cache_params_t cc_params = {
       .cache_size = cache_size,
       .default_ttl = 86400 * 300,
       .hashpower = 24,
       .consider_obj_metadata = consider_obj_metadata,
       .version_num = version_num,
+      .n_obj = n_obj,
   };
   cache_t *cache;
 
@@ -249,6 +261,12 @@ static inline cache_t *create_cache_with_version_num(const char *trace_path, con
     cache = LRU_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "fifo") == 0) {
     cache = FIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "promo-queue") == 0) {
+    cache = PromoQueue_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "twoq-promo") == 0) {
+    cache = TwoQ_promo_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "arc-promo") == 0) {
+    cache = ARC_promo_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "twoq-delay") == 0) {
     cache = TwoQ_Delay_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "twoq-batch") == 0) {
@@ -312,7 +330,7 @@ static inline cache_t *create_cache_with_version_num(const char *trace_path, con
     } else {
       const char *window_size = strstr(eviction_params, "window-size=");
       if (window_size == NULL) {
-        char *new_params = malloc(strlen(eviction_params) + 20);
+        char *new_params = (char *)malloc(strlen(eviction_params) + 20);
         sprintf(new_params, "%s,window-size=0.01", eviction_params);
         cache = WTinyLFU_init(cc_params, new_params);
       } else {
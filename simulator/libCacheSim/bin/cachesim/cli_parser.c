@@ -47,6 +47,8 @@ enum argp_option_short {
 
   OPTION_PREFETCH_ALGO = 'p',
   OPTION_PREFETCH_PARAMS = 0x109,
+  OPTION_COST_MODEL = 0x10a,
+  OPTION_FLASH = 0x10b,
 };
 
 /*
@@ -92,6 +94,16 @@ static struct argp_option options[] = {
      10},
     {"consider-obj-metadata", OPTION_CONSIDER_OBJ_METADATA, "false", 0,
      "Whether consider per object metadata size in the simulated cache", 10},
+    {"cost-model", OPTION_COST_MODEL, "\"lock=40,splice=20,n-thread=16\"", 0,
+     "The cost in ns of hit, miss, lock, splice, scan, md-write, and kappa, "
+     "n-thread of the modelled throughput reported with the miss ratio",
+     10},
+    {"flash", OPTION_FLASH,
+     "\"segment-size=1MiB,op=0.1,gc=greedy\"", 0,
+     "Simulate the cache on a log-structured flash device and report the "
+     "write amplification, segment-size, op, gc (greedy/fifo/cost-benefit), "
+     "write-bw, read-bw (MB/s), read-lat (us), queue-depth",
+     10},
     {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output", 10},
 
     {0}};
@@ -121,6 +133,12 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_ADMISSION_ALGO:
       arguments->admission_algo = arg;
       break;
+    case OPTION_COST_MODEL:
+      parse_cost_model_params(arg, &arguments->cost_model);
+      break;
+    case OPTION_FLASH:
+      parse_flash_params(arg, &arguments->flash);
+      break;
     case OPTION_PREFETCH_ALGO:
       arguments->prefetch_algo = arg;
       break;
@@ -198,7 +216,8 @@ static char doc[] =
     "trace can be zstd compressed\n"
     "cache_size is in byte, but also support KB/MB/GB\n"
     "supported trace_type: txt/csv/twr/vscsi/oracleGeneralBin\n"
-    "supported eviction_algo: LRU/LFU/FIFO/ARC/LeCaR/Cacheus\n";
+    "supported eviction_algo: LRU/LFU/FIFO/ARC/LeCaR/Cacheus\n"
+    "promotionOracle computes the optimal promotions of FIFO-reinsertion\n";
 
 /**
  * @brief initialize the arguments
@@ -226,6 +245,8 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->n_req = -1;
   args->sample_ratio = 1.0;
+  args->cost_model = default_cost_model_params();
+  args->flash = default_flash_params();
 
   for (int i = 0; i < N_MAX_ALGO; i++) {
     args->eviction_algo[i] = NULL;
@@ -279,7 +300,9 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
    * after we set up the reader */
   assert(N_ARGS == 4);
 
-  if (args->ofilepath[0] == '\0') {
+  if (args->ofilepath[0] == '\0' && strcmp(args->trace_path, "-") == 0) {
+    snprintf(args->ofilepath, OFILEPATH_LEN, "stdin.cachesim");
+  } else if (args->ofilepath[0] == '\0') {
     char *trace_filename = rindex(args->trace_path, '/');
     snprintf(args->ofilepath, OFILEPATH_LEN, "%s.cachesim",
              trace_filename == NULL ? args->trace_path : trace_filename + 1);
@@ -311,8 +334,13 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
     reader_init_params.ignore_obj_size = true;
   }
 
-  args->reader =
-      setup_reader(args->trace_path, args->trace_type, &reader_init_params);
+  if (args->trace_type == MERGE_TRACE) {
+    args->reader =
+        setup_merge_reader_from_file(args->trace_path, &reader_init_params);
+  } else {
+    args->reader =
+        setup_reader(args->trace_path, args->trace_type, &reader_init_params);
+  }
 
   if (args->consider_obj_metadata &&
       should_disable_obj_metadata(args->reader)) {
@@ -327,12 +355,23 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
    * the working set size **/
   conv_cache_sizes(args->args[3], args);
 
+  args->promotion_oracle =
+      args->n_eviction_algo == 1 &&
+      strcasecmp(args->eviction_algo[0], "promotionOracle") == 0;
+  if (args->promotion_oracle) {
+    if (!args->ignore_obj_size) {
+      ERROR("promotionOracle uses unit size objects, please use --ignore-obj-size 1\n");
+    }
+    return;
+  }
+
   for (int i = 0; i < args->n_eviction_algo; i++) {
     for (int j = 0; j < args->n_cache_size; j++) {
       int idx = i * args->n_cache_size + j;
       args->caches[idx] = create_cache(
           args->trace_path, args->eviction_algo[i], args->cache_sizes[j],
-          args->eviction_params, args->consider_obj_metadata);
+          args->eviction_params, args->consider_obj_metadata,
+          (int64_t)args->reader->n_total_obj);
 
       if (args->admission_algo != NULL) {
         args->caches[idx]->admissioner =
@@ -343,6 +382,10 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
         args->caches[idx]->prefetcher = create_prefetcher(
             args->prefetch_algo, args->prefetch_params, args->cache_sizes[j]);
       }
+
+      if (args->flash.enabled) {
+        attach_flash_tier(args->caches[idx], &args->flash);
+      }
     }
   }
 
@@ -352,7 +395,11 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
 void cache_reset(struct arguments *args, int version_num) {
   for (int i = 0; i < args->n_eviction_algo * args->n_cache_size; i++) {
     args->caches[i] = create_cache_with_version_num(args->trace_path, args->eviction_algo[0], args->cache_sizes[i],
-                args->eviction_params, args->consider_obj_metadata, version_num);
+                args->eviction_params, args->consider_obj_metadata, version_num,
+                (int64_t)args->reader->n_total_obj);
+    if (args->flash.enabled) {
+      attach_flash_tier(args->caches[i], &args->flash);
+    }
   }
 }
 
@@ -435,6 +482,9 @@ static int conv_cache_sizes(char *cache_size_str, struct arguments *args) {
   while (token != NULL) {
     if (strchr(token, '.') != NULL) {
       // input is a float
+      if (args->reader->is_stream) {
+        ERROR("relative cache size is not supported when reading from a stream\n");
+      }
       if (wss == 0) {
         int64_t wss_obj = 0, wss_byte = 0;
         cal_working_set_size(args->reader, &wss_obj, &wss_byte);
@@ -463,6 +513,9 @@ static void set_cache_size(struct arguments *args, reader_t *reader) {
   // }
 
   // detect cache size from the trace
+  if (reader->is_stream) {
+    ERROR("cache size must be given when reading from a stream\n");
+  }
   int n_cache_sizes = 0;
   int64_t wss_obj = 0, wss_byte = 0;
   cal_working_set_size(reader, &wss_obj, &wss_byte);
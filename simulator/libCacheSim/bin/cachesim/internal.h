@@ -4,6 +4,7 @@
 
 #include "../../include/libCacheSim/admissionAlgo.h"
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/costModel.h"
 #include "../../include/libCacheSim/enum.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 #include "../../include/libCacheSim/reader.h"
@@ -46,6 +47,12 @@ struct arguments {
   bool ignore_obj_size;
   bool consider_obj_metadata;
   bool use_ttl;
+  /* the eviction algo is promotionOracle, compute the optimal promotions of
+   * FIFO-reinsertion instead of simulating caches */
+  bool promotion_oracle;
+  cost_model_params_t cost_model;
+  /* enabled by --flash */
+  flash_params_t flash;
 
   /* arguments generated */
   reader_t *reader;
@@ -59,10 +66,20 @@ void cache_reset(struct arguments *args, int version_num);
 void free_arg(struct arguments *args);
 
 void simulate(reader_t *reader, cache_t *cache, int report_interval,
-              int warmup_sec, char *ofilepath, bool ignore_obj_size);
+              int warmup_sec, char *ofilepath, bool ignore_obj_size,
+              const cost_model_params_t *cost_model);
 
 void print_parsed_args(struct arguments *args);
 
+/**
+ * @brief append the write amplification, device write bandwidth and the
+ * request rate the device sustains to a result line ending with a newline,
+ * does nothing if the flash tier is not enabled
+ */
+void append_flash_stat(char *output_str, size_t size,
+                       const flash_params_t *params, const flash_stat_t *stat,
+                       int64_t n_req);
+
 #ifdef __cplusplus
 }
 #endif
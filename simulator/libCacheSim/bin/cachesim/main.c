@@ -7,6 +7,7 @@
 #include <libgen.h>
 
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/promotionOracle.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../include/libCacheSim/simulator.h"
 #include "../../utils/include/mystr.h"
@@ -18,7 +19,8 @@ int dump(struct arguments args, cache_stat_t *result) {
   char output_str[1024];
   char output_filename[128];
   create_dir("result/");
-  sprintf(output_filename, "result/%s", basename(args.trace_path));
+  sprintf(output_filename, "result/%s",
+          strcmp(args.trace_path, "-") == 0 ? "stdin" : basename(args.trace_path));
   FILE *output_file = fopen(output_filename, "a");
 
   uint64_t size_unit = 1;
@@ -42,14 +44,18 @@ int dump(struct arguments args, cache_stat_t *result) {
   for (int i = 0; i < args.n_cache_size * args.n_eviction_algo; i++) {
     // printf("DEBUG - number of misses: %f\n", (double)result[i].n_miss);
     // printf("DEBUG - number of requests: %f\n", (double)result[i].n_req);
+    cost_estimate_t cost = estimate_cost(&args.cost_model, &result[i]);
     snprintf(output_str, 1024,
              "%s %32s cache size %8ld%s, %lld req, miss ratio %.4lf, byte miss "
-             "ratio %.4lf %8ld %.4lf %8ld %8ld %8ld %8ld %8ld\n",
+             "ratio %.4lf %8ld %.4lf %8ld %8ld %8ld %8ld %8ld, cpu %.1lf ns/req, critical section %.1lf ns/req, "
+             "modelled throughput %.2lf MQPS (%d threads)\n",
              output_filename, result[i].cache_name, (long)(result[i].cache_size / size_unit), size_unit_str,
              (long long)result[i].n_req, (double)result[i].n_miss / (double)result[i].n_req,
              (double)result[i].n_miss_byte / (double)result[i].n_req_byte, result[i].n_promotion,
              result[i].mean_stay_time, result[i].type1, result[i].type2, result[i].type3, result[i].type4,
-             result[i].type5);
+             result[i].type5, cost.cpu_ns_per_req, cost.cs_ns_per_req, cost.throughput_n, args.cost_model.n_thread);
+    append_flash_stat(output_str, 1024, &args.flash, &result[i].flash,
+                      result[i].n_req);
     printf("%s", output_str);
     fprintf(output_file, "%s", output_str);
   }
@@ -58,11 +64,67 @@ int dump(struct arguments args, cache_stat_t *result) {
   return 0;
 }
 
+/**
+ * @brief compute the optimal promotions at each cache size, print the miss
+ * ratio and the number of promotions, and write the per-request promotion
+ * decisions (uint32 per request) to result/<trace>.promotion.<cache_size>
+ */
+static void run_promotion_oracle(struct arguments *args) {
+  int64_t cache_sizes[N_MAX_CACHE_SIZE];
+  for (int i = 0; i < args->n_cache_size; i++) {
+    cache_sizes[i] = (int64_t)args->cache_sizes[i];
+  }
+  promotion_oracle_result_t *results =
+      get_optimal_promotion(args->reader, cache_sizes, args->n_cache_size, true);
+
+  char output_str[1024];
+  char output_filename[128];
+  const char *trace_name =
+      strcmp(args->trace_path, "-") == 0 ? "stdin" : basename(args->trace_path);
+  create_dir("result/");
+  sprintf(output_filename, "result/%s", trace_name);
+  FILE *output_file = fopen(output_filename, "a");
+
+  printf("\n");
+  for (int i = 0; i < args->n_cache_size; i++) {
+    promotion_oracle_result_t *result = &results[i];
+    snprintf(output_str, 1024,
+             "%s %32s cache size %8ld, %lld req, miss ratio %.4lf, "
+             "target hit ratio %.4lf, promotion %lld\n",
+             output_filename, "promotionOracle", (long)result->cache_size,
+             (long long)result->n_req,
+             (double)result->n_miss / (double)result->n_req,
+             (double)result->n_target_hit / (double)result->n_req,
+             (long long)result->n_promotion);
+    printf("%s", output_str);
+    fprintf(output_file, "%s", output_str);
+
+    char decision_filename[256];
+    snprintf(decision_filename, sizeof(decision_filename),
+             "result/%s.promotion.%ld", trace_name, (long)result->cache_size);
+    FILE *decision_file = fopen(decision_filename, "wb");
+    if (decision_file == NULL) {
+      ERROR("cannot open file %s %s\n", decision_filename, strerror(errno));
+    }
+    fwrite(result->promotion, sizeof(uint32_t), result->n_req, decision_file);
+    fclose(decision_file);
+  }
+  fclose(output_file);
+
+  free_promotion_oracle_result(results, args->n_cache_size);
+}
+
 int main(int argc, char **argv) {
   struct arguments args;
 
   parse_cmd(argc, argv, &args);
 
+  if (args.promotion_oracle) {
+    run_promotion_oracle(&args);
+    free_arg(&args);
+    return 0;
+  }
+
   int64_t req_num = get_num_of_req(args.reader);
 
   if (args.n_cache_size == 0) {
@@ -73,21 +135,28 @@ int main(int argc, char **argv) {
   if (args.n_cache_size * args.n_eviction_algo == 1) {
     // find the
     int64_t size = req_num;
-    int *if_promote = malloc(sizeof(int) * size);
-    uint64_t *time_downgrade = malloc(sizeof(uint64_t) * size);
-    for (int i = 0; i < size; i++) {
-      if_promote[i] = -1;
-      time_downgrade[i] = UINT64_MAX;
+    int *if_promote = NULL;
+    uint64_t *time_downgrade = NULL;
+    /* the number of requests in a stream is unknown, so the promotion history
+     * cannot be recorded */
+    bool optimal_search = size > 0;
+    if (optimal_search) {
+      if_promote = malloc(sizeof(int) * size);
+      time_downgrade = malloc(sizeof(uint64_t) * size);
+      for (int i = 0; i < size; i++) {
+        if_promote[i] = -1;
+        time_downgrade[i] = UINT64_MAX;
+      }
     }
     int version_num = 0;
     args.caches[0]->if_promote = if_promote;
     args.caches[0]->time_downgrade = time_downgrade;
     args.caches[0]->version_num = version_num;
-    args.caches[0]->mode_optimal_search = true;
+    args.caches[0]->mode_optimal_search = optimal_search;
 
     for (int i = 0; i < 1; i++) {
       simulate(args.reader, args.caches[0], args.report_interval, args.warmup_sec, args.ofilepath,
-               args.ignore_obj_size);
+               args.ignore_obj_size, &args.cost_model);
       reset_reader(args.reader);
       cache_reset(&args, version_num);
       version_num++;
@@ -95,7 +164,7 @@ int main(int argc, char **argv) {
       args.caches[0]->n_req = 0;
       args.caches[0]->if_promote = if_promote;
       args.caches[0]->time_downgrade = time_downgrade;
-      args.caches[0]->mode_optimal_search = true;
+      args.caches[0]->mode_optimal_search = optimal_search;
     }
     free(if_promote);
     free(time_downgrade);
@@ -106,7 +175,11 @@ int main(int argc, char **argv) {
     int64_t size = req_num;
     int **if_promotes = malloc(sizeof(int *) * args.n_cache_size);
     uint64_t **time_downgrades = malloc(sizeof(uint64_t *) * args.n_cache_size);
+    bool optimal_search = size > 0;
     for (int i = 0; i < args.n_cache_size; i++) {
+      if_promotes[i] = NULL;
+      time_downgrades[i] = NULL;
+      if (!optimal_search) continue;
       if_promotes[i] = malloc(sizeof(int) * size);
       time_downgrades[i] = malloc(sizeof(uint64_t) * size);
       for (int j = 0; j < size; j++) {
@@ -120,7 +193,7 @@ int main(int argc, char **argv) {
         args.caches[j]->if_promote = if_promotes[j];
         args.caches[j]->time_downgrade = time_downgrades[j];
         args.caches[j]->version_num = version_num;
-        args.caches[j]->mode_optimal_search = true;
+        args.caches[j]->mode_optimal_search = optimal_search;
       }
       cache_stat_t *result =
           simulate_with_multi_caches(args.reader, args.caches, args.n_cache_size * args.n_eviction_algo, NULL, 0,
@@ -179,14 +252,18 @@ int main(int argc, char **argv) {
   for (int i = 0; i < args.n_cache_size * args.n_eviction_algo; i++) {
     // printf("DEBUG - number of misses: %f\n", (double)result[i].n_miss);
     // printf("DEBUG - number of requests: %f\n", (double)result[i].n_req);
+    cost_estimate_t cost = estimate_cost(&args.cost_model, &result[i]);
     snprintf(output_str, 1024,
              "%s %32s cache size %8ld%s, %lld req, miss ratio %.4lf, byte miss "
-             "ratio %.4lf %8ld %.4lf %8ld %8ld %8ld %8ld %8ld\n",
+             "ratio %.4lf %8ld %.4lf %8ld %8ld %8ld %8ld %8ld, cpu %.1lf ns/req, critical section %.1lf ns/req, "
+             "modelled throughput %.2lf MQPS (%d threads)\n",
              output_filename, result[i].cache_name, (long)(result[i].cache_size / size_unit), size_unit_str,
              (long long)result[i].n_req, (double)result[i].n_miss / (double)result[i].n_req,
              (double)result[i].n_miss_byte / (double)result[i].n_req_byte, result[i].n_promotion,
              result[i].mean_stay_time, result[i].type1, result[i].type2, result[i].type3, result[i].type4,
-             result[i].type5);
+             result[i].type5, cost.cpu_ns_per_req, cost.cs_ns_per_req, cost.throughput_n, args.cost_model.n_thread);
+    append_flash_stat(output_str, 1024, &args.flash, &result[i].flash,
+                      result[i].n_req);
     printf("%s", output_str);
     fprintf(output_file, "%s", output_str);
   }
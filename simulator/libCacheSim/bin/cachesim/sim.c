@@ -1,17 +1,71 @@
 
 
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/costModel.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../utils/include/mymath.h"
 #include "../../utils/include/mystr.h"
 #include "../../utils/include/mysys.h"
+#include "internal.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* the number of requests given to get_batch at a time */
+#define SIM_BATCH_SIZE 16384
+
+/**
+ * @brief simulate the rest of the trace with get_batch, e.g., lpFIFO_shards
+ * running its shards on separate threads,
+ * req holds the next request whose clock_time has been adjusted
+ */
+static void simulate_in_batches(reader_t *reader, cache_t *cache, request_t *req, uint64_t start_ts,
+                                uint64_t *req_cnt, uint64_t *req_byte, uint64_t *miss_cnt,
+                                uint64_t *miss_byte) {
+  request_t *reqs = my_malloc_n(request_t, SIM_BATCH_SIZE);
+  memset(reqs, 0, sizeof(request_t) * SIM_BATCH_SIZE);
+  bool *hits = my_malloc_n(bool, SIM_BATCH_SIZE);
+
+  while (req->valid) {
+    int n_req = 0;
+    while (req->valid && n_req < SIM_BATCH_SIZE) {
+      copy_request(&reqs[n_req++], req);
+      read_one_req(reader, req);
+      req->clock_time -= start_ts;
+    }
+
+    cache->get_batch(cache, reqs, n_req, hits);
+
+    for (int i = 0; i < n_req; i++) {
+      *req_cnt += 1;
+      *req_byte += reqs[i].obj_size;
+      if (!hits[i]) {
+        *miss_cnt += 1;
+        *miss_byte += reqs[i].obj_size;
+      }
+    }
+  }
+
+  my_free(sizeof(request_t) * SIM_BATCH_SIZE, reqs);
+  my_free(sizeof(bool) * SIM_BATCH_SIZE, hits);
+}
+
+void append_flash_stat(char *output_str, size_t size, const flash_params_t *params, const flash_stat_t *stat,
+                       int64_t n_req) {
+  if (!params->enabled) return;
+
+  size_t len = strlen(output_str);
+  if (len > 0 && output_str[len - 1] == '\n') len -= 1;
+  flash_estimate_t est = estimate_flash(params, stat, n_req);
+  snprintf(output_str + len, size - len,
+           ", flash write amp %.3lf, device write %.2lf MB/s, "
+           "achievable %.2lf MQPS\n",
+           est.write_amp, est.write_mbps, est.max_mqps);
+}
+
 void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_sec, char *ofilepath,
-              bool ignore_obj_size) {
+              bool ignore_obj_size, const cost_model_params_t *cost_model) {
   /* random seed */
   srand(time(NULL));
   set_rand_seed(rand());
@@ -25,6 +79,10 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
   uint64_t start_ts = (uint64_t)req->clock_time;
   uint64_t last_report_ts = warmup_sec;
 
+  /* the counters at the end of warmup */
+  cache_stat_t warmup_stat;
+  memset(&warmup_stat, 0, sizeof(warmup_stat));
+
   double start_time = -1;
   while (req->valid) {
     req->clock_time -= start_ts;
@@ -35,9 +93,16 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
     } else {
       if (start_time < 0) {
         start_time = gettime();
+        get_cache_op_stat(cache, NULL, &warmup_stat);
       }
     }
 
+    if (cache->get_batch != NULL) {
+      simulate_in_batches(reader, cache, req, start_ts, &req_cnt, &req_byte,
+                          &miss_cnt, &miss_byte);
+      break;
+    }
+
     req_cnt++;
     req_byte += req->obj_size;
     if (cache->get(cache, req) == false) {
@@ -68,6 +133,13 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
 
   double runtime = gettime() - start_time;
 
+  cache_stat_t stat;
+  memset(&stat, 0, sizeof(stat));
+  stat.n_req = (int64_t)req_cnt;
+  stat.n_miss = (int64_t)miss_cnt;
+  get_cache_op_stat(cache, &warmup_stat, &stat);
+  cost_estimate_t cost = estimate_cost(cost_model, &stat);
+
   char output_str[1024];
   char size_str[8];
   if (!ignore_obj_size) convert_size_to_str(cache->cache_size, size_str);
@@ -76,18 +148,26 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
   if (!ignore_obj_size) {
     snprintf(output_str, 1024,
              "%s %s cache size %8s, %16lu req, miss ratio %.4lf, throughput "
-             "%.2lf MQPS\n",
+             "%.2lf MQPS, cpu %.1lf ns/req, critical section %.1lf ns/req, "
+             "modelled throughput %.2lf MQPS (%d threads)\n",
              reader->trace_path, cache->cache_name, size_str, (unsigned long)req_cnt,
-             (double)miss_cnt / (double)req_cnt, (double)req_cnt / 1000000.0 / runtime);
+             (double)miss_cnt / (double)req_cnt, (double)req_cnt / 1000000.0 / runtime, cost.cpu_ns_per_req,
+             cost.cs_ns_per_req, cost.throughput_n, cost_model->n_thread);
   } else {
     snprintf(output_str, 1024,
              "%s %s cache size %8ld, %16lu req, miss ratio %.4lf, throughput "
-             "%.2lf MQPS, promotion %ld\n",
+             "%.2lf MQPS, promotion %ld, cpu %.1lf ns/req, critical section %.1lf ns/req, "
+             "modelled throughput %.2lf MQPS (%d threads)\n",
              reader->trace_path, cache->cache_name, cache->cache_size, (unsigned long)req_cnt,
-             (double)miss_cnt / (double)req_cnt, (double)req_cnt / 1000000.0 / runtime, cache->n_promotion);
+             (double)miss_cnt / (double)req_cnt, (double)req_cnt / 1000000.0 / runtime, (long)stat.n_promotion,
+             cost.cpu_ns_per_req, cost.cs_ns_per_req, cost.throughput_n, cost_model->n_thread);
   }
 
 #pragma GCC diagnostic pop
+  if (cache->flash != NULL) {
+    append_flash_stat(output_str, sizeof(output_str), &cache->flash->params,
+                      &stat.flash, (int64_t)req_cnt);
+  }
   printf("%s", output_str);
   // printf("hit count %ld\n", req_cnt - miss_cnt);
 
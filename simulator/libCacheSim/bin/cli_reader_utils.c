@@ -2,6 +2,7 @@
 
 #define _GNU_SOURCE
 #include <assert.h>
+#include <errno.h>
 #include <string.h>
 
 #include "../include/libCacheSim/reader.h"
@@ -61,6 +62,10 @@ trace_type_e trace_type_str_to_enum(const char *trace_type_str,
     return ORACLE_SYS_TWRNS_TRACE;
   } else if (strcasecmp(trace_type_str, "valpinTrace") == 0) {
     return VALPIN_TRACE;
+  } else if (strcasecmp(trace_type_str, "merge") == 0) {
+    return MERGE_TRACE;
+  } else if (strcasecmp(trace_type_str, "synthetic") == 0) {
+    return SYNTHETIC_TRACE;
   } else {
     ERROR("unsupported trace type: %s\n", trace_type_str);
   }
@@ -186,7 +191,9 @@ void parse_reader_params(const char *reader_params_str,
 trace_type_e detect_trace_type(const char *trace_path) {
   trace_type_e trace_type = UNKNOWN_TRACE;
 
-  if (strcasestr(trace_path, "oracleGeneralBin") != NULL ||
+  if (strncasecmp(trace_path, "synthetic:", 10) == 0) {
+    trace_type = SYNTHETIC_TRACE;
+  } else if (strcasestr(trace_path, "oracleGeneralBin") != NULL ||
       strcasestr(trace_path, "oracleGeneral.bin") != NULL ||
       strcasestr(trace_path, "bin.oracleGeneral") != NULL ||
       strcasestr(trace_path, "oracleGeneral.zst") != NULL ||
@@ -283,6 +290,91 @@ void cal_working_set_size(reader_t *reader, int64_t *wss_obj,
   reset_reader(reader);
 }
 
+/**
+ * @brief setup a merge reader from a file listing the traces to merge,
+ * each line has the trace path, trace type and an optional rate scale,
+ * e.g., "/data/cluster52.oracleGeneral oracleGeneral 2.0",
+ * empty lines and lines starting with # are ignored,
+ * relative paths are relative to the directory of the merge file
+ *
+ * @param merge_file_path
+ * @param init_params the parameters used by all traces
+ * @return reader_t*
+ */
+reader_t *setup_merge_reader_from_file(const char *merge_file_path,
+                                       const reader_init_param_t *init_params) {
+  FILE *f = fopen(merge_file_path, "r");
+  if (f == NULL) {
+    ERROR("cannot open %s: %s\n", merge_file_path, strerror(errno));
+    exit(1);
+  }
+
+  int n_readers = 0, n_allocated = 8;
+  reader_t **readers = malloc(sizeof(reader_t *) * n_allocated);
+  double *rate_scales = malloc(sizeof(double) * n_allocated);
+
+  /* the sources are not sampled or capped, the merged trace is */
+  reader_init_param_t source_params;
+  memcpy(&source_params, init_params, sizeof(reader_init_param_t));
+  source_params.sampler = NULL;
+  source_params.cap_at_n_req = -1;
+
+  char merge_dir[1024];
+  strncpy(merge_dir, merge_file_path, sizeof(merge_dir) - 1);
+  merge_dir[sizeof(merge_dir) - 1] = '\0';
+  char *slash = strrchr(merge_dir, '/');
+  if (slash != NULL) {
+    *(slash + 1) = '\0';
+  } else {
+    merge_dir[0] = '\0';
+  }
+
+  char line[1024], trace_path[1024], path[2048], type_str[128];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    double rate_scale = 1.0;
+    if (line[0] == '#') continue;
+    int n_field =
+        sscanf(line, "%1023s %127s %lf", trace_path, type_str, &rate_scale);
+    if (n_field <= 0) continue;
+    if (n_field == 1) {
+      ERROR("trace type is missing in line \"%s\" of %s\n", line,
+            merge_file_path);
+      exit(1);
+    }
+
+    snprintf(path, sizeof(path), "%s%s",
+             trace_path[0] == '/' ? "" : merge_dir, trace_path);
+    trace_type_e trace_type = trace_type_str_to_enum(type_str, path);
+    if (trace_type == MERGE_TRACE) {
+      ERROR("cannot merge a merge trace %s\n", path);
+      exit(1);
+    }
+
+    if (n_readers == n_allocated) {
+      n_allocated *= 2;
+      readers = realloc(readers, sizeof(reader_t *) * n_allocated);
+      rate_scales = realloc(rate_scales, sizeof(double) * n_allocated);
+    }
+    readers[n_readers] = setup_reader(path, trace_type, &source_params);
+    rate_scales[n_readers] = rate_scale;
+    n_readers++;
+  }
+  fclose(f);
+
+  if (n_readers == 0) {
+    ERROR("no trace found in %s\n", merge_file_path);
+    exit(1);
+  }
+
+  INFO("merging %d traces from %s\n", n_readers, merge_file_path);
+  reader_t *reader =
+      setup_merge_reader(readers, n_readers, rate_scales, init_params);
+  free(readers);
+  free(rate_scales);
+
+  return reader;
+}
+
 /**
  * @brief Create a reader from the parameters
  *
@@ -315,7 +407,12 @@ reader_t *create_reader(const char *trace_type_str, const char *trace_path,
     reader_init_params.sampler = sampler;
   }
 
-  reader_t *reader = setup_reader(trace_path, trace_type, &reader_init_params);
+  reader_t *reader;
+  if (trace_type == MERGE_TRACE) {
+    reader = setup_merge_reader_from_file(trace_path, &reader_init_params);
+  } else {
+    reader = setup_reader(trace_path, trace_type, &reader_init_params);
+  }
 
   return reader;
 }
@@ -0,0 +1,231 @@
+
+
+#define _GNU_SOURCE
+#include <argp.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/const.h"
+#include "../../utils/include/mystr.h"
+#include "../../utils/include/mysys.h"
+#include "../cli_reader_utils.h"
+#include "internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *argp_program_version = "concurrentSim 0.0.1";
+const char *argp_program_bug_address =
+    "https://groups.google.com/g/libcachesim/";
+
+enum argp_option_short {
+  OPTION_TRACE_TYPE_PARAMS = 't',
+  OPTION_NUM_REQ = 'n',
+  OPTION_VERBOSE = 'v',
+  OPTION_NUM_THREAD = 0x100,
+  OPTION_BATCH_SIZE = 0x101,
+  OPTION_DELAY_RATIO = 0x102,
+  OPTION_PROB = 0x103,
+  OPTION_LATENCY_SAMPLE = 0x104,
+  OPTION_N_BIT_COUNTER = 0x105,
+  OPTION_VERIFY = 0x106,
+};
+
+/*
+   OPTIONS.  Field 1 in ARGP.
+   Order of fields: {NAME, KEY, ARG, FLAGS, DOC}.
+*/
+static struct argp_option options[] = {
+    {"trace-type-params", OPTION_TRACE_TYPE_PARAMS,
+     "\"obj-id-col=1;delimiter=,\"", 0,
+     "Parameters used for csv trace, e.g., \"obj-id-col=1;delimiter=,\"", 2},
+    {"num-req", OPTION_NUM_REQ, "-1", 0,
+     "Num of requests to process, default -1 means all requests in the trace"},
+
+    {"num-thread", OPTION_NUM_THREAD, "1,2,4,8", 0,
+     "The number of worker threads, a list runs one experiment per count", 4},
+    {"batch-size", OPTION_BATCH_SIZE, "32", 0,
+     "The per-thread buffer size of lru-batch", 4},
+    {"delay-ratio", OPTION_DELAY_RATIO, "0.1", 0,
+     "lru-delay promotes an object at most once every delay-ratio * "
+     "cache_size insertions",
+     4},
+    {"prob", OPTION_PROB, "0.5", 0,
+     "The probability that lru-prob promotes an object on hit", 4},
+    {"latency-sample", OPTION_LATENCY_SAMPLE, "16", 0,
+     "Measure the latency of one in every n gets", 4},
+    {"n-bit-counter", OPTION_N_BIT_COUNTER, "1", 0,
+     "The number of bits of the frequency counter of clock-lockfree", 4},
+    {"verify", OPTION_VERIFY, "false", 0,
+     "Check the cache after each run and compare clock-lockfree with the "
+     "single-threaded Clock",
+     4},
+
+    {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output"},
+
+    {0}};
+
+/**
+ * @brief parse a comma separated list of thread counts, e.g., 1,2,4,8
+ */
+static void parse_thread_cnts(char *thread_cnt_str, struct arguments *args) {
+  char *token = strtok(thread_cnt_str, ",");
+  args->n_thread_cnt = 0;
+  while (token != NULL) {
+    if (args->n_thread_cnt >= N_MAX_THREAD_CNT) {
+      ERROR("too many thread counts, at most %d\n", N_MAX_THREAD_CNT);
+    }
+    int n_thread = atoi(token);
+    if (n_thread <= 0) {
+      n_thread = n_cores();
+    }
+    args->thread_cnts[args->n_thread_cnt++] = n_thread;
+    token = strtok(NULL, ",");
+  }
+}
+
+/*
+   PARSER. Field 2 in ARGP.
+   Order of parameters: KEY, ARG, STATE.
+*/
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+  struct arguments *arguments = state->input;
+
+  switch (key) {
+    case OPTION_TRACE_TYPE_PARAMS:
+      arguments->trace_type_params = arg;
+      break;
+    case OPTION_NUM_REQ:
+      arguments->n_req = atoll(arg);
+      break;
+    case OPTION_NUM_THREAD:
+      parse_thread_cnts(arg, arguments);
+      break;
+    case OPTION_BATCH_SIZE:
+      arguments->batch_size = atoi(arg);
+      break;
+    case OPTION_DELAY_RATIO:
+      arguments->delay_ratio = atof(arg);
+      break;
+    case OPTION_PROB:
+      arguments->prob = atof(arg);
+      if (arguments->prob < 0 || arguments->prob > 1) {
+        ERROR("prob should be in [0, 1]\n");
+      }
+      break;
+    case OPTION_LATENCY_SAMPLE:
+      arguments->latency_sample = atoi(arg);
+      if (arguments->latency_sample <= 0) {
+        arguments->latency_sample = 1;
+      }
+      break;
+    case OPTION_N_BIT_COUNTER:
+      arguments->n_bit_counter = atoi(arg);
+      break;
+    case OPTION_VERIFY:
+      arguments->verify = is_true(arg) ? true : false;
+      break;
+    case OPTION_VERBOSE:
+      arguments->verbose = is_true(arg) ? true : false;
+      break;
+    case ARGP_KEY_ARG:
+      if (state->arg_num >= N_ARGS) {
+        printf("found too many arguments, current %s\n", arg);
+        argp_usage(state);
+        exit(1);
+      }
+      arguments->args[state->arg_num] = arg;
+      break;
+    case ARGP_KEY_END:
+      if (state->arg_num < N_ARGS) {
+        printf("not enough arguments found\n");
+        argp_usage(state);
+        exit(1);
+      }
+      break;
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+/*
+   ARGS_DOC. Field 3 in ARGP.
+   A description of the non-option command-line arguments
+     that we accept.
+*/
+static char args_doc[] = "trace_path trace_type algo cache_size";
+
+/* Program documentation. */
+static char doc[] =
+    "example: ./concurrentSim /trace/path oracleGeneral lru,clock 0.1 "
+    "--num-thread=1,2,4,8\n\n"
+    "replay the trace with multiple threads issuing gets against one shared "
+    "cache, and report the throughput and get latency\n\n"
+    "supported algo: lru/clock/lru-batch/lru-delay/lru-prob/clock-lockfree, "
+    "multiple algorithms can be separated by comma\n"
+    "cache_size is the number of objects, "
+    "or a fraction of the number of objects in the trace\n";
+
+/**
+ * @brief initialize the arguments
+ *
+ * @param args
+ */
+static void init_arg(struct arguments *args) {
+  memset(args, 0, sizeof(struct arguments));
+
+  args->trace_path = NULL;
+  args->trace_type_params = NULL;
+  args->n_req = -1;
+  args->thread_cnts[0] = 1;
+  args->thread_cnts[1] = 2;
+  args->thread_cnts[2] = 4;
+  args->thread_cnts[3] = 8;
+  args->n_thread_cnt = 4;
+  args->batch_size = 32;
+  args->delay_ratio = 0.1;
+  args->prob = 0.5;
+  args->latency_sample = 16;
+  args->n_bit_counter = 1;
+  args->verify = false;
+  args->verbose = true;
+}
+
+/**
+ * @brief parse the command line arguments
+ *
+ * @param argc
+ * @param argv
+ */
+void parse_cmd(int argc, char *argv[], struct arguments *args) {
+  init_arg(args);
+
+  static struct argp argp = {options, parse_opt, args_doc, doc};
+
+  argp_parse(&argp, argc, argv, 0, 0, args);
+
+  args->trace_path = args->args[0];
+  args->trace_type_str = args->args[1];
+  args->algo_str = args->args[2];
+  args->cache_size_str = args->args[3];
+  assert(N_ARGS == 4);
+
+  char *token = strtok(args->algo_str, ",");
+  args->n_algo = 0;
+  while (token != NULL) {
+    if (args->n_algo >= CC_N_ALGO) {
+      ERROR("too many algorithms, at most %d\n", CC_N_ALGO);
+    }
+    args->algos[args->n_algo++] = cc_algo_str_to_enum(token);
+    token = strtok(NULL, ",");
+  }
+
+  args->reader = create_reader(args->trace_type_str, args->trace_path,
+                               args->trace_type_params, args->n_req, true, 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,583 @@
+//
+//  a small concurrent cache engine with a global-lock LRU, a clock with
+//  atomic reference bits, LRU with batched, delayed and probabilistic
+//  promotion, and a clock that does not use the global lock,
+//  see concurrentCache.h
+//
+//  concurrentCache.c
+//  libCacheSim
+//
+
+#include "concurrentCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define N_STRIPE_LOCK_POWER 12
+
+static inline uint64_t _hash(obj_id_t obj_id) {
+  return get_hash_value_int_64(&obj_id);
+}
+
+/* xorshift64*, each thread has its own state */
+static inline double _next_rand(cc_thread_t *thread) {
+  uint64_t x = thread->rand_state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  thread->rand_state = x;
+  return (double)((x * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****              hash table protected by striped locks            ****
+// ****                                                               ****
+// ***********************************************************************
+
+static int32_t _ht_find(concurrent_cache_t *cache, obj_id_t obj_id) {
+  uint64_t bucket = _hash(obj_id) & cache->bucket_mask;
+  pthread_spinlock_t *lock = &cache->stripe_locks[bucket & cache->stripe_mask];
+
+  pthread_spin_lock(lock);
+  int32_t idx = cache->buckets[bucket];
+  while (idx != -1 && cache->objs[idx].obj_id != obj_id) {
+    idx = cache->objs[idx].hash_next;
+  }
+  pthread_spin_unlock(lock);
+
+  return idx;
+}
+
+static void _ht_insert(concurrent_cache_t *cache, int32_t idx) {
+  uint64_t bucket = _hash(cache->objs[idx].obj_id) & cache->bucket_mask;
+  pthread_spinlock_t *lock = &cache->stripe_locks[bucket & cache->stripe_mask];
+
+  pthread_spin_lock(lock);
+  cache->objs[idx].hash_next = cache->buckets[bucket];
+  cache->buckets[bucket] = idx;
+  pthread_spin_unlock(lock);
+}
+
+/* insert the object unless another object with the same id exists,
+ * this is used when inserting without the global lock */
+static bool _ht_insert_if_absent(concurrent_cache_t *cache, int32_t idx) {
+  obj_id_t obj_id = cache->objs[idx].obj_id;
+  uint64_t bucket = _hash(obj_id) & cache->bucket_mask;
+  pthread_spinlock_t *lock = &cache->stripe_locks[bucket & cache->stripe_mask];
+
+  pthread_spin_lock(lock);
+  int32_t curr = cache->buckets[bucket];
+  while (curr != -1 && cache->objs[curr].obj_id != obj_id) {
+    curr = cache->objs[curr].hash_next;
+  }
+  if (curr == -1) {
+    cache->objs[idx].hash_next = cache->buckets[bucket];
+    cache->buckets[bucket] = idx;
+  }
+  pthread_spin_unlock(lock);
+
+  return curr == -1;
+}
+
+static void _ht_remove(concurrent_cache_t *cache, int32_t idx) {
+  uint64_t bucket = _hash(cache->objs[idx].obj_id) & cache->bucket_mask;
+  pthread_spinlock_t *lock = &cache->stripe_locks[bucket & cache->stripe_mask];
+
+  pthread_spin_lock(lock);
+  int32_t *curr = &cache->buckets[bucket];
+  while (*curr != idx) {
+    curr = &cache->objs[*curr].hash_next;
+  }
+  *curr = cache->objs[idx].hash_next;
+  pthread_spin_unlock(lock);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****          queue operations, caller holds the global lock       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void _remove_from_queue(concurrent_cache_t *cache, int32_t idx) {
+  cc_obj_t *obj = &cache->objs[idx];
+  if (obj->prev != -1) {
+    cache->objs[obj->prev].next = obj->next;
+  } else {
+    cache->head = obj->next;
+  }
+  if (obj->next != -1) {
+    cache->objs[obj->next].prev = obj->prev;
+  } else {
+    cache->tail = obj->prev;
+  }
+  obj->prev = obj->next = -1;
+}
+
+static void _prepend_to_head(concurrent_cache_t *cache, int32_t idx) {
+  cc_obj_t *obj = &cache->objs[idx];
+  obj->prev = -1;
+  obj->next = cache->head;
+  if (cache->head != -1) {
+    cache->objs[cache->head].prev = idx;
+  }
+  cache->head = idx;
+  if (cache->tail == -1) {
+    cache->tail = idx;
+  }
+}
+
+static void _move_to_head(concurrent_cache_t *cache, int32_t idx) {
+  if (cache->head == idx) return;
+  _remove_from_queue(cache, idx);
+  _prepend_to_head(cache, idx);
+}
+
+/* the object may have been evicted and its slot reused by another object
+ * after the caller found it without holding the global lock, a slot of
+ * clock-lockfree is in the hash table only when it is READY, if another thread
+ * holds the slot, wait until it has kept or evicted the object */
+static inline bool _is_valid(concurrent_cache_t *cache, int32_t idx,
+                             obj_id_t obj_id) {
+  if (cache->algo == CC_CLOCK_LOCKFREE) {
+    unsigned char state;
+    do {
+      state = atomic_load_explicit(&cache->objs[idx].state,
+                                   memory_order_acquire);
+    } while (state == CC_SLOT_BUSY);
+    return state == CC_SLOT_READY && cache->objs[idx].obj_id == obj_id;
+  }
+  return cache->objs[idx].in_cache && cache->objs[idx].obj_id == obj_id;
+}
+
+/**
+ * @brief find a victim and return its slot, the victim is removed from the
+ * queue and the hash table
+ */
+static int32_t _evict(concurrent_cache_t *cache, cc_thread_t *thread) {
+  int32_t idx = cache->tail;
+  if (cache->algo == CC_CLOCK) {
+    while (atomic_load_explicit(&cache->objs[idx].ref, memory_order_relaxed)) {
+      atomic_store_explicit(&cache->objs[idx].ref, 0, memory_order_relaxed);
+      _move_to_head(cache, idx);
+      thread->n_promotion++;
+      idx = cache->tail;
+    }
+  }
+
+  _remove_from_queue(cache, idx);
+  _ht_remove(cache, idx);
+  cache->objs[idx].in_cache = false;
+  cache->n_obj--;
+
+  return idx;
+}
+
+static void _insert(concurrent_cache_t *cache, cc_thread_t *thread,
+                    obj_id_t obj_id) {
+  int32_t idx;
+  if (cache->n_obj_used < cache->params.cache_size) {
+    idx = (int32_t)cache->n_obj_used++;
+  } else {
+    idx = _evict(cache, thread);
+  }
+
+  cc_obj_t *obj = &cache->objs[idx];
+  int64_t n_insert =
+      atomic_fetch_add_explicit(&cache->n_insert, 1, memory_order_relaxed) + 1;
+  obj->obj_id = obj_id;
+  obj->in_cache = true;
+  atomic_store_explicit(&obj->ref, 0, memory_order_relaxed);
+  atomic_store_explicit(&obj->last_promo, n_insert, memory_order_relaxed);
+  _prepend_to_head(cache, idx);
+  _ht_insert(cache, idx);
+  cache->n_obj++;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                        get functions                          ****
+// ****                                                               ****
+// ***********************************************************************
+
+static bool _miss(concurrent_cache_t *cache, cc_thread_t *thread,
+                  obj_id_t obj_id) {
+  pthread_mutex_lock(&cache->lock);
+  thread->n_lock++;
+  /* another thread may have inserted the object after our lookup */
+  if (_ht_find(cache, obj_id) == -1) {
+    _insert(cache, thread, obj_id);
+  }
+  pthread_mutex_unlock(&cache->lock);
+
+  thread->n_miss++;
+  return false;
+}
+
+static bool _lru_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                     obj_id_t obj_id) {
+  pthread_mutex_lock(&cache->lock);
+  thread->n_lock++;
+  int32_t idx = _ht_find(cache, obj_id);
+  if (idx != -1) {
+    if (cache->head != idx) {
+      _move_to_head(cache, idx);
+      thread->n_promotion++;
+    }
+  } else {
+    _insert(cache, thread, obj_id);
+    thread->n_miss++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+
+  return idx != -1;
+}
+
+static bool _clock_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                       obj_id_t obj_id) {
+  int32_t idx = _ht_find(cache, obj_id);
+  if (idx == -1) {
+    return _miss(cache, thread, obj_id);
+  }
+
+  /* read before write so that hot objects do not bounce between cores */
+  if (!atomic_load_explicit(&cache->objs[idx].ref, memory_order_relaxed)) {
+    atomic_store_explicit(&cache->objs[idx].ref, 1, memory_order_relaxed);
+  }
+  return true;
+}
+
+static void _flush_buffer(concurrent_cache_t *cache, cc_thread_t *thread) {
+  if (thread->n_buf == 0) return;
+
+  pthread_mutex_lock(&cache->lock);
+  thread->n_lock++;
+  for (int i = 0; i < thread->n_buf; i++) {
+    int32_t idx = thread->buf[i];
+    if (_is_valid(cache, idx, thread->buf_obj_id[i])) {
+      _move_to_head(cache, idx);
+      thread->n_promotion++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  thread->n_buf = 0;
+}
+
+static bool _lru_batch_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                           obj_id_t obj_id) {
+  int32_t idx = _ht_find(cache, obj_id);
+  if (idx == -1) {
+    return _miss(cache, thread, obj_id);
+  }
+
+  thread->buf[thread->n_buf] = idx;
+  thread->buf_obj_id[thread->n_buf] = obj_id;
+  if (++thread->n_buf == cache->params.batch_size) {
+    _flush_buffer(cache, thread);
+  }
+  return true;
+}
+
+static inline bool _delay_passed(concurrent_cache_t *cache, int32_t idx) {
+  int64_t n_insert =
+      atomic_load_explicit(&cache->n_insert, memory_order_relaxed);
+  int64_t last_promo = atomic_load_explicit(&cache->objs[idx].last_promo,
+                                            memory_order_relaxed);
+  return n_insert - last_promo > cache->delay_time;
+}
+
+static bool _lru_delay_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                           obj_id_t obj_id) {
+  int32_t idx = _ht_find(cache, obj_id);
+  if (idx == -1) {
+    return _miss(cache, thread, obj_id);
+  }
+
+  if (_delay_passed(cache, idx)) {
+    pthread_mutex_lock(&cache->lock);
+    thread->n_lock++;
+    /* check again, another thread may have promoted the object */
+    if (_is_valid(cache, idx, obj_id) && _delay_passed(cache, idx)) {
+      _move_to_head(cache, idx);
+      atomic_store_explicit(
+          &cache->objs[idx].last_promo,
+          atomic_load_explicit(&cache->n_insert, memory_order_relaxed),
+          memory_order_relaxed);
+      thread->n_promotion++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+  }
+  return true;
+}
+
+static bool _lru_prob_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                          obj_id_t obj_id) {
+  int32_t idx = _ht_find(cache, obj_id);
+  if (idx == -1) {
+    return _miss(cache, thread, obj_id);
+  }
+
+  if (_next_rand(thread) < cache->params.prob) {
+    pthread_mutex_lock(&cache->lock);
+    thread->n_lock++;
+    if (_is_valid(cache, idx, obj_id)) {
+      _move_to_head(cache, idx);
+      thread->n_promotion++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+  }
+  return true;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****           clock on a slot array without the global lock       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static bool _clock_lockfree_get(concurrent_cache_t *cache, cc_thread_t *thread,
+                                obj_id_t obj_id) {
+  int32_t idx = _ht_find(cache, obj_id);
+  /* the slot may be reused between the lookup and the increment, the object
+   * is a hit only if it is still in the slot after the increment */
+  if (idx != -1 && _is_valid(cache, idx, obj_id)) {
+    atomic_uchar *freq = &cache->objs[idx].ref;
+    unsigned char f = atomic_load_explicit(freq, memory_order_relaxed);
+    while (f < cache->max_freq &&
+           !atomic_compare_exchange_weak_explicit(
+               freq, &f, f + 1, memory_order_relaxed, memory_order_relaxed)) {
+    }
+    if (_is_valid(cache, idx, obj_id)) return true;
+  }
+
+  thread->n_miss++;
+  uint64_t n_slot = (uint64_t)cache->params.cache_size;
+  while (true) {
+    /* the thread that moves the hand from h to h + 1 inspects slot h */
+    uint_fast64_t h = atomic_load_explicit(&cache->hand, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&cache->hand, &h, h + 1,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+    idx = (int32_t)(h % n_slot);
+    cc_obj_t *obj = &cache->objs[idx];
+
+    /* the hand may wrap around and meet another thread on the same slot */
+    unsigned char state =
+        atomic_load_explicit(&obj->state, memory_order_acquire);
+    if (state == CC_SLOT_BUSY ||
+        !atomic_compare_exchange_strong_explicit(&obj->state, &state,
+                                                 CC_SLOT_BUSY,
+                                                 memory_order_acquire,
+                                                 memory_order_relaxed)) {
+      continue;
+    }
+
+    if (state == CC_SLOT_READY) {
+      /* only the thread holding the slot decreases the counter */
+      if (atomic_load_explicit(&obj->ref, memory_order_relaxed) >= 1) {
+        atomic_fetch_sub_explicit(&obj->ref, 1, memory_order_relaxed);
+        thread->n_promotion++;
+        atomic_store_explicit(&obj->state, CC_SLOT_READY,
+                              memory_order_release);
+        continue;
+      }
+      _ht_remove(cache, idx);
+    }
+
+    obj->obj_id = obj_id;
+    atomic_store_explicit(&obj->ref, 0, memory_order_relaxed);
+    /* another thread may have inserted the same object, the slot is left
+     * empty and will be filled when the hand comes back */
+    state = _ht_insert_if_absent(cache, idx) ? CC_SLOT_READY : CC_SLOT_EMPTY;
+    atomic_store_explicit(&obj->state, state, memory_order_release);
+    return false;
+  }
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+
+concurrent_cache_t *create_concurrent_cache(cc_algo_e algo,
+                                            const cc_params_t params) {
+  if (params.cache_size <= 0 || params.cache_size > INT32_MAX) {
+    ERROR("concurrent cache size %ld is not supported\n",
+          (long)params.cache_size);
+  }
+
+  concurrent_cache_t *cache = malloc(sizeof(concurrent_cache_t));
+  memset(cache, 0, sizeof(concurrent_cache_t));
+  cache->algo = algo;
+  cache->params = params;
+  if (cache->params.batch_size <= 0) cache->params.batch_size = 1;
+  cache->delay_time = (int64_t)(params.delay_ratio * params.cache_size);
+
+  cache->objs = malloc(sizeof(cc_obj_t) * params.cache_size);
+  for (int64_t i = 0; i < params.cache_size; i++) {
+    cache->objs[i].obj_id = 0;
+    cache->objs[i].hash_next = -1;
+    cache->objs[i].prev = cache->objs[i].next = -1;
+    cache->objs[i].in_cache = false;
+    atomic_init(&cache->objs[i].ref, 0);
+    atomic_init(&cache->objs[i].state, CC_SLOT_EMPTY);
+    atomic_init(&cache->objs[i].last_promo, 0);
+  }
+
+  uint64_t n_bucket = 1;
+  while (n_bucket < (uint64_t)params.cache_size) n_bucket <<= 1;
+  cache->buckets = malloc(sizeof(int32_t) * n_bucket);
+  memset(cache->buckets, 0xff, sizeof(int32_t) * n_bucket);
+  cache->bucket_mask = n_bucket - 1;
+
+  uint64_t n_stripe = 1ULL << N_STRIPE_LOCK_POWER;
+  cache->stripe_locks = malloc(sizeof(pthread_spinlock_t) * n_stripe);
+  for (uint64_t i = 0; i < n_stripe; i++) {
+    pthread_spin_init(&cache->stripe_locks[i], PTHREAD_PROCESS_PRIVATE);
+  }
+  cache->stripe_mask = n_stripe - 1;
+
+  pthread_mutex_init(&cache->lock, NULL);
+  cache->head = cache->tail = -1;
+  atomic_init(&cache->n_insert, 0);
+  atomic_init(&cache->hand, 0);
+  if (cache->params.n_bit_counter <= 0) cache->params.n_bit_counter = 1;
+  if (cache->params.n_bit_counter > 8) {
+    ERROR("n_bit_counter %d is larger than 8\n", cache->params.n_bit_counter);
+  }
+  cache->max_freq = (1 << cache->params.n_bit_counter) - 1;
+
+  cache->threads = malloc(sizeof(cc_thread_t) * params.n_thread);
+  memset(cache->threads, 0, sizeof(cc_thread_t) * params.n_thread);
+  for (int i = 0; i < params.n_thread; i++) {
+    cache->threads[i].buf = malloc(sizeof(int32_t) * cache->params.batch_size);
+    cache->threads[i].buf_obj_id =
+        malloc(sizeof(obj_id_t) * cache->params.batch_size);
+    cache->threads[i].rand_state = 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+
+  return cache;
+}
+
+void free_concurrent_cache(concurrent_cache_t *cache) {
+  for (int i = 0; i < cache->params.n_thread; i++) {
+    free(cache->threads[i].buf);
+    free(cache->threads[i].buf_obj_id);
+  }
+  free(cache->threads);
+  for (uint64_t i = 0; i <= cache->stripe_mask; i++) {
+    pthread_spin_destroy(&cache->stripe_locks[i]);
+  }
+  free((void *)cache->stripe_locks);
+  pthread_mutex_destroy(&cache->lock);
+  free(cache->buckets);
+  free(cache->objs);
+  free(cache);
+}
+
+bool concurrent_cache_get(concurrent_cache_t *cache, int thread_id,
+                          obj_id_t obj_id) {
+  cc_thread_t *thread = &cache->threads[thread_id];
+  thread->n_get++;
+
+  switch (cache->algo) {
+    case CC_LRU:
+      return _lru_get(cache, thread, obj_id);
+    case CC_CLOCK:
+      return _clock_get(cache, thread, obj_id);
+    case CC_LRU_BATCH:
+      return _lru_batch_get(cache, thread, obj_id);
+    case CC_LRU_DELAY:
+      return _lru_delay_get(cache, thread, obj_id);
+    case CC_LRU_PROB:
+      return _lru_prob_get(cache, thread, obj_id);
+    case CC_CLOCK_LOCKFREE:
+      return _clock_lockfree_get(cache, thread, obj_id);
+    default:
+      ERROR("unknown concurrent cache algorithm %d\n", cache->algo);
+  }
+  return false;
+}
+
+void concurrent_cache_flush(concurrent_cache_t *cache, int thread_id) {
+  _flush_buffer(cache, &cache->threads[thread_id]);
+}
+
+int64_t concurrent_cache_check(concurrent_cache_t *cache) {
+  int64_t n_obj = 0;
+  if (cache->algo == CC_CLOCK_LOCKFREE) {
+    for (int64_t i = 0; i < cache->params.cache_size; i++) {
+      cc_obj_t *obj = &cache->objs[i];
+      unsigned char state = atomic_load(&obj->state);
+      if (state == CC_SLOT_BUSY) {
+        WARN("slot %ld is still busy\n", (long)i);
+        return -1;
+      }
+      if (state == CC_SLOT_READY) {
+        if (_ht_find(cache, obj->obj_id) != i) {
+          WARN("object %lu in slot %ld is not in the hash table\n",
+               (unsigned long)obj->obj_id, (long)i);
+          return -1;
+        }
+        n_obj++;
+      }
+    }
+  } else {
+    for (int32_t idx = cache->head; idx != -1; idx = cache->objs[idx].next) {
+      if (!cache->objs[idx].in_cache ||
+          _ht_find(cache, cache->objs[idx].obj_id) != idx) {
+        WARN("object %lu in the queue is not in the hash table\n",
+             (unsigned long)cache->objs[idx].obj_id);
+        return -1;
+      }
+      n_obj++;
+    }
+    if (n_obj != cache->n_obj) {
+      WARN("queue has %ld objects, expect %ld\n", (long)n_obj,
+           (long)cache->n_obj);
+      return -1;
+    }
+  }
+
+  /* every object in the hash table is counted above */
+  int64_t n_hashed = 0;
+  for (uint64_t b = 0; b <= cache->bucket_mask; b++) {
+    for (int32_t idx = cache->buckets[b]; idx != -1;
+         idx = cache->objs[idx].hash_next) {
+      n_hashed++;
+    }
+  }
+  if (n_hashed != n_obj || n_obj > cache->params.cache_size) {
+    WARN("hash table has %ld objects, expect %ld\n", (long)n_hashed,
+         (long)n_obj);
+    return -1;
+  }
+
+  return n_obj;
+}
+
+cc_algo_e cc_algo_str_to_enum(const char *algo_str) {
+  for (int i = 0; i < CC_N_ALGO; i++) {
+    if (strcasecmp(algo_str, cc_algo_names[i]) == 0) {
+      return (cc_algo_e)i;
+    }
+  }
+  ERROR("unknown concurrent cache algorithm %s, supported: lru, clock, "
+        "lru-batch, lru-delay, lru-prob, clock-lockfree\n",
+        algo_str);
+  return CC_N_ALGO;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+#pragma once
+//
+//  a small concurrent cache engine, multiple threads issue gets against one
+//  shared cache, this is used to measure how lazy promotion translates into
+//  throughput when there is real synchronization
+//
+//  the caches in libCacheSim are single-threaded, so this engine has its own
+//  hash table and queue, objects have unit size and the cache size is the
+//  number of objects
+//
+//  concurrentCache.h
+//  libCacheSim
+//
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../include/libCacheSim/request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  /* every get takes the global lock */
+  CC_LRU,
+  /* hit sets an atomic reference bit without locking,
+   * miss takes the global lock and runs the clock hand */
+  CC_CLOCK,
+  /* hit is appended to a per-thread buffer, the buffer is flushed
+   * (promoted) under the global lock when it is full */
+  CC_LRU_BATCH,
+  /* hit is promoted only if the object has not been promoted in the last
+   * delay_ratio * cache_size insertions, checked before taking the lock */
+  CC_LRU_DELAY,
+  /* hit is promoted with probability prob, checked before taking the lock */
+  CC_LRU_PROB,
+  /* FIFO-reinsertion on a fixed-capacity slot array without the global lock,
+   * hit increments an n-bit counter with CAS, miss advances the hand with CAS
+   * and claims a slot by CAS on its state, it is the same as Clock in
+   * libCacheSim when running with one thread */
+  CC_CLOCK_LOCKFREE,
+
+  CC_N_ALGO
+} cc_algo_e;
+
+static const char *const cc_algo_names[] = {
+    "lru", "clock", "lru-batch", "lru-delay", "lru-prob", "clock-lockfree"};
+
+/* the state of a slot used by clock-lockfree */
+typedef enum {
+  CC_SLOT_EMPTY = 0,
+  CC_SLOT_READY = 1,
+  /* a thread is evicting the object or inserting a new object */
+  CC_SLOT_BUSY = 2,
+} cc_slot_state_e;
+
+typedef struct {
+  int64_t cache_size;
+  int n_thread;
+  int batch_size;
+  double delay_ratio;
+  double prob;
+  int n_bit_counter;
+} cc_params_t;
+
+typedef struct {
+  obj_id_t obj_id;
+  int32_t hash_next;
+  /* queue links, prev is towards the head (newest) */
+  int32_t prev;
+  int32_t next;
+  bool in_cache;
+  /* the reference bit, or the n-bit frequency counter of clock-lockfree */
+  atomic_uchar ref;
+  atomic_uchar state;
+  /* the value of n_insert when the object was last promoted */
+  atomic_int_fast64_t last_promo;
+} cc_obj_t;
+
+/* the state owned by one worker thread, it is padded to avoid false sharing */
+typedef struct {
+  int32_t *buf;
+  obj_id_t *buf_obj_id;
+  int n_buf;
+  uint64_t rand_state;
+
+  uint64_t n_get;
+  uint64_t n_miss;
+  uint64_t n_promotion;
+  uint64_t n_lock;
+  char pad[64];
+} cc_thread_t;
+
+typedef struct {
+  cc_algo_e algo;
+  cc_params_t params;
+  int64_t delay_time;
+
+  /* the objects are preallocated and reused so that a thread that found an
+   * object without holding the global lock never reads freed memory */
+  cc_obj_t *objs;
+  int64_t n_obj_used;
+  int64_t n_obj;
+
+  /* the hash table is protected by striped locks, the queue and eviction
+   * are protected by the global lock */
+  int32_t *buckets;
+  uint64_t bucket_mask;
+  pthread_spinlock_t *stripe_locks;
+  uint64_t stripe_mask;
+
+  pthread_mutex_t lock;
+  int32_t head;
+  int32_t tail;
+  atomic_int_fast64_t n_insert;
+
+  /* the eviction hand of clock-lockfree, the slot is hand % cache_size */
+  atomic_uint_fast64_t hand;
+  int max_freq;
+
+  cc_thread_t *threads;
+} concurrent_cache_t;
+
+concurrent_cache_t *create_concurrent_cache(cc_algo_e algo,
+                                            const cc_params_t params);
+
+void free_concurrent_cache(concurrent_cache_t *cache);
+
+/**
+ * @brief get an object from the cache, insert it on a miss,
+ * this function can be called from multiple threads concurrently,
+ * each thread uses a different thread_id
+ *
+ * @return true on hit
+ */
+bool concurrent_cache_get(concurrent_cache_t *cache, int thread_id,
+                          obj_id_t obj_id);
+
+/* promote the objects still in the per-thread buffer */
+void concurrent_cache_flush(concurrent_cache_t *cache, int thread_id);
+
+/**
+ * @brief check that the hash table and the queue (or the slot array) agree,
+ * this must be called when no thread is using the cache
+ *
+ * @return the number of objects in the cache, -1 if inconsistent
+ */
+int64_t concurrent_cache_check(concurrent_cache_t *cache);
+
+cc_algo_e cc_algo_str_to_enum(const char *algo_str);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../../include/libCacheSim/enum.h"
+#include "../../include/libCacheSim/reader.h"
+#include "concurrentCache.h"
+
+#define N_ARGS 4
+#define N_MAX_THREAD_CNT 32
+
+/* This structure is used to communicate with parse_opt. */
+struct arguments {
+  /* argument from the user */
+  char *args[N_ARGS];
+  char *trace_path;
+  char *trace_type_str;
+  char *trace_type_params;
+  char *algo_str;
+  char *cache_size_str;
+  int64_t n_req; /* number of requests to process */
+  int thread_cnts[N_MAX_THREAD_CNT];
+  int n_thread_cnt;
+  int batch_size;
+  double delay_ratio;
+  double prob;
+  int n_bit_counter;
+  /* check the consistency of the cache after each run, and compare
+   * clock-lockfree with the single-threaded Clock */
+  bool verify;
+  /* measure the latency of one in every latency_sample gets */
+  int latency_sample;
+  bool verbose;
+
+  /* arguments generated */
+  reader_t *reader;
+  cc_algo_e algos[CC_N_ALGO];
+  int n_algo;
+};
+
+void parse_cmd(int argc, char *argv[], struct arguments *args);
@@ -0,0 +1,266 @@
+/**
+ * replay a trace with multiple threads against one shared cache and report
+ * the throughput and get latency at different thread counts, this shows how
+ * much the promotion savings of lazy promotion translate into throughput
+ *
+ * each thread replays every n_thread-th request of the trace so that the
+ * interleaving is close to the original order
+ *
+ **/
+
+#define _GNU_SOURCE
+#include <glib.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/reader.h"
+#include "../../utils/include/mysys.h"
+#include "internal.h"
+
+/* latency histogram with 32 sub-buckets per power of two, the error is
+ * within 3% */
+#define LAT_LINEAR_LIMIT 64
+#define LAT_SUB_BUCKET_POWER 5
+#define LAT_N_BUCKET \
+  (LAT_LINEAR_LIMIT + (64 - 6) * (1 << LAT_SUB_BUCKET_POWER))
+
+typedef struct {
+  concurrent_cache_t *cache;
+  const obj_id_t *obj_ids;
+  int64_t n_req;
+  int thread_id;
+  int n_thread;
+  int latency_sample;
+  pthread_barrier_t *barrier;
+  uint64_t lat_hist[LAT_N_BUCKET];
+} worker_params_t;
+
+static inline int lat_to_bucket(uint64_t ns) {
+  if (ns < LAT_LINEAR_LIMIT) return (int)ns;
+  int msb = 63 - __builtin_clzll(ns);
+  return LAT_LINEAR_LIMIT + (msb - 6) * (1 << LAT_SUB_BUCKET_POWER) +
+         (int)((ns >> (msb - LAT_SUB_BUCKET_POWER)) &
+               ((1 << LAT_SUB_BUCKET_POWER) - 1));
+}
+
+static inline uint64_t bucket_to_lat(int bucket) {
+  if (bucket < LAT_LINEAR_LIMIT) return bucket;
+  int msb = (bucket - LAT_LINEAR_LIMIT) / (1 << LAT_SUB_BUCKET_POWER) + 6;
+  uint64_t sub = (bucket - LAT_LINEAR_LIMIT) % (1 << LAT_SUB_BUCKET_POWER);
+  return (1ULL << msb) + (sub << (msb - LAT_SUB_BUCKET_POWER));
+}
+
+static inline uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *worker(void *data) {
+  worker_params_t *params = (worker_params_t *)data;
+  concurrent_cache_t *cache = params->cache;
+  int thread_id = params->thread_id;
+
+  pthread_barrier_wait(params->barrier);
+
+  int64_t cnt = 0;
+  for (int64_t i = thread_id; i < params->n_req; i += params->n_thread) {
+    if (++cnt % params->latency_sample == 0) {
+      uint64_t start = now_ns();
+      concurrent_cache_get(cache, thread_id, params->obj_ids[i]);
+      params->lat_hist[lat_to_bucket(now_ns() - start)]++;
+    } else {
+      concurrent_cache_get(cache, thread_id, params->obj_ids[i]);
+    }
+  }
+  concurrent_cache_flush(cache, thread_id);
+
+  pthread_barrier_wait(params->barrier);
+  return NULL;
+}
+
+static uint64_t get_percentile(const uint64_t *hist, uint64_t n, double p) {
+  uint64_t target = (uint64_t)(n * p);
+  uint64_t sum = 0;
+  for (int i = 0; i < LAT_N_BUCKET; i++) {
+    sum += hist[i];
+    if (sum > target) return bucket_to_lat(i);
+  }
+  return bucket_to_lat(LAT_N_BUCKET - 1);
+}
+
+static void run_one(struct arguments *args, cc_algo_e algo,
+                    const obj_id_t *obj_ids, int64_t n_req,
+                    int64_t cache_size, int n_thread) {
+  cc_params_t cc_params = {.cache_size = cache_size,
+                           .n_thread = n_thread,
+                           .batch_size = args->batch_size,
+                           .delay_ratio = args->delay_ratio,
+                           .prob = args->prob,
+                           .n_bit_counter = args->n_bit_counter};
+  concurrent_cache_t *cache = create_concurrent_cache(algo, cc_params);
+
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, n_thread + 1);
+  pthread_t *threads = malloc(sizeof(pthread_t) * n_thread);
+  worker_params_t *params = malloc(sizeof(worker_params_t) * n_thread);
+  memset(params, 0, sizeof(worker_params_t) * n_thread);
+  for (int i = 0; i < n_thread; i++) {
+    params[i].cache = cache;
+    params[i].obj_ids = obj_ids;
+    params[i].n_req = n_req;
+    params[i].thread_id = i;
+    params[i].n_thread = n_thread;
+    params[i].latency_sample = args->latency_sample;
+    params[i].barrier = &barrier;
+    pthread_create(&threads[i], NULL, worker, &params[i]);
+  }
+
+  pthread_barrier_wait(&barrier);
+  double start_time = gettime();
+  pthread_barrier_wait(&barrier);
+  double runtime = gettime() - start_time;
+
+  uint64_t *lat_hist = calloc(LAT_N_BUCKET, sizeof(uint64_t));
+  uint64_t n_lat = 0, n_get = 0, n_miss = 0, n_promotion = 0, n_lock = 0;
+  for (int i = 0; i < n_thread; i++) {
+    pthread_join(threads[i], NULL);
+    for (int j = 0; j < LAT_N_BUCKET; j++) {
+      lat_hist[j] += params[i].lat_hist[j];
+      n_lat += params[i].lat_hist[j];
+    }
+    n_get += cache->threads[i].n_get;
+    n_miss += cache->threads[i].n_miss;
+    n_promotion += cache->threads[i].n_promotion;
+    n_lock += cache->threads[i].n_lock;
+  }
+
+  printf(
+      "%-14s cache size %8ld, %3d threads, %ld req, miss ratio %.4lf, "
+      "throughput %8.2lf MQPS, p50 %6lu ns, p99 %6lu ns, "
+      "promotion %lu, lock/req %.4lf\n",
+      cc_algo_names[algo], (long)cache_size, n_thread, (long)n_get,
+      (double)n_miss / n_get, (double)n_get / 1000000.0 / runtime,
+      (unsigned long)get_percentile(lat_hist, n_lat, 0.5),
+      (unsigned long)get_percentile(lat_hist, n_lat, 0.99),
+      (unsigned long)n_promotion, (double)n_lock / n_get);
+
+  if (args->verify) {
+    int64_t n_obj = concurrent_cache_check(cache);
+    if (n_obj < 0) {
+      ERROR("%s with %d threads: cache is inconsistent\n", cc_algo_names[algo],
+            n_thread);
+    }
+    INFO("%s with %d threads: cache is consistent, %ld objects\n",
+         cc_algo_names[algo], n_thread, (long)n_obj);
+  }
+
+  free(lat_hist);
+  free(params);
+  free(threads);
+  pthread_barrier_destroy(&barrier);
+  free_concurrent_cache(cache);
+}
+
+/**
+ * @brief run Clock in libCacheSim on the same requests, clock-lockfree with
+ * one thread should have the same miss ratio
+ */
+static void run_reference_clock(struct arguments *args,
+                                const obj_id_t *obj_ids, int64_t n_req,
+                                int64_t cache_size) {
+  common_cache_params_t cc_params = default_common_cache_params();
+  cc_params.cache_size = cache_size;
+  char clock_params[64];
+  snprintf(clock_params, sizeof(clock_params), "n-bit-counter=%d",
+           args->n_bit_counter);
+  cache_t *cache = Clock_init(cc_params, clock_params);
+
+  request_t *req = new_request();
+  uint64_t n_miss = 0;
+  for (int64_t i = 0; i < n_req; i++) {
+    req->obj_id = obj_ids[i];
+    req->obj_size = 1;
+    req->clock_time = i;
+    if (!cache->get(cache, req)) n_miss++;
+  }
+
+  printf("%-14s cache size %8ld,   1 threads, %ld req, miss ratio %.4lf, "
+         "promotion %ld (single-threaded Clock)\n",
+         "Clock", (long)cache_size, (long)n_req, (double)n_miss / n_req,
+         (long)cache->n_promotion);
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+/**
+ * @brief load the object ids of the trace into memory so that reading the
+ * trace is not part of the measurement
+ */
+static obj_id_t *load_trace(reader_t *reader, int64_t *n_req,
+                            int64_t *n_obj) {
+  int64_t n_alloc = get_num_of_req(reader);
+  if (n_alloc <= 0) n_alloc = 1 << 20;
+  obj_id_t *obj_ids = malloc(sizeof(obj_id_t) * n_alloc);
+  GHashTable *obj_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+  request_t *req = new_request();
+  *n_req = 0;
+  while (read_one_req(reader, req) == 0) {
+    if (*n_req == n_alloc) {
+      n_alloc *= 2;
+      obj_ids = realloc(obj_ids, sizeof(obj_id_t) * n_alloc);
+    }
+    obj_ids[(*n_req)++] = req->obj_id;
+    g_hash_table_add(obj_table, GSIZE_TO_POINTER(req->obj_id));
+  }
+  *n_obj = g_hash_table_size(obj_table);
+
+  g_hash_table_destroy(obj_table);
+  free_request(req);
+  return obj_ids;
+}
+
+int main(int argc, char **argv) {
+  struct arguments args;
+  parse_cmd(argc, argv, &args);
+
+  int64_t n_req = 0, n_obj = 0;
+  obj_id_t *obj_ids = load_trace(args.reader, &n_req, &n_obj);
+  if (n_req == 0) {
+    ERROR("no request found in trace %s\n", args.trace_path);
+  }
+
+  int64_t cache_size;
+  if (strchr(args.cache_size_str, '.') != NULL) {
+    cache_size = (int64_t)(n_obj * atof(args.cache_size_str));
+  } else {
+    cache_size = atoll(args.cache_size_str);
+  }
+  if (cache_size <= 0) {
+    ERROR("cache size %s is too small, the trace has %ld objects\n",
+          args.cache_size_str, (long)n_obj);
+  }
+
+  INFO("%s: %ld requests, %ld objects, cache size %ld objects\n",
+       args.trace_path, (long)n_req, (long)n_obj, (long)cache_size);
+
+  for (int i = 0; i < args.n_algo; i++) {
+    if (args.verify && args.algos[i] == CC_CLOCK_LOCKFREE) {
+      run_reference_clock(&args, obj_ids, n_req, cache_size);
+    }
+    for (int j = 0; j < args.n_thread_cnt; j++) {
+      run_one(&args, args.algos[i], obj_ids, n_req, cache_size,
+              args.thread_cnts[j]);
+    }
+  }
+
+  free(obj_ids);
+  close_reader(args.reader);
+
+  return 0;
+}
@@ -7,6 +7,7 @@
 #include "../../include/libCacheSim/const.h"
 #include "../../utils/include/mystr.h"
 #include "../../utils/include/mysys.h"
+#include "../cachesim/cache_init.h"
 #include "../cli_reader_utils.h"
 #include "internal.h"
 
@@ -30,6 +31,14 @@ enum argp_option_short {
   OPTION_ACCESS_PATTERN_SAMPLE_RATIO = 0x102,
   OPTION_TRACK_N_HIT = 0x103,
   OPTION_TRACK_N_POPULAR = 0x104,
+  OPTION_NUM_THREAD = 0x105,
+  OPTION_SKETCH = 0x106,
+  OPTION_ACCESS_PATTERN_STREAM = 0x107,
+  OPTION_SIM_CACHE = 0x108,
+  OPTION_SIM_CACHE_SIZE = 0x109,
+  OPTION_CHECKPOINT = 0x10a,
+  OPTION_RESUME = 0x10b,
+  OPTION_SIM_CACHE_WARMUP_SEC = 0x10c,
 
   OPTION_ENABLE_ALL = 0x200,
   OPTION_ENABLE_COMMON = 0x201,
@@ -52,6 +61,7 @@ enum argp_option_short {
   OPTION_ENABLE_WRITE_REUSE_CCDF = 0x210,
   OPTION_ENABLE_WRITE_REUSE_CCDF2 = 0x211,
   OPTION_ENABLE_WRITE_REUSE_CCDF3 = 0x212,
+  OPTION_ENABLE_FOOTPRINT = 0x213,
 };
 
 /*
@@ -98,6 +108,14 @@ static struct argp_option options[] = {
      3},
     {"ttl", OPTION_ENABLE_TTL, NULL, OPTION_ARG_OPTIONAL,
      "ttl analysis, output a ttl distribution in dataname.ttl file", 2},
+    {"footprint", OPTION_ENABLE_FOOTPRINT, NULL, OPTION_ARG_OPTIONAL,
+     "footprint of all window lengths and the LRU/FIFO miss ratio curves "
+     "derived from it in dataname.footprint",
+     3},
+    {"scanDetector", OPTION_ENABLE_SCAN_DETECTOR, NULL, OPTION_ARG_OPTIONAL,
+     "detect scans in an oracle trace, output the scans in dataname.scan and "
+     "the run size distribution in dataname.scanSize",
+     3},
 
     {NULL, 0, NULL, 0, "trace analyzer related parameters:", 4},
     {"time-window", OPTION_TIME_WINDOW, "300", 0,
@@ -105,10 +123,38 @@ static struct argp_option options[] = {
     {"warmup-sec", OPTION_WARMUP_SEC, "86400", 0, "warm up before analysis", 4},
     {"access-pattern-sample-ratio", OPTION_ACCESS_PATTERN_SAMPLE_RATIO, "0.01",
      0, "the sampling ratio in access pattern analysis", 4},
+    {"access-pattern-stream", OPTION_ACCESS_PATTERN_STREAM, NULL,
+     OPTION_ARG_OPTIONAL,
+     "write the access pattern streams to dataname.accessStream and "
+     "dataname.accessStreamIdx while analyzing, so that they can be mmapped",
+     4},
     {"track-n-hit", OPTION_TRACK_N_HIT, "8", 0,
      "track one-hit-wonder, two-hit-wonder, etc.", 4},
     {"track-n-popular", OPTION_TRACK_N_POPULAR, "8", 0,
      "track how many requests the n most popular objects get", 4},
+    {"num-thread", OPTION_NUM_THREAD, "4", 0,
+     "the number of threads that enrich requests, each owns a hash partition "
+     "of the objects",
+     4},
+    {"sketch", OPTION_SKETCH, "4194304", OPTION_ARG_OPTIONAL,
+     "bounded-memory mode, track at most the given number of hash-sampled "
+     "objects and estimate the trace-wide stat with sketches",
+     4},
+    {"sim-cache", OPTION_SIM_CACHE, "LRU,FIFO", 0,
+     "simulate the caches on the analyzed requests, the miss ratio of each "
+     "time window is in dataname.missRatio_w300",
+     4},
+    {"sim-cache-size", OPTION_SIM_CACHE_SIZE, "1GiB,4GiB", 0,
+     "the sizes of the simulated caches, each cache is simulated at each size",
+     4},
+    {"sim-cache-warmup-sec", OPTION_SIM_CACHE_WARMUP_SEC, "0", 0,
+     "warm up the simulated caches before counting the miss ratio", 4},
+    {"checkpoint", OPTION_CHECKPOINT, "path", 0,
+     "save the analysis state at the end of the trace to the file", 4},
+    {"resume", OPTION_RESUME, "path", 0,
+     "resume from a checkpoint and analyze only the requests after it, the "
+     "outputs of the checkpointed run must be in the working directory",
+     4},
 
     {NULL, 0, NULL, 0, "common parameters:", 0},
 
@@ -147,9 +193,34 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
           (int)(1.0 / arguments->analysis_param.access_pattern_sample_ratio) +
           1;
       break;
+    case OPTION_ACCESS_PATTERN_STREAM:
+      arguments->analysis_param.access_pattern_stream = true;
+      break;
     case OPTION_TRACK_N_HIT:
       arguments->analysis_param.track_n_hit = atoi(arg);
       break;
+    case OPTION_NUM_THREAD:
+      arguments->analysis_param.n_enrich_thread = atoi(arg);
+      break;
+    case OPTION_SKETCH:
+      arguments->analysis_param.sketch = true;
+      if (arg != NULL) arguments->analysis_param.sketch_n_obj = atoll(arg);
+      break;
+    case OPTION_SIM_CACHE:
+      arguments->sim_cache_algos = arg;
+      break;
+    case OPTION_SIM_CACHE_SIZE:
+      arguments->sim_cache_sizes = arg;
+      break;
+    case OPTION_SIM_CACHE_WARMUP_SEC:
+      arguments->analysis_param.sim_cache_warmup_time = atoi(arg);
+      break;
+    case OPTION_CHECKPOINT:
+      arguments->analysis_param.checkpoint_path = arg;
+      break;
+    case OPTION_RESUME:
+      arguments->analysis_param.resume_path = arg;
+      break;
     case OPTION_ENABLE_ALL:
       arguments->analysis_option.req_rate = true;
       arguments->analysis_option.access_pattern = true;
@@ -157,6 +228,7 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
       arguments->analysis_option.reuse = true;
       arguments->analysis_option.popularity = true;
       arguments->analysis_option.popularity_decay = true;
+      arguments->analysis_option.footprint = true;
       break;
     case OPTION_ENABLE_COMMON:
       arguments->analysis_option.req_rate = true;
@@ -186,6 +258,12 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_ENABLE_TTL:
       arguments->analysis_option.ttl = true;
       break;
+    case OPTION_ENABLE_FOOTPRINT:
+      arguments->analysis_option.footprint = true;
+      break;
+    case OPTION_ENABLE_SCAN_DETECTOR:
+      arguments->analysis_option.scan_detector = true;
+      break;
 
     case OPTION_VERBOSE:
       arguments->verbose = is_true(arg) ? true : false;
@@ -248,6 +326,74 @@ static void init_arg(struct arguments *args) {
   args->reader = NULL;
 }
 
+/**
+ * @brief convert a size string with an optional KiB/MiB/GiB/TiB suffix to
+ * bytes, e.g., 100MiB -> 100 * 1024 * 1024
+ */
+static uint64_t conv_size_str_to_byte(const char *size_str) {
+  char *end = NULL;
+  uint64_t size = strtoull(size_str, &end, 10);
+  switch (end == NULL ? '\0' : *end) {
+    case 'k':
+    case 'K':
+      return size * KiB;
+    case 'm':
+    case 'M':
+      return size * MiB;
+    case 'g':
+    case 'G':
+      return size * GiB;
+    case 't':
+    case 'T':
+      return size * TiB;
+    default:
+      return size;
+  }
+}
+
+/**
+ * @brief create the caches to simulate on the request stream, every algorithm
+ * in --sim-cache at every size in --sim-cache-size, the sizes are absolute
+ * because computing the working set size needs another pass over the trace
+ */
+static void create_sim_caches(struct arguments *args) {
+  char algos[1024], sizes[1024];
+  snprintf(algos, sizeof(algos), "%s",
+           args->sim_cache_algos == NULL ? "LRU" : args->sim_cache_algos);
+  snprintf(sizes, sizeof(sizes), "%s",
+           args->sim_cache_sizes == NULL ? "1GiB" : args->sim_cache_sizes);
+
+  uint64_t cache_sizes[N_MAX_SIM_CACHE];
+  int n_size = 0;
+  char *save_ptr = NULL;
+  for (char *token = strtok_r(sizes, ",", &save_ptr); token != NULL;
+       token = strtok_r(NULL, ",", &save_ptr)) {
+    if (n_size == N_MAX_SIM_CACHE) {
+      ERROR("too many cache sizes, at most %d\n", N_MAX_SIM_CACHE);
+    }
+    cache_sizes[n_size] = conv_size_str_to_byte(token);
+    if (cache_sizes[n_size] == 0) {
+      ERROR("invalid cache size %s\n", token);
+    }
+    n_size += 1;
+  }
+
+  int n_cache = 0;
+  for (char *token = strtok_r(algos, ",", &save_ptr); token != NULL;
+       token = strtok_r(NULL, ",", &save_ptr)) {
+    for (int i = 0; i < n_size; i++) {
+      if (n_cache == N_MAX_SIM_CACHE) {
+        ERROR("too many simulated caches, at most %d\n", N_MAX_SIM_CACHE);
+      }
+      args->caches[n_cache++] = create_cache(args->trace_path, token,
+                                             cache_sizes[i], NULL, false, 0);
+    }
+  }
+
+  args->analysis_param.n_cache = n_cache;
+  args->analysis_param.caches = args->caches;
+}
+
 /**
  * @brief parse the command line arguments
  *
@@ -272,6 +418,10 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
 
   args->reader = create_reader(trace_type_str, args->trace_path,
                                args->trace_type_params, args->n_req, false, 1);
+
+  if (args->sim_cache_algos != NULL || args->sim_cache_sizes != NULL) {
+    create_sim_caches(args);
+  }
 }
 
 void free_arg(struct arguments *args) { close_reader(args->reader); }
@@ -8,6 +8,7 @@
 
 #define N_ARGS 2
 #define OFILEPATH_LEN 128
+#define N_MAX_SIM_CACHE 64
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,8 +28,13 @@ struct arguments {
   traceAnalyzer::analysis_option_t analysis_option;
   traceAnalyzer::analysis_param_t analysis_param;
 
+  /* caches simulated on the request stream, each algorithm with each size */
+  char *sim_cache_algos;
+  char *sim_cache_sizes;
+
   /* arguments generated */
   reader_t *reader;
+  cache_t *caches[N_MAX_SIM_CACHE];
 };
 
 void parse_cmd(int argc, char *argv[], struct arguments *args);
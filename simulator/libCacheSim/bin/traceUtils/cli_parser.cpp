@@ -8,6 +8,8 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include <thread>
+
 #include "../../include/libCacheSim/const.h"
 #include "../../utils/include/mysys.h"
 #include "../cli_reader_utils.h"
@@ -27,6 +29,9 @@ enum argp_option_short {
   // trace conv
   OPTION_OUTPUT_TXT = 0x102,
   OPTION_REMOVE_SIZE_CHANGE = 0x103,
+  OPTION_NUM_THREAD = 0x104,
+  OPTION_REMAP_OBJ_ID = 0x105,
+  OPTION_OUTPUT_LCS = 0x106,
 
   // trace print
   OPTION_NUM_REQ = 'n',
@@ -62,6 +67,16 @@ static struct argp_option options[] = {
      "whether remove object size change, if true, objects with changed size "
      "are updated to the old size",
      4},
+    {"num-thread", OPTION_NUM_THREAD, "1", 0,
+     "Number of threads used to compute next access, -1 means all cores", 4},
+    {"remap-obj-id", OPTION_REMAP_OBJ_ID, "false", 0,
+     "map obj_id to dense ids [0, n_obj) in the order of first access, this "
+     "allows simulation with the direct index hashtable",
+     4},
+    {"output-lcs", OPTION_OUTPUT_LCS, "false", 0,
+     "output lcs trace, which has a header storing the number of requests and "
+     "objects",
+     4},
 
     {0, 0, 0, 0, "tracePrint options:"},
     {"num-req", OPTION_NUM_REQ, "-1", 0,
@@ -108,6 +123,18 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_REMOVE_SIZE_CHANGE:
       arguments->remove_size_change = is_true(arg) ? true : false;
       break;
+    case OPTION_NUM_THREAD:
+      arguments->n_thread = atoi(arg);
+      if (arguments->n_thread == 0 || arguments->n_thread == -1) {
+        arguments->n_thread = std::thread::hardware_concurrency();
+      }
+      break;
+    case OPTION_REMAP_OBJ_ID:
+      arguments->remap_obj_id = is_true(arg) ? true : false;
+      break;
+    case OPTION_OUTPUT_LCS:
+      arguments->output_lcs = is_true(arg) ? true : false;
+      break;
     case OPTION_OUTPUT_TXT:
       arguments->output_txt = is_true(arg) ? true : false;
       break;
@@ -188,6 +215,9 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->output_txt = false;
   args->remove_size_change = false;
+  args->n_thread = 1;
+  args->remap_obj_id = false;
+  args->output_lcs = false;
   args->cache_name = NULL;
   args->cache_size = 0;
   args->delimiter = ',';
@@ -226,6 +256,17 @@ static void print_parsed_arg(struct arguments *args) {
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", ignore object size");
 
+  if (args->remap_obj_id)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", remap obj_id to dense ids");
+
+  if (args->output_lcs)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", output lcs trace");
+
+  if (args->n_thread > 1)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", %d threads",
+                  args->n_thread);
+
   snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, "\n");
 
   INFO("%s", output_str);
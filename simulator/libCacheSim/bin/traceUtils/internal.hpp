@@ -28,6 +28,12 @@ struct arguments {
   /* some objects may change size during the trace, this keeps the size as the
    * last size in the trace */
   bool remove_size_change;
+  /* the number of threads used to compute next access, 1 means sequential */
+  int n_thread;
+  /* map obj_id to dense ids [0, n_obj) */
+  bool remap_obj_id;
+  /* output lcs trace, which stores the trace stat in the header */
+  bool output_lcs;
 
   /* trace print */
   int64_t num_req; /* number of requests to print */
@@ -62,10 +68,30 @@ namespace traceConv {
  * @param sample_ratio
  * @param output_txt    whether also output a txt trace
  * @param remove_size_change whether remove object size change during traceConv
+ * @param remap_obj_id whether map obj_id to dense ids [0, n_obj), which
+ *  allows the simulator to use the direct index hashtable
  * @param use_lcs_format whether use lcs format
  */
 void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath,
                               int sample_ratio, bool output_txt,
-                              bool remove_size_change, bool use_lcs_format);
+                              bool remove_size_change, bool remap_obj_id,
+                              bool use_lcs_format);
+
+/**
+ * @brief convert the trace to oracleGeneral format using multiple threads,
+ * the output is the same as convert_to_oracleGeneral
+ *
+ * @param reader
+ * @param ofilepath
+ * @param n_thread      the number of threads used to compute next access
+ * @param output_txt    whether also output a txt trace
+ * @param remove_size_change whether remove object size change during traceConv
+ * @param remap_obj_id whether map obj_id to dense ids [0, n_obj)
+ * @param use_lcs_format whether use lcs format
+ */
+void convert_to_oracleGeneral_parallel(reader_t *reader, std::string ofilepath,
+                                       int n_thread, bool output_txt,
+                                       bool remove_size_change,
+                                       bool remap_obj_id, bool use_lcs_format);
 
 }  // namespace traceConv
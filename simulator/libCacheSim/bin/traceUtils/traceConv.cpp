@@ -3,10 +3,16 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "../../dataStructure/robin_hood.h"
 #include "../../include/libCacheSim/logging.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../traceReader/generalReader/lcs.h"
@@ -34,7 +40,10 @@ struct trace_stat {
 
 static void _reverse_file(std::string ofilepath, struct trace_stat stat,
                           bool output_txt, bool remove_size_change,
-                          bool use_lcs_format);
+                          bool remap_obj_id, bool use_lcs_format);
+
+static void _fill_lcs_header(lcs_trace_header_t *lcs_header,
+                             struct trace_stat stat);
 
 /**
  * @brief Convert a trace to oracleGeneral format, which is a binary format
@@ -47,10 +56,14 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
  * @param sample_ratio
  * @param output_txt
  * @param remove_size_change
+ * @param remap_obj_id whether map obj_id to dense ids [0, n_obj) in the order
+ *      of first access
+ * @param use_lcs_format
  */
 void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath,
                               int sample_ratio, bool output_txt,
-                              bool remove_size_change, bool use_lcs_format) {
+                              bool remove_size_change, bool remap_obj_id,
+                              bool use_lcs_format) {
   request_t *req = new_request();
   std::ofstream ofile_temp(ofilepath + ".reverse",
                            std::ios::out | std::ios::binary | std::ios::trunc);
@@ -127,7 +140,7 @@ void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath,
   stat.n_req_byte = total_bytes;
   stat.n_obj_byte = unique_bytes;
 
-  _reverse_file(ofilepath, stat, output_txt, remove_size_change,
+  _reverse_file(ofilepath, stat, output_txt, remove_size_change, remap_obj_id,
                 use_lcs_format);
 }
 
@@ -170,9 +183,29 @@ static void *_setup_mmap(const std::string &file_path, size_t *size) {
   return mapped_file;
 }
 
+static void _fill_lcs_header(lcs_trace_header_t *lcs_header,
+                             struct trace_stat stat) {
+  memset(lcs_header, 0, sizeof(lcs_trace_header_t));
+  lcs_header->start_magic = LCS_TRACE_START_MAGIC;
+  lcs_header->end_magic = LCS_TRACE_END_MAGIC;
+  lcs_header->n_req = stat.n_req;
+  lcs_header->n_obj = stat.n_obj;
+  lcs_header->n_req_byte = stat.n_req_byte;
+  lcs_header->n_obj_byte = stat.n_obj_byte;
+  lcs_header->time_field = 1;
+  lcs_header->obj_id_field = 2;
+  lcs_header->obj_size_field = 3;
+  lcs_header->next_access_vtime_field = 4;
+  lcs_header->item_size = sizeof(oracleGeneral_req_t);
+  lcs_header->n_fields = 4;
+  memcpy(lcs_header->format, "<IQIQ", 5);
+
+  verify_LCS_trace_header(lcs_header);
+}
+
 static void _reverse_file(std::string ofilepath, struct trace_stat stat,
                           bool output_txt, bool remove_size_change,
-                          bool use_lcs_format) {
+                          bool remap_obj_id, bool use_lcs_format) {
   int64_t n_req = 0;
   size_t file_size;
   char *mapped_file =
@@ -183,21 +216,7 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
                       std::ios::out | std::ios::binary | std::ios::trunc);
   if (use_lcs_format) {
     lcs_trace_header_t lcs_header;
-    lcs_header.start_magic = LCS_TRACE_START_MAGIC;
-    lcs_header.end_magic = LCS_TRACE_END_MAGIC;
-    lcs_header.n_req = stat.n_req;
-    lcs_header.n_obj = stat.n_obj;
-    lcs_header.n_req_byte = stat.n_req_byte;
-    lcs_header.n_obj_byte = stat.n_obj_byte;
-    lcs_header.time_field = 1;
-    lcs_header.obj_id_field = 2;
-    lcs_header.obj_size_field = 3;
-    lcs_header.next_access_vtime_field = 4;
-    lcs_header.item_size = sizeof(oracleGeneral_req_t);
-    lcs_header.n_fields = 4;
-    memcpy(lcs_header.format, "<IQIQ", 5);
-
-    verify_LCS_trace_header(&lcs_header);
+    _fill_lcs_header(&lcs_header, stat);
     ofile.write(reinterpret_cast<char *>(&lcs_header),
                 sizeof(lcs_trace_header_t));
   }
@@ -211,6 +230,10 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
   std::unordered_map<uint64_t, uint32_t> last_obj_size;
   last_obj_size.reserve(stat.n_obj);
 
+  /* dense obj_id are assigned in the order of first access */
+  robin_hood::unordered_flat_map<uint64_t, uint64_t> dense_obj_id;
+  if (remap_obj_id) dense_obj_id.reserve(stat.n_obj);
+
   oracleGeneral_req_t og_req;
   size_t req_entry_size = sizeof(oracleGeneral_req_t);
 
@@ -231,6 +254,17 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
       }
     }
 
+    if (remap_obj_id) {
+      auto it = dense_obj_id.find(og_req.obj_id);
+      if (it != dense_obj_id.end()) {
+        og_req.obj_id = it->second;
+      } else {
+        uint64_t new_obj_id = dense_obj_id.size();
+        dense_obj_id[og_req.obj_id] = new_obj_id;
+        og_req.obj_id = new_obj_id;
+      }
+    }
+
     ofile.write(reinterpret_cast<char *>(&og_req), req_entry_size);
     if (output_txt) {
       ofile_txt << og_req.clock_time << "," << og_req.obj_id << ","
@@ -253,4 +287,220 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat,
   INFO("trace conversion finished, %ld requests %ld objects, output %s\n",
        (long) n_req, (long) stat.n_obj, ofilepath.c_str());
 }
+/* per-chunk state of the parallel converter */
+struct og_chunk {
+  int64_t start;
+  int64_t end;
+  /* the first position of each object in the chunk */
+  robin_hood::unordered_flat_map<uint64_t, int64_t> first_pos;
+  /* positions whose next access is not in this chunk, in reverse order */
+  std::vector<int64_t> unresolved;
+};
+
+/**
+ * @brief scan one chunk backward and link every request to the next
+ * request of the same object in the chunk, a request that is the last
+ * access to the object in this chunk is recorded as unresolved
+ */
+static void _link_chunk(oracleGeneral_req_t *reqs, struct og_chunk *chunk) {
+  chunk->first_pos.reserve((chunk->end - chunk->start) / 4 + 1024);
+  for (int64_t i = chunk->end - 1; i >= chunk->start; i--) {
+    auto it = chunk->first_pos.find(reqs[i].obj_id);
+    if (it == chunk->first_pos.end()) {
+      chunk->unresolved.push_back(i);
+      chunk->first_pos[reqs[i].obj_id] = i;
+    } else {
+      /* vtime is the reference count which starts from 1 */
+      reqs[i].next_access_vtime = it->second + 1;
+      it->second = i;
+    }
+  }
+}
+
+/**
+ * @brief the parallel version of convert_to_oracleGeneral, it reads the trace
+ * once and writes requests directly to the output file, then the output file
+ * is split into chunks and next_access_vtime within each chunk is computed in
+ * parallel, the last accesses in each chunk are linked to the first accesses
+ * in later chunks in a backward merge over the per-chunk first-position tables
+ *
+ * @param reader
+ * @param ofilepath
+ * @param n_thread
+ * @param output_txt
+ * @param remove_size_change
+ * @param remap_obj_id
+ * @param use_lcs_format
+ */
+void convert_to_oracleGeneral_parallel(reader_t *reader, std::string ofilepath,
+                                       int n_thread, bool output_txt,
+                                       bool remove_size_change,
+                                       bool remap_obj_id, bool use_lcs_format) {
+  size_t header_size = use_lcs_format ? sizeof(lcs_trace_header_t) : 0;
+  size_t req_entry_size = sizeof(oracleGeneral_req_t);
+  struct trace_stat stat;
+  memset(&stat, 0, sizeof(stat));
+
+  /* step 1: copy the requests to the output file */
+  std::ofstream ofile(ofilepath,
+                      std::ios::out | std::ios::binary | std::ios::trunc);
+  if (use_lcs_format) {
+    /* the header is filled after we have the trace stat */
+    char empty_header[sizeof(lcs_trace_header_t)] = {0};
+    ofile.write(empty_header, sizeof(lcs_trace_header_t));
+  }
+
+  /* the first and the last size of each object, the trace stat counts the
+   * sizes before the size change is removed as the sequential converter */
+  robin_hood::unordered_flat_map<uint64_t, std::pair<uint32_t, uint32_t>>
+      obj_size;
+  robin_hood::unordered_flat_map<uint64_t, uint64_t> dense_obj_id;
+  request_t *req = new_request();
+  oracleGeneral_req_t og_req;
+  og_req.next_access_vtime = -1;
+  while (read_one_req(reader, req) == 0) {
+    og_req.init(req);
+    stat.n_req += 1;
+    stat.n_req_byte += og_req.obj_size;
+    if (remove_size_change) {
+      uint32_t size = og_req.obj_size;
+      auto it = obj_size.find(og_req.obj_id);
+      if (it != obj_size.end()) {
+        it->second.second = size;
+        og_req.obj_size = it->second.first;
+      } else {
+        obj_size[og_req.obj_id] = {size, size};
+      }
+    }
+    if (remap_obj_id) {
+      auto it = dense_obj_id.find(og_req.obj_id);
+      if (it != dense_obj_id.end()) {
+        og_req.obj_id = it->second;
+      } else {
+        uint64_t new_obj_id = dense_obj_id.size();
+        dense_obj_id[og_req.obj_id] = new_obj_id;
+        og_req.obj_id = new_obj_id;
+      }
+    }
+    ofile.write(reinterpret_cast<char *>(&og_req), req_entry_size);
+
+    if (stat.n_req % 100000000 == 0) {
+      INFO("%s: read %ld M requests (%.2lf GB)\n", reader->trace_path,
+           (long)(stat.n_req / 1e6), (double)stat.n_req_byte / GiB);
+    }
+  }
+  free_request(req);
+  for (auto &p : obj_size) {
+    stat.n_obj_byte += p.second.second;
+  }
+  obj_size.clear();
+  dense_obj_id.clear();
+  ofile.close();
+
+  if (stat.n_req == 0) {
+    ERROR("%s: no request in the trace\n", reader->trace_path);
+    return;
+  }
+
+  int fd = open(ofilepath.c_str(), O_RDWR);
+  if (fd < 0) {
+    ERROR("Unable to open '%s', %s\n", ofilepath.c_str(), strerror(errno));
+    exit(1);
+  }
+  size_t file_size = header_size + stat.n_req * req_entry_size;
+  char *mapped_file = reinterpret_cast<char *>(
+      mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  if (mapped_file == MAP_FAILED) {
+    close(fd);
+    ERROR("Unable to mmap %llu bytes, %s\n", (unsigned long long)file_size,
+          strerror(errno));
+    abort();
+  }
+  close(fd);
+  oracleGeneral_req_t *reqs =
+      reinterpret_cast<oracleGeneral_req_t *>(mapped_file + header_size);
+
+  /* step 2: link requests within each chunk in parallel,
+   * we use more chunks than threads to balance the load */
+  if (n_thread < 1) n_thread = 1;
+  int64_t n_chunk = (int64_t)n_thread * 4;
+  if (n_chunk > stat.n_req) n_chunk = stat.n_req;
+  int64_t chunk_size = (stat.n_req + n_chunk - 1) / n_chunk;
+  n_chunk = (stat.n_req + chunk_size - 1) / chunk_size;
+
+  std::vector<struct og_chunk> chunks(n_chunk);
+  for (int64_t i = 0; i < n_chunk; i++) {
+    chunks[i].start = i * chunk_size;
+    chunks[i].end = std::min(stat.n_req, (i + 1) * chunk_size);
+  }
+
+  INFO("%s: %.2f M requests, computing next access in %ld chunks using %d "
+       "threads\n",
+       ofilepath.c_str(), (double)stat.n_req / 1.0e6, (long)n_chunk,
+       n_thread);
+
+  std::atomic<int64_t> next_chunk(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_thread; t++) {
+    threads.emplace_back([&]() {
+      int64_t idx;
+      while ((idx = next_chunk.fetch_add(1)) < n_chunk) {
+        _link_chunk(reqs, &chunks[idx]);
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  /* step 3: backward merge, the last access of an object in a chunk is
+   * linked to its first access in the closest later chunk */
+  robin_hood::unordered_flat_map<uint64_t, int64_t> next_first_pos;
+  for (int64_t i = n_chunk - 1; i >= 0; i--) {
+    struct og_chunk &chunk = chunks[i];
+    for (int64_t pos : chunk.unresolved) {
+      auto it = next_first_pos.find(reqs[pos].obj_id);
+      if (it == next_first_pos.end()) {
+        /* this is the last access of the object in the trace */
+        stat.n_obj += 1;
+        if (!remove_size_change) stat.n_obj_byte += reqs[pos].obj_size;
+      } else {
+        reqs[pos].next_access_vtime = it->second + 1;
+      }
+    }
+    for (auto &p : chunk.first_pos) {
+      next_first_pos[p.first] = p.second;
+    }
+
+    /* release the chunk memory as early as possible */
+    robin_hood::unordered_flat_map<uint64_t, int64_t>().swap(chunk.first_pos);
+    std::vector<int64_t>().swap(chunk.unresolved);
+  }
+  assert((int64_t)next_first_pos.size() == stat.n_obj);
+  next_first_pos.clear();
+
+  if (use_lcs_format) {
+    lcs_trace_header_t lcs_header;
+    _fill_lcs_header(&lcs_header, stat);
+    memcpy(mapped_file, &lcs_header, sizeof(lcs_trace_header_t));
+  }
+
+  if (output_txt) {
+    std::ofstream ofile_txt(ofilepath + ".txt",
+                            std::ios::out | std::ios::trunc);
+    for (int64_t i = 0; i < stat.n_req; i++) {
+      ofile_txt << reqs[i].clock_time << "," << reqs[i].obj_id << ","
+                << reqs[i].obj_size << "," << reqs[i].next_access_vtime
+                << "\n";
+    }
+    ofile_txt.close();
+  }
+
+  msync(mapped_file, file_size, MS_SYNC);
+  munmap(mapped_file, file_size);
+
+  INFO(
+      "trace conversion finished, %ld requests (%.2lf GB) %ld objects (%.2lf "
+      "GB), output %s\n",
+      (long)stat.n_req, (double)stat.n_req_byte / GiB, (long)stat.n_obj,
+      (double)stat.n_obj_byte / GiB, ofilepath.c_str());
+}
 }  // namespace traceConv
\ No newline at end of file
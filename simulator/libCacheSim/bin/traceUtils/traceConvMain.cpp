@@ -31,12 +31,22 @@ int main(int argc, char *argv[]) {
 
   cli::parse_cmd(argc, argv, &args);
   if (strlen(args.ofilepath) == 0) {
-    snprintf(args.ofilepath, OFILEPATH_LEN, "%s.oracleGeneral", args.trace_path);
+    snprintf(args.ofilepath, OFILEPATH_LEN,
+             args.output_lcs ? "%s.lcs" : "%s.oracleGeneral", args.trace_path);
   }
 
-  traceConv::convert_to_oracleGeneral(args.reader, args.ofilepath,
-                                      args.sample_ratio, args.output_txt,
-                                      args.remove_size_change, false);
+  /* virtual traces, e.g., synthetic traces, and streams cannot be read
+   * backward */
+  if (args.n_thread > 1 || args.reader->trace_format == VIRTUAL_TRACE_FORMAT ||
+      args.reader->is_stream) {
+    traceConv::convert_to_oracleGeneral_parallel(
+        args.reader, args.ofilepath, args.n_thread, args.output_txt,
+        args.remove_size_change, args.remap_obj_id, args.output_lcs);
+  } else {
+    traceConv::convert_to_oracleGeneral(
+        args.reader, args.ofilepath, args.sample_ratio, args.output_txt,
+        args.remove_size_change, args.remap_obj_id, args.output_lcs);
+  }
 }
 
 
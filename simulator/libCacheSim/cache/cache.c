@@ -57,6 +57,9 @@ cache_t *cache_struct_init(const char *const cache_name,
 
   cache->evicted = -1;
   cache->n_promotion = 0;
+  cache->n_reinsertion = 0;
+  cache->n_promotion_batch = 0;
+  cache->flash = NULL;
 
   /* this option works only when eviction age tracking
    * is on in config.h */
@@ -70,6 +73,16 @@ cache_t *cache_struct_init(const char *const cache_name,
   int hash_power = HASH_POWER_DEFAULT;
   if (params.hashpower > 0 && params.hashpower < 40)
     hash_power = params.hashpower;
+#if HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+  /* the table has one slot per obj_id in [0, n_obj), sizing it for all
+   * objects avoids growing it during the simulation */
+  if (params.n_obj > 0) {
+    hash_power = 1;
+    while (hashsize(hash_power) < (uint64_t)params.n_obj &&
+           hash_power < DIRECT_INDEX_MAX_HASHPOWER)
+      hash_power++;
+  }
+#endif
   cache->hashtable = create_hashtable(hash_power);
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_head);
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_tail);
@@ -86,9 +99,41 @@ void cache_struct_free(cache_t *cache) {
   free_hashtable(cache->hashtable);
   if (cache->admissioner != NULL) cache->admissioner->free(cache->admissioner);
   if (cache->prefetcher != NULL) cache->prefetcher->free(cache->prefetcher);
+  if (cache->flash != NULL) flash_tier_release(cache->flash);
   my_free(sizeof(cache_t), cache);
 }
 
+void get_cache_op_stat(const cache_t *cache, const cache_stat_t *start,
+                       cache_stat_t *stat) {
+  stat->n_promotion = cache->n_promotion;
+  stat->n_reinsertion = cache->n_reinsertion;
+  stat->n_promotion_batch = cache->n_promotion_batch;
+  memset(&stat->flash, 0, sizeof(flash_stat_t));
+  if (cache->flash != NULL) stat->flash = cache->flash->stat;
+  if (start == NULL) return;
+
+  stat->n_promotion -= start->n_promotion;
+  stat->n_reinsertion -= start->n_reinsertion;
+  stat->n_promotion_batch -= start->n_promotion_batch;
+  if (cache->flash != NULL) {
+    stat->flash = flash_stat_since(&stat->flash, &start->flash);
+  }
+}
+
+void attach_flash_tier(cache_t *cache, const flash_params_t *params) {
+  if (cache->attach_flash == NULL) {
+    ERROR("%s does not support a flash tier, the FIFO-family algorithms "
+          "(FIFO, Clock, FIFO-Reinsertion, Sieve, S3FIFO, DelayFR, AGE, "
+          "promo-queue, arc-promo, twoq-promo, lpFIFO_batch, ...) do\n",
+          cache->cache_name);
+  }
+  cache->attach_flash(cache, create_flash_tier(params, cache->cache_size));
+}
+
+void cache_attach_flash_base(cache_t *cache, flash_tier_t *flash) {
+  flash_tier_add_cache(flash, cache);
+}
+
 /**
  * @brief create a new cache with the same size as the old cache
  *
@@ -110,6 +155,9 @@ cache_t *clone_cache(const cache_t *old_cache) {
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  if (old_cache->flash != NULL) {
+    attach_flash_tier(cache, &old_cache->flash->params);
+  }
 
   return cache;
 }
@@ -140,6 +188,9 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  if (old_cache->flash != NULL) {
+    attach_flash_tier(cache, &old_cache->flash->params);
+  }
   return cache;
 }
 
@@ -220,6 +271,10 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
     // cache_obj->last_access_time = cache -> n_req;
   }
 
+  if (cache->flash != NULL && update_cache) {
+    flash_tier_access(cache, req->clock_time, cache_obj);
+  }
+
   return cache_obj;
 }
 
@@ -304,6 +359,10 @@ cache_obj_t *cache_insert_base(cache_t *cache, const request_t *req) {
   cache_obj->misc.next_access_vtime = req->next_access_vtime;
   cache_obj->misc.freq = 0;
 
+  if (cache->flash != NULL) {
+    flash_tier_insert(cache, cache_obj);
+  }
+
   return cache_obj;
 }
 
@@ -358,6 +417,10 @@ void cache_remove_obj_base(cache_t *cache, cache_obj_t *obj,
   // prevent overflow
   // assert(cache -> sum_demotion_time >= (cache -> n_insert - obj -> last_access_time));
 
+  if (cache->flash != NULL) {
+    flash_tier_remove(cache, obj);
+  }
+
   if (remove_from_hashtable) {
     hashtable_delete(cache->hashtable, obj);
   }
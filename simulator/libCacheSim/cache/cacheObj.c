@@ -44,6 +44,8 @@ void copy_request_to_cache_obj(cache_obj_t *cache_obj, const request_t *req) {
 cache_obj_t *create_cache_obj_from_request(const request_t *req) {
   cache_obj_t *cache_obj = my_malloc(cache_obj_t);
   memset(cache_obj, 0, sizeof(cache_obj_t));
+  /* 0 is a valid flash segment, a new object is not on the flash tier */
+  cache_obj->flash_seg_id = -1;
   if (req != NULL) copy_request_to_cache_obj(cache_obj, req);
   return cache_obj;
 }
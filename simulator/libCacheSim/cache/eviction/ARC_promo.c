@@ -0,0 +1,565 @@
+//
+//  ARC cache replacement algorithm
+//  https://www.usenix.org/conference/fast-03/arc-self-tuning-low-overhead-replacement-cache
+//
+//
+//  T1 and T2 are promotion queues over the objects in the hashtable of the
+//  cache, so the promotion on hit in LRU is replaced by the policy given in
+//  promotion=LRU|Prob|Delay|Batch|FR|AGE, the other parameters are the
+//  parameters of the queues, see promotion.h, the functions are instantiated
+//  per policy, so the hit path has no indirect call
+//
+//  ARC_LRU, ARC_Prob, ARC_Delay, ARC_Batch and ARC_FR are ARC_promo with
+//  their default promotion parameters
+//
+//
+//  libCacheSim
+//
+//  Created by Juncheng on 09/28/20.
+//  Copyright © 2020 Juncheng. All rights reserved.
+//
+
+#include <string.h>
+
+#include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/evictionAlgo/promotion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* obj->promo.queue_id */
+#define ARC_PROMO_T1 1
+#define ARC_PROMO_T2 2
+
+typedef struct ARC_promo_params {
+  // L1_data is T1 in the paper, L1_ghost is B1 in the paper
+  promo_queue_t T1;
+  cache_t *B1;
+  promo_queue_t T2;
+  cache_t *B2;
+  /* the bytes in T1, T2 has the rest of the cache */
+  int64_t T1_byte;
+
+  double p;
+  bool curr_obj_in_L1_ghost;
+  bool curr_obj_in_L2_ghost;
+  int64_t vtime_last_req_in_ghost;
+  request_t *req_local;
+} ARC_promo_params_t;
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void ARC_promo_free(cache_t *cache);
+static bool ARC_promo_get(cache_t *cache, const request_t *req);
+static void ARC_promo_print_cache(const cache_t *cache);
+
+static bool ARC_promo_get_debug(cache_t *cache, const request_t *req);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****            policy specialized developer facing APIs           ****
+// ****                                                               ****
+// ***********************************************************************
+
+static inline void _ARC_promo_update_stat(cache_t *cache, const ARC_promo_params_t *params) {
+  cache->n_promotion = params->T1.n_promotion + params->T2.n_promotion;
+  cache->n_reinsertion = params->T1.n_reinsertion + params->T2.n_reinsertion;
+  cache->n_promotion_batch = params->T1.n_batch + params->T2.n_batch;
+}
+
+/* unlink the object from T1 or T2 and update the size of T1 */
+static inline __attribute__((always_inline)) void _ARC_promo_unlink(cache_t *cache, cache_obj_t *obj,
+                                                                    const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  if (obj->promo.queue_id == ARC_PROMO_T1) {
+    promo_queue_remove(&params->T1, policy, obj);
+    params->T1_byte -= obj->obj_size + cache->obj_md_size;
+  } else {
+    promo_queue_remove(&params->T2, policy, obj);
+  }
+}
+
+/* evict from T1 or T2 and insert the object to its ghost */
+static inline __attribute__((always_inline)) void _ARC_promo_evict_to_ghost(cache_t *cache, bool from_T1,
+                                                                            const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  cache_obj_t *obj = promo_queue_evict(from_T1 ? &params->T1 : &params->T2, policy);
+  DEBUG_ASSERT(obj != NULL);
+  if (from_T1) {
+    params->T1_byte -= obj->obj_size + cache->obj_md_size;
+  }
+  copy_cache_obj_to_request(params->req_local, obj);
+  cache_t *ghost = from_T1 ? params->B1 : params->B2;
+  bool in_g = ghost->get(ghost, params->req_local);
+  DEBUG_ASSERT(in_g == false);
+  (void)in_g;
+  _ARC_promo_update_stat(cache, params);
+  cache_evict_base(cache, obj, true);
+}
+
+/**
+ * @brief find an object in the cache
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to update the cache,
+ *  if true, the object is promoted
+ *  and if the object is expired, it is removed from the cache
+ * @return the object or NULL if not found
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_ARC_promo_find(cache_t *cache, const request_t *req,
+                                                                          const bool update_cache,
+                                                                          const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  cache_obj_t *obj = cache_find_base(cache, req, update_cache);
+
+  if (!update_cache) {
+    return obj;
+  }
+
+  cache_obj_t *obj_b1 = params->B1->find(params->B1, req, false);
+  cache_obj_t *obj_b2 = params->B2->find(params->B2, req, false);
+  DEBUG_ASSERT(obj_b1 == NULL || obj_b2 == NULL);
+  cache_obj_t *obj_ghost = obj_b1 ? obj_b1 : obj_b2;
+  DEBUG_ASSERT(obj == NULL || obj_ghost == NULL);
+
+  if (obj == NULL && obj_ghost == NULL) {
+    return NULL;
+  }
+
+  params->curr_obj_in_L1_ghost = false;
+  params->curr_obj_in_L2_ghost = false;
+
+  int64_t b1_size = params->B1->get_occupied_byte(params->B1);
+  int64_t b2_size = params->B2->get_occupied_byte(params->B2);
+
+  if (obj_ghost != NULL) {
+    params->vtime_last_req_in_ghost = cache->n_req;
+    // cache miss, but hit on thost
+    if (obj_b1 != NULL) {
+      params->curr_obj_in_L1_ghost = true;
+      // case II: x in L1_ghost
+      double delta = MAX((double)b2_size / b1_size, 1);
+      params->p = MIN(params->p + delta, cache->cache_size);
+      bool removed = params->B1->remove(params->B1, obj_b1->obj_id);
+      DEBUG_ASSERT(removed);
+      (void)removed;
+    } else {
+      params->curr_obj_in_L2_ghost = true;
+      // case III: x in L2_ghost
+      double delta = MAX((double)b1_size / b2_size, 1);
+      params->p = MAX(params->p - delta, 0);
+      bool removed = params->B2->remove(params->B2, obj_b2->obj_id);
+      DEBUG_ASSERT(removed);
+      (void)removed;
+    }
+  } else {
+    // cache hit, case I: x in L1_data or L2_data
+    promo_queue_access(&params->T2, req->clock_time);
+    if (obj->promo.queue_id == ARC_PROMO_T1) {
+      // move to L2 head as a new object of L2
+      _ARC_promo_unlink(cache, obj, policy);
+      promo_queue_insert(&params->T2, policy, obj);
+      obj->promo.queue_id = ARC_PROMO_T2;
+    } else {
+      promo_queue_hit(&params->T2, policy, obj);
+    }
+  }
+
+  _ARC_promo_update_stat(cache, params);
+  return obj;
+}
+
+/**
+ * @brief insert an object into the cache,
+ * update the hash table and cache metadata
+ * this function assumes the cache has enough space
+ * eviction should be
+ * performed before calling this function
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_ARC_promo_insert(cache_t *cache, const request_t *req,
+                                                                            const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  cache_obj_t *obj = cache_insert_base(cache, req);
+
+  if (params->vtime_last_req_in_ghost == cache->n_req &&
+      (params->curr_obj_in_L1_ghost || params->curr_obj_in_L2_ghost)) {
+    // insert to L2 data head
+    promo_queue_insert(&params->T2, policy, obj);
+    obj->promo.queue_id = ARC_PROMO_T2;
+    DEBUG_ASSERT(params->B2->find(params->B2, req, false) == NULL);
+
+    params->curr_obj_in_L1_ghost = false;
+    params->curr_obj_in_L2_ghost = false;
+    params->vtime_last_req_in_ghost = -1;
+  } else {
+    // insert to L1 data head
+    promo_queue_insert(&params->T1, policy, obj);
+    obj->promo.queue_id = ARC_PROMO_T1;
+    params->T1_byte += obj->obj_size + cache->obj_md_size;
+  }
+
+  return obj;
+}
+
+/* whether REPLACE evicts from T1 */
+static inline bool _ARC_promo_replace_T1(const cache_t *cache) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  int64_t t1_size = params->T1_byte;
+  int64_t t2_size = cache->occupied_byte - t1_size;
+
+  bool cond1 = t1_size > 0;
+  bool cond2 = t1_size > params->p;
+  bool cond3 = t1_size == params->p && params->curr_obj_in_L2_ghost;
+  bool cond4 = t2_size == 0;
+
+  return (cond1 && (cond2 || cond3)) || cond4;
+}
+
+/* whether case IV evicts from T1 without REPLACE, and whether it deletes
+ * the LRU of the L1 ghost first */
+static inline bool _ARC_promo_miss_on_all_queues_T1(const cache_t *cache, const request_t *req, bool *evict_b1) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  int64_t t1_size = params->T1_byte;
+  int64_t b1_size = params->B1->get_occupied_byte(params->B1);
+
+  int64_t incoming_size = req->obj_size + cache->obj_md_size;
+  *evict_b1 = false;
+  if (t1_size + b1_size + incoming_size > cache->cache_size) {
+    // case A: L1 = T1 U B1 has exactly c pages
+    if (b1_size > 0) {
+      // if T1 < c (ghost is not empty),
+      // delete the LRU of the L1 ghost, and replace
+      // we do not use t1_size < cache->cache_size
+      // because it does not work for variable size objects
+      *evict_b1 = true;
+      return false;
+    } else {
+      // T1 >= c, L1 data size is too large, ghost is empty, so evict from L1
+      // data
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline bool _ARC_promo_hit_on_ghost(const cache_t *cache) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  return params->vtime_last_req_in_ghost == cache->n_req &&
+         (params->curr_obj_in_L1_ghost || params->curr_obj_in_L2_ghost);
+}
+
+/**
+ * @brief find the object to be evicted
+ * this function does not actually evict the object or update metadata
+ * not all eviction algorithms support this function
+ * because the eviction logic cannot be decoupled from finding eviction
+ * candidate, so use assert(false) if you cannot support this function
+ *
+ * @param cache the cache
+ * @return the object to be evicted
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_ARC_promo_to_evict(cache_t *cache, const request_t *req,
+                                                                              const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  cache->to_evict_candidate_gen_vtime = cache->n_req;
+
+  bool evict_b1 = false;
+  bool from_T1 = false;
+  if (!_ARC_promo_hit_on_ghost(cache) && _ARC_promo_miss_on_all_queues_T1(cache, req, &evict_b1)) {
+    from_T1 = true;
+  } else {
+    from_T1 = _ARC_promo_replace_T1(cache);
+  }
+  cache->to_evict_candidate = promo_queue_to_evict(from_T1 ? &params->T1 : &params->T2, policy);
+  DEBUG_ASSERT(cache->to_evict_candidate != NULL);
+  return cache->to_evict_candidate;
+}
+
+/**
+ * @brief evict an object from the cache
+ * it needs to call cache_evict_base before returning
+ * which updates some metadata such as n_obj, occupied size, and hash table
+ *
+ * @param cache
+ * @param req not used
+ * @param evicted_obj if not NULL, return the evicted object to caller
+ */
+static inline __attribute__((always_inline)) void _ARC_promo_evict(cache_t *cache, const request_t *req,
+                                                                   const promo_policy_e policy) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  if (_ARC_promo_hit_on_ghost(cache)) {
+    // the REPLACE function in the paper
+    _ARC_promo_evict_to_ghost(cache, _ARC_promo_replace_T1(cache), policy);
+  } else {
+    // this is the case IV in the paper
+    bool evict_b1 = false;
+    if (_ARC_promo_miss_on_all_queues_T1(cache, req, &evict_b1)) {
+      // the object evicted from L1 data does not go to the ghost
+      cache_obj_t *obj = promo_queue_evict(&params->T1, policy);
+      params->T1_byte -= obj->obj_size + cache->obj_md_size;
+      _ARC_promo_update_stat(cache, params);
+      cache_evict_base(cache, obj, true);
+    } else {
+      if (evict_b1) {
+        params->B1->evict(params->B1, req);
+      } else {
+        // T1 + B1 + T2 + B2, T1 and T2 are the cache
+        while (cache->occupied_byte + params->B1->get_occupied_byte(params->B1) +
+                   params->B2->get_occupied_byte(params->B2) >=
+               cache->cache_size * 2) {
+          // delete the LRU end of the L2 ghost
+          params->B2->evict(params->B2, req);
+        }
+      }
+      _ARC_promo_evict_to_ghost(cache, _ARC_promo_replace_T1(cache), policy);
+    }
+  }
+  cache->to_evict_candidate_gen_vtime = -1;
+}
+
+/**
+ * @brief remove an object from the cache
+ * this is different from cache_evict because it is used to for user trigger
+ * remove, and eviction is used by the cache to make space for new objects
+ *
+ * it needs to call cache_remove_obj_base before returning
+ * which updates some metadata such as n_obj, occupied size, and hash table
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static inline __attribute__((always_inline)) bool _ARC_promo_remove(cache_t *cache, const obj_id_t obj_id,
+                                                                    const promo_policy_e policy) {
+  cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_id);
+  if (obj == NULL) {
+    return false;
+  }
+
+  _ARC_promo_unlink(cache, obj, policy);
+  cache_remove_obj_base(cache, obj, true);
+  return true;
+}
+
+PROMO_QUEUE_DEFINE_ALL(ARC_promo)
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize the cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params the promotion policy and its parameters,
+ * the same for T1 and T2, see promotion.h or use -e "print" with the
+ * cachesim binary
+ */
+cache_t *ARC_promo_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  cache_t *cache = cache_struct_init("ARC_promo", ccache_params, cache_specific_params);
+  cache->cache_init = ARC_promo_init;
+  cache->cache_free = ARC_promo_free;
+  cache->get = ARC_promo_get;
+  cache->can_insert = cache_can_insert_default;
+  cache->get_occupied_byte = cache_get_occupied_byte_default;
+  cache->get_n_obj = cache_get_n_obj_default;
+  cache->print_cache = ARC_promo_print_cache;
+  cache->attach_flash = cache_attach_flash_base;
+
+  if (ccache_params.consider_obj_metadata) {
+    // two pointer + ghost metadata
+    cache->obj_md_size = 8 * 2 + 8 * 3;
+  } else {
+    cache->obj_md_size = 0;
+  }
+
+  cache->eviction_params = my_malloc_n(ARC_promo_params_t, 1);
+  memset(cache->eviction_params, 0, sizeof(ARC_promo_params_t));
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  params->p = 0;
+
+  promo_queue_parse_params(&params->T1, PROMO_QUEUE_DEFAULT_PARAMS, cache->cache_size, cache->cache_name);
+  if (cache_specific_params != NULL) {
+    promo_queue_parse_params(&params->T1, cache_specific_params, cache->cache_size, cache->cache_name);
+  }
+  params->T2 = params->T1;
+  promo_queue_setup(&params->T1, cache->cache_size);
+  promo_queue_setup(&params->T2, cache->cache_size);
+  params->T1.cache = cache;
+  params->T2.cache = cache;
+  /* only T2 is hit, so the budget of T2 is the one that adapts */
+  promo_queue_setup_ref(&params->T2, ARC_promo_init, ccache_params, cache_specific_params);
+  PROMO_QUEUE_SET_FUNCS(cache, ARC_promo, params->T1.policy);
+
+  common_cache_params_t ccache_params_local = ccache_params;
+  params->B1 = LRU_init(ccache_params_local, NULL);
+  params->B2 = LRU_init(ccache_params_local, NULL);
+
+  params->curr_obj_in_L1_ghost = false;
+  params->curr_obj_in_L2_ghost = false;
+  params->vtime_last_req_in_ghost = -1;
+  params->req_local = new_request();
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "ARC-%s", promo_policy_names[params->T1.policy]);
+
+  return cache;
+}
+
+/* the promotion variants, with the parameters they have always used,
+ * the user parameters are appended and override the defaults */
+static cache_t *ARC_promo_init_with(const common_cache_params_t ccache_params,
+                                    const char *default_params,
+                                    const char *cache_specific_params) {
+  char params_str[1024];
+  if (cache_specific_params != NULL && cache_specific_params[0] != '\0') {
+    snprintf(params_str, sizeof(params_str), "%s,%s", default_params,
+             cache_specific_params);
+  } else {
+    snprintf(params_str, sizeof(params_str), "%s", default_params);
+  }
+  return ARC_promo_init(ccache_params, params_str);
+}
+
+cache_t *ARC_LRU_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return ARC_promo_init_with(ccache_params, "promotion=LRU", cache_specific_params);
+}
+
+cache_t *ARC_Prob_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return ARC_promo_init_with(ccache_params, "promotion=Prob,prob=0.5", cache_specific_params);
+}
+
+cache_t *ARC_Delay_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return ARC_promo_init_with(ccache_params, "promotion=Delay,delay-time=0.2", cache_specific_params);
+}
+
+cache_t *ARC_Batch_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return ARC_promo_init_with(ccache_params, "promotion=Batch,batch-size=0.5", cache_specific_params);
+}
+
+cache_t *ARC_FR_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return ARC_promo_init_with(ccache_params, "promotion=FR,n-bit-counter=1", cache_specific_params);
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void ARC_promo_free(cache_t *cache) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  promo_queue_free(&params->T1);
+  promo_queue_free(&params->T2);
+  params->B1->cache_free(params->B1);
+  params->B2->cache_free(params->B2);
+
+  free_request(params->req_local);
+  my_free(sizeof(ARC_promo_params_t), params);
+  cache_struct_free(cache);
+}
+
+/**
+ * @brief this function is the user facing API
+ * it performs the following logic
+ *
+ * ```
+ * if obj in cache:
+ *    update_metadata
+ *    return true
+ * else:
+ *    if cache does not have enough space:
+ *        evict until it has space to insert
+ *    insert the object
+ *    return false
+ * ```
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool ARC_promo_get(cache_t *cache, const request_t *req) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  bool hit = ARC_promo_get_debug(cache, req);
+  // bool hit = cache_get_base(cache, req);
+  promo_queue_count_hit(&params->T2, req, hit);
+  return hit;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                       debug functions                         ****
+// ****                                                               ****
+// ***********************************************************************
+static void _ARC_promo_print_queue(const promo_queue_t *q) {
+  cache_obj_t *cur = q->q_head;
+  // print from the most recent to the least recent
+  if (cur == NULL) {
+    printf("empty\n");
+    return;
+  }
+  while (cur != NULL) {
+    printf("%lu->", (unsigned long)cur->obj_id);
+    cur = cur->queue.next;
+  }
+  printf("END\n");
+}
+
+static void ARC_promo_print_cache(const cache_t *cache) {
+  ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+  printf("T1: ");
+  _ARC_promo_print_queue(&params->T1);
+  printf("T2: ");
+  _ARC_promo_print_queue(&params->T2);
+  printf("B1: ");
+  params->B1->print_cache(params->B1);
+  printf("B2: ");
+  params->B2->print_cache(params->B2);
+}
+
+static bool ARC_promo_get_debug(cache_t *cache, const request_t *req) {
+  // ARC_promo_params_t *params = (ARC_promo_params_t *)(cache->eviction_params);
+
+  cache->n_req += 1;
+
+  // printf("%ld obj_id %ld: p %.2lf\n", cache->n_req, req->obj_id, params->p);
+  // ARC_promo_print_cache(cache);
+  // printf("==================================\n");
+
+  cache_obj_t *obj = cache->find(cache, req, true);
+
+  if (obj != NULL) {
+    return true;
+  }
+
+  while (cache->get_occupied_byte(cache) + req->obj_size + cache->obj_md_size > cache->cache_size) {
+    cache->evict(cache, req);
+  }
+
+  cache->insert(cache, req);
+
+  return false;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -64,6 +64,7 @@ cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = Clock_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
   cache->num_stats = 0;
   cache->num_stats2 = 0;
@@ -256,6 +257,8 @@ static void Clock_evict(cache_t *cache, const request_t *req) {
     params->n_byte_rewritten += obj_to_evict->obj_size;
     move_obj_to_head(&params->q_head, &params->q_tail, obj_to_evict);
     cache->n_promotion += 1;
+    cache->n_reinsertion += 1;
+    cache_rewrite_base(cache, obj_to_evict);
     // obj_to_evict->last_promote_itime = cache->n_insert;
     // obj_to_evict->is_promoted = true;
     obj_to_evict = params->q_tail;
@@ -62,6 +62,7 @@ cache_t *DelayClock_init(const common_cache_params_t ccache_params, const char *
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = DelayClock_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
   cache->num_stats = 0;
   cache->num_stats2 = 0;
@@ -153,7 +154,8 @@ static cache_obj_t *DelayClock_find(cache_t *cache, const request_t *req, const
       obj->clock.freq += 1;
     }
     obj->is_promoted = false;
-    if (UINT64_MAX != cache -> time_downgrade[cache -> n_req]){
+    if (cache->time_downgrade != NULL &&
+        UINT64_MAX != cache -> time_downgrade[cache -> n_req]){
       obj->clock.freq = 0;
       obj->last_access_itime = 0;
     }
@@ -269,6 +271,8 @@ static void DelayClock_evict(cache_t *cache, const request_t *req) {
     params->n_byte_rewritten += obj_to_evict->obj_size;
     move_obj_to_head(&params->q_head, &params->q_tail, obj_to_evict);
     cache->n_promotion += 1;
+    cache->n_reinsertion += 1;
+    cache_rewrite_base(cache, obj_to_evict);
     obj_to_evict->last_promote_itime = cache->n_insert;
     obj_to_evict->last_promote_time = cache->n_req;
     // obj_to_evict->last_access_itime = 0; (maybe useful move)
@@ -276,7 +280,7 @@ static void DelayClock_evict(cache_t *cache, const request_t *req) {
     obj_to_evict = params->q_tail;
   }
 
-  if (obj_to_evict->is_promoted){
+  if (obj_to_evict->is_promoted && cache->time_downgrade != NULL){
     // that means the promotion failed
     cache->time_downgrade[obj_to_evict->last_access_time] = cache->version_num + 1;
   }
@@ -2,6 +2,12 @@
 //  DelayFR, the same as FIFO-Reinsertion or second chance, is a FIFO with
 //  which inserts back some objects upon eviction
 //
+//  a hit sets the reinsertion bit only if the object has not been reused in
+//  the last delay-ratio * cache size insertions, promotion-budget=x
+//  (reinsertions per request) or promotion-budget-per-sec=x adapts
+//  delay-ratio online to cap the promotion rate, budget-epsilon=x keeps the
+//  miss ratio within x of DelayFR without the budget, see promoBudget.h
+//
 //
 //  DelayFR.c
 //  libCacheSim
@@ -64,6 +70,7 @@ cache_t *DelayFR_init(const common_cache_params_t ccache_params, const char *cac
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = DelayFR_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
   cache->num_stats = 0;
   cache->num_stats2 = 0;
@@ -88,7 +95,23 @@ cache_t *DelayFR_init(const common_cache_params_t ccache_params, const char *cac
     DelayFR_parse_params(cache, cache_specific_params);
   }
 
-  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "DelayFR-%d-%f", params->n_bit_counter, params->delay_ratio);
+  /* the lazy bound is a delay of the cache size */
+  promo_budget_init(&params->budget, params->delay_ratio, MAX(params->delay_ratio, 1.0));
+  if (promo_budget_guarded(&params->budget)) {
+    char ref_params[1024];
+    params->budget.ref =
+        DelayFR_init(ccache_params, promo_budget_ref_params(ref_params, sizeof(ref_params), cache_specific_params));
+  }
+
+  if (promo_budget_guarded(&params->budget)) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "DelayFR-%d-budget%g%s-eps%g", params->n_bit_counter,
+             params->budget.target, params->budget.per_sec ? "/s" : "", params->budget.epsilon);
+  } else if (params->budget.enabled) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "DelayFR-%d-budget%g%s", params->n_bit_counter,
+             params->budget.target, params->budget.per_sec ? "/s" : "");
+  } else {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "DelayFR-%d-%f", params->n_bit_counter, params->delay_ratio);
+  }
 
   return cache;
 }
@@ -99,6 +122,10 @@ cache_t *DelayFR_init(const common_cache_params_t ccache_params, const char *cac
  * @param cache
  */
 static void DelayFR_free(cache_t *cache) {
+  DelayFR_params_t *params = (DelayFR_params_t *)cache->eviction_params;
+  if (params->budget.ref != NULL) {
+    params->budget.ref->cache_free(params->budget.ref);
+  }
   free(cache->eviction_params);
   cache_struct_free(cache);
 }
@@ -122,7 +149,14 @@ static void DelayFR_free(cache_t *cache) {
  * @param req
  * @return true if cache hit, false if cache miss
  */
-static bool DelayFR_get(cache_t *cache, const request_t *req) { return cache_get_base(cache, req); }
+static bool DelayFR_get(cache_t *cache, const request_t *req) {
+  bool hit = cache_get_base(cache, req);
+  DelayFR_params_t *params = (DelayFR_params_t *)cache->eviction_params;
+  if (params->budget.ref != NULL) {
+    promo_budget_count_hit(&params->budget, hit, params->budget.ref->get(params->budget.ref, req));
+  }
+  return hit;
+}
 
 // ***********************************************************************
 // ****                                                               ****
@@ -143,6 +177,12 @@ static bool DelayFR_get(cache_t *cache, const request_t *req) { return cache_get
 static cache_obj_t *DelayFR_find(cache_t *cache, const request_t *req, const bool update_cache) {
   DelayFR_params_t *params = (DelayFR_params_t *)cache->eviction_params;
   cache_obj_t *obj = cache_find_base(cache, req, update_cache);
+  if (update_cache) {
+    if (promo_budget_tick(&params->budget, req->clock_time, cache->n_promotion)) {
+      params->delay_ratio = params->budget.knob;
+      params->delay_time = params->delay_ratio * cache->cache_size;
+    }
+  }
   if (obj != NULL && update_cache && obj->delay_FR.freq < params->max_freq) {
     uint64_t time_passed = params->current_time - obj->delay_FR.last_reuse_time;
     if (time_passed > params->delay_time) {
@@ -221,6 +261,8 @@ static void DelayFR_evict(cache_t *cache, const request_t *req) {
   params->n_byte_rewritten += obj_to_evict->obj_size;
 
   cache->n_promotion += 1;
+  cache->n_reinsertion += 1;
+  cache_rewrite_base(cache, obj_to_evict);
   params->current_time += 1;
 }
 
@@ -277,8 +319,10 @@ static bool DelayFR_remove(cache_t *cache, const obj_id_t obj_id) {
 // ****                                                               ****
 // ***********************************************************************
 static const char *DelayFR_current_params(cache_t *cache, DelayFR_params_t *params) {
-  static __thread char params_str[128];
-  snprintf(params_str, 128, "n-bit-counter=%d,delay-ratio=%f\n", params->n_bit_counter, params->delay_ratio);
+  static __thread char params_str[256];
+  snprintf(params_str, 256, "n-bit-counter=%d,delay-ratio=%f,promotion-budget%s=%g,budget-window=%ld,budget-epsilon=%g\n",
+           params->n_bit_counter, params->delay_ratio, params->budget.per_sec ? "-per-sec" : "", params->budget.target,
+           (long)params->budget.window, params->budget.epsilon);
 
   return params_str;
 }
@@ -313,6 +357,16 @@ static void DelayFR_parse_params(cache_t *cache, const char *cache_specific_para
       if (strlen(end) > 2) {
         ERROR("param parsing error, find string \"%s\" after number\n", end);
       }
+    } else if (strcasecmp(key, "promotion-budget") == 0) {
+      params->budget.target = strtod(value, NULL);
+      params->budget.per_sec = false;
+    } else if (strcasecmp(key, "promotion-budget-per-sec") == 0) {
+      params->budget.target = strtod(value, NULL);
+      params->budget.per_sec = true;
+    } else if (strcasecmp(key, "budget-window") == 0) {
+      params->budget.window = strtol(value, NULL, 0);
+    } else if (strcasecmp(key, "budget-epsilon") == 0) {
+      params->budget.epsilon = strtod(value, NULL);
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", DelayFR_current_params(cache, params));
       exit(0);
@@ -104,6 +104,7 @@ cache_t *FIFO_Reinsertion_init(const common_cache_params_t ccache_params,
   cache->evict = FIFO_Reinsertion_evict;
   cache->remove = FIFO_Reinsertion_remove;
   cache->to_evict = FIFO_Reinsertion_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 4;
@@ -311,6 +312,7 @@ static void FIFO_Reinsertion_evict(cache_t *cache, const request_t *req) {
 
     params->n_obj_rewritten += 1;
     params->n_byte_rewritten += cache_obj->obj_size;
+    cache_rewrite_base(cache, cache_obj);
   }
 }
 
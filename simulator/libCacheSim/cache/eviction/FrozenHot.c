@@ -240,9 +240,9 @@ static bool FH_lru_get(cache_t *cache, const request_t *req, FH_params_t *params
  */
 static void FH_free(cache_t *cache) { 
   FH_params_t* params = (FH_params_t*)cache->eviction_params;
-  // if (params->hash_table_f != NULL){
-  //   free_hashtable(params->hash_table_f);
-  // }
+  if (params->hash_table_f != NULL){
+    free_hashtable_f(params->hash_table_f);
+  }
   free(cache->eviction_params);
   // cache_struct_free(cache);
 }
@@ -375,10 +375,7 @@ static void construction(void* c){
   params->regular_cache_miss = 0;
   // // destroy any previous hashtable
   if (params->hash_table_f != NULL){
-    free_chained_hashtable_f_v2(params->hash_table_f);
-    my_free(sizeof(cache_obj_t *) * hashsize(params->hash_table_f->hashpower),
-          params->hash_table_f->ptr_table);
-    my_free(sizeof(hashtable_t), params->hash_table_f);
+    free_hashtable_f(params->hash_table_f);
   }
   params->hash_table_f = create_hashtable(16);
   // // split the list
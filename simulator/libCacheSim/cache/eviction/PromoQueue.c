@@ -0,0 +1,240 @@
+//
+//  a queue with a pluggable promotion policy, see
+//  include/libCacheSim/evictionAlgo/promotion.h
+//
+//  promotion=LRU|Prob|Delay|Batch|FR|AGE selects the policy, the functions
+//  of each policy are generated by PROMO_QUEUE_DEFINE and picked at init,
+//  so the policy is a constant inside find, insert and evict
+//
+//  promotion-budget=x (promotions per request) or promotion-budget-per-sec=x
+//  caps the promotion rate of Prob, Delay, Batch and AGE by adapting their
+//  knob online, budget-window sets how often the controller adjusts it,
+//  budget-epsilon=x keeps the miss ratio within x of the policy without
+//  the budget by running a copy of the cache without it as a reference
+//
+//  ARC_promo and TwoQ_promo use the same queue (promotion.h) for their
+//  lists, it can be used on its own, e.g., promotion=Delay is LRU_delay,
+//  promotion=FR is Clock
+//
+//  PromoQueue.c
+//  libCacheSim
+//
+
+#include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/evictionAlgo/promotion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void PromoQueue_free(cache_t *cache);
+static bool PromoQueue_get(cache_t *cache, const request_t *req);
+static void PromoQueue_print_cache(const cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****            policy specialized developer facing APIs           ****
+// ****                                                               ****
+// ***********************************************************************
+
+static inline void _PromoQueue_update_stat(cache_t *cache,
+                                           const promo_queue_t *q) {
+  cache->n_promotion = q->n_promotion;
+  cache->n_reinsertion = q->n_reinsertion;
+  cache->n_promotion_batch = q->n_batch;
+}
+
+static inline __attribute__((always_inline)) cache_obj_t *_PromoQueue_find(
+    cache_t *cache, const request_t *req, const bool update_cache,
+    const promo_policy_e policy) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  cache_obj_t *obj = cache_find_base(cache, req, update_cache);
+  if (!update_cache) {
+    return obj;
+  }
+
+  promo_queue_access(q, req->clock_time);
+  if (obj != NULL) {
+    promo_queue_hit(q, policy, obj);
+    _PromoQueue_update_stat(cache, q);
+  }
+  return obj;
+}
+
+static inline __attribute__((always_inline)) cache_obj_t *_PromoQueue_insert(
+    cache_t *cache, const request_t *req, const promo_policy_e policy) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  cache_obj_t *obj = cache_insert_base(cache, req);
+  promo_queue_insert(q, policy, obj);
+  return obj;
+}
+
+static inline __attribute__((always_inline)) cache_obj_t *
+_PromoQueue_to_evict(cache_t *cache, const request_t *req,
+                     const promo_policy_e policy) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  DEBUG_ASSERT(q->q_tail != NULL || cache->occupied_byte == 0);
+
+  cache->to_evict_candidate_gen_vtime = cache->n_req;
+  return promo_queue_to_evict(q, policy);
+}
+
+static inline __attribute__((always_inline)) void _PromoQueue_evict(
+    cache_t *cache, const request_t *req, const promo_policy_e policy) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  DEBUG_ASSERT(q->q_tail != NULL);
+
+  cache_obj_t *obj_to_evict = promo_queue_evict(q, policy);
+  _PromoQueue_update_stat(cache, q);
+  cache_evict_base(cache, obj_to_evict, true);
+}
+
+static inline __attribute__((always_inline)) bool _PromoQueue_remove(
+    cache_t *cache, const obj_id_t obj_id, const promo_policy_e policy) {
+  cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_id);
+  if (obj == NULL) {
+    return false;
+  }
+
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  promo_queue_remove(q, policy, obj);
+  cache_remove_obj_base(cache, obj, true);
+  return true;
+}
+
+PROMO_QUEUE_DEFINE_ALL(PromoQueue)
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a PromoQueue cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params promotion=LRU|Prob|Delay|Batch|FR|AGE and the
+ * parameters of the policy, prob, delay-time, batch-size, n-bit-counter and
+ * scaler, a delay-time or batch-size with a decimal point is a fraction of
+ * the cache size, promotion-budget or promotion-budget-per-sec caps the
+ * promotion rate by adapting the parameter of the policy, budget-epsilon
+ * lets the rate exceed the budget to keep the miss ratio within epsilon of
+ * the policy without the budget
+ */
+cache_t *PromoQueue_init(const common_cache_params_t ccache_params,
+                         const char *cache_specific_params) {
+  cache_t *cache =
+      cache_struct_init("PromoQueue", ccache_params, cache_specific_params);
+  cache->cache_init = PromoQueue_init;
+  cache->cache_free = PromoQueue_free;
+  cache->get = PromoQueue_get;
+  cache->get_occupied_byte = cache_get_occupied_byte_default;
+  cache->can_insert = cache_can_insert_default;
+  cache->get_n_obj = cache_get_n_obj_default;
+  cache->print_cache = PromoQueue_print_cache;
+  cache->attach_flash = cache_attach_flash_base;
+
+  if (ccache_params.consider_obj_metadata) {
+    cache->obj_md_size = 8 * 2;
+  } else {
+    cache->obj_md_size = 0;
+  }
+
+  cache->eviction_params = malloc(sizeof(promo_queue_t));
+  memset(cache->eviction_params, 0, sizeof(promo_queue_t));
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  q->cache = cache;
+
+  promo_queue_parse_params(q, PROMO_QUEUE_DEFAULT_PARAMS, cache->cache_size,
+                           cache->cache_name);
+  if (cache_specific_params != NULL) {
+    promo_queue_parse_params(q, cache_specific_params, cache->cache_size,
+                             cache->cache_name);
+  }
+  promo_queue_setup(q, cache->cache_size);
+  promo_queue_setup_ref(q, PromoQueue_init, ccache_params,
+                        cache_specific_params);
+
+  PROMO_QUEUE_SET_FUNCS(cache, PromoQueue, q->policy);
+
+  if (promo_budget_guarded(&q->budget)) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN,
+             "PromoQueue-%s-budget%g%s-eps%g", promo_policy_names[q->policy],
+             q->budget.target, q->budget.per_sec ? "/s" : "",
+             q->budget.epsilon);
+  } else if (q->budget.enabled) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "PromoQueue-%s-budget%g%s",
+             promo_policy_names[q->policy], q->budget.target,
+             q->budget.per_sec ? "/s" : "");
+  } else {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "PromoQueue-%s",
+             promo_policy_names[q->policy]);
+  }
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void PromoQueue_free(cache_t *cache) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  promo_queue_free(q);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+/**
+ * @brief this function is the user facing API
+ * it performs the following logic
+ *
+ * ```
+ * if obj in cache:
+ *    update_metadata
+ *    return true
+ * else:
+ *    if cache does not have enough space:
+ *        evict until it has space to insert
+ *    insert the object
+ *    return false
+ * ```
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool PromoQueue_get(cache_t *cache, const request_t *req) {
+  bool hit = cache_get_base(cache, req);
+  promo_queue_count_hit((promo_queue_t *)cache->eviction_params, req, hit);
+  return hit;
+}
+
+static void PromoQueue_print_cache(const cache_t *cache) {
+  promo_queue_t *q = (promo_queue_t *)cache->eviction_params;
+  cache_obj_t *cur = q->q_head;
+  // print from the most recent to the least recent
+  if (cur == NULL) {
+    printf("empty\n");
+    return;
+  }
+  while (cur != NULL) {
+    printf("%lu->", (unsigned long)cur->obj_id);
+    cur = cur->queue.next;
+  }
+  printf("END\n");
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -72,6 +72,7 @@ static inline int64_t S3FIFO_get_n_obj(const cache_t *cache);
 static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req);
 static void S3FIFO_parse_params(cache_t *cache,
                                 const char *cache_specific_params);
+static void S3FIFO_attach_flash(cache_t *cache, flash_tier_t *flash);
 
 static void S3FIFO_evict_fifo(cache_t *cache, const request_t *req);
 static void S3FIFO_evict_main(cache_t *cache, const request_t *req);
@@ -97,6 +98,7 @@ cache_t *S3FIFO_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = S3FIFO_get_n_obj;
   cache->get_occupied_byte = S3FIFO_get_occupied_byte;
   cache->can_insert = S3FIFO_can_insert;
+  cache->attach_flash = S3FIFO_attach_flash;
 
   cache->obj_md_size = 0;
 
@@ -342,6 +344,9 @@ static void S3FIFO_evict_fifo(cache_t *cache, const request_t *req) {
 
       cache_obj_t *new_obj = main->insert(main, params->req_local);
       new_obj->misc.freq = obj_to_evict->misc.freq;
+      if (cache->flash != NULL) {
+        cache->flash->stat.n_rewrite_byte += new_obj->obj_size;
+      }
 #if defined(TRACK_EVICTION_V_AGE)
       new_obj->create_time = obj_to_evict->create_time;
     } else {
@@ -392,6 +397,9 @@ static void S3FIFO_evict_main(cache_t *cache, const request_t *req) {
       obj_to_evict = NULL;
 
       cache_obj_t *new_obj = main->insert(main, params->req_local);
+      if (cache->flash != NULL) {
+        cache->flash->stat.n_rewrite_byte += new_obj->obj_size;
+      }
       // clock with 2-bit counter
       new_obj->S3FIFO.freq = MIN(freq, 3) - 1;
       new_obj->misc.freq = freq;
@@ -481,6 +489,16 @@ static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req) {
   return req->obj_size <= params->fifo->cache_size;
 }
 
+/* the objects live in the small and the main FIFO, they share the tier, a
+ * move from the small to the main FIFO and a reinsertion into the main FIFO
+ * write the object again, the ghost only holds ids */
+static void S3FIFO_attach_flash(cache_t *cache, flash_tier_t *flash) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  cache_attach_flash_base(cache, flash);
+  cache_attach_flash_base(params->fifo, flash);
+  cache_attach_flash_base(params->main_cache, flash);
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                parameter set up functions                     ****
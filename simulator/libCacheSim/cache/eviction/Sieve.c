@@ -54,6 +54,7 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
   cache->evict = Sieve_evict;
   cache->remove = Sieve_remove;
   cache->to_evict = Sieve_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 1;
@@ -0,0 +1,444 @@
+//
+//  Quick demotion + lazy promotion v1
+//
+//  20% Ain + ARC
+//  insert to ARC when evicting from Ain
+//
+//  Ain and Am are queues over the objects in the hashtable of the cache, Am
+//  is a promotion queue, promotion=LRU|Prob|Delay|Batch|FR|AGE and the other
+//  parameters that are not Ain-size-ratio or Aout-size-ratio are its
+//  parameters, see promotion.h, the functions are instantiated per policy,
+//  so the hit path has no indirect call
+//
+//  TwoQ_LRU, TwoQ_Prob, TwoQ_Delay, TwoQ_Batch and TwoQ_FR are TwoQ_promo
+//  with their default promotion parameters
+//
+//
+//  TwoQ_promo.c
+//  libCacheSim
+//
+//  Created by Juncheng on 12/4/18.
+//  Copyright © 2018 Juncheng. All rights reserved.
+//
+
+#include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/evictionAlgo/promotion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* obj->promo.queue_id */
+#define TWOQ_PROMO_AIN 1
+#define TWOQ_PROMO_AM 2
+
+typedef struct {
+  /* a FIFO, objects are only inserted and evicted */
+  promo_queue_t Ain;
+  cache_t *Aout;
+  promo_queue_t Am;
+  /* the bytes in Ain, Am has the rest of the cache */
+  int64_t Ain_byte;
+  bool hit_on_ghost;
+
+  int64_t Ain_cache_size;
+  int64_t Aout_cache_size;
+  int64_t Am_cache_size;
+  double Ain_size_ratio;
+  double Aout_size_ratio;
+  // the parameters of Am
+  char Am_params[512];
+
+  request_t *req_local;
+} TwoQ_promo_params_t;
+
+static const char *DEFAULT_CACHE_PARAMS = "Ain-size-ratio=0.25,Aout-size-ratio=0.5";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+cache_t *TwoQ_promo_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
+static void TwoQ_promo_free(cache_t *cache);
+static bool TwoQ_promo_get(cache_t *cache, const request_t *req);
+
+static inline bool TwoQ_promo_can_insert(cache_t *cache, const request_t *req);
+static void TwoQ_promo_parse_params(cache_t *cache, const char *cache_specific_params);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****            policy specialized developer facing APIs           ****
+// ****                                                               ****
+// ***********************************************************************
+
+static inline void _TwoQ_promo_update_stat(cache_t *cache, const TwoQ_promo_params_t *params) {
+  cache->n_promotion = params->Am.n_promotion;
+  cache->n_reinsertion = params->Am.n_reinsertion;
+  cache->n_promotion_batch = params->Am.n_batch;
+}
+
+/* evict from Am, the object does not go to Aout */
+static inline __attribute__((always_inline)) void _TwoQ_promo_evict_Am(cache_t *cache, const promo_policy_e policy) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+  cache_obj_t *obj = promo_queue_evict(&params->Am, policy);
+  _TwoQ_promo_update_stat(cache, params);
+  cache_evict_base(cache, obj, true);
+}
+
+/**
+ * @brief find an object in the cache
+ *
+ * @param cache
+ * @param req
+ * @param update_cache whether to update the cache,
+ *  if true, the object is promoted
+ *  and if the object is expired, it is removed from the cache
+ * @return the object or NULL if not found
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_TwoQ_promo_find(cache_t *cache, const request_t *req,
+                                                                           const bool update_cache,
+                                                                           const promo_policy_e policy) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+
+  cache_obj_t *obj = cache_find_base(cache, req, update_cache);
+
+  // if update cache is false, we only check the Ain and Am
+  if (!update_cache) {
+    return obj;
+  }
+
+  /* update cache is true from now */
+  params->hit_on_ghost = false;
+  if (obj != NULL && obj->promo.queue_id == TWOQ_PROMO_AIN) {
+    return obj;
+  }
+
+  if (params->Aout->remove(params->Aout, req->obj_id)) {
+    // if object in Aout, remove will return true
+    params->hit_on_ghost = true;
+  }
+
+  promo_queue_access(&params->Am, req->clock_time);
+  if (obj != NULL) {
+    promo_queue_hit(&params->Am, policy, obj);
+  }
+  _TwoQ_promo_update_stat(cache, params);
+  return obj;
+}
+
+/**
+ * @brief insert an object into the cache,
+ * update the hash table and cache metadata
+ * this function assumes the cache has enough space
+ * eviction should be
+ * performed before calling this function
+ *
+ * @param cache
+ * @param req
+ * @return the inserted object
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_TwoQ_promo_insert(cache_t *cache, const request_t *req,
+                                                                             const promo_policy_e policy) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+  cache_obj_t *obj = NULL;
+
+  if (params->hit_on_ghost) {
+    /* insert into the ARC, which is accessed and makes room in its own
+     * share of the cache */
+    params->hit_on_ghost = false;
+    promo_queue_access(&params->Am, req->clock_time);
+    while (cache->occupied_byte - params->Ain_byte + req->obj_size + cache->obj_md_size > params->Am_cache_size) {
+      _TwoQ_promo_evict_Am(cache, policy);
+    }
+    obj = cache_insert_base(cache, req);
+    promo_queue_insert(&params->Am, policy, obj);
+    obj->promo.queue_id = TWOQ_PROMO_AM;
+  } else {
+    /* insert into the Ain */
+    obj = cache_insert_base(cache, req);
+    promo_queue_insert(&params->Ain, PROMO_LRU, obj);
+    obj->promo.queue_id = TWOQ_PROMO_AIN;
+    params->Ain_byte += obj->obj_size + cache->obj_md_size;
+  }
+  return obj;
+}
+
+/**
+ * @brief find the object to be evicted
+ * this function does not actually evict the object or update metadata
+ * not all eviction algorithms support this function
+ * because the eviction logic cannot be decoupled from finding eviction
+ * candidate, so use assert(false) if you cannot support this function
+ *
+ * @param cache the cache
+ * @return the object to be evicted
+ */
+static inline __attribute__((always_inline)) cache_obj_t *_TwoQ_promo_to_evict(cache_t *cache, const request_t *req,
+                                                                               const promo_policy_e policy) {
+  assert(false);
+  return NULL;
+}
+
+/**
+ * @brief evict an object from the cache
+ * it needs to call cache_evict_base before returning
+ * which updates some metadata such as n_obj, occupied size, and hash table
+ *
+ * @param cache
+ * @param req not used
+ * @param evicted_obj if not NULL, return the evicted object to caller
+ */
+static inline __attribute__((always_inline)) void _TwoQ_promo_evict(cache_t *cache, const request_t *req,
+                                                                    const promo_policy_e policy) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+
+  /* evict from Ain when it is over its share, and from the other queue when
+   * one is empty, e.g., when the simulator empties the cache at the end */
+  bool evict_Ain = params->Ain_byte > params->Ain_cache_size;
+  if (params->Am.q_tail == NULL) {
+    evict_Ain = true;
+  } else if (params->Ain.q_tail == NULL) {
+    evict_Ain = false;
+  }
+
+  if (evict_Ain) {
+    // evict from Ain cache
+    cache_obj_t *obj = promo_queue_evict(&params->Ain, PROMO_LRU);
+    assert(obj != NULL);
+    params->Ain_byte -= obj->obj_size + cache->obj_md_size;
+    // need to copy the object before it is evicted
+    copy_cache_obj_to_request(params->req_local, obj);
+    params->Aout->get(params->Aout, params->req_local);
+    cache_evict_base(cache, obj, true);
+  } else {
+    // evict from Am
+    _TwoQ_promo_evict_Am(cache, policy);
+  }
+}
+
+/**
+ * @brief remove an object from the cache
+ * this is different from cache_evict because it is used to for user trigger
+ * remove, and eviction is used by the cache to make space for new objects
+ *
+ * it needs to call cache_remove_obj_base before returning
+ * which updates some metadata such as n_obj, occupied size, and hash table
+ *
+ * @param cache
+ * @param obj_id
+ * @return true if the object is removed, false if the object is not in the
+ * cache
+ */
+static inline __attribute__((always_inline)) bool _TwoQ_promo_remove(cache_t *cache, const obj_id_t obj_id,
+                                                                     const promo_policy_e policy) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+  cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_id);
+  if (obj == NULL) {
+    return params->Aout->remove(params->Aout, obj_id);
+  }
+
+  if (obj->promo.queue_id == TWOQ_PROMO_AIN) {
+    promo_queue_remove(&params->Ain, PROMO_LRU, obj);
+    params->Ain_byte -= obj->obj_size + cache->obj_md_size;
+  } else {
+    promo_queue_remove(&params->Am, policy, obj);
+  }
+  cache_remove_obj_base(cache, obj, true);
+  return true;
+}
+
+PROMO_QUEUE_DEFINE_ALL(TwoQ_promo)
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief initialize cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params cache specific parameters, see parse_params
+ * function or use -e "print" with the cachesim binary
+ */
+cache_t *TwoQ_promo_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  cache_t *cache = cache_struct_init("TwoQ_promo", ccache_params, cache_specific_params);
+  cache->cache_init = TwoQ_promo_init;
+  cache->cache_free = TwoQ_promo_free;
+  cache->get = TwoQ_promo_get;
+  cache->get_n_obj = cache_get_n_obj_default;
+  cache->get_occupied_byte = cache_get_occupied_byte_default;
+  cache->can_insert = TwoQ_promo_can_insert;
+  cache->attach_flash = cache_attach_flash_base;
+
+  cache->obj_md_size = 0;
+
+  cache->eviction_params = malloc(sizeof(TwoQ_promo_params_t));
+  memset(cache->eviction_params, 0, sizeof(TwoQ_promo_params_t));
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+  params->req_local = new_request();
+  params->hit_on_ghost = false;
+
+  TwoQ_promo_parse_params(cache, DEFAULT_CACHE_PARAMS);
+  if (cache_specific_params != NULL) {
+    TwoQ_promo_parse_params(cache, cache_specific_params);
+  }
+
+  params->Ain_cache_size = ccache_params.cache_size * params->Ain_size_ratio;
+  params->Aout_cache_size = ccache_params.cache_size * params->Aout_size_ratio;
+  params->Am_cache_size = ccache_params.cache_size - params->Ain_cache_size;
+
+  promo_queue_setup(&params->Ain, params->Ain_cache_size);
+
+  common_cache_params_t ccache_params_local = ccache_params;
+  ccache_params_local.cache_size = params->Aout_cache_size;
+  params->Aout = FIFO_init(ccache_params_local, NULL);
+
+  promo_queue_parse_params(&params->Am, PROMO_QUEUE_DEFAULT_PARAMS, params->Am_cache_size, cache->cache_name);
+  promo_queue_parse_params(&params->Am, params->Am_params, params->Am_cache_size, cache->cache_name);
+  promo_queue_setup(&params->Am, params->Am_cache_size);
+  promo_queue_setup_ref(&params->Am, TwoQ_promo_init, ccache_params, cache_specific_params);
+  params->Am.cache = cache;
+  PROMO_QUEUE_SET_FUNCS(cache, TwoQ_promo, params->Am.policy);
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "TwoQ-%s", promo_policy_names[params->Am.policy]);
+
+  return cache;
+}
+
+/* the promotion variants, with the parameters they have always used,
+ * the user parameters are appended and override the defaults */
+static cache_t *TwoQ_promo_init_with(const common_cache_params_t ccache_params,
+                                     const char *default_params,
+                                     const char *cache_specific_params) {
+  char params_str[1024];
+  if (cache_specific_params != NULL && cache_specific_params[0] != '\0') {
+    snprintf(params_str, sizeof(params_str), "%s,%s", default_params,
+             cache_specific_params);
+  } else {
+    snprintf(params_str, sizeof(params_str), "%s", default_params);
+  }
+  return TwoQ_promo_init(ccache_params, params_str);
+}
+
+cache_t *TwoQ_LRU_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return TwoQ_promo_init_with(ccache_params, "promotion=LRU", cache_specific_params);
+}
+
+cache_t *TwoQ_Prob_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return TwoQ_promo_init_with(ccache_params, "promotion=Prob,prob=0.5", cache_specific_params);
+}
+
+cache_t *TwoQ_Delay_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return TwoQ_promo_init_with(ccache_params, "promotion=Delay,delay-time=0.2", cache_specific_params);
+}
+
+cache_t *TwoQ_Batch_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return TwoQ_promo_init_with(ccache_params, "promotion=Batch,batch-size=0.5", cache_specific_params);
+}
+
+cache_t *TwoQ_FR_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  return TwoQ_promo_init_with(ccache_params, "promotion=FR,n-bit-counter=1", cache_specific_params);
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void TwoQ_promo_free(cache_t *cache) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+  free_request(params->req_local);
+  promo_queue_free(&params->Ain);
+  params->Aout->cache_free(params->Aout);
+  promo_queue_free(&params->Am);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+/**
+ * @brief this function is the user facing API
+ * it performs the following logic
+ *
+ * ```
+ * if obj in cache:
+ *    update_metadata
+ *    return true
+ * else:
+ *    if cache does not have enough space:
+ *        evict until it has space to insert
+ *    insert the object
+ *    return false
+ * ```
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool TwoQ_promo_get(cache_t *cache, const request_t *req) {
+  DEBUG_ASSERT(cache->occupied_byte <= cache->cache_size);
+  bool cache_hit = cache_get_base(cache, req);
+  promo_queue_count_hit(&((TwoQ_promo_params_t *)cache->eviction_params)->Am, req, cache_hit);
+  return cache_hit;
+}
+
+static inline bool TwoQ_promo_can_insert(cache_t *cache, const request_t *req) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)cache->eviction_params;
+
+  return req->obj_size <= params->Ain_cache_size;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                parameter set up functions                     ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *TwoQ_promo_current_params(TwoQ_promo_params_t *params) {
+  static __thread char params_str[640];
+  snprintf(params_str, 640, "Ain-size-ratio=%.2lf,Aout-size-ratio=%.2lf,Am: %s\n", params->Ain_size_ratio,
+           params->Aout_size_ratio, params->Am_params);
+  return params_str;
+}
+
+static void TwoQ_promo_parse_params(cache_t *cache, const char *cache_specific_params) {
+  TwoQ_promo_params_t *params = (TwoQ_promo_params_t *)(cache->eviction_params);
+
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "Ain-size-ratio") == 0) {
+      params->Ain_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "Aout-size-ratio") == 0) {
+      params->Aout_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("parameters: %s\n", TwoQ_promo_current_params(params));
+      exit(0);
+    } else if (value != NULL) {
+      // the promotion parameters of Am
+      size_t len = strlen(params->Am_params);
+      snprintf(params->Am_params + len, sizeof(params->Am_params) - len, "%s%s=%s", len > 0 ? "," : "", key, value);
+    } else {
+      ERROR("%s does not have parameter %s\n", cache->cache_name, key);
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -89,6 +89,7 @@ cache_t *bc_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = bc_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
 
 #ifdef USE_BELADY
@@ -272,8 +273,10 @@ static void bc_evict(cache_t *cache, const request_t *req) {
     params->n_obj_rewritten += 1;
     params->n_byte_rewritten += obj_to_evict->obj_size;
     move_obj_to_head(&params->q_head, &params->q_tail, obj_to_evict);
+    cache_rewrite_base(cache, obj_to_evict);
     obj_to_evict = params->q_tail;
     cache -> n_promotion += 1;
+    cache -> n_reinsertion += 1;
   }
 
   remove_obj_from_list(&params->q_head, &params->q_tail, obj_to_evict);
@@ -3,6 +3,10 @@
 //  Does not promote at eviction time, but periodically based on 
 //  the provided constant param batch-size
 //
+//  hits are recorded in a buffer of object pointers, an object is queued at
+//  most once per batch, and an evicted object clears its slot, so the buffer
+//  only holds unique live objects
+//
 //  lpFIFO_batch.c
 //  libCacheSim
 //
@@ -26,10 +30,13 @@ typedef struct {
   cache_obj_t *q_tail;
   uint64_t batch_size; // determines how often promotion is performed
   float promotion_ratio; // determines how many objects are promoted
-  uint64_t *buffer; //a large buffer is fine because it still isolated each thread's access
+  // the objects hit since the last promotion, NULL if evicted since queued
+  cache_obj_t **buffer;
   uint64_t num_thread; // will always be 1
   uint64_t buffer_pos;
   uint64_t buffer_size;
+  // the number of hits, orders the promotions
+  int64_t n_hit;
 
   uint64_t prev_promote_time;
   uint64_t time_insert;
@@ -55,9 +62,18 @@ static cache_obj_t *lpFIFO_batch_find(cache_t *cache, const request_t *req,
 static cache_obj_t *lpFIFO_batch_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *lpFIFO_batch_to_evict(cache_t *cache, const request_t *req);
 static void lpFIFO_batch_evict(cache_t *cache, const request_t *req);
-static void lpFIFO_batch_promote_all(cache_t *cache, const request_t *req, uint64_t *buff, const uint64_t* batch_size);
+static void lpFIFO_batch_promote_all(cache_t *cache, const request_t *req);
 static bool lpFIFO_batch_remove(cache_t *cache, const obj_id_t obj_id);
 
+/* clear the slot of an object that leaves the cache before promotion */
+static inline void lpFIFO_batch_dequeue(lpFIFO_batch_params_t *params,
+                                        cache_obj_t *obj) {
+  if (obj->lpFIFO_batch.queued) {
+    params->buffer[obj->lpFIFO_batch.buffer_idx] = NULL;
+    obj->lpFIFO_batch.queued = false;
+  }
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                   end user facing functions                   ****
@@ -84,6 +100,7 @@ cache_t *lpFIFO_batch_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = lpFIFO_batch_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
 
 #ifdef USE_BELADY
@@ -96,7 +113,6 @@ cache_t *lpFIFO_batch_init(const common_cache_params_t ccache_params,
   params->q_head = NULL;
   params->q_tail = NULL;
   params->batch_size = 10000;
-  params->buffer_size = 100000000L;
   params->num_thread = 1;
   params->buffer_pos = 0;
 
@@ -117,8 +133,10 @@ cache_t *lpFIFO_batch_init(const common_cache_params_t ccache_params,
   //   ccache_params_local.cache_size = 1;
   // }
 
-  params->buffer_size = cache->cache_size * 100; //set the multiplier to be 100
-  params->buffer = malloc(sizeof(uint64_t) * params->buffer_size);
+  // the buffer holds the unique objects hit in one batch,
+  // it grows if a batch hits more objects than the batch size
+  params->buffer_size = MIN(params->batch_size, 1 << 20);
+  params->buffer = malloc(sizeof(cache_obj_t *) * params->buffer_size);
 
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "lpFIFO_batch-%f",
              params->promotion_ratio);
@@ -184,11 +202,19 @@ static cache_obj_t *lpFIFO_batch_find(cache_t *cache, const request_t *req,
   cache_obj_t *obj = cache_find_base(cache, req, update_cache);
 
   if (obj != NULL && update_cache) {
-    // atomic add 1 and then read the value
-    params->buffer[params->buffer_pos % params->buffer_size] = obj -> obj_id;
-    params->buffer_pos += 1;
+    obj->lpFIFO_batch.last_hit = params->n_hit++;
+    if (!obj->lpFIFO_batch.queued) {
+      if (params->buffer_pos == params->buffer_size) {
+        params->buffer_size *= 2;
+        params->buffer = realloc(params->buffer,
+                                 sizeof(cache_obj_t *) * params->buffer_size);
+      }
+      obj->lpFIFO_batch.queued = true;
+      obj->lpFIFO_batch.buffer_idx = params->buffer_pos;
+      params->buffer[params->buffer_pos++] = obj;
+    }
     if (params->time_insert - params->prev_promote_time >= params -> batch_size){
-      lpFIFO_batch_promote_all(cache, req, params->buffer, &params -> buffer_pos);
+      lpFIFO_batch_promote_all(cache, req);
       params->prev_promote_time = params->time_insert;
       params->buffer_pos = 0;
     }
@@ -270,46 +296,50 @@ static void lpFIFO_batch_evict(cache_t *cache, const request_t *req) {
   lpFIFO_batch_params_t *params = (lpFIFO_batch_params_t *)cache->eviction_params;
 
   cache_obj_t *obj_to_evict = params->q_tail;
+  lpFIFO_batch_dequeue(params, obj_to_evict);
   remove_obj_from_list(&params->q_head, &params->q_tail, obj_to_evict);
   cache_evict_base(cache, obj_to_evict, true);
 }
 
+static int lpFIFO_batch_cmp_last_hit(const void *a, const void *b) {
+  const cache_obj_t *obj_a = *(cache_obj_t *const *)a;
+  const cache_obj_t *obj_b = *(cache_obj_t *const *)b;
+  return (obj_a->lpFIFO_batch.last_hit > obj_b->lpFIFO_batch.last_hit) -
+         (obj_a->lpFIFO_batch.last_hit < obj_b->lpFIFO_batch.last_hit);
+}
+
 /**
- * @brief promotes all currently marked objects within the cache
+ * @brief promotes all currently marked objects within the cache,
+ * the objects are moved to the head in the order of their last hit,
+ * so the most recently hit object ends up at the head
  *
  * @param cache
  * @param req not used
  */
-static void lpFIFO_batch_promote_all(cache_t *cache, const request_t *req, uint64_t *buff, const uint64_t* start) {
+static void lpFIFO_batch_promote_all(cache_t *cache, const request_t *req) {
   lpFIFO_batch_params_t *params = (lpFIFO_batch_params_t *)cache->eviction_params;
-  uint64_t pos = 0;
-  uint64_t count = 0;
-  if (*start > params->buffer_size) {
-    pos = *start;
-    count = params->buffer_size;
-  }else{
-    count = *start;
-  }
-  uint64_t obj_to_promote = 0L;
-
-  // create an empty hash table because we don't want the duplicate objects
-  // to be promoted
-  hashtable_t *duplicate_table = create_hashtable(8);
-  for (int i = 0; i < count; i++) {
-    obj_to_promote = buff[pos % params->buffer_size];
-    cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_to_promote);
-    if (obj != NULL) {
-      move_obj_to_head(&params->q_head, &params->q_tail, obj);
-      if (hashtable_find_obj_id(duplicate_table, obj_to_promote) == NULL){
-        hashtable_f_insert_obj(duplicate_table, obj);
-        cache -> n_promotion += 1;
-        params->num_promotion++;
-      }
+
+  // drop the slots of objects evicted after they were queued
+  uint64_t n_live = 0;
+  for (uint64_t i = 0; i < params->buffer_pos; i++) {
+    if (params->buffer[i] != NULL) {
+      params->buffer[n_live++] = params->buffer[i];
     }
-    pos += 1;
   }
 
-  free_chained_hashtable_f(duplicate_table);
+  qsort(params->buffer, n_live, sizeof(cache_obj_t *),
+        lpFIFO_batch_cmp_last_hit);
+  for (uint64_t i = 0; i < n_live; i++) {
+    cache_obj_t *obj = params->buffer[i];
+    obj->lpFIFO_batch.queued = false;
+    move_obj_to_head(&params->q_head, &params->q_tail, obj);
+    cache_rewrite_base(cache, obj);
+  }
+  cache->n_promotion += n_live;
+  if (n_live > 0) {
+    cache->n_promotion_batch += 1;
+  }
+  params->num_promotion += n_live;
 }
 
 /**
@@ -331,6 +361,7 @@ static void lpFIFO_batch_remove_obj(cache_t *cache, cache_obj_t *obj) {
   lpFIFO_batch_params_t *params = (lpFIFO_batch_params_t *)cache->eviction_params;
 
   DEBUG_ASSERT(obj != NULL);
+  lpFIFO_batch_dequeue(params, obj);
   remove_obj_from_list(&params->q_head, &params->q_tail, obj);
   cache_remove_obj_base(cache, obj, true);
 }
@@ -3,24 +3,66 @@
 //  Note: supports different obj sizes, but may be inefficient
 //        because the hashing does not consider size as weight
 //
+//  with n-thread > 0, get_batch runs the shards on separate threads,
+//  requests are routed to per-shard single-producer single-consumer queues,
+//  each shard is owned by one thread so the result is the same as the
+//  sequential mode, the threads are started by the first get_batch and
+//  sleep on a condition variable between batches
+//
 //  lpFIFO_shards.c
 //  libCacheSim
 //
 //
 
+#include <pthread.h>
+#include <sched.h>
+
 #include "../../dataStructure/hashtable/hashtable.h"
 #include "../../dataStructure/hash/hash.h"
+#include "../../dataStructure/spscQueue.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* the capacity of the queue of each shard */
+#define SHARD_QUEUE_SIZE 4096
+/* pushed after the last request of a batch */
+#define SHARD_QUEUE_BATCH_END (-1)
+
+struct lpFIFO_shards_params;
+
+typedef struct {
+  struct lpFIFO_shards_params *params;
+  cache_t *cache;
+  int thread_id;
+  /* n_insert of the parent cache made by this thread */
+  int64_t n_insert;
+} lpFIFO_shards_thread_t;
+
 typedef struct lpFIFO_shards_params {
   cache_t **shards;
   int n_shards;
   // a temporary request used to move object between shards
   request_t *req_local;
+
+  /* parallel mode, the number of threads running the shards in get_batch,
+   * 0 runs the shards on the caller's thread */
+  int n_thread;
+  pthread_t *threads;
+  lpFIFO_shards_thread_t *thread_states;
+  spsc_queue_t **queues;
+  /* the batch being served */
+  const request_t *batch_reqs;
+  bool *batch_hits;
+  /* the number of threads that have finished the batch */
+  atomic_int n_thread_done;
+  /* the threads wait for a new batch_seq or stop under batch_mtx */
+  pthread_mutex_t batch_mtx;
+  pthread_cond_t batch_cond;
+  int64_t batch_seq;
+  bool stop;
 } lpFIFO_shards_params_t;
 
 // #define LAZY_PROMOTION
@@ -44,6 +86,10 @@ static cache_obj_t *lpFIFO_shards_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *lpFIFO_shards_to_evict(cache_t *cache, const request_t *req);
 static void lpFIFO_shards_evict(cache_t *cache, const request_t *req);
 static bool lpFIFO_shards_remove(cache_t *cache, const obj_id_t obj_id);
+static void lpFIFO_shards_get_batch(cache_t *cache, const request_t *reqs,
+                                    int n, bool *hits);
+static void lpFIFO_shards_start_threads(cache_t *cache);
+static void lpFIFO_shards_stop_threads(cache_t *cache);
 
 /* lpFIFO_shards cannot an object larger than shard size */
 static inline bool lpFIFO_shards_can_insert(cache_t *cache, const request_t *req);
@@ -70,6 +116,7 @@ cache_t *lpFIFO_shards_init(const common_cache_params_t ccache_params,
   cache->cache_init = lpFIFO_shards_init;
   cache->cache_free = lpFIFO_shards_free;
   cache->get = lpFIFO_shards_get;
+  cache->get_batch = lpFIFO_shards_get_batch;
   cache->find = lpFIFO_shards_find;
   cache->insert = lpFIFO_shards_insert;
   cache->evict = lpFIFO_shards_evict;
@@ -86,6 +133,7 @@ cache_t *lpFIFO_shards_init(const common_cache_params_t ccache_params,
   }
 
   cache->eviction_params = (lpFIFO_shards_params_t *)malloc(sizeof(lpFIFO_shards_params_t));
+  memset(cache->eviction_params, 0, sizeof(lpFIFO_shards_params_t));
   lpFIFO_shards_params_t *params = (lpFIFO_shards_params_t *)(cache->eviction_params);
 
   lpFIFO_shards_parse_params(cache, DEFAULT_CACHE_PARAMS);
@@ -114,6 +162,10 @@ cache_t *lpFIFO_shards_init(const common_cache_params_t ccache_params,
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "lpFIFO_shard-%d",
              params->n_shards);
 
+  if (params->n_thread < 0 || params->n_thread > params->n_shards) {
+    params->n_thread = params->n_shards;
+  }
+
   return cache;
 }
 
@@ -124,6 +176,9 @@ cache_t *lpFIFO_shards_init(const common_cache_params_t ccache_params,
  */
 static void lpFIFO_shards_free(cache_t *cache) {
   lpFIFO_shards_params_t *params = (lpFIFO_shards_params_t *)(cache->eviction_params);
+  if (params->threads != NULL) {
+    lpFIFO_shards_stop_threads(cache);
+  }
   free_request(params->req_local);
   for (int i = 0; i < params->n_shards; i++)
     params->shards[i]->cache_free(params->shards[i]);
@@ -348,7 +403,8 @@ static inline int64_t lpFIFO_shards_get_n_obj(const cache_t *cache) {
 // ***********************************************************************
 static const char *lpFIFO_shards_current_params(lpFIFO_shards_params_t *params) {
   static __thread char params_str[128];
-  snprintf(params_str, 128, "n-shards=%d\n", params->n_shards);
+  snprintf(params_str, 128, "n-shards=%d, n-thread=%d\n", params->n_shards,
+           params->n_thread);
   return params_str;
 }
 
@@ -376,6 +432,11 @@ static void lpFIFO_shards_parse_params(cache_t *cache,
         ERROR("param parsing error, find string \"%s\" after number\n", end);
       }
 
+    } else if (strcasecmp(key, "n-thread") == 0) {
+      params->n_thread = (int)strtol(value, &end, 0);
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", lpFIFO_shards_current_params(params));
       exit(0);
@@ -393,6 +454,190 @@ static void lpFIFO_shards_parse_params(cache_t *cache,
 // ****                                                               ****
 // ***********************************************************************
 
+/**
+ * @brief serve one request on its shard, this is the same as
+ * cache_get_base with lpFIFO_shards_find and lpFIFO_shards_insert,
+ * it only touches the shard and read-only fields of the parent cache,
+ * so different shards can run on different threads
+ *
+ * the eviction loop in cache_get_base is skipped because the shards never
+ * hold more than cache_size in total
+ */
+static bool lpFIFO_shards_shard_get(cache_t *cache, cache_t *shard,
+                                    const request_t *req, int64_t *n_insert) {
+  cache_obj_t *obj = shard->find(shard, req, true);
+  if (obj != NULL) {
+    return true;
+  }
+
+  if (!lpFIFO_shards_can_insert(cache, req)) {
+    return false;
+  }
+
+  *n_insert += 1;
+  while (shard->get_occupied_byte(shard) + req->obj_size + cache->obj_md_size >
+         shard->cache_size) {
+    shard->evict(shard, req);
+  }
+  shard->insert(shard, req);
+
+  return false;
+}
+
+/* wait for the next batch, return false if the cache is being freed */
+static bool lpFIFO_shards_wait_batch(lpFIFO_shards_params_t *params,
+                                     int64_t *seen_seq) {
+  pthread_mutex_lock(&params->batch_mtx);
+  while (params->batch_seq == *seen_seq && !params->stop) {
+    pthread_cond_wait(&params->batch_cond, &params->batch_mtx);
+  }
+  bool stop = params->stop;
+  *seen_seq = params->batch_seq;
+  pthread_mutex_unlock(&params->batch_mtx);
+  return !stop;
+}
+
+static void *lpFIFO_shards_thread_func(void *data) {
+  lpFIFO_shards_thread_t *state = (lpFIFO_shards_thread_t *)data;
+  lpFIFO_shards_params_t *params = state->params;
+  int n_owned = 0;
+  int64_t seen_seq = 0;
+  for (int s = state->thread_id; s < params->n_shards; s += params->n_thread) {
+    n_owned++;
+  }
+
+  while (lpFIFO_shards_wait_batch(params, &seen_seq)) {
+    /* the caller is pushing the batch, serve the owned shards until each
+     * of them has reached the end of the batch */
+    int n_batch_end = 0;
+    while (n_batch_end < n_owned) {
+      bool progress = false;
+      for (int s = state->thread_id; s < params->n_shards;
+           s += params->n_thread) {
+        int32_t idx;
+        while (spsc_queue_try_pop(params->queues[s], &idx)) {
+          progress = true;
+          if (idx == SHARD_QUEUE_BATCH_END) {
+            n_batch_end++;
+            continue;
+          }
+          params->batch_hits[idx] = lpFIFO_shards_shard_get(
+              state->cache, params->shards[s], &params->batch_reqs[idx],
+              &state->n_insert);
+        }
+      }
+      if (!progress) sched_yield();
+    }
+    atomic_fetch_add_explicit(&params->n_thread_done, 1, memory_order_release);
+  }
+
+  return NULL;
+}
+
+static void lpFIFO_shards_start_threads(cache_t *cache) {
+  lpFIFO_shards_params_t *params =
+      (lpFIFO_shards_params_t *)cache->eviction_params;
+
+  params->queues = malloc(sizeof(spsc_queue_t *) * params->n_shards);
+  for (int i = 0; i < params->n_shards; i++) {
+    params->queues[i] = spsc_queue_new(SHARD_QUEUE_SIZE);
+  }
+  atomic_init(&params->n_thread_done, 0);
+  pthread_mutex_init(&params->batch_mtx, NULL);
+  pthread_cond_init(&params->batch_cond, NULL);
+  params->batch_seq = 0;
+  params->stop = false;
+
+  params->threads = malloc(sizeof(pthread_t) * params->n_thread);
+  params->thread_states =
+      malloc(sizeof(lpFIFO_shards_thread_t) * params->n_thread);
+  for (int i = 0; i < params->n_thread; i++) {
+    params->thread_states[i].params = params;
+    params->thread_states[i].cache = cache;
+    params->thread_states[i].thread_id = i;
+    params->thread_states[i].n_insert = 0;
+    pthread_create(&params->threads[i], NULL, lpFIFO_shards_thread_func,
+                   &params->thread_states[i]);
+  }
+}
+
+static void lpFIFO_shards_stop_threads(cache_t *cache) {
+  lpFIFO_shards_params_t *params =
+      (lpFIFO_shards_params_t *)cache->eviction_params;
+
+  pthread_mutex_lock(&params->batch_mtx);
+  params->stop = true;
+  pthread_cond_broadcast(&params->batch_cond);
+  pthread_mutex_unlock(&params->batch_mtx);
+  for (int i = 0; i < params->n_thread; i++) {
+    pthread_join(params->threads[i], NULL);
+  }
+  for (int i = 0; i < params->n_shards; i++) {
+    spsc_queue_free(params->queues[i]);
+  }
+  pthread_mutex_destroy(&params->batch_mtx);
+  pthread_cond_destroy(&params->batch_cond);
+  free(params->queues);
+  free(params->threads);
+  free(params->thread_states);
+  params->threads = NULL;
+}
+
+/**
+ * @brief serve a batch of requests, in parallel mode the requests are routed
+ * to the queues of their shards and the caller waits for all shards to
+ * finish the batch
+ */
+static void lpFIFO_shards_get_batch(cache_t *cache, const request_t *reqs,
+                                    int n, bool *hits) {
+  lpFIFO_shards_params_t *params =
+      (lpFIFO_shards_params_t *)cache->eviction_params;
+
+  /* admission and prefetching keep state in the parent cache */
+  if (params->n_thread == 0 || cache->admissioner != NULL ||
+      cache->prefetcher != NULL) {
+    for (int i = 0; i < n; i++) {
+      hits[i] = cache->get(cache, &reqs[i]);
+    }
+    return;
+  }
+
+  if (params->threads == NULL) {
+    lpFIFO_shards_start_threads(cache);
+  }
+
+  params->batch_reqs = reqs;
+  params->batch_hits = hits;
+  atomic_store_explicit(&params->n_thread_done, 0, memory_order_relaxed);
+  cache->n_req += n;
+
+  /* wake up the threads before pushing, a batch can be larger than the
+   * queues */
+  pthread_mutex_lock(&params->batch_mtx);
+  params->batch_seq += 1;
+  pthread_cond_broadcast(&params->batch_cond);
+  pthread_mutex_unlock(&params->batch_mtx);
+
+  for (int i = 0; i < n; i++) {
+    uint64_t shard_id =
+        get_hash_value_int_64(&(reqs[i].obj_id)) % (params->n_shards);
+    spsc_queue_push(params->queues[shard_id], i);
+  }
+  for (int i = 0; i < params->n_shards; i++) {
+    spsc_queue_push(params->queues[i], SHARD_QUEUE_BATCH_END);
+  }
+
+  while (atomic_load_explicit(&params->n_thread_done, memory_order_acquire) <
+         params->n_thread) {
+    sched_yield();
+  }
+
+  for (int i = 0; i < params->n_thread; i++) {
+    cache->n_insert += params->thread_states[i].n_insert;
+    params->thread_states[i].n_insert = 0;
+  }
+}
+
 
 // ***********************************************************************
 // ****                                                               ****
@@ -82,6 +82,7 @@ cache_t *offlineFR_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = offlineFR_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
 
 #ifdef USE_BELADY
@@ -269,6 +270,8 @@ static void offlineFR_evict(cache_t *cache, const request_t *req) {
     params->n_byte_rewritten += obj_to_evict->obj_size;
     move_obj_to_head(&params->q_head, &params->q_tail, obj_to_evict);
     cache->n_promotion += 1;
+    cache->n_reinsertion += 1;
+    cache_rewrite_base(cache, obj_to_evict);
     obj_to_evict->clock.check_time = params->vtime;
     obj_to_evict = params->q_tail;
     reuse_distance = obj_to_evict->clock.next_access_vtime - params->vtime;
@@ -1,13 +1,15 @@
 //
 // PredClock that estimates the next reuse distance and evict the objects
+//
+// at eviction, the candidates from the tail are scored in batches by a
+// pluggable predictor, see evictionAlgo/predictor.h, mode 1 uses the age
+// predictor (age * scaler) or the model loaded by model=<path>
 //  libCacheSim
 //
 //  Created by Juncheng on 12/4/18.
 //  Copyright © 2018 Juncheng. All rights reserved.
 //
 
-#include <float.h>
-
 #include "../../dataStructure/hashtable/hashtable.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
@@ -36,10 +38,11 @@ static cache_obj_t *PredClock_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *PredClock_to_evict(cache_t *cache, const request_t *req);
 static void PredClock_evict(cache_t *cache, const request_t *req);
 static bool PredClock_remove(cache_t *cache, const obj_id_t obj_id);
-static bool is_retained(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance);
-static bool is_retained1(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance);
-static bool is_retained2(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance);
-static bool is_retained3(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance);
+static void PredClock_gather(PredClock_params_t *params, pred_batch_t *batch, cache_obj_t **candidates);
+static void is_retained(cache_t *cache, const pred_batch_t *batch, uint8_t *retain);
+static void is_retained2(cache_t *cache, const pred_batch_t *batch, uint8_t *retain);
+static void PredClock_update_pred_stat(PredClock_params_t *params, cache_obj_t *obj, bool retained,
+                                       const double expected_reuse_distance);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -66,6 +69,7 @@ cache_t *PredClock_init(const common_cache_params_t ccache_params, const char *c
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = PredClock_to_evict;
+  cache->attach_flash = cache_attach_flash_base;
   cache->obj_md_size = 0;
 
 #ifdef USE_BELADY
@@ -88,6 +92,9 @@ cache_t *PredClock_init(const common_cache_params_t ccache_params, const char *c
   if (cache_specific_params != NULL) {
     PredClock_parse_params(cache, cache_specific_params);
   }
+  if (params->predictor.kind == PREDICTOR_AGE) {
+    predictor_init_age(&params->predictor, params->scaler);
+  }
 
   printf("scaler is : %f\n", params->scaler);
 
@@ -249,28 +256,44 @@ static void PredClock_evict(cache_t *cache, const request_t *req) {
   PredClock_params_t *params = (PredClock_params_t *)cache->eviction_params;
   double miss_ratio;
   miss_ratio = (double)params->miss / (double)params->vtime;
-  double expected_reuse_distance = (double)cache->cache_size / miss_ratio;
 
-  cache_obj_t *obj_to_evict = params->q_tail;
-  assert(params->vtime >= obj_to_evict->predClock.last_access_vtime);  // Prevent underflow
-  assert((double)(params->vtime - obj_to_evict->predClock.last_access_vtime) <=
-         DBL_MAX / params->scaler);  // Prevent overflow in multiplication
-
-  double estimated_reuse_distance = (params->vtime - obj_to_evict->predClock.last_access_vtime) * params->scaler;
-
-  bool retained = is_retained(cache, obj_to_evict, expected_reuse_distance);
-  while (obj_to_evict->predClock.freq > 0 && retained && obj_to_evict->predClock.check_time != params->vtime) {
-    params->counter_insert += 1;
-    obj_to_evict->predClock.loop_travel_time += 1;
-    obj_to_evict->predClock.freq -= 1;
-    params->n_obj_rewritten += 1;
-    params->n_byte_rewritten += obj_to_evict->obj_size;
-    move_obj_to_head(&params->q_head, &params->q_tail, obj_to_evict);
-    cache->n_promotion += 1;
-    obj_to_evict->predClock.check_time = params->vtime;
-    obj_to_evict->predClock.pos = params->counter_insert;
-    obj_to_evict = params->q_tail;
-    retained = is_retained(cache, obj_to_evict, expected_reuse_distance);
+  pred_batch_t batch;
+  batch.expected_reuse_distance = (double)cache->cache_size / miss_ratio;
+  cache_obj_t *candidates[PRED_BATCH_SIZE];
+  uint8_t retain[PRED_BATCH_SIZE];
+
+  cache_obj_t *obj_to_evict = NULL;
+  while (obj_to_evict == NULL) {
+    /* the candidates are the tail and the objects before it, each one
+     * becomes the tail after the previous one is reinserted */
+    PredClock_gather(params, &batch, candidates);
+    is_retained(cache, &batch, retain);
+
+    for (int i = 0; i < batch.n; i++) {
+      cache_obj_t *obj = candidates[i];
+      DEBUG_ASSERT(obj == params->q_tail);
+      if (params->mode == 1) {
+        PredClock_update_pred_stat(params, obj, retain[i], batch.expected_reuse_distance);
+      }
+      if (obj->predClock.freq == 0 || !retain[i] || obj->predClock.check_time == params->vtime) {
+        obj_to_evict = obj;
+        break;
+      }
+
+      params->counter_insert += 1;
+      obj->predClock.loop_travel_time += 1;
+      obj->predClock.freq -= 1;
+      params->n_obj_rewritten += 1;
+      params->n_byte_rewritten += obj->obj_size;
+      move_obj_to_head(&params->q_head, &params->q_tail, obj);
+      cache->n_promotion += 1;
+      cache->n_reinsertion += 1;
+      cache_rewrite_base(cache, obj);
+      obj->predClock.check_time = params->vtime;
+      obj->predClock.pos = params->counter_insert;
+    }
+    /* is_retained2 counts the candidates it has decided on */
+    params->num_reinsert += batch.n;
   }
 
   params->num_reinsert = 0;
@@ -326,82 +349,79 @@ static bool PredClock_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
-static bool is_retained(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance) {
+/**
+ * @brief gather the features of the eviction candidates starting from the
+ * tail, stop after an object that will be evicted without asking the
+ * predictor, so the walk is not longer than a Clock step
+ */
+static void PredClock_gather(PredClock_params_t *params, pred_batch_t *batch, cache_obj_t **candidates) {
+  cache_obj_t *obj = params->q_tail;
+  int n = 0;
+  while (obj != NULL && n < PRED_BATCH_SIZE) {
+    candidates[n] = obj;
+    batch->feat[PRED_FEAT_AGE][n] = (double)(params->vtime - obj->predClock.last_access_vtime);
+    batch->feat[PRED_FEAT_REUSE][n] = (double)obj->predClock.reuse_dst;
+    batch->feat[PRED_FEAT_FREQ][n] = obj->predClock.freq;
+    batch->feat[PRED_FEAT_HIT_FREQ][n] = obj->predClock.hit_freq;
+    batch->feat[PRED_FEAT_N_REINSERT][n] = obj->predClock.loop_travel_time;
+    n += 1;
+    if (obj->predClock.freq == 0 || obj->predClock.check_time == params->vtime) {
+      break;
+    }
+    obj = obj->queue.prev;
+  }
+  batch->n = n;
+}
+
+/**
+ * @brief decide whether each candidate in the batch is retained
+ */
+static void is_retained(cache_t *cache, const pred_batch_t *batch, uint8_t *retain) {
   PredClock_params_t *params = (PredClock_params_t *)cache->eviction_params;
-  bool retained;
   switch (params->mode) {
     case 1:
-      retained = is_retained1(cache, obj_to_evict, expected_reuse_distance);
+      predictor_score_batch(&params->predictor, batch, retain);
       break;
     case 2:
-      retained = is_retained2(cache, obj_to_evict, expected_reuse_distance);
+      is_retained2(cache, batch, retain);
       break;
     case 3:
-      retained = is_retained3(cache, obj_to_evict, expected_reuse_distance);
+      memset(retain, 1, batch->n);
       break;
     default:
       printf("mode not supported\n");
       exit(1);
   }
-  return retained;
 }
 
-static bool is_retained1(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance) {
-  if (obj_to_evict->predClock.freq == 0) {
-    return false;
+/* false negatives of the predictor, the decision is made on obj */
+static void PredClock_update_pred_stat(PredClock_params_t *params, cache_obj_t *obj, bool retained,
+                                       const double expected_reuse_distance) {
+  if (obj->predClock.freq == 0) {
+    return;
   }
-  PredClock_params_t *params = (PredClock_params_t *)cache->eviction_params;
-  double reuse_age = (params->vtime - obj_to_evict->predClock.last_access_vtime);
-  double previous_reuse_distance = obj_to_evict->predClock.reuse_dst;
-
-  // stats purpose
-  int64_t actual_next_reuse_time = obj_to_evict->misc.next_access_vtime - params->vtime;
 
-  int next_reuse_time_prediction;
-  // next_reuse_time_prediction = MAX(previous_reuse_distance * params->scaler, (int)reuse_age * params->scaler);
-  next_reuse_time_prediction = (int)reuse_age * params->scaler;
-
-  if (obj_to_evict->predClock.freq != 0 && obj_to_evict->predClock.loop_travel_time > 0) {
-    // printf("reuse_age: %f, expected_reuse_distance: %f, previous_reuse_distance: %f, actual_next_reuse_time: %ld, total_freq: %d,hit_freq: %d, loop_travel_time: %d\n",
-    //       reuse_age, expected_reuse_distance, previous_reuse_distance, actual_next_reuse_time, obj_to_evict->predClock.total_freq, obj_to_evict->predClock.hit_freq, obj_to_evict->predClock.loop_travel_time);
+  if (retained) {
+    obj->predClock.hit_freq = 0;
+    return;
   }
 
-  if (next_reuse_time_prediction < expected_reuse_distance && obj_to_evict->predClock.freq != 0) {
-    obj_to_evict->predClock.hit_freq = 0;
-    return true;
-  } else {
-    if (next_reuse_time_prediction >= expected_reuse_distance && actual_next_reuse_time < expected_reuse_distance){
-      false_negative += 1;
-      // return true;
-      // printf("reuse_age: %f, expected_reuse_distance: %f, previous_reuse_distance: %f, actual_next_reuse_time: %ld, total_freq: %d,hit_freq: %d, loop_travel_time: %d\n",
-      //       reuse_age, expected_reuse_distance, previous_reuse_distance, actual_next_reuse_time, obj_to_evict->predClock.total_freq, obj_to_evict->predClock.hit_freq, obj_to_evict->predClock.loop_travel_time);
-    }
-
-    total_negative += 1;
-
-    return false;
+  // stats purpose
+  int64_t actual_next_reuse_time = obj->misc.next_access_vtime - params->vtime;
+  if (actual_next_reuse_time < expected_reuse_distance) {
+    false_negative += 1;
   }
-
-  return false;
+  total_negative += 1;
 }
 
-static bool is_retained2(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance) {
-
+static void is_retained2(cache_t *cache, const pred_batch_t *batch, uint8_t *retain) {
   PredClock_params_t *params = (PredClock_params_t *)cache->eviction_params;
 
-  // x is the parameter
+  // x is the parameter, skip one promotion every x candidates
   int x = params->interval;
-  if (params->num_reinsert % x == x - 1) {
-    params->num_reinsert += 1;
-    return false;
+  for (int i = 0; i < batch->n; i++) {
+    retain[i] = (params->num_reinsert + i) % x != x - 1;
   }
-  params->num_reinsert += 1;
-
-  return true;
-}
-
-static bool is_retained3(cache_t *cache, cache_obj_t *obj_to_evict, const double expected_reuse_distance) {
-  return true;
 }
 
 // ***********************************************************************
@@ -453,6 +473,8 @@ static void PredClock_parse_params(cache_t *cache, const char *cache_specific_pa
       if (strlen(end) > 2) {
         ERROR("param parsing error, find string \"%s\" after number\n", end);
       }
+    } else if (strcasecmp(key, "model") == 0) {
+      predictor_load(&params->predictor, value);
     } else if (strcasecmp(key, "interval") == 0) {
       params->interval = (int)strtol(value, &end, 10);
       if (strlen(end) > 2) {
@@ -0,0 +1,390 @@
+//
+//  a log-structured flash tier under a cache, see flashTier.h
+//
+//  flashTier.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/flashTier.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../dataStructure/hashtable/hashtable.h"
+#include "../include/libCacheSim/cache.h"
+#include "../include/libCacheSim/const.h"
+#include "../include/libCacheSim/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of segments when segment-size is not given */
+#define FLASH_DEFAULT_N_SEGMENT 256
+/* garbage collection runs when the free segments drop to this number, the
+ * valid objects of a victim fill the rest of the open segment and at most
+ * one new segment, and the host write after it may seal one more */
+#define FLASH_GC_RESERVE 2
+
+static const char *flash_gc_policy_names[] = {"greedy", "fifo",
+                                              "cost-benefit"};
+
+flash_params_t default_flash_params(void) {
+  flash_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.enabled = false;
+  params.segment_size = 0;
+  params.over_provision = 0.1;
+  params.gc_policy = FLASH_GC_GREEDY;
+  params.write_bw_mbps = 1000;
+  params.read_bw_mbps = 3000;
+  params.read_lat_us = 80;
+  params.queue_depth = 32;
+  return params;
+}
+
+/* a number with an optional KiB, MiB, GiB (or KB, MB, GB) suffix */
+static int64_t parse_size(const char *str) {
+  char *end;
+  double size = strtod(str, &end);
+  if (strncasecmp(end, "k", 1) == 0) {
+    size *= KiB;
+  } else if (strncasecmp(end, "m", 1) == 0) {
+    size *= MiB;
+  } else if (strncasecmp(end, "g", 1) == 0) {
+    size *= GiB;
+  } else if (*end != '\0') {
+    ERROR("cannot parse size %s\n", str);
+  }
+  return (int64_t)size;
+}
+
+void parse_flash_params(const char *params_str, flash_params_t *params) {
+  char *str = strdup(params_str);
+  char *old_str = str;
+  params->enabled = true;
+
+  while (str != NULL && str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep(&str, "=");
+    char *value = strsep(&str, ",");
+
+    // skip the white space
+    while (str != NULL && *str == ' ') {
+      str++;
+    }
+
+    if (value == NULL) {
+      ERROR("flash parameter %s has no value\n", key);
+    }
+
+    if (strcasecmp(key, "segment-size") == 0) {
+      params->segment_size = parse_size(value);
+    } else if (strcasecmp(key, "op") == 0) {
+      params->over_provision = strtod(value, NULL);
+      if (params->over_provision <= 0) {
+        ERROR("flash over-provisioning must be positive\n");
+      }
+    } else if (strcasecmp(key, "gc") == 0) {
+      int i;
+      for (i = 0; i <= FLASH_GC_COST_BENEFIT; i++) {
+        if (strcasecmp(value, flash_gc_policy_names[i]) == 0) break;
+      }
+      if (i > FLASH_GC_COST_BENEFIT) {
+        ERROR("unknown flash gc policy %s, supported: greedy, fifo, "
+              "cost-benefit\n",
+              value);
+      }
+      params->gc_policy = (flash_gc_policy_e)i;
+    } else if (strcasecmp(key, "write-bw") == 0) {
+      params->write_bw_mbps = strtod(value, NULL);
+    } else if (strcasecmp(key, "read-bw") == 0) {
+      params->read_bw_mbps = strtod(value, NULL);
+    } else if (strcasecmp(key, "read-lat") == 0) {
+      params->read_lat_us = strtod(value, NULL);
+    } else if (strcasecmp(key, "queue-depth") == 0) {
+      params->queue_depth = (int)strtol(value, NULL, 0);
+      if (params->queue_depth <= 0) {
+        ERROR("flash queue depth must be positive\n");
+      }
+    } else {
+      ERROR("flash does not have parameter %s, supported: segment-size, op, "
+            "gc, write-bw, read-bw, read-lat, queue-depth\n",
+            key);
+    }
+  }
+
+  free(old_str);
+}
+
+flash_tier_t *create_flash_tier(const flash_params_t *params,
+                                int64_t cache_size) {
+  flash_tier_t *flash = my_malloc(flash_tier_t);
+  memset(flash, 0, sizeof(flash_tier_t));
+  flash->params = *params;
+
+  int64_t capacity =
+      (int64_t)((double)cache_size * (1.0 + params->over_provision));
+  flash->segment_size = params->segment_size;
+  if (flash->segment_size <= 0) {
+    flash->segment_size = MAX(capacity / FLASH_DEFAULT_N_SEGMENT, 1);
+  }
+  flash->n_segment = (int32_t)(capacity / flash->segment_size);
+  if (flash->n_segment < FLASH_GC_RESERVE + 2) {
+    ERROR("flash tier of %ld bytes has only %d segments of %ld bytes, use a "
+          "smaller segment-size\n",
+          (long)capacity, flash->n_segment, (long)flash->segment_size);
+  }
+
+  flash->segments = my_malloc_n(flash_segment_t, flash->n_segment);
+  memset(flash->segments, 0, sizeof(flash_segment_t) * flash->n_segment);
+  flash->free_segments = my_malloc_n(int32_t, flash->n_segment);
+  /* pop from the end, so segment 0 is used first */
+  for (int32_t i = 0; i < flash->n_segment; i++) {
+    flash->free_segments[i] = flash->n_segment - 1 - i;
+  }
+  flash->n_free_segment = flash->n_segment;
+  flash->open_segment = flash->free_segments[--flash->n_free_segment];
+  flash->segments[flash->open_segment].state = FLASH_SEG_OPEN;
+
+  flash->stat.start_time = -1;
+  flash->stat.end_time = -1;
+
+  return flash;
+}
+
+void flash_tier_add_cache(flash_tier_t *flash, cache_t *cache) {
+  if (flash->n_cache == FLASH_MAX_CACHE) {
+    ERROR("a flash tier can be shared by at most %d caches\n",
+          FLASH_MAX_CACHE);
+  }
+  flash->caches[flash->n_cache++] = cache;
+  flash->n_ref += 1;
+  cache->flash = flash;
+}
+
+void flash_tier_release(flash_tier_t *flash) {
+  if (--flash->n_ref > 0) return;
+
+  for (int32_t i = 0; i < flash->n_segment; i++) {
+    free(flash->segments[i].obj_ids);
+  }
+  my_free(sizeof(flash_segment_t) * flash->n_segment, flash->segments);
+  my_free(sizeof(int32_t) * flash->n_segment, flash->free_segments);
+  my_free(sizeof(flash_tier_t), flash);
+}
+
+static void _flash_seal_open_segment(flash_tier_t *flash) {
+  flash_segment_t *seg = &flash->segments[flash->open_segment];
+  seg->state = FLASH_SEG_SEALED;
+  seg->seal_time = flash->write_clock;
+
+  if (flash->n_free_segment == 0) {
+    ERROR("flash tier has no free segment, the garbage collection reserve "
+          "(%d segments) is too small\n",
+          FLASH_GC_RESERVE);
+  }
+  flash->open_segment = flash->free_segments[--flash->n_free_segment];
+  flash->segments[flash->open_segment].state = FLASH_SEG_OPEN;
+}
+
+/* append an object to the open segment, the old copy must be invalidated */
+static void _flash_append(flash_tier_t *flash, cache_obj_t *obj) {
+  int64_t size = obj->obj_size;
+  if (size > flash->segment_size) {
+    ERROR("object of %ld bytes is larger than the flash segment (%ld bytes), "
+          "use a larger segment-size\n",
+          (long)size, (long)flash->segment_size);
+  }
+
+  flash_segment_t *seg = &flash->segments[flash->open_segment];
+  if (seg->used_byte + size > flash->segment_size) {
+    _flash_seal_open_segment(flash);
+    seg = &flash->segments[flash->open_segment];
+  }
+
+  if (seg->n_obj == seg->obj_ids_size) {
+    seg->obj_ids_size = seg->obj_ids_size == 0 ? 64 : seg->obj_ids_size * 2;
+    seg->obj_ids = realloc(seg->obj_ids, sizeof(obj_id_t) * seg->obj_ids_size);
+  }
+  seg->obj_ids[seg->n_obj++] = obj->obj_id;
+  seg->used_byte += size;
+  seg->valid_byte += size;
+  obj->flash_seg_id = flash->open_segment;
+  flash->write_clock += size;
+}
+
+static void _flash_invalidate(flash_tier_t *flash, cache_obj_t *obj) {
+  if (obj->flash_seg_id < 0) return;
+
+  flash_segment_t *seg = &flash->segments[obj->flash_seg_id];
+  seg->valid_byte -= obj->obj_size;
+  DEBUG_ASSERT(seg->valid_byte >= 0);
+  obj->flash_seg_id = -1;
+}
+
+static int32_t _flash_pick_victim(const flash_tier_t *flash) {
+  int32_t victim = -1;
+  double best = -DBL_MAX;
+  for (int32_t i = 0; i < flash->n_segment; i++) {
+    const flash_segment_t *seg = &flash->segments[i];
+    if (seg->state != FLASH_SEG_SEALED) continue;
+
+    double score;
+    switch (flash->params.gc_policy) {
+      case FLASH_GC_GREEDY:
+        score = -(double)seg->valid_byte;
+        break;
+      case FLASH_GC_FIFO:
+        score = -(double)seg->seal_time;
+        break;
+      case FLASH_GC_COST_BENEFIT: {
+        /* LFS, the free space gained times its age over the cost of reading
+         * the segment and writing its valid bytes */
+        double u = (double)seg->valid_byte / (double)flash->segment_size;
+        double age = (double)(flash->write_clock - seg->seal_time);
+        score = (1 - u) * age / (1 + u);
+        break;
+      }
+      default:
+        abort();
+    }
+    if (score > best) {
+      best = score;
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+/* the object with the id whose copy is in the segment, NULL if none */
+static cache_obj_t *_flash_find_obj(const flash_tier_t *flash, obj_id_t obj_id,
+                                    int32_t seg_id) {
+  for (int32_t i = 0; i < flash->n_cache; i++) {
+    cache_obj_t *obj =
+        hashtable_find_obj_id(flash->caches[i]->hashtable, obj_id);
+    if (obj != NULL && obj->flash_seg_id == seg_id) return obj;
+  }
+  return NULL;
+}
+
+/* clean one segment, return false if there is no sealed segment */
+static bool _flash_gc_one(flash_tier_t *flash) {
+  int32_t victim = _flash_pick_victim(flash);
+  if (victim < 0) return false;
+
+  flash_segment_t *seg = &flash->segments[victim];
+  for (int32_t i = 0; i < seg->n_obj; i++) {
+    /* an object id may be stale, the object may have been rewritten to
+     * another segment, or evicted and inserted again */
+    cache_obj_t *obj = _flash_find_obj(flash, seg->obj_ids[i], victim);
+    if (obj == NULL) continue;
+
+    seg->valid_byte -= obj->obj_size;
+    _flash_append(flash, obj);
+    flash->stat.n_gc_write_byte += obj->obj_size;
+  }
+
+  seg->state = FLASH_SEG_FREE;
+  seg->used_byte = 0;
+  seg->valid_byte = 0;
+  seg->n_obj = 0;
+  flash->free_segments[flash->n_free_segment++] = victim;
+  flash->stat.n_gc += 1;
+  return true;
+}
+
+static void _flash_write(flash_tier_t *flash, cache_obj_t *obj) {
+  /* each collection frees a segment and uses at most one for the valid
+   * objects it moves, stop if a round over all segments does not help */
+  int32_t n_round = 0;
+  while (flash->n_free_segment <= FLASH_GC_RESERVE) {
+    if (!_flash_gc_one(flash) || ++n_round > flash->n_segment) {
+      ERROR("flash tier cannot free a segment, the over-provisioning (%.2lf) "
+            "is too small, note that the tail of a segment an object does "
+            "not fit in is not used, increase op or segment-size\n",
+            flash->params.over_provision);
+    }
+  }
+  _flash_append(flash, obj);
+  flash->stat.n_host_write_byte += obj->obj_size;
+}
+
+void flash_tier_access(cache_t *cache, int64_t clock_time,
+                       const cache_obj_t *obj) {
+  flash_tier_t *flash = cache->flash;
+  if (flash->stat.start_time < 0) flash->stat.start_time = clock_time;
+  flash->stat.end_time = clock_time;
+
+  if (obj != NULL && obj->flash_seg_id >= 0) {
+    flash->stat.n_read += 1;
+    flash->stat.n_read_byte += obj->obj_size;
+  }
+}
+
+void flash_tier_insert(cache_t *cache, cache_obj_t *obj) {
+  obj->flash_seg_id = -1;
+  _flash_write(cache->flash, obj);
+}
+
+void flash_tier_rewrite(cache_t *cache, cache_obj_t *obj) {
+  flash_tier_t *flash = cache->flash;
+  _flash_invalidate(flash, obj);
+  _flash_write(flash, obj);
+  flash->stat.n_rewrite_byte += obj->obj_size;
+}
+
+void flash_tier_remove(cache_t *cache, cache_obj_t *obj) {
+  _flash_invalidate(cache->flash, obj);
+}
+
+flash_estimate_t estimate_flash(const flash_params_t *params,
+                                const flash_stat_t *stat, int64_t n_req) {
+  flash_estimate_t est;
+  memset(&est, 0, sizeof(est));
+  if (n_req == 0 || stat->n_host_write_byte == 0) {
+    return est;
+  }
+
+  double device_write_byte =
+      (double)(stat->n_host_write_byte + stat->n_gc_write_byte);
+  est.write_amp = device_write_byte / (double)stat->n_host_write_byte;
+
+  /* garbage collection reads the valid bytes it moves */
+  double device_read_byte =
+      (double)(stat->n_read_byte + stat->n_gc_write_byte);
+  double bw_sec = device_write_byte / (params->write_bw_mbps * 1e6) +
+                  device_read_byte / (params->read_bw_mbps * 1e6);
+  double lat_sec =
+      (double)stat->n_read * params->read_lat_us * 1e-6 / params->queue_depth;
+  double device_sec = MAX(bw_sec, lat_sec);
+  est.max_mqps = device_sec > 0 ? (double)n_req / device_sec / 1e6 : 0;
+
+  int64_t trace_sec = stat->end_time - stat->start_time;
+  if (trace_sec > 0) {
+    est.write_mbps = device_write_byte / (double)trace_sec / 1e6;
+  } else {
+    est.write_mbps = device_write_byte / (double)n_req * est.max_mqps;
+  }
+  return est;
+}
+
+flash_stat_t flash_stat_since(const flash_stat_t *stat,
+                              const flash_stat_t *start) {
+  flash_stat_t diff = *stat;
+  diff.n_host_write_byte -= start->n_host_write_byte;
+  diff.n_rewrite_byte -= start->n_rewrite_byte;
+  diff.n_gc_write_byte -= start->n_gc_write_byte;
+  diff.n_gc -= start->n_gc;
+  diff.n_read -= start->n_read;
+  diff.n_read_byte -= start->n_read_byte;
+  if (start->end_time >= 0) diff.start_time = start->end_time;
+  return diff;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -450,9 +450,13 @@ void chained_hashtable_f_foreach_v2(hashtable_t *hashtable,
   }
 }
 
+/* the objects in a f table are owned by another table, only unlink them */
 void free_chained_hashtable_f_v2(hashtable_t *hashtable) {
   if (!hashtable->external_obj)
     chained_hashtable_f_foreach_v2(hashtable, foreach_free_hash_f_next, NULL);
+  my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
+          hashtable->ptr_table);
+  my_free(sizeof(hashtable_t), hashtable);
 }
 
 void check_hashtable_integrity_v2(const hashtable_t *hashtable) {
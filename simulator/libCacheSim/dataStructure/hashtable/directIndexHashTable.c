@@ -0,0 +1,230 @@
+//
+// This hash table uses the object id as the index of the slot, it only works
+// for traces that have dense object ids, e.g., traces converted using
+// traceConv --remap-obj-id, which have obj_id in [0, n_obj)
+// |----------------|
+// |  cache_obj_t*  | obj_id 0
+// |----------------|
+// |  cache_obj_t*  | obj_id 1
+// |----------------|
+// |      NULL      | obj_id 2 (not in cache)
+// |----------------|
+// |  cache_obj_t*  | obj_id 3
+// |----------------|
+//
+// the table grows (doubles) when an obj_id larger than the table is inserted,
+// so the size of the table is decided by the largest obj_id
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
+#include "directIndexHashTable.h"
+
+static void _direct_index_hashtable_expand(hashtable_t *hashtable,
+                                           const obj_id_t obj_id);
+
+/* free object, called by other functions when iterating through the hashtable
+ */
+static inline void foreach_free_obj(cache_obj_t *cache_obj, void *user_data) {
+  free_cache_obj(cache_obj);
+}
+
+/************************ hashtable func ************************/
+hashtable_t *create_direct_index_hashtable(const uint16_t hashpower) {
+  hashtable_t *hashtable = my_malloc(hashtable_t);
+  memset(hashtable, 0, sizeof(hashtable_t));
+
+  size_t size = sizeof(cache_obj_t *) * hashsize(hashpower);
+  hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(hashpower));
+  if (hashtable->ptr_table == NULL) {
+    ERROR("allocate hash table %zu entry * %lu B = %ld MiB failed\n",
+          sizeof(cache_obj_t *), (unsigned long)(hashsize(hashpower)),
+          (long)(size / 1024 / 1024));
+    exit(1);
+  }
+  memset(hashtable->ptr_table, 0, size);
+
+#ifdef USE_HUGEPAGE
+  madvise(hashtable->ptr_table, size, MADV_HUGEPAGE);
+#endif
+  hashtable->external_obj = false;
+  hashtable->hashpower = hashpower;
+  hashtable->n_obj = 0;
+  return hashtable;
+}
+
+cache_obj_t *direct_index_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                                const obj_id_t obj_id) {
+  if (unlikely(obj_id >= hashsize(hashtable->hashpower))) {
+    return NULL;
+  }
+  return hashtable->ptr_table[obj_id];
+}
+
+cache_obj_t *direct_index_hashtable_find(const hashtable_t *hashtable,
+                                         const request_t *req) {
+  return direct_index_hashtable_find_obj_id(hashtable, req->obj_id);
+}
+
+cache_obj_t *direct_index_hashtable_find_obj(const hashtable_t *hashtable,
+                                             const cache_obj_t *obj_to_find) {
+  return direct_index_hashtable_find_obj_id(hashtable, obj_to_find->obj_id);
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *direct_index_hashtable_insert(hashtable_t *hashtable,
+                                           const request_t *req) {
+  cache_obj_t *new_cache_obj = create_cache_obj_from_request(req);
+  return direct_index_hashtable_insert_obj(hashtable, new_cache_obj);
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *direct_index_hashtable_insert_obj(hashtable_t *hashtable,
+                                               cache_obj_t *cache_obj) {
+  if (unlikely(cache_obj->obj_id >= hashsize(hashtable->hashpower))) {
+    _direct_index_hashtable_expand(hashtable, cache_obj->obj_id);
+  }
+
+  DEBUG_ASSERT(hashtable->ptr_table[cache_obj->obj_id] == NULL);
+  hashtable->ptr_table[cache_obj->obj_id] = cache_obj;
+  hashtable->n_obj += 1;
+  return cache_obj;
+}
+
+/* the object ids are unique, so the f variant does not need a second chain */
+cache_obj_t *direct_index_hashtable_f_insert_obj(hashtable_t *hashtable,
+                                                 cache_obj_t *cache_obj) {
+  if (unlikely(cache_obj->obj_id >= hashsize(hashtable->hashpower))) {
+    _direct_index_hashtable_expand(hashtable, cache_obj->obj_id);
+  }
+
+  hashtable->ptr_table[cache_obj->obj_id] = cache_obj;
+  return cache_obj;
+}
+
+/* you need to free the extra_metadata before deleting from hash table */
+void direct_index_hashtable_delete(hashtable_t *hashtable,
+                                   cache_obj_t *cache_obj) {
+  // the object to remove is not in the hash table
+  DEBUG_ASSERT(cache_obj->obj_id < hashsize(hashtable->hashpower));
+  DEBUG_ASSERT(hashtable->ptr_table[cache_obj->obj_id] == cache_obj);
+
+  hashtable->ptr_table[cache_obj->obj_id] = NULL;
+  hashtable->n_obj -= 1;
+  if (!hashtable->external_obj) free_cache_obj(cache_obj);
+}
+
+bool direct_index_hashtable_try_delete(hashtable_t *hashtable,
+                                       cache_obj_t *cache_obj) {
+  if (cache_obj->obj_id >= hashsize(hashtable->hashpower) ||
+      hashtable->ptr_table[cache_obj->obj_id] != cache_obj) {
+    return false;
+  }
+
+  direct_index_hashtable_delete(hashtable, cache_obj);
+  return true;
+}
+
+bool direct_index_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                          const obj_id_t obj_id) {
+  cache_obj_t *cache_obj =
+      direct_index_hashtable_find_obj_id(hashtable, obj_id);
+  if (cache_obj == NULL) return false;
+
+  direct_index_hashtable_delete(hashtable, cache_obj);
+  return true;
+}
+
+/**
+ * the table can be much larger than the number of cached objects, we still
+ * use rejection sampling because scanning to the next object is biased
+ * towards objects after long empty runs
+ */
+cache_obj_t *direct_index_hashtable_rand_obj(hashtable_t *hashtable) {
+  DEBUG_ASSERT(hashtable->n_obj > 0);
+  uint64_t mask = hashmask(hashtable->hashpower);
+  uint64_t pos = next_rand() & mask;
+  while (hashtable->ptr_table[pos] == NULL) {
+    pos = next_rand() & mask;
+  }
+  return hashtable->ptr_table[pos];
+}
+
+void direct_index_hashtable_foreach(hashtable_t *hashtable,
+                                    hashtable_iter iter_func, void *user_data) {
+  cache_obj_t *cur_obj;
+  for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
+    cur_obj = hashtable->ptr_table[i];
+    if (cur_obj != NULL) {
+      iter_func(cur_obj, user_data);
+    }
+  }
+}
+
+void free_direct_index_hashtable(hashtable_t *hashtable) {
+  if (!hashtable->external_obj)
+    direct_index_hashtable_foreach(hashtable, foreach_free_obj, NULL);
+  my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
+          hashtable->ptr_table);
+  my_free(sizeof(hashtable_t), hashtable);
+}
+
+/* the objects in a f table are owned by another table */
+void free_direct_index_hashtable_f(hashtable_t *hashtable) {
+  my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
+          hashtable->ptr_table);
+  my_free(sizeof(hashtable_t), hashtable);
+}
+
+/* grows the hashtable to the smallest power of 2 that can hold obj_id */
+static void _direct_index_hashtable_expand(hashtable_t *hashtable,
+                                           const obj_id_t obj_id) {
+  uint16_t old_hashpower = hashtable->hashpower;
+  uint16_t new_hashpower = old_hashpower;
+  while (obj_id >= hashsize(new_hashpower)) new_hashpower += 1;
+
+  if (new_hashpower > DIRECT_INDEX_MAX_HASHPOWER) {
+    ERROR(
+        "obj_id %lu is too large for the direct index hashtable, the trace "
+        "needs dense object ids (traceConv --remap-obj-id)\n",
+        (unsigned long)obj_id);
+    abort();
+  }
+
+  cache_obj_t **old_table = hashtable->ptr_table;
+  hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(new_hashpower));
+  ASSERT_NOT_NULL(hashtable->ptr_table,
+                  "unable to grow hashtable to size %llu\n",
+                  hashsizeULL(new_hashpower));
+#ifdef USE_HUGEPAGE
+  madvise(hashtable->ptr_table,
+          sizeof(cache_obj_t *) * hashsize(new_hashpower), MADV_HUGEPAGE);
+#endif
+  memcpy(hashtable->ptr_table, old_table,
+         sizeof(cache_obj_t *) * hashsize(old_hashpower));
+  memset(hashtable->ptr_table + hashsize(old_hashpower), 0,
+         sizeof(cache_obj_t *) *
+             (hashsize(new_hashpower) - hashsize(old_hashpower)));
+  hashtable->hashpower = new_hashpower;
+
+  VERBOSE("hashtable resized from %llu to %llu\n", hashsizeULL(old_hashpower),
+          hashsizeULL(new_hashpower));
+
+  my_free(sizeof(cache_obj_t *) * hashsize(old_hashpower), old_table);
+}
+
+#ifdef __cplusplus
+}
+#endif
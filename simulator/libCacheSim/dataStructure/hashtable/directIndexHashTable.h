@@ -0,0 +1,68 @@
+//
+// a hash table for traces with dense object ids (0 .. n_obj-1), such as the
+// traces generated by traceConv --remap-obj-id, the object id is used as the
+// index into a flat pointer array, so there is no hashing and no chaining
+//
+
+#ifndef libCacheSim_DIRECTINDEXHASHTABLE_H
+#define libCacheSim_DIRECTINDEXHASHTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "../../include/libCacheSim/cacheObj.h"
+#include "../../include/libCacheSim/request.h"
+#include "hashtableStruct.h"
+
+/* the table grows with the largest obj_id, we refuse to grow beyond this
+ * because the trace is likely not remapped */
+#define DIRECT_INDEX_MAX_HASHPOWER 34
+
+hashtable_t *create_direct_index_hashtable(const uint16_t hashpower_init);
+
+cache_obj_t *direct_index_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                                const obj_id_t obj_id);
+
+cache_obj_t *direct_index_hashtable_find(const hashtable_t *hashtable,
+                                         const request_t *req);
+
+cache_obj_t *direct_index_hashtable_find_obj(const hashtable_t *hashtable,
+                                             const cache_obj_t *obj_to_find);
+
+/* return an empty cache_obj_t */
+cache_obj_t *direct_index_hashtable_insert(hashtable_t *hashtable,
+                                           const request_t *req);
+
+cache_obj_t *direct_index_hashtable_insert_obj(hashtable_t *hashtable,
+                                               cache_obj_t *cache_obj);
+
+cache_obj_t *direct_index_hashtable_f_insert_obj(hashtable_t *hashtable,
+                                                 cache_obj_t *cache_obj);
+
+bool direct_index_hashtable_try_delete(hashtable_t *hashtable,
+                                       cache_obj_t *cache_obj);
+
+void direct_index_hashtable_delete(hashtable_t *hashtable,
+                                   cache_obj_t *cache_obj);
+
+bool direct_index_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                          const obj_id_t obj_id);
+
+cache_obj_t *direct_index_hashtable_rand_obj(hashtable_t *hashtable);
+
+void direct_index_hashtable_foreach(hashtable_t *hashtable,
+                                    hashtable_iter iter_func, void *user_data);
+
+void free_direct_index_hashtable(hashtable_t *hashtable);
+
+void free_direct_index_hashtable_f(hashtable_t *hashtable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_DIRECTINDEXHASHTABLE_H
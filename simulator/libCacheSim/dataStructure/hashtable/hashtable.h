@@ -45,10 +45,32 @@
 #define hashtable_rand_obj(hashtable) chained_hashtable_rand_obj_v2(hashtable)
 #define hashtable_foreach(hashtable, iter_func, user_data) chained_hashtable_foreach_v2(hashtable, iter_func, user_data)
 #define free_hashtable(hashtable) free_chained_hashtable_v2(hashtable)
+#define free_hashtable_f(hashtable) free_chained_hashtable_f_v2(hashtable)
 #define free_chained_hashtable_f(hashtable) free_chained_hashtable_f_v2(hashtable)
 #define hashtable_add_ptr_to_monitoring(hashtable, ptr)
 #define HASHTABLE_VER 2
 
+#elif HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+#include "directIndexHashTable.h"
+#define create_hashtable(hashpower) create_direct_index_hashtable(hashpower)
+#define hashtable_find(hashtable, req) direct_index_hashtable_find(hashtable, req)
+#define hashtable_find_obj_id(hashtable, obj_id) direct_index_hashtable_find_obj_id(hashtable, obj_id)
+#define hashtable_f_find_obj_id(hashtable, obj_id) direct_index_hashtable_find_obj_id(hashtable, obj_id)
+#define hashtable_find_obj(hashtable, cache_obj) direct_index_hashtable_find_obj(hashtable, cache_obj)
+#define hashtable_insert(hashtable, req) direct_index_hashtable_insert(hashtable, req)
+#define hashtable_insert_obj(hashtable, cache_obj) direct_index_hashtable_insert_obj(hashtable, cache_obj)
+#define hashtable_f_insert_obj(hashtable, cache_obj) direct_index_hashtable_f_insert_obj(hashtable, cache_obj)
+#define hashtable_delete(hashtable, cache_obj) direct_index_hashtable_delete(hashtable, cache_obj)
+#define hashtable_try_delete(hashtable, cache_obj) direct_index_hashtable_try_delete(hashtable, cache_obj)
+#define hashtable_delete_obj_id(hashtable, obj_id) direct_index_hashtable_delete_obj_id(hashtable, obj_id)
+#define hashtable_rand_obj(hashtable) direct_index_hashtable_rand_obj(hashtable)
+#define hashtable_foreach(hashtable, iter_func, user_data) direct_index_hashtable_foreach(hashtable, iter_func, user_data)
+#define free_hashtable(hashtable) free_direct_index_hashtable(hashtable)
+#define free_hashtable_f(hashtable) free_direct_index_hashtable_f(hashtable)
+#define free_chained_hashtable_f(hashtable) free_direct_index_hashtable_f(hashtable)
+#define hashtable_add_ptr_to_monitoring(hashtable, ptr)
+#define HASHTABLE_VER 3
+
 #elif HASHTABLE_TYPE == CUCKCOO_HASHTABLE
 #include "cuckooHashTable.h"
 #error not implemented
@@ -0,0 +1,77 @@
+#pragma once
+//
+//  a bounded single-producer single-consumer queue of int32_t,
+//  one thread pushes and another thread pops without locking
+//
+//  spscQueue.h
+//  libCacheSim
+//
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  /* written by the consumer */
+  _Alignas(64) atomic_uint_fast64_t head;
+  /* written by the producer */
+  _Alignas(64) atomic_uint_fast64_t tail;
+  _Alignas(64) int32_t *buf;
+  uint64_t mask;
+} spsc_queue_t;
+
+/* capacity is rounded up to a power of two */
+static inline spsc_queue_t *spsc_queue_new(uint64_t capacity) {
+  uint64_t sz = 1;
+  while (sz < capacity) sz <<= 1;
+
+  spsc_queue_t *q = aligned_alloc(64, sizeof(spsc_queue_t));
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+  q->buf = malloc(sizeof(int32_t) * sz);
+  q->mask = sz - 1;
+  return q;
+}
+
+static inline void spsc_queue_free(spsc_queue_t *q) {
+  free(q->buf);
+  free(q);
+}
+
+/* return false if the queue is full */
+static inline bool spsc_queue_try_push(spsc_queue_t *q, int32_t v) {
+  uint64_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  uint64_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+  if (tail - head > q->mask) return false;
+
+  q->buf[tail & q->mask] = v;
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+/* return false if the queue is empty */
+static inline bool spsc_queue_try_pop(spsc_queue_t *q, int32_t *v) {
+  uint64_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+  if (head == tail) return false;
+
+  *v = q->buf[head & q->mask];
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+  return true;
+}
+
+static inline void spsc_queue_push(spsc_queue_t *q, int32_t v) {
+  while (!spsc_queue_try_push(q, v)) {
+    sched_yield();
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,7 +27,9 @@
 
 /* cache simulator */
 #include "libCacheSim/plugin.h"
+#include "libCacheSim/costModel.h"
 #include "libCacheSim/profilerLRU.h"
+#include "libCacheSim/promotionOracle.h"
 #include "libCacheSim/simulator.h"
 
 #endif  // libCacheSim_H
@@ -15,6 +15,7 @@
 #include "admissionAlgo.h"
 #include "cacheObj.h"
 #include "const.h"
+#include "flashTier.h"
 #include "logging.h"
 #include "macro.h"
 #include "request.h"
@@ -36,6 +37,9 @@ typedef struct {
   int64_t num_thread;
   bool consider_obj_metadata;
   int version_num; //for keeping track of the number of iterations
+  /* the number of objects in the trace if known (e.g., from the LCS header),
+   * 0 if unknown, the direct index hashtable is presized with it */
+  int64_t n_obj;
 
 } common_cache_params_t;
 
@@ -46,6 +50,11 @@ typedef void (*cache_free_func_ptr)(cache_t *);
 
 typedef bool (*cache_get_func_ptr)(cache_t *, const request_t *);
 
+/* serve n requests, hits[i] is whether reqs[i] is a hit, the result is the
+ * same as calling get on each request in order */
+typedef void (*cache_get_batch_func_ptr)(cache_t *, const request_t *reqs,
+                                         int n, bool *hits);
+
 typedef cache_obj_t *(*cache_find_func_ptr)(cache_t *, const request_t *,
                                             const bool);
 
@@ -67,6 +76,8 @@ typedef int64_t (*cache_get_occupied_byte_func_ptr)(const cache_t *);
 
 typedef int64_t (*cache_get_n_obj_func_ptr)(const cache_t *);
 
+typedef void (*cache_attach_flash_func_ptr)(cache_t *, flash_tier_t *);
+
 typedef void (*cache_print_cache_func_ptr)(const cache_t *);
 
 // #define EVICTION_AGE_ARRAY_SZE 40
@@ -101,6 +112,12 @@ typedef struct {
   double mean_stay_time;
 
   int64_t n_promotion;
+  /* see cache_t */
+  int64_t n_reinsertion;
+  int64_t n_promotion_batch;
+
+  /* the flash tier, all 0 if the cache has none */
+  flash_stat_t flash;
 } cache_stat_t;
 
 struct hashtable;
@@ -110,6 +127,8 @@ struct cache {
   cache_init_func_ptr cache_init;
   cache_free_func_ptr cache_free;
   cache_get_func_ptr get;
+  /* optional, NULL if the cache does not serve requests in batches */
+  cache_get_batch_func_ptr get_batch;
 
   cache_find_func_ptr find;
   cache_can_insert_func_ptr can_insert;
@@ -151,6 +170,19 @@ struct cache {
   int64_t n_insert;
 
   int64_t n_promotion;
+  /* the promotions made at eviction time, e.g., by Clock, included in
+   * n_promotion */
+  int64_t n_reinsertion;
+  /* the number of batches if promotions are applied in batches, 0 otherwise */
+  int64_t n_promotion_batch;
+
+  /* optional, NULL if the cache is not simulated on flash */
+  flash_tier_t *flash;
+  /* places the writes of the cache on a flash tier, NULL if the algorithm
+   * does not report its writes, cache_attach_flash_base for algorithms whose
+   * objects are in cache->hashtable, composite algorithms share the tier with
+   * their sub-caches */
+  cache_attach_flash_func_ptr attach_flash;
 
   int evicted; //used for special random
 
@@ -241,6 +273,34 @@ cache_t *clone_cache(const cache_t *old_cache);
 cache_t *create_cache_with_new_size(const cache_t *old_cache,
                                     const uint64_t new_size);
 
+/**
+ * @brief fill the promotion, reinsertion and flash counters of stat with
+ * the counts of the cache since the snapshot start, or since the start of
+ * the simulation if start is NULL, take the snapshot at the end of warmup
+ * so that the reported counters exclude the warmup
+ *
+ * @param cache
+ * @param start
+ * @param stat
+ */
+void get_cache_op_stat(const cache_t *cache, const cache_stat_t *start,
+                       cache_stat_t *stat);
+
+/**
+ * @brief create a flash tier of the cache size and attach it to the cache,
+ * report an error if the algorithm does not support a flash tier
+ *
+ * @param cache
+ * @param params
+ */
+void attach_flash_tier(cache_t *cache, const flash_params_t *params);
+
+/**
+ * @brief the attach_flash of the algorithms whose objects are all in
+ * cache->hashtable
+ */
+void cache_attach_flash_base(cache_t *cache, flash_tier_t *flash);
+
 /**
  * a function that finds object from the cache, it is used by
  * all eviction algorithms that directly use the hashtable
@@ -303,6 +363,18 @@ void cache_remove_obj_base(cache_t *cache, cache_obj_t *obj,
 void cache_evict_base(cache_t *cache, cache_obj_t *obj,
                       bool remove_from_hashtable);
 
+/**
+ * @brief this function is called by eviction algorithms that write an object
+ * again without inserting it, e.g., a reinsertion at eviction or a
+ * promotion, so that the flash tier (if any) appends a new copy
+ *
+ * @param cache the cache
+ * @param obj the rewritten object
+ */
+static inline void cache_rewrite_base(cache_t *cache, cache_obj_t *obj) {
+  if (cache->flash != NULL) flash_tier_rewrite(cache, obj);
+}
+
 /**
  * @brief get the number of bytes occupied, this is the default
  * for most algorithms, but some algorithms may have different implementation
@@ -151,12 +151,29 @@ typedef struct FIFOMerge_obj_metadata {
 
 typedef struct {
   int freq;
+  /* whether the object is in the promotion buffer, and its slot */
+  bool queued;
+  uint32_t buffer_idx;
+  /* the sequence number of the last hit, used to order the promotions */
+  int64_t last_hit;
 } lpFIFO_batch_obj_metadata_t;
 
 typedef struct {
   int freq;
 } lpFIFO_shards_obj_metadata_t;
 
+/* used by the promotion queue, see evictionAlgo/promotion.h */
+typedef struct {
+  uint64_t last_promo_vtime;  // measured in number of insertions
+  int64_t last_access_vtime;  // measured in number of accesses
+  int64_t last_hit;
+  uint32_t buffer_idx;
+  int32_t freq;
+  bool queued;
+  /* the queue of an algorithm with several queues, e.g., T1 or T2 of ARC */
+  int8_t queue_id;
+} promo_obj_metadata_t;
+
 typedef struct {
   uint64_t last_promo_vtime;
   uint64_t last_promotion;
@@ -246,6 +263,9 @@ typedef struct cache_obj {
   uint64_t last_promote_itime;
   uint64_t last_promote_time;
   bool is_promoted;
+  /* the flash segment of the live copy, -1 if none (set when the object is
+   * created), see flashTier.h */
+  int32_t flash_seg_id;
   pthread_mutex_t lock;
   struct {
     struct cache_obj *prev;
@@ -291,6 +311,7 @@ typedef struct cache_obj {
     Sieve_obj_params_t sieve;
     lpFIFO_batch_obj_metadata_t lpFIFO_batch;
     lpFIFO_shards_obj_metadata_t lpFIFO_shards;
+    promo_obj_metadata_t promo;
     delay_obj_metadata_t delay_count;
     HOTCache_metadata_t hot_cache;
     DelayFR_obj_metadata_t delay_FR;
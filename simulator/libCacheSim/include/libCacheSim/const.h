@@ -28,6 +28,9 @@ extern "C" {
 
 #define CHAINED_HASHTABLE 0xc1
 #define CUCKOO_HASHTABLE 0xc2
+#define CHAINED_HASHTABLEV2 0xc3
+/* use obj_id as the index, requires dense obj_id, see traceConv */
+#define DIRECT_INDEX_HASHTABLE 0xc4
 
 #define MEM_ALIGN_SIZE 128
 
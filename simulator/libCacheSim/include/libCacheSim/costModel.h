@@ -0,0 +1,77 @@
+//
+//  a cost model that turns the operation counts of a simulation into the
+//  CPU time per request and a modelled multi-thread throughput
+//
+//  every request pays a lookup, a miss also inserts, evicts and scans the
+//  tail, a promotion on hit takes the queue lock and splices the object to
+//  the head (batched promotions take the lock once per batch), a
+//  reinsertion splices under the eviction lock, and a hit that does not
+//  promote writes the per-object metadata (e.g., the Clock bit)
+//
+//  the list operations under the lock form the critical section, its share
+//  of the CPU time is the serial fraction of the Universal Scalability Law,
+//  X(n) = n * X(1) / (1 + sigma * (n - 1) + kappa * n * (n - 1)),
+//  which is Amdahl's law when kappa is 0
+//
+//  costModel.h
+//  libCacheSim
+//
+
+#ifndef costModel_h
+#define costModel_h
+
+#include "cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  /* the cost in ns of each operation */
+  double hit_ns;
+  double miss_ns;
+  double lock_ns;
+  double splice_ns;
+  double scan_step_ns;
+  double md_write_ns;
+
+  /* the coherence coefficient of USL, 0 is Amdahl's law */
+  double kappa;
+  /* the number of threads of the modelled throughput */
+  int n_thread;
+} cost_model_params_t;
+
+typedef struct {
+  double cpu_ns_per_req;
+  /* the time per request spent holding the queue lock */
+  double cs_ns_per_req;
+  /* the throughput in million requests per second */
+  double throughput_1;
+  double throughput_n;
+} cost_estimate_t;
+
+/**
+ * @brief the default costs, roughly a hash table lookup, an uncontended
+ * lock, and a splice of a doubly linked list on a recent server
+ */
+cost_model_params_t default_cost_model_params(void);
+
+/**
+ * @brief parse "hit=50,miss=200,lock=40,splice=20,scan=5,md-write=2,
+ * kappa=0,n-thread=16", unspecified costs are not changed
+ */
+void parse_cost_model_params(const char *params_str,
+                             cost_model_params_t *params);
+
+/**
+ * @brief estimate the cost of a simulation from its cache_stat_t,
+ * each miss is counted as one eviction, which holds after the cache is full
+ */
+cost_estimate_t estimate_cost(const cost_model_params_t *params,
+                              const cache_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* costModel_h */
@@ -22,6 +22,8 @@ static const char *my_bool_str[] = {"false", "true", "unknown"};
 typedef enum {
   BINARY_TRACE_FORMAT,
   TXT_TRACE_FORMAT,
+  /* requests are not read from one trace file, e.g., merged traces */
+  VIRTUAL_TRACE_FORMAT,
 
   INVALID_TRACE_FORMAT
 } trace_format_e;
@@ -62,6 +64,10 @@ typedef enum {
   VALPIN_TRACE,
   // ORACLE_WIKI19t_TRACE,
 
+  /* virtual traces */
+  MERGE_TRACE,
+  SYNTHETIC_TRACE,
+
   UNKNOWN_TRACE,
 } __attribute__((__packed__)) trace_type_e;
 
@@ -95,6 +101,8 @@ static char *g_trace_type_name[UNKNOWN_TRACE + 2] = {
     "ORACLE_WIKI19u_TRACE",
     "VALPIN_TRACE",
     // "ORACLE_WIKI19t_TRACE",
+    "MERGE_TRACE",
+    "SYNTHETIC_TRACE",
     "UNKNOWN_TRACE",
 };
 
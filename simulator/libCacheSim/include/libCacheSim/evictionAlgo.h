@@ -3,6 +3,8 @@
 #include <time.h>
 
 #include "cache.h"
+#include "evictionAlgo/predictor.h"
+#include "evictionAlgo/promoBudget.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -62,6 +64,9 @@ typedef struct {
   uint64_t current_time;
   uint64_t delay_time;
   double delay_ratio;
+
+  /* adapts delay_ratio if promotion-budget is set */
+  promo_budget_t budget;
 } DelayFR_params_t;
 
 typedef struct {
@@ -100,6 +105,7 @@ typedef struct {
   int counter_insert;  // including
   int interval;        // the interval is the epoch for us to skip one promotion
   double threshold;
+  predictor_t predictor;  // decides retention in mode 1
 } PredClock_params_t;
 
 typedef struct {
@@ -121,6 +127,9 @@ typedef struct {
   float scaler;
 } AGE_params_t;
 
+cache_t *PromoQueue_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
+
+cache_t *TwoQ_promo_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 cache_t *TwoQ_LRU_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 cache_t *TwoQ_Delay_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 cache_t *TwoQ_Prob_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
@@ -129,6 +138,8 @@ cache_t *TwoQ_FR_init(const common_cache_params_t ccache_params, const char *cac
 
 cache_t *ARC_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 
+cache_t *ARC_promo_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
+
 cache_t *ARC_LRU_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 
 cache_t *ARC_Delay_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
@@ -0,0 +1,235 @@
+#pragma once
+//
+//  pluggable reuse predictors that decide whether eviction candidates are
+//  retained, scored a batch at a time
+//
+//  the caller gathers the features of up to PRED_BATCH_SIZE candidates into
+//  the contiguous arrays of pred_batch_t (one array per feature) and calls
+//  predictor_score_batch once, the kind is dispatched once per batch and
+//  every kind is a loop over the batch without data dependent branches, so
+//  the compiler vectorizes it
+//    age     retain if age * scaler < the expected reuse distance
+//    linear  retain if bias + sum(weight * feature) > 0
+//    gbdt    retain if the sum of the leaves of oblivious trees > 0,
+//            an oblivious tree compares the same (feature, threshold) at
+//            every node of a level, so the leaf index is the bits of the
+//            depth comparisons and evaluation has no branches
+//
+//  the learned models see age and reuse distance divided by the expected
+//  reuse distance, so a model trained at one cache size transfers to others,
+//  a model file is one of
+//    linear <bias> <w_age> <w_reuse> <w_freq> <w_hit_freq> <w_n_reinsert>
+//    gbdt <n_tree> <depth>
+//    followed by, for each tree, depth pairs of <feature> <threshold> and
+//    2^depth leaves, the comparison of level k is bit k of the leaf index
+//
+//  predictor.h
+//  libCacheSim
+//
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRED_BATCH_SIZE 16
+#define PRED_MAX_TREE 32
+#define PRED_MAX_DEPTH 6
+
+typedef enum {
+  PRED_FEAT_AGE = 0,    /* requests since the last access */
+  PRED_FEAT_REUSE,      /* the last reuse distance */
+  PRED_FEAT_FREQ,       /* the reinsertion counter */
+  PRED_FEAT_HIT_FREQ,   /* hits since the last reinsertion */
+  PRED_FEAT_N_REINSERT, /* reinsertions since insertion */
+
+  N_PRED_FEAT
+} pred_feature_e;
+
+typedef enum {
+  PREDICTOR_AGE = 0,
+  PREDICTOR_LINEAR,
+  PREDICTOR_GBDT,
+} predictor_kind_e;
+
+typedef struct {
+  int n;
+  double expected_reuse_distance;
+  double feat[N_PRED_FEAT][PRED_BATCH_SIZE];
+} pred_batch_t;
+
+typedef struct {
+  predictor_kind_e kind;
+
+  /* age */
+  double scaler;
+
+  /* linear */
+  double bias;
+  double weight[N_PRED_FEAT];
+
+  /* gbdt */
+  int n_tree;
+  int depth;
+  int split_feat[PRED_MAX_TREE][PRED_MAX_DEPTH];
+  double split_thresh[PRED_MAX_TREE][PRED_MAX_DEPTH];
+  double leaf[PRED_MAX_TREE][1 << PRED_MAX_DEPTH];
+} predictor_t;
+
+static inline void predictor_init_age(predictor_t *p, double scaler) {
+  memset(p, 0, sizeof(predictor_t));
+  p->kind = PREDICTOR_AGE;
+  p->scaler = scaler;
+}
+
+/**
+ * @brief load a linear or gbdt model from a file, see the format above
+ */
+static inline void predictor_load(predictor_t *p, const char *path) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    ERROR("cannot open predictor model %s\n", path);
+  }
+
+  char kind[16];
+  if (fscanf(f, "%15s", kind) != 1) {
+    ERROR("cannot read the kind of predictor model %s\n", path);
+  }
+
+  memset(p, 0, sizeof(predictor_t));
+  bool ok = true;
+  if (strcasecmp(kind, "linear") == 0) {
+    p->kind = PREDICTOR_LINEAR;
+    ok = fscanf(f, "%lf", &p->bias) == 1;
+    for (int i = 0; i < N_PRED_FEAT && ok; i++) {
+      ok = fscanf(f, "%lf", &p->weight[i]) == 1;
+    }
+  } else if (strcasecmp(kind, "gbdt") == 0) {
+    p->kind = PREDICTOR_GBDT;
+    ok = fscanf(f, "%d %d", &p->n_tree, &p->depth) == 2;
+    if (ok && (p->n_tree < 1 || p->n_tree > PRED_MAX_TREE || p->depth < 1 ||
+               p->depth > PRED_MAX_DEPTH)) {
+      ERROR("predictor model %s has %d trees of depth %d, at most %d trees of "
+            "depth %d are supported\n",
+            path, p->n_tree, p->depth, PRED_MAX_TREE, PRED_MAX_DEPTH);
+    }
+    for (int t = 0; t < p->n_tree && ok; t++) {
+      for (int d = 0; d < p->depth && ok; d++) {
+        ok = fscanf(f, "%d %lf", &p->split_feat[t][d],
+                    &p->split_thresh[t][d]) == 2 &&
+             p->split_feat[t][d] >= 0 && p->split_feat[t][d] < N_PRED_FEAT;
+      }
+      for (int l = 0; l < (1 << p->depth) && ok; l++) {
+        ok = fscanf(f, "%lf", &p->leaf[t][l]) == 1;
+      }
+    }
+  } else {
+    ERROR("unknown predictor model %s in %s, supported: linear, gbdt\n", kind,
+          path);
+  }
+  if (!ok) {
+    ERROR("predictor model %s is truncated or malformed\n", path);
+  }
+  fclose(f);
+}
+
+static inline void _predictor_score_age(const predictor_t *p,
+                                        const pred_batch_t *b,
+                                        uint8_t *retain) {
+  /* the prediction is truncated to an integer before it is compared with the
+   * expected reuse distance, trunc(x) < d is x < ceil(d) for x >= 0 */
+  const double limit = ceil(b->expected_reuse_distance);
+  const double scaler = p->scaler;
+  const double *age = b->feat[PRED_FEAT_AGE];
+  for (int i = 0; i < b->n; i++) {
+    retain[i] = age[i] * scaler < limit;
+  }
+}
+
+static inline void _predictor_score_linear(const predictor_t *p,
+                                           const pred_batch_t *b,
+                                           uint8_t *retain) {
+  const double inv_ed = 1.0 / b->expected_reuse_distance;
+  double score[PRED_BATCH_SIZE];
+  for (int i = 0; i < b->n; i++) {
+    score[i] = p->bias +
+               p->weight[PRED_FEAT_AGE] * b->feat[PRED_FEAT_AGE][i] * inv_ed +
+               p->weight[PRED_FEAT_REUSE] * b->feat[PRED_FEAT_REUSE][i] * inv_ed;
+  }
+  for (int j = PRED_FEAT_FREQ; j < N_PRED_FEAT; j++) {
+    const double w = p->weight[j];
+    for (int i = 0; i < b->n; i++) {
+      score[i] += w * b->feat[j][i];
+    }
+  }
+  for (int i = 0; i < b->n; i++) {
+    retain[i] = score[i] > 0;
+  }
+}
+
+static inline void _predictor_score_gbdt(const predictor_t *p,
+                                         const pred_batch_t *b,
+                                         uint8_t *retain) {
+  /* normalize age and reuse distance once for all trees */
+  double x[N_PRED_FEAT][PRED_BATCH_SIZE];
+  const double inv_ed = 1.0 / b->expected_reuse_distance;
+  for (int j = 0; j < N_PRED_FEAT; j++) {
+    const double s =
+        (j == PRED_FEAT_AGE || j == PRED_FEAT_REUSE) ? inv_ed : 1.0;
+    for (int i = 0; i < b->n; i++) {
+      x[j][i] = b->feat[j][i] * s;
+    }
+  }
+
+  double score[PRED_BATCH_SIZE] = {0};
+  int32_t idx[PRED_BATCH_SIZE];
+  for (int t = 0; t < p->n_tree; t++) {
+    for (int i = 0; i < b->n; i++) idx[i] = 0;
+    for (int d = 0; d < p->depth; d++) {
+      const double *xf = x[p->split_feat[t][d]];
+      const double thresh = p->split_thresh[t][d];
+      for (int i = 0; i < b->n; i++) {
+        idx[i] |= (int32_t)(xf[i] > thresh) << d;
+      }
+    }
+    for (int i = 0; i < b->n; i++) {
+      score[i] += p->leaf[t][idx[i]];
+    }
+  }
+  for (int i = 0; i < b->n; i++) {
+    retain[i] = score[i] > 0;
+  }
+}
+
+/**
+ * @brief decide for each candidate in the batch whether it is retained
+ *
+ * @param retain output, retain[i] is 1 if candidate i should be kept
+ */
+static inline void predictor_score_batch(const predictor_t *p,
+                                         const pred_batch_t *b,
+                                         uint8_t *retain) {
+  switch (p->kind) {
+    case PREDICTOR_AGE:
+      _predictor_score_age(p, b, retain);
+      break;
+    case PREDICTOR_LINEAR:
+      _predictor_score_linear(p, b, retain);
+      break;
+    case PREDICTOR_GBDT:
+      _predictor_score_gbdt(p, b, retain);
+      break;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
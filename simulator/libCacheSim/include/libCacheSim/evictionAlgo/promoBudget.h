@@ -0,0 +1,211 @@
+#pragma once
+//
+//  a feedback controller that caps the promotion rate of a lazy promotion
+//  policy by adapting its knob online, e.g., prob of Prob, delay-time of
+//  Delay, batch-size of Batch, scaler of AGE, delay-ratio of DelayFR
+//
+//  the configured knob is the unconstrained policy and the most eager
+//  setting the controller uses, every window of requests it compares the
+//  promotion rate (per request or per second) with the budget and moves the
+//  knob multiplicatively, towards lazy if over budget, and back towards the
+//  configured value if under budget
+//
+//  the rate is the larger of the rate in the window and the rate since the
+//  start, so the promotions spent over budget while the knob converges are
+//  paid back by running lazier, and the rate over the whole trace stays
+//  within the budget
+//
+//  by default the budget is a hard cap, the controller only moves towards
+//  eager when the rate is under budget, so it keeps the miss ratio as close
+//  to the unconstrained policy as the budget allows
+//
+//  with epsilon (budget-epsilon), the owner runs ref, a copy of the cache
+//  with the configured knob and no budget, on the same requests, and the
+//  controller moves towards eager regardless of the budget while the hit
+//  ratio since the start is more than half of epsilon below that of ref, so
+//  the miss ratio stays within epsilon of the unconstrained policy and the
+//  budget becomes a soft cap, ref sees the same requests at the same time,
+//  so a phase change of the workload does not look like a loss
+//
+//  promoBudget.h
+//  libCacheSim
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cache;
+
+/* the largest step of the knob in one window, the controller throttles
+ * fast and relaxes slowly, so a burst after a quiet window does not run at
+ * the eager setting for long */
+#define PROMO_BUDGET_MAX_LAZY_STEP 4.0
+#define PROMO_BUDGET_MAX_EAGER_STEP 1.25
+/* move towards eager only below this fraction of the budget */
+#define PROMO_BUDGET_HYSTERESIS 0.8
+/* the guard backs off above this fraction of epsilon, the loss keeps growing
+ * for a while after the knob turns eager, until the cache content recovers */
+#define PROMO_BUDGET_GUARD_MARGIN 0.5
+
+typedef struct {
+  bool enabled;
+  /* promotions per request, or per second if per_sec */
+  double target;
+  bool per_sec;
+  /* the number of requests in a window */
+  int64_t window;
+
+  double knob;
+  /* the configured value and the bound in the lazy direction */
+  double knob_eager;
+  double knob_lazy;
+
+  /* the counters at the start of the window */
+  int64_t n_req;
+  int64_t n_promotion_start;
+  int64_t start_time;
+  /* the counters since the start */
+  int64_t n_req_total;
+  int64_t first_time;
+  int64_t n_adjust;
+
+  /* the hit ratio guard, off if epsilon is 0 */
+  double epsilon;
+  /* the cache without the budget, created and run by the owner */
+  struct cache *ref;
+  /* the counters of the guard since the start */
+  int64_t n_guard_req;
+  int64_t n_hit;
+  int64_t n_ref_hit;
+} promo_budget_t;
+
+static inline void promo_budget_init(promo_budget_t *b, double knob_eager,
+                                     double knob_lazy) {
+  b->enabled = b->target > 0;
+  if (b->window <= 0) b->window = 1000;
+  b->knob = knob_eager;
+  b->knob_eager = knob_eager;
+  b->knob_lazy = knob_lazy;
+  b->n_req = 0;
+  b->n_promotion_start = 0;
+  b->start_time = -1;
+  b->n_req_total = 0;
+  b->first_time = -1;
+  b->n_adjust = 0;
+  b->n_guard_req = 0;
+  b->n_hit = 0;
+  b->n_ref_hit = 0;
+}
+
+/* whether the owner should create ref */
+static inline bool promo_budget_guarded(const promo_budget_t *b) {
+  return b->enabled && b->epsilon > 0;
+}
+
+/* the parameters of ref, the parameters of the cache with the budget and the
+ * guard turned off, the later value of a parameter overrides the earlier */
+static inline const char *promo_budget_ref_params(char *buf, size_t size,
+                                                  const char *params) {
+  bool has_params = params != NULL && params[0] != '\0';
+  snprintf(buf, size, "%s%spromotion-budget=0,budget-epsilon=0",
+           has_params ? params : "", has_params ? "," : "");
+  return buf;
+}
+
+/* count the outcome of one request in the cache and in ref */
+static inline void promo_budget_count_hit(promo_budget_t *b, bool hit,
+                                          bool ref_hit) {
+  b->n_guard_req += 1;
+  b->n_hit += hit;
+  b->n_ref_hit += ref_hit;
+}
+
+/* move the knob by factor (>= 1) towards knob_lazy, or knob_eager if
+ * factor < 1, and clamp it between the two */
+static inline void _promo_budget_move(promo_budget_t *b, double factor) {
+  bool lazy_is_larger = b->knob_lazy > b->knob_eager;
+  if (b->knob == 0 && lazy_is_larger) {
+    /* a multiplicative step cannot leave 0 */
+    b->knob = b->knob_lazy / 1024;
+  }
+  double knob = lazy_is_larger ? b->knob * factor : b->knob / factor;
+  double lo = lazy_is_larger ? b->knob_eager : b->knob_lazy;
+  double hi = lazy_is_larger ? b->knob_lazy : b->knob_eager;
+  if (knob < lo) knob = lo;
+  if (knob > hi) knob = hi;
+  if (knob != b->knob) b->n_adjust += 1;
+  b->knob = knob;
+}
+
+static inline bool _promo_budget_update(promo_budget_t *b, int64_t now,
+                                        int64_t n_promotion) {
+  double rate = (double)(n_promotion - b->n_promotion_start);
+  double total_rate = (double)n_promotion;
+  if (b->per_sec) {
+    if (now <= b->start_time) {
+      /* the window has not spanned a second, keep accumulating */
+      return false;
+    }
+    rate /= (double)(now - b->start_time);
+    total_rate /= (double)(now - b->first_time);
+  } else {
+    rate /= (double)b->n_req;
+    total_rate /= (double)b->n_req_total;
+  }
+  if (total_rate > rate) rate = total_rate;
+
+  /* the hit ratio lost to the unconstrained policy since the start, the
+   * eager knob stops the loss from growing but does not win it back, so the
+   * controller backs off, as fast as it throttles, before the loss reaches
+   * epsilon */
+  bool guard = false;
+  if (b->epsilon > 0 && b->n_guard_req > 0) {
+    double loss = (double)(b->n_ref_hit - b->n_hit) / (double)b->n_guard_req;
+    guard = loss > b->epsilon * PROMO_BUDGET_GUARD_MARGIN;
+  }
+
+  double old_knob = b->knob;
+  if (guard) {
+    _promo_budget_move(b, 1.0 / PROMO_BUDGET_MAX_LAZY_STEP);
+  } else if (rate > b->target) {
+    double step = rate / b->target;
+    _promo_budget_move(b, step < PROMO_BUDGET_MAX_LAZY_STEP
+                              ? step
+                              : PROMO_BUDGET_MAX_LAZY_STEP);
+  } else if (rate < b->target * PROMO_BUDGET_HYSTERESIS) {
+    double step = rate > 0 ? b->target / rate : PROMO_BUDGET_MAX_EAGER_STEP;
+    _promo_budget_move(b, step < PROMO_BUDGET_MAX_EAGER_STEP
+                              ? 1.0 / step
+                              : 1.0 / PROMO_BUDGET_MAX_EAGER_STEP);
+  }
+
+  b->n_req = 0;
+  b->n_promotion_start = n_promotion;
+  b->start_time = now;
+  return b->knob != old_knob;
+}
+
+/**
+ * @brief count one request, call it on every lookup with the cumulative
+ * promotion counter of the cache
+ *
+ * @param now the clock time of the request, used if the budget is per second
+ * @return true if the knob changed
+ */
+static inline bool promo_budget_tick(promo_budget_t *b, int64_t now,
+                                     int64_t n_promotion) {
+  if (!b->enabled) return false;
+  if (b->start_time < 0) b->start_time = b->first_time = now;
+  b->n_req_total += 1;
+  if (++b->n_req < b->window) return false;
+  return _promo_budget_update(b, now, n_promotion);
+}
+
+#ifdef __cplusplus
+}
+#endif
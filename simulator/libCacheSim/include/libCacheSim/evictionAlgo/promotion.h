@@ -0,0 +1,596 @@
+#pragma once
+//
+//  promotion policies for queue-based caches
+//
+//  a promotion queue is a doubly linked list ordered by the time of insertion
+//  or promotion, the head is the newest, the tail is evicted, and the policy
+//  decides when an object moves back to the head:
+//    LRU   (eager) on every hit
+//    Prob  on a hit with probability prob
+//    Delay on a hit if the object has not been promoted in the last
+//          delay_time insertions
+//    Batch hits are buffered and promoted together every batch_size
+//          insertions, in the order of their last hit
+//    FR    at eviction, if the object was hit since its last promotion
+//          (FIFO-reinsertion / Clock with an n-bit counter)
+//    AGE   at eviction, like FR, but only if the object was accessed within
+//          scaler * the expected reuse distance
+//
+//  a promotion budget (see promoBudget.h) adapts prob, delay_time,
+//  batch_size or scaler online to cap the promotion rate, budget-epsilon
+//  keeps the miss ratio within epsilon of the policy without the budget
+//
+//  every function takes the policy as its second argument, callers pass a
+//  constant so that each call site is specialized after inlining and the hit
+//  path has neither a branch nor an indirect call on the policy,
+//  PROMO_QUEUE_DEFINE_ALL instantiates the cache functions of an algorithm
+//  once per policy and PROMO_QUEUE_SET_FUNCS picks them at init, see
+//  PromoQueue.c for a cache of one queue, and ARC_promo.c, TwoQ_promo.c for
+//  algorithms that keep several queues over one hashtable
+//
+//  promotion.h
+//  libCacheSim
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../cache.h"
+#include "../cacheObj.h"
+#include "../logging.h"
+#include "../macro.h"
+#include "promoBudget.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  PROMO_LRU = 0,
+  PROMO_PROB,
+  PROMO_DELAY,
+  PROMO_BATCH,
+  PROMO_FR,
+  PROMO_AGE,
+
+  N_PROMO_POLICY
+} promo_policy_e;
+
+static const char *const promo_policy_names[N_PROMO_POLICY] = {
+    "LRU", "Prob", "Delay", "Batch", "FR", "AGE"};
+
+/* return N_PROMO_POLICY if the name is unknown, eager is an alias of LRU */
+static inline promo_policy_e promo_policy_from_str(const char *name) {
+  if (strcasecmp(name, "eager") == 0) return PROMO_LRU;
+  for (int i = 0; i < N_PROMO_POLICY; i++) {
+    if (strcasecmp(name, promo_policy_names[i]) == 0) return (promo_policy_e)i;
+  }
+  return N_PROMO_POLICY;
+}
+
+typedef struct {
+  /* q_head and q_tail are the first two fields so that the queue can be
+   * read as LRU_params_t by algorithms that walk the list */
+  cache_obj_t *q_head;
+  cache_obj_t *q_tail;
+  promo_policy_e policy;
+
+  /* policy parameters */
+  float prob;
+  uint64_t delay_time;
+  uint64_t batch_size;
+  int max_freq;
+  double scaler;
+  /* the capacity of the queue, used by AGE to estimate the reuse distance */
+  int64_t queue_size;
+
+  /* the number of insertions, the clock of Delay and Batch */
+  uint64_t n_insert;
+  /* the number of accesses, the clock of AGE */
+  int64_t vtime;
+  int64_t n_hit;
+
+  /* the objects hit since the last batch, NULL if removed since queued */
+  cache_obj_t **buffer;
+  uint64_t buffer_pos;
+  uint64_t buffer_size;
+  uint64_t last_batch_time;
+
+  int64_t n_promotion;
+  /* the promotions made at eviction by FR and AGE */
+  int64_t n_reinsertion;
+  int64_t n_batch;
+
+  /* enabled if budget.target is set before promo_queue_setup */
+  promo_budget_t budget;
+
+  /* the cache that promotions are reported to with cache_rewrite_base,
+   * NULL if none */
+  struct cache *cache;
+} promo_queue_t;
+
+/**
+ * @brief set up the queue after the policy parameters are set
+ */
+static inline void promo_queue_setup(promo_queue_t *q, int64_t queue_size) {
+  q->q_head = NULL;
+  q->q_tail = NULL;
+  q->queue_size = queue_size;
+  if (q->delay_time == 0) q->delay_time = 1;
+  if (q->batch_size == 0) q->batch_size = 1;
+  if (q->max_freq < 1) q->max_freq = 1;
+
+  q->buffer = NULL;
+  if (q->policy == PROMO_BATCH) {
+    q->buffer_size = MIN(q->batch_size, 1 << 20);
+    q->buffer = malloc(sizeof(cache_obj_t *) * q->buffer_size);
+  }
+
+  /* the configured knob is the most eager, the lazy bound is 1000 times
+   * lazier, or the queue size for delay-time because an object is evicted
+   * before it can be promoted again, a batch still promotes the objects hit
+   * since the last batch, so batch-size can grow past the queue size, AGE
+   * compares reuse times with the queue size scaled by scaler, so its bound
+   * is 1 / queue size of the configured scaler when the queue is in bytes */
+  int64_t max_time = MAX(queue_size, 1);
+  switch (q->policy) {
+    case PROMO_PROB:
+      promo_budget_init(&q->budget, q->prob, q->prob / 1000);
+      break;
+    case PROMO_DELAY:
+      promo_budget_init(&q->budget, (double)q->delay_time,
+                        (double)MAX((uint64_t)max_time, q->delay_time));
+      break;
+    case PROMO_BATCH:
+      promo_budget_init(&q->budget, (double)q->batch_size,
+                        (double)MAX((uint64_t)max_time, q->batch_size) * 1000);
+      break;
+    case PROMO_AGE:
+      promo_budget_init(&q->budget, q->scaler,
+                        q->scaler / (double)MAX(max_time, 1000));
+      break;
+    default:
+      /* LRU and FR do not have a knob */
+      if (q->budget.target > 0) {
+        WARN("promotion budget is not supported by %s, ignored\n",
+             promo_policy_names[q->policy]);
+      }
+      q->budget.target = 0;
+      promo_budget_init(&q->budget, 0, 0);
+  }
+}
+
+/* set the knob of the policy from the budget controller */
+static inline void _promo_queue_apply_budget(promo_queue_t *q) {
+  double knob = q->budget.knob;
+  switch (q->policy) {
+    case PROMO_PROB:
+      q->prob = (float)knob;
+      break;
+    case PROMO_DELAY:
+      q->delay_time = MAX((uint64_t)knob, 1);
+      break;
+    case PROMO_BATCH:
+      q->batch_size = MAX((uint64_t)knob, 1);
+      break;
+    case PROMO_AGE:
+      q->scaler = knob;
+      break;
+    default:
+      break;
+  }
+}
+
+/* the parameters of a queue, the parameters given to the cache are parsed
+ * after them */
+#define PROMO_QUEUE_DEFAULT_PARAMS                                        \
+  "promotion=LRU,prob=0.5,delay-time=0.2,batch-size=0.2,n-bit-counter=1," \
+  "scaler=0.1"
+
+static inline const char *promo_queue_current_params(const promo_queue_t *q) {
+  static __thread char params_str[384];
+  snprintf(params_str, 384,
+           "promotion=%s,prob=%.4f,delay-time=%lu,batch-size=%lu,"
+           "max-freq=%d,scaler=%.4f,promotion-budget%s=%g,"
+           "budget-window=%ld,budget-epsilon=%g\n",
+           promo_policy_names[q->policy], q->prob,
+           (unsigned long)q->delay_time, (unsigned long)q->batch_size,
+           q->max_freq, q->scaler, q->budget.per_sec ? "-per-sec" : "",
+           q->budget.target, (long)q->budget.window, q->budget.epsilon);
+  return params_str;
+}
+
+/* a value with a decimal point is a fraction of the queue size */
+static inline uint64_t _promo_queue_parse_time(const char *value,
+                                               int64_t queue_size) {
+  char *end;
+  uint64_t t;
+  if (strchr(value, '.') != NULL) {
+    t = (uint64_t)(strtof(value, &end) * queue_size);
+  } else {
+    t = (uint64_t)strtol(value, &end, 0);
+  }
+  if (strlen(end) > 2) {
+    ERROR("param parsing error, find string \"%s\" after number\n", end);
+  }
+  return t;
+}
+
+/**
+ * @brief parse the policy and its parameters, call it before
+ * promo_queue_setup
+ *
+ * @param queue_size the size that a delay-time or batch-size with a decimal
+ * point is a fraction of
+ * @param cache_name used in the error message of an unknown parameter
+ */
+static inline void promo_queue_parse_params(promo_queue_t *q,
+                                            const char *cache_specific_params,
+                                            int64_t queue_size,
+                                            const char *cache_name) {
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "promotion") == 0) {
+      q->policy = promo_policy_from_str(value);
+      if (q->policy == N_PROMO_POLICY) {
+        ERROR("unknown promotion policy %s, supported: LRU, Prob, Delay, "
+              "Batch, FR, AGE\n",
+              value);
+      }
+    } else if (strcasecmp(key, "prob") == 0) {
+      q->prob = (float)strtod(value, NULL);
+    } else if (strcasecmp(key, "delay-time") == 0) {
+      q->delay_time = _promo_queue_parse_time(value, queue_size);
+    } else if (strcasecmp(key, "batch-size") == 0) {
+      q->batch_size = _promo_queue_parse_time(value, queue_size);
+    } else if (strcasecmp(key, "n-bit-counter") == 0) {
+      q->max_freq = (1 << (int)strtol(value, NULL, 0)) - 1;
+    } else if (strcasecmp(key, "scaler") == 0) {
+      q->scaler = strtod(value, NULL);
+    } else if (strcasecmp(key, "promotion-budget") == 0) {
+      q->budget.target = strtod(value, NULL);
+      q->budget.per_sec = false;
+    } else if (strcasecmp(key, "promotion-budget-per-sec") == 0) {
+      q->budget.target = strtod(value, NULL);
+      q->budget.per_sec = true;
+    } else if (strcasecmp(key, "budget-window") == 0) {
+      q->budget.window = strtol(value, NULL, 0);
+    } else if (strcasecmp(key, "budget-epsilon") == 0) {
+      q->budget.epsilon = strtod(value, NULL);
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n", promo_queue_current_params(q));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s\n", cache_name, key);
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+static inline void promo_queue_free(promo_queue_t *q) {
+  free(q->buffer);
+  q->buffer = NULL;
+  if (q->budget.ref != NULL) {
+    q->budget.ref->cache_free(q->budget.ref);
+    q->budget.ref = NULL;
+  }
+}
+
+/**
+ * @brief create the reference cache of the hit ratio guard of the budget if
+ * budget-epsilon is set, call it after promo_queue_setup
+ *
+ * @param init the init function of the cache that owns the queue
+ * @param cache_specific_params the parameters given to the cache
+ */
+static inline void promo_queue_setup_ref(
+    promo_queue_t *q,
+    cache_t *(*init)(const common_cache_params_t, const char *),
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params) {
+  if (!promo_budget_guarded(&q->budget)) return;
+  char params_str[1024];
+  q->budget.ref = init(ccache_params,
+                       promo_budget_ref_params(params_str, sizeof(params_str),
+                                               cache_specific_params));
+}
+
+/**
+ * @brief run the request on the reference cache and count both outcomes,
+ * call it on every request after the cache has served it
+ */
+static inline void promo_queue_count_hit(promo_queue_t *q,
+                                         const request_t *req, bool hit) {
+  if (q->budget.ref == NULL) return;
+  bool ref_hit = q->budget.ref->get(q->budget.ref, req);
+  promo_budget_count_hit(&q->budget, hit, ref_hit);
+}
+
+static inline void _promo_queue_promote(promo_queue_t *q, cache_obj_t *obj) {
+  move_obj_to_head(&q->q_head, &q->q_tail, obj);
+  q->n_promotion += 1;
+  if (q->cache != NULL) cache_rewrite_base(q->cache, obj);
+}
+
+static int _promo_queue_cmp_last_hit(const void *a, const void *b) {
+  const cache_obj_t *obj_a = *(cache_obj_t *const *)a;
+  const cache_obj_t *obj_b = *(cache_obj_t *const *)b;
+  return (obj_a->promo.last_hit > obj_b->promo.last_hit) -
+         (obj_a->promo.last_hit < obj_b->promo.last_hit);
+}
+
+/* promote the buffered objects, the most recently hit ends at the head */
+static inline void _promo_queue_flush(promo_queue_t *q) {
+  uint64_t n_live = 0;
+  for (uint64_t i = 0; i < q->buffer_pos; i++) {
+    if (q->buffer[i] != NULL) {
+      q->buffer[n_live++] = q->buffer[i];
+    }
+  }
+
+  qsort(q->buffer, n_live, sizeof(cache_obj_t *), _promo_queue_cmp_last_hit);
+  for (uint64_t i = 0; i < n_live; i++) {
+    q->buffer[i]->promo.queued = false;
+    _promo_queue_promote(q, q->buffer[i]);
+  }
+  if (n_live > 0) {
+    q->n_batch += 1;
+  }
+  q->buffer_pos = 0;
+  q->last_batch_time = q->n_insert;
+}
+
+static inline void _promo_queue_enqueue(promo_queue_t *q, cache_obj_t *obj) {
+  if (obj->promo.queued) return;
+
+  if (q->buffer_pos == q->buffer_size) {
+    /* drop the slots of the objects evicted since queued, so that the buffer
+     * is bounded by the queue size however long the batch is */
+    uint64_t n_live = 0;
+    for (uint64_t i = 0; i < q->buffer_pos; i++) {
+      if (q->buffer[i] != NULL) {
+        q->buffer[i]->promo.buffer_idx = n_live;
+        q->buffer[n_live++] = q->buffer[i];
+      }
+    }
+    q->buffer_pos = n_live;
+    if (n_live * 2 > q->buffer_size) {
+      q->buffer_size *= 2;
+      q->buffer = realloc(q->buffer, sizeof(cache_obj_t *) * q->buffer_size);
+    }
+  }
+  obj->promo.queued = true;
+  obj->promo.buffer_idx = q->buffer_pos;
+  q->buffer[q->buffer_pos++] = obj;
+}
+
+/* whether AGE keeps the object at eviction */
+static inline bool _promo_queue_age_retain(const promo_queue_t *q,
+                                           const cache_obj_t *obj) {
+  if (obj->promo.freq == 0) return false;
+  if (q->vtime == 0 || q->n_insert == 0) return true;
+
+  double miss_ratio = (double)q->n_insert / (double)q->vtime;
+  double expected_reuse_distance = (double)q->queue_size / miss_ratio;
+  return (double)(q->vtime - obj->promo.last_access_vtime) <
+         expected_reuse_distance * q->scaler;
+}
+
+/**
+ * @brief count one access to the queue, call it on every lookup,
+ * hit or miss, before promo_queue_hit or promo_queue_insert
+ *
+ * @param now the clock time of the request, used by a per second budget
+ */
+static inline void promo_queue_access(promo_queue_t *q, int64_t now) {
+  q->vtime += 1;
+  if (promo_budget_tick(&q->budget, now, q->n_promotion)) {
+    _promo_queue_apply_budget(q);
+  }
+}
+
+/**
+ * @brief add a new object at the head
+ */
+static inline __attribute__((always_inline)) void promo_queue_insert(
+    promo_queue_t *q, const promo_policy_e policy, cache_obj_t *obj) {
+  q->n_insert += 1;
+  obj->promo.freq = 0;
+  obj->promo.queued = false;
+  obj->promo.last_promo_vtime = q->n_insert;
+  obj->promo.last_access_vtime = q->vtime;
+  prepend_obj_to_head(&q->q_head, &q->q_tail, obj);
+}
+
+/**
+ * @brief a hit on an object in the queue
+ */
+static inline __attribute__((always_inline)) void promo_queue_hit(
+    promo_queue_t *q, const promo_policy_e policy, cache_obj_t *obj) {
+  q->n_hit += 1;
+
+  switch (policy) {
+    case PROMO_LRU:
+      _promo_queue_promote(q, obj);
+      break;
+    case PROMO_PROB:
+      if ((float)rand() / (float)(RAND_MAX) < q->prob) {
+        _promo_queue_promote(q, obj);
+      }
+      break;
+    case PROMO_DELAY:
+      if (q->n_insert - obj->promo.last_promo_vtime > q->delay_time) {
+        _promo_queue_promote(q, obj);
+        obj->promo.last_promo_vtime = q->n_insert;
+      }
+      break;
+    case PROMO_BATCH:
+      obj->promo.last_hit = q->n_hit;
+      _promo_queue_enqueue(q, obj);
+      if (q->n_insert - q->last_batch_time >= q->batch_size) {
+        _promo_queue_flush(q);
+      }
+      break;
+    case PROMO_FR:
+    case PROMO_AGE:
+      if (obj->promo.freq < q->max_freq) {
+        obj->promo.freq += 1;
+      }
+      obj->promo.last_access_vtime = q->vtime;
+      break;
+    default:
+      abort();
+  }
+}
+
+/**
+ * @brief the object that promo_queue_evict will return,
+ * this does not change the queue, NULL if the queue is empty
+ */
+static inline __attribute__((always_inline)) cache_obj_t *promo_queue_to_evict(
+    const promo_queue_t *q, const promo_policy_e policy) {
+  cache_obj_t *obj = q->q_tail;
+  if (obj == NULL || (policy != PROMO_FR && policy != PROMO_AGE)) {
+    return obj;
+  }
+
+  /* an object with freq f is moved to the head f times before eviction */
+  int n_round = 0;
+  while (obj->promo.freq - n_round >= 1 &&
+         (policy == PROMO_FR || _promo_queue_age_retain(q, obj))) {
+    obj = obj->queue.prev;
+    if (obj == NULL) {
+      obj = q->q_tail;
+      n_round += 1;
+    }
+  }
+  return obj;
+}
+
+/**
+ * @brief find the object to evict and unlink it from the queue,
+ * FR and AGE move the objects they keep to the head first,
+ * NULL if the queue is empty
+ */
+static inline __attribute__((always_inline)) cache_obj_t *promo_queue_evict(
+    promo_queue_t *q, const promo_policy_e policy) {
+  cache_obj_t *obj = q->q_tail;
+  if (obj == NULL) {
+    return NULL;
+  }
+
+  if (policy == PROMO_FR || policy == PROMO_AGE) {
+    while (obj->promo.freq >= 1 &&
+           (policy == PROMO_FR || _promo_queue_age_retain(q, obj))) {
+      obj->promo.freq -= 1;
+      _promo_queue_promote(q, obj);
+      q->n_reinsertion += 1;
+      obj = q->q_tail;
+    }
+  }
+
+  if (policy == PROMO_BATCH && obj->promo.queued) {
+    q->buffer[obj->promo.buffer_idx] = NULL;
+    obj->promo.queued = false;
+  }
+  remove_obj_from_list(&q->q_head, &q->q_tail, obj);
+  return obj;
+}
+
+/**
+ * @brief unlink an object that is not the eviction victim
+ */
+static inline __attribute__((always_inline)) void promo_queue_remove(
+    promo_queue_t *q, const promo_policy_e policy, cache_obj_t *obj) {
+  if (policy == PROMO_BATCH && obj->promo.queued) {
+    q->buffer[obj->promo.buffer_idx] = NULL;
+    obj->promo.queued = false;
+  }
+  remove_obj_from_list(&q->q_head, &q->q_tail, obj);
+}
+
+/* instantiate the cache functions of an algorithm for one policy, the
+ * algorithm defines _<prefix>_find, _insert, _to_evict, _evict and _remove
+ * with the policy as the last argument, and they are always_inline so that
+ * the policy is a constant in each instance */
+#define PROMO_QUEUE_DEFINE(prefix, name, POLICY)                             \
+  static cache_obj_t *prefix##_find_##name(                                  \
+      cache_t *cache, const request_t *req, const bool update_cache) {       \
+    return _##prefix##_find(cache, req, update_cache, POLICY);               \
+  }                                                                          \
+  static cache_obj_t *prefix##_insert_##name(cache_t *cache,                 \
+                                             const request_t *req) {         \
+    return _##prefix##_insert(cache, req, POLICY);                           \
+  }                                                                          \
+  static cache_obj_t *prefix##_to_evict_##name(cache_t *cache,               \
+                                               const request_t *req) {       \
+    return _##prefix##_to_evict(cache, req, POLICY);                         \
+  }                                                                          \
+  static void prefix##_evict_##name(cache_t *cache, const request_t *req) {  \
+    _##prefix##_evict(cache, req, POLICY);                                   \
+  }                                                                          \
+  static bool prefix##_remove_##name(cache_t *cache, const obj_id_t obj_id) { \
+    return _##prefix##_remove(cache, obj_id, POLICY);                        \
+  }
+
+#define PROMO_QUEUE_DEFINE_ALL(prefix)        \
+  PROMO_QUEUE_DEFINE(prefix, LRU, PROMO_LRU)     \
+  PROMO_QUEUE_DEFINE(prefix, Prob, PROMO_PROB)   \
+  PROMO_QUEUE_DEFINE(prefix, Delay, PROMO_DELAY) \
+  PROMO_QUEUE_DEFINE(prefix, Batch, PROMO_BATCH) \
+  PROMO_QUEUE_DEFINE(prefix, FR, PROMO_FR)       \
+  PROMO_QUEUE_DEFINE(prefix, AGE, PROMO_AGE)
+
+#define _PROMO_QUEUE_SET_FUNCS(cache, prefix, name) \
+  do {                                              \
+    (cache)->find = prefix##_find_##name;           \
+    (cache)->insert = prefix##_insert_##name;       \
+    (cache)->to_evict = prefix##_to_evict_##name;   \
+    (cache)->evict = prefix##_evict_##name;         \
+    (cache)->remove = prefix##_remove_##name;       \
+  } while (0)
+
+/* point the cache functions to the instance of the policy */
+#define PROMO_QUEUE_SET_FUNCS(cache, prefix, policy)            \
+  do {                                                          \
+    switch (policy) {                                           \
+      case PROMO_LRU:                                           \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, LRU);             \
+        break;                                                  \
+      case PROMO_PROB:                                          \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, Prob);            \
+        break;                                                  \
+      case PROMO_DELAY:                                         \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, Delay);           \
+        break;                                                  \
+      case PROMO_BATCH:                                         \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, Batch);           \
+        break;                                                  \
+      case PROMO_FR:                                            \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, FR);              \
+        break;                                                  \
+      case PROMO_AGE:                                           \
+        _PROMO_QUEUE_SET_FUNCS(cache, prefix, AGE);             \
+        break;                                                  \
+      default:                                                  \
+        ERROR("unknown promotion policy %d\n", (int)(policy));  \
+    }                                                           \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+//
+//  a flash tier that places the writes of a cache on a log-structured device
+//
+//  every object written by the cache, an insertion, or a rewrite such as a
+//  promotion or a reinsertion at eviction, is appended to the open segment,
+//  the old copy of a rewritten object and the copy of an evicted object
+//  become invalid, when the device runs out of free segments, garbage
+//  collection picks a victim segment (greedy, fifo or cost-benefit),
+//  appends its valid objects to the log and frees it
+//
+//  the device write amplification is (host writes + GC writes) / host
+//  writes, and a bandwidth and latency model of the device gives the write
+//  MB/s and the request rate the device can sustain
+//
+//  the tier is attached to a cache with attach_flash_tier, the base
+//  functions of the cache report insertions, hits and evictions, and the
+//  eviction algorithms report rewrites with cache_rewrite_base, the
+//  FIFO-family algorithms (FIFO, Clock, FIFO-Reinsertion, Sieve, DelayFR,
+//  AGE, PromoQueue, ARC_promo, TwoQ_promo, lpFIFO_batch, ...) do, S3FIFO
+//  shares the tier with its FIFO and main queues, the other algorithms do
+//  not support a tier
+//
+//  flashTier.h
+//  libCacheSim
+//
+
+#ifndef flashTier_h
+#define flashTier_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cacheObj.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  FLASH_GC_GREEDY = 0,
+  FLASH_GC_FIFO,
+  FLASH_GC_COST_BENEFIT,
+} flash_gc_policy_e;
+
+typedef struct {
+  bool enabled;
+  /* in bytes, 0 divides the device into 256 segments */
+  int64_t segment_size;
+  /* the device capacity is (1 + over_provision) * cache size */
+  double over_provision;
+  flash_gc_policy_e gc_policy;
+
+  /* the device model */
+  double write_bw_mbps;
+  double read_bw_mbps;
+  double read_lat_us;
+  int queue_depth;
+} flash_params_t;
+
+typedef struct {
+  /* insertions and rewrites */
+  int64_t n_host_write_byte;
+  /* the part of host writes that are rewrites */
+  int64_t n_rewrite_byte;
+  /* valid bytes moved by garbage collection */
+  int64_t n_gc_write_byte;
+  int64_t n_gc;
+  /* hits served from the device */
+  int64_t n_read;
+  int64_t n_read_byte;
+  /* the trace time in seconds */
+  int64_t start_time;
+  int64_t end_time;
+} flash_stat_t;
+
+typedef struct {
+  double write_amp;
+  /* device writes in MB per second of trace time, or at the achievable
+   * request rate if the trace has no timestamps */
+  double write_mbps;
+  /* the request rate in million requests per second that saturates the
+   * device */
+  double max_mqps;
+} flash_estimate_t;
+
+typedef enum {
+  FLASH_SEG_FREE = 0,
+  FLASH_SEG_OPEN,
+  FLASH_SEG_SEALED,
+} flash_seg_state_e;
+
+typedef struct {
+  flash_seg_state_e state;
+  int64_t used_byte;
+  int64_t valid_byte;
+  /* the device write clock when the segment is sealed */
+  int64_t seal_time;
+  /* the objects appended to the segment, some may be invalid */
+  obj_id_t *obj_ids;
+  int32_t n_obj;
+  int32_t obj_ids_size;
+} flash_segment_t;
+
+/* the number of caches that can share a tier, a composite algorithm shares
+ * it with its sub-caches */
+#define FLASH_MAX_CACHE 4
+
+typedef struct flash_tier {
+  flash_params_t params;
+  int64_t segment_size;
+  int32_t n_segment;
+  flash_segment_t *segments;
+  int32_t *free_segments;
+  int32_t n_free_segment;
+  int32_t open_segment;
+  /* the number of bytes written to the device */
+  int64_t write_clock;
+
+  /* the caches whose objects are on the tier, garbage collection looks the
+   * objects of a victim segment up in their hashtables */
+  struct cache *caches[FLASH_MAX_CACHE];
+  int32_t n_cache;
+  /* the tier is freed when the last cache that holds it is freed */
+  int32_t n_ref;
+
+  flash_stat_t stat;
+} flash_tier_t;
+
+struct cache;
+
+flash_params_t default_flash_params(void);
+
+/**
+ * @brief parse "segment-size=1MiB,op=0.1,gc=greedy,write-bw=1000,
+ * read-bw=3000,read-lat=80,queue-depth=32", bandwidth in MB/s and
+ * latency in us, unspecified parameters are not changed
+ */
+void parse_flash_params(const char *params_str, flash_params_t *params);
+
+/**
+ * @brief create a flash tier for a cache of cache_size bytes
+ */
+flash_tier_t *create_flash_tier(const flash_params_t *params,
+                                int64_t cache_size);
+
+/**
+ * @brief let a cache write to the tier, the cache holds a reference
+ */
+void flash_tier_add_cache(flash_tier_t *flash, struct cache *cache);
+
+/**
+ * @brief drop the reference of a cache, the tier is freed with the last
+ * reference
+ */
+void flash_tier_release(flash_tier_t *flash);
+
+/* called by the base functions of the cache */
+void flash_tier_access(struct cache *cache, int64_t clock_time,
+                       const cache_obj_t *obj);
+void flash_tier_insert(struct cache *cache, cache_obj_t *obj);
+void flash_tier_rewrite(struct cache *cache, cache_obj_t *obj);
+void flash_tier_remove(struct cache *cache, cache_obj_t *obj);
+
+/**
+ * @brief write amplification, write bandwidth and the request rate that
+ * saturates the device
+ */
+flash_estimate_t estimate_flash(const flash_params_t *params,
+                                const flash_stat_t *stat, int64_t n_req);
+
+/**
+ * @brief the counts between two snapshots of the stat, e.g., after warmup
+ */
+flash_stat_t flash_stat_since(const flash_stat_t *stat,
+                              const flash_stat_t *start);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* flashTier_h */
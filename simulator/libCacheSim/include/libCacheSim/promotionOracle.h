@@ -0,0 +1,66 @@
+//
+//  the offline optimal promotion oracle for FIFO-reinsertion (Clock),
+//  it finds the optimal hit set and the promotions that FIFO-reinsertion
+//  needs to reach it, in one reverse scan and one forward pass of the trace
+//
+//  objects have unit size, and the cache size is the number of objects
+//
+//  promotionOracle.h
+//  libCacheSim
+//
+
+#ifndef promotionOracle_h
+#define promotionOracle_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  int64_t cache_size;
+  int64_t n_req;
+  int64_t n_miss;
+  /* the number of requests in the target hit set */
+  int64_t n_target_hit;
+  int64_t n_promotion;
+  /* promotion[i] is the number of times the object of the i-th request is
+   * promoted before its next request, NULL if the decisions are not saved */
+  uint32_t *promotion;
+} promotion_oracle_result_t;
+
+/**
+ * @brief compute the optimal promotions of FIFO-reinsertion at each cache size
+ *
+ * the target hit set is an optimal (Belady) hit set: the reverse scan
+ * accepts the reuse intervals latest-start first while the occupancy of the
+ * interval stays below the cache size (a segment tree tracks the occupancy),
+ * then the forward pass runs FIFO-reinsertion, which does not insert
+ * objects whose next request is not a target hit, and promotes an object
+ * at the tail only if its next request is a target hit
+ *
+ * the reader is read once and reset
+ *
+ * @param reader
+ * @param cache_sizes the number of objects
+ * @param n_size
+ * @param save_decision whether to save the per-request promotion decisions
+ * @return an array of n_size results, free with free_promotion_oracle_result
+ */
+promotion_oracle_result_t *get_optimal_promotion(reader_t *reader,
+                                                 const int64_t *cache_sizes,
+                                                 int n_size,
+                                                 bool save_decision);
+
+void free_promotion_oracle_result(promotion_oracle_result_t *results,
+                                  int n_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* promotionOracle_h */
@@ -72,10 +72,12 @@ enum read_direction {
 };
 
 struct zstd_reader;
+struct stream_reader;
 typedef struct reader {
   /************* common fields *************/
   uint64_t n_read_req;
   uint64_t n_total_req; /* number of requests in the trace */
+  uint64_t n_total_obj; /* number of objects in the trace, 0 if unknown */
   char *trace_path;
   size_t file_size;
   reader_init_param_t init_params;
@@ -102,6 +104,9 @@ typedef struct reader {
   size_t mmap_offset;
   struct zstd_reader *zstd_reader_p;
   bool is_zstd_file;
+  /* the trace is read from a pipe or stdin, which cannot be rewound */
+  struct stream_reader *stream_reader_p;
+  bool is_stream;
   /* the size of one request in binary trace */
   size_t item_size;
   /************* used by txt trace *************/
@@ -180,6 +185,44 @@ static inline reader_init_param_t default_reader_init_params(void) {
 reader_t *setup_reader(const char *trace_path, trace_type_e trace_type,
                        const reader_init_param_t *reader_init_param);
 
+/**
+ * setup a reader that merges multiple traces by timestamp, each request is
+ * tagged with the index of its trace in req->tenant_id, and the obj_id is
+ * changed so that objects from different traces are different
+ * @param readers the readers to merge, the returned reader owns them
+ * @param n_readers
+ * @param rate_scales the request rate of each trace is multiplied by the
+ *  scale, NULL means no scaling, all traces are aligned to start at time 0
+ * @param reader_init_param only cap_at_n_req, ignore_obj_size and sampler are
+ *  used
+ *
+ * @return a pointer to reader_t struct, which should be closed by close_reader
+ */
+reader_t *setup_merge_reader(reader_t **readers, int n_readers,
+                             const double *rate_scales,
+                             const reader_init_param_t *reader_init_param);
+
+/**
+ * setup a reader that generates a synthetic workload instead of reading a
+ * trace, the workload is specified as "dist:key=value,key=value",
+ * e.g., "zipf:alpha=0.9,n_obj=1e8,n_req=1e10,size=lognormal,size_mu=8",
+ * dist is zipf or uniform, the keys are
+ *  n_obj, n_req, alpha, seed, req_rate (requests per second),
+ *  size (a fixed size or lognormal), size_mu, size_sigma, size_max,
+ *  scan_ratio, scan_len, loop_ratio, loop_len, one_hit_ratio (the fraction
+ *  of requests from scans, loops and one-hit wonders),
+ *  shift_every, shift_step (popularity ranks move every shift_every requests),
+ *  lookahead (compute next_access_vtime using a window of lookahead requests)
+ * setup_reader calls this function for SYNTHETIC_TRACE
+ * @param spec the workload specification
+ * @param reader_init_param only cap_at_n_req, ignore_obj_size and sampler are
+ *  used
+ *
+ * @return a pointer to reader_t struct, which should be closed by close_reader
+ */
+reader_t *setup_synthetic_reader(const char *spec,
+                                 const reader_init_param_t *init_params);
+
 /* this is the same function as setup_reader */
 static inline reader_t *open_trace(
     const char *path, const trace_type_e type,
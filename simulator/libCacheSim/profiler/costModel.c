@@ -0,0 +1,126 @@
+//
+//  the cost model of promotions, see costModel.h
+//
+//  costModel.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/costModel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../include/libCacheSim/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+cost_model_params_t default_cost_model_params(void) {
+  cost_model_params_t params;
+  params.hit_ns = 50;
+  params.miss_ns = 200;
+  params.lock_ns = 40;
+  params.splice_ns = 20;
+  params.scan_step_ns = 5;
+  params.md_write_ns = 2;
+  params.kappa = 0;
+  params.n_thread = 16;
+  return params;
+}
+
+void parse_cost_model_params(const char *params_str,
+                             cost_model_params_t *params) {
+  char *str = strdup(params_str);
+  char *old_str = str;
+
+  while (str != NULL && str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep(&str, "=");
+    char *value = strsep(&str, ",");
+
+    // skip the white space
+    while (str != NULL && *str == ' ') {
+      str++;
+    }
+
+    if (value == NULL) {
+      ERROR("cost model parameter %s has no value\n", key);
+    }
+
+    if (strcasecmp(key, "hit") == 0) {
+      params->hit_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "miss") == 0) {
+      params->miss_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "lock") == 0) {
+      params->lock_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "splice") == 0) {
+      params->splice_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "scan") == 0) {
+      params->scan_step_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "md-write") == 0) {
+      params->md_write_ns = strtod(value, NULL);
+    } else if (strcasecmp(key, "kappa") == 0) {
+      params->kappa = strtod(value, NULL);
+    } else if (strcasecmp(key, "n-thread") == 0) {
+      params->n_thread = (int)strtol(value, NULL, 0);
+      if (params->n_thread <= 0) {
+        ERROR("n-thread of the cost model must be positive\n");
+      }
+    } else {
+      ERROR("cost model does not have parameter %s, supported: hit, miss, "
+            "lock, splice, scan, md-write, kappa, n-thread\n",
+            key);
+    }
+  }
+
+  free(old_str);
+}
+
+cost_estimate_t estimate_cost(const cost_model_params_t *params,
+                              const cache_stat_t *stat) {
+  cost_estimate_t est;
+  memset(&est, 0, sizeof(est));
+  if (stat->n_req == 0) {
+    return est;
+  }
+
+  double n_req = (double)stat->n_req;
+  double n_miss = (double)stat->n_miss;
+  double n_hit = n_req - n_miss;
+  double n_reinsertion = (double)stat->n_reinsertion;
+  double n_promotion_on_hit = (double)(stat->n_promotion - stat->n_reinsertion);
+  if (n_promotion_on_hit < 0) n_promotion_on_hit = 0;
+  double n_promotion_lock = stat->n_promotion_batch > 0
+                                ? (double)stat->n_promotion_batch
+                                : n_promotion_on_hit;
+  /* a scan step is either a reinsertion or the eviction of the victim */
+  double n_scan_step = n_miss + n_reinsertion;
+  double n_md_write = n_hit - n_promotion_on_hit;
+  if (n_md_write < 0) n_md_write = 0;
+
+  /* a miss inserts and evicts under one lock acquisition */
+  double cs_ns = n_miss * (params->lock_ns + 2 * params->splice_ns) +
+                 n_promotion_lock * params->lock_ns +
+                 (n_promotion_on_hit + n_reinsertion) * params->splice_ns +
+                 n_scan_step * params->scan_step_ns;
+  double parallel_ns = n_hit * params->hit_ns + n_miss * params->miss_ns +
+                       n_md_write * params->md_write_ns;
+
+  est.cpu_ns_per_req = (cs_ns + parallel_ns) / n_req;
+  est.cs_ns_per_req = cs_ns / n_req;
+  est.throughput_1 = 1000.0 / est.cpu_ns_per_req;
+
+  double sigma = est.cs_ns_per_req / est.cpu_ns_per_req;
+  double n = (double)params->n_thread;
+  est.throughput_n =
+      n * est.throughput_1 /
+      (1 + sigma * (n - 1) + params->kappa * n * (n - 1));
+  return est;
+}
+
+#ifdef __cplusplus
+}
+#endif
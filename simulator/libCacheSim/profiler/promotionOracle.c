@@ -0,0 +1,271 @@
+//
+//  the offline optimal promotion oracle for FIFO-reinsertion (Clock)
+//
+//  a request is a target hit if the reuse interval ending at it is accepted,
+//  the reverse scan accepts the intervals in the order of decreasing start
+//  time if every point of the interval is covered by fewer than cache_size
+//  accepted intervals, which gives an optimal hit set for unit size objects,
+//  the occupancy is kept in a segment tree with range add and range max
+//
+//  the forward pass runs FIFO-reinsertion with the target hit set: an object
+//  is needed if its next request is a target hit, a needed object at the tail
+//  is promoted, an object that is not needed is evicted, and a miss whose
+//  object is not needed is not inserted, because at most cache_size needed
+//  objects exist at any time, every target hit is a hit, and an object is
+//  only promoted when it would otherwise miss a target hit
+//
+//  promotionOracle.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/promotionOracle.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the trace in memory, objects are numbered in the order of first request */
+typedef struct {
+  int32_t *obj_idx;
+  int64_t n_req;
+  int64_t n_obj;
+} oracle_trace_t;
+
+/* a segment tree over request time, the occupancy of a range is its max */
+typedef struct {
+  int32_t *max;
+  int32_t *lazy;
+  int64_t n_leaf;
+} seg_tree_t;
+
+static void _load_trace(reader_t *reader, oracle_trace_t *trace) {
+  int64_t capacity = get_num_of_req(reader);
+  if (capacity <= 0) capacity = 1 << 20;
+  trace->obj_idx = malloc(sizeof(int32_t) * capacity);
+  trace->n_req = 0;
+  trace->n_obj = 0;
+
+  GHashTable *obj_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+  request_t *req = new_request();
+  read_one_req(reader, req);
+  while (req->valid) {
+    if (trace->n_req == capacity) {
+      capacity *= 2;
+      trace->obj_idx = realloc(trace->obj_idx, sizeof(int32_t) * capacity);
+    }
+
+    gpointer key = GSIZE_TO_POINTER(req->obj_id);
+    gpointer value = g_hash_table_lookup(obj_table, key);
+    if (value == NULL) {
+      value = GSIZE_TO_POINTER(++trace->n_obj);
+      g_hash_table_insert(obj_table, key, value);
+    }
+    trace->obj_idx[trace->n_req++] = (int32_t)(GPOINTER_TO_SIZE(value) - 1);
+    read_one_req(reader, req);
+  }
+
+  free_request(req);
+  g_hash_table_destroy(obj_table);
+  if (!reader->is_stream) {
+    reset_reader(reader);
+  }
+}
+
+static int32_t _seg_max(const seg_tree_t *seg, int64_t node, int64_t node_l,
+                        int64_t node_r, int64_t l, int64_t r) {
+  if (r < node_l || node_r < l) return INT32_MIN;
+  if (l <= node_l && node_r <= r) return seg->max[node];
+
+  int64_t mid = (node_l + node_r) / 2;
+  int32_t left = _seg_max(seg, node * 2, node_l, mid, l, r);
+  int32_t right = _seg_max(seg, node * 2 + 1, mid + 1, node_r, l, r);
+  return MAX(left, right) + seg->lazy[node];
+}
+
+static void _seg_incr(seg_tree_t *seg, int64_t node, int64_t node_l,
+                      int64_t node_r, int64_t l, int64_t r) {
+  if (r < node_l || node_r < l) return;
+  if (l <= node_l && node_r <= r) {
+    seg->max[node] += 1;
+    seg->lazy[node] += 1;
+    return;
+  }
+
+  int64_t mid = (node_l + node_r) / 2;
+  _seg_incr(seg, node * 2, node_l, mid, l, r);
+  _seg_incr(seg, node * 2 + 1, mid + 1, node_r, l, r);
+  seg->max[node] =
+      MAX(seg->max[node * 2], seg->max[node * 2 + 1]) + seg->lazy[node];
+}
+
+/**
+ * @brief the reverse scan, accepted[t] is whether the reuse interval
+ * [t, next request of the same object) is accepted, i.e., whether the next
+ * request is a target hit
+ *
+ * @return the number of target hits
+ */
+static int64_t _find_target_hits(const oracle_trace_t *trace,
+                                 int64_t cache_size, uint8_t *accepted) {
+  seg_tree_t seg;
+  seg.n_leaf = 1;
+  while (seg.n_leaf < trace->n_req) seg.n_leaf <<= 1;
+  seg.max = calloc(seg.n_leaf * 2, sizeof(int32_t));
+  seg.lazy = calloc(seg.n_leaf * 2, sizeof(int32_t));
+
+  int64_t *next_req = malloc(sizeof(int64_t) * trace->n_obj);
+  for (int64_t i = 0; i < trace->n_obj; i++) next_req[i] = -1;
+
+  int64_t n_target_hit = 0;
+  for (int64_t t = trace->n_req - 1; t >= 0; t--) {
+    int32_t obj = trace->obj_idx[t];
+    int64_t next = next_req[obj];
+    next_req[obj] = t;
+
+    accepted[t] = 0;
+    if (next == -1) continue;
+    if (_seg_max(&seg, 1, 0, seg.n_leaf - 1, t, next - 1) < cache_size) {
+      _seg_incr(&seg, 1, 0, seg.n_leaf - 1, t, next - 1);
+      accepted[t] = 1;
+      n_target_hit += 1;
+    }
+  }
+
+  free(next_req);
+  free(seg.max);
+  free(seg.lazy);
+  return n_target_hit;
+}
+
+/**
+ * @brief the forward pass, run FIFO-reinsertion that keeps the needed
+ * objects, the queue is a doubly linked list of object indexes
+ */
+static void _run_fifo_reinsertion(const oracle_trace_t *trace,
+                                  const uint8_t *accepted,
+                                  promotion_oracle_result_t *result) {
+  int32_t *prev = malloc(sizeof(int32_t) * trace->n_obj);
+  int32_t *next = malloc(sizeof(int32_t) * trace->n_obj);
+  int64_t *last_req = malloc(sizeof(int64_t) * trace->n_obj);
+  uint8_t *in_cache = calloc(trace->n_obj, sizeof(uint8_t));
+  int32_t head = -1, tail = -1;
+  int64_t n_obj_cached = 0;
+
+#define QUEUE_REMOVE(o)                     \
+  do {                                      \
+    if (prev[o] != -1)                      \
+      next[prev[o]] = next[o];              \
+    else                                    \
+      head = next[o];                       \
+    if (next[o] != -1)                      \
+      prev[next[o]] = prev[o];              \
+    else                                    \
+      tail = prev[o];                       \
+  } while (0)
+
+#define QUEUE_PREPEND(o)       \
+  do {                         \
+    prev[o] = -1;              \
+    next[o] = head;            \
+    if (head != -1) prev[head] = o; \
+    head = o;                  \
+    if (tail == -1) tail = o;  \
+  } while (0)
+
+  for (int64_t t = 0; t < trace->n_req; t++) {
+    int32_t obj = trace->obj_idx[t];
+    if (in_cache[obj]) {
+      last_req[obj] = t;
+      continue;
+    }
+
+    result->n_miss += 1;
+    if (!accepted[t]) {
+      continue;
+    }
+
+    while (n_obj_cached >= result->cache_size) {
+      int32_t victim = tail;
+      QUEUE_REMOVE(victim);
+      if (accepted[last_req[victim]]) {
+        QUEUE_PREPEND(victim);
+        result->n_promotion += 1;
+        if (result->promotion != NULL) {
+          result->promotion[last_req[victim]] += 1;
+        }
+      } else {
+        in_cache[victim] = 0;
+        n_obj_cached -= 1;
+      }
+    }
+
+    QUEUE_PREPEND(obj);
+    in_cache[obj] = 1;
+    last_req[obj] = t;
+    n_obj_cached += 1;
+  }
+
+#undef QUEUE_REMOVE
+#undef QUEUE_PREPEND
+
+  free(prev);
+  free(next);
+  free(last_req);
+  free(in_cache);
+}
+
+promotion_oracle_result_t *get_optimal_promotion(reader_t *reader,
+                                                 const int64_t *cache_sizes,
+                                                 int n_size,
+                                                 bool save_decision) {
+  oracle_trace_t trace;
+  _load_trace(reader, &trace);
+  if (trace.n_req == 0) {
+    ERROR("the trace is empty\n");
+  }
+
+  promotion_oracle_result_t *results =
+      calloc(n_size, sizeof(promotion_oracle_result_t));
+  uint8_t *accepted = malloc(sizeof(uint8_t) * trace.n_req);
+
+  for (int i = 0; i < n_size; i++) {
+    promotion_oracle_result_t *result = &results[i];
+    result->cache_size = cache_sizes[i];
+    result->n_req = trace.n_req;
+    if (save_decision) {
+      result->promotion = calloc(trace.n_req, sizeof(uint32_t));
+    }
+    if (cache_sizes[i] <= 0) {
+      ERROR("cache size %ld is not a positive number of objects\n",
+            (long)cache_sizes[i]);
+    }
+
+    result->n_target_hit =
+        _find_target_hits(&trace, cache_sizes[i], accepted);
+    _run_fifo_reinsertion(&trace, accepted, result);
+    DEBUG_ASSERT(trace.n_req - result->n_miss >= result->n_target_hit);
+  }
+
+  free(accepted);
+  free(trace.obj_idx);
+  return results;
+}
+
+void free_promotion_oracle_result(promotion_oracle_result_t *results,
+                                  int n_size) {
+  for (int i = 0; i < n_size; i++) {
+    free(results[i].promotion);
+  }
+  free(results);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -34,67 +34,42 @@ typedef struct simulator_multithreading_params {
   bool free_cache_when_finish;
 } sim_mt_params_t;
 
-static void _simulate(gpointer data, gpointer user_data) {
-  sim_mt_params_t *params = (sim_mt_params_t *)user_data;
-  int idx = GPOINTER_TO_UINT(data) - 1;
-  set_rand_seed(0);
-
+/**
+ * @brief warm up one cache using all requests from the warmup reader
+ */
+static void _warmup_with_reader(sim_mt_params_t *params, int idx,
+                                request_t *req) {
   cache_stat_t *result = params->result;
-  reader_t *cloned_reader = clone_reader(params->reader);
-  request_t *req = new_request();
   cache_t *local_cache = params->caches[idx];
-  strncpy(result[idx].cache_name, local_cache->cache_name,
-          CACHE_NAME_ARRAY_LEN);
 
-  /* warm up using warmup_reader */
-  if (params->warmup_reader) {
-    reader_t *warmup_cloned_reader = clone_reader(params->warmup_reader);
+  reader_t *warmup_cloned_reader = clone_reader(params->warmup_reader);
+  read_one_req(warmup_cloned_reader, req);
+  while (req->valid) {
+    local_cache->get(local_cache, req);
+    result[idx].n_warmup_req += 1;
     read_one_req(warmup_cloned_reader, req);
-    while (req->valid) {
-      local_cache->get(local_cache, req);
-      result[idx].n_warmup_req += 1;
-      read_one_req(warmup_cloned_reader, req);
-    }
-    close_reader(warmup_cloned_reader);
-    INFO("cache %s (size %" PRIu64
-         ") finishes warm up using warmup reader "
-         "with %" PRIu64 " requests\n",
-         local_cache->cache_name, local_cache->cache_size,
-         result[idx].n_warmup_req);
   }
+  close_reader(warmup_cloned_reader);
+  INFO("cache %s (size %" PRIu64
+       ") finishes warm up using warmup reader "
+       "with %" PRIu64 " requests\n",
+       local_cache->cache_name, local_cache->cache_size,
+       result[idx].n_warmup_req);
+}
 
-  read_one_req(cloned_reader, req);
-  int64_t start_ts = (int64_t)req->clock_time;
-
-  /* using warmup_frac or warmup_sec of requests from reader to warm up */
-  if (params->n_warmup_req > 0 || params->warmup_sec > 0) {
-    uint64_t n_warmup = 0;
-    while (req->valid && (n_warmup < params->n_warmup_req ||
-                          req->clock_time - start_ts < params->warmup_sec)) {
-      req->clock_time -= start_ts;
-      local_cache->get(local_cache, req);
-      n_warmup += 1;
-      read_one_req(cloned_reader, req);
-    }
-    result[idx].n_warmup_req += n_warmup;
-    INFO("cache %s (size %" PRIu64
-         ") finishes warm up using "
-         "with %" PRIu64 " requests, %.2lf hour trace time\n",
-         local_cache->cache_name, local_cache->cache_size, n_warmup,
-         (double)(req->clock_time - start_ts) / 3600.0);
-  }
+/**
+ * @brief evict all objects, collect the result of one cache and report
+ * progress, req is the last request of the trace, warmup_stat holds the
+ * counters at the end of warmup
+ */
+static void _finish_simulation(sim_mt_params_t *params, int idx,
+                               request_t *req,
+                               const cache_stat_t *warmup_stat) {
+  cache_stat_t *result = params->result;
+  cache_t *local_cache = params->caches[idx];
 
-  while (req->valid) {
-    result[idx].n_req++;
-    result[idx].n_req_byte += req->obj_size;
-
-    req->clock_time -= start_ts;
-    if (local_cache->get(local_cache, req) == false) {
-      result[idx].n_miss++;
-      result[idx].n_miss_byte += req->obj_size;
-    }
-    read_one_req(cloned_reader, req);
-  }
+  /* before the final evictions, which can reinsert objects */
+  get_cache_op_stat(local_cache, warmup_stat, &result[idx]);
 
   // in this section, evict all objects in the cache
   for (int i = 0; i < local_cache->n_obj; i++) {
@@ -135,7 +110,6 @@ static void _simulate(gpointer data, gpointer user_data) {
   result[idx].type4 = local_cache->type4;
   result[idx].type5 = local_cache->type5;
   
-  result[idx].n_promotion = local_cache->n_promotion;
 
   result[idx].mean_stay_time = ((double)local_cache->sum_demotion_time) / ((double)local_cache->num_demotion_obj);
   // printf("mean stay time: %lf\n", result[idx].mean_stay_time);
@@ -150,10 +124,333 @@ static void _simulate(gpointer data, gpointer user_data) {
   if (params->free_cache_when_finish) {
     local_cache->cache_free(local_cache);
   }
+}
+
+/* caches that serve requests in batches (get_batch), e.g., lpFIFO_shards
+ * running its shards on separate threads, are given this many requests
+ * at a time after warmup */
+#define SIM_BATCH_SIZE 16384
+
+/**
+ * @brief simulate the rest of the trace with get_batch,
+ * req holds the next request to simulate and is invalid on return
+ */
+static void _simulate_in_batches(sim_mt_params_t *params, int idx,
+                                 reader_t *reader, request_t *req,
+                                 int64_t start_ts) {
+  cache_stat_t *result = params->result;
+  cache_t *local_cache = params->caches[idx];
+  request_t *reqs = my_malloc_n(request_t, SIM_BATCH_SIZE);
+  memset(reqs, 0, sizeof(request_t) * SIM_BATCH_SIZE);
+  bool *hits = my_malloc_n(bool, SIM_BATCH_SIZE);
+
+  while (req->valid) {
+    int n_req = 0;
+    while (req->valid && n_req < SIM_BATCH_SIZE) {
+      req->clock_time -= start_ts;
+      copy_request(&reqs[n_req++], req);
+      read_one_req(reader, req);
+    }
+
+    local_cache->get_batch(local_cache, reqs, n_req, hits);
+
+    for (int i = 0; i < n_req; i++) {
+      result[idx].n_req++;
+      result[idx].n_req_byte += reqs[i].obj_size;
+      if (!hits[i]) {
+        result[idx].n_miss++;
+        result[idx].n_miss_byte += reqs[i].obj_size;
+      }
+    }
+  }
+
+  my_free(sizeof(request_t) * SIM_BATCH_SIZE, reqs);
+  my_free(sizeof(bool) * SIM_BATCH_SIZE, hits);
+}
+
+static void _simulate(gpointer data, gpointer user_data) {
+  sim_mt_params_t *params = (sim_mt_params_t *)user_data;
+  int idx = GPOINTER_TO_UINT(data) - 1;
+  set_rand_seed(0);
+
+  cache_stat_t *result = params->result;
+  reader_t *cloned_reader = clone_reader(params->reader);
+  request_t *req = new_request();
+  cache_t *local_cache = params->caches[idx];
+  strncpy(result[idx].cache_name, local_cache->cache_name,
+          CACHE_NAME_ARRAY_LEN);
+
+  /* warm up using warmup_reader */
+  if (params->warmup_reader) {
+    _warmup_with_reader(params, idx, req);
+  }
+
+  read_one_req(cloned_reader, req);
+  int64_t start_ts = (int64_t)req->clock_time;
+
+  /* using warmup_frac or warmup_sec of requests from reader to warm up */
+  if (params->n_warmup_req > 0 || params->warmup_sec > 0) {
+    uint64_t n_warmup = 0;
+    while (req->valid && (n_warmup < params->n_warmup_req ||
+                          req->clock_time - start_ts < params->warmup_sec)) {
+      req->clock_time -= start_ts;
+      local_cache->get(local_cache, req);
+      n_warmup += 1;
+      read_one_req(cloned_reader, req);
+    }
+    result[idx].n_warmup_req += n_warmup;
+    INFO("cache %s (size %" PRIu64
+         ") finishes warm up using "
+         "with %" PRIu64 " requests, %.2lf hour trace time\n",
+         local_cache->cache_name, local_cache->cache_size, n_warmup,
+         (double)(req->clock_time - start_ts) / 3600.0);
+  }
+
+  /* the promotion and flash counters exclude the warmup */
+  cache_stat_t warmup_stat;
+  get_cache_op_stat(local_cache, NULL, &warmup_stat);
+
+  if (local_cache->get_batch != NULL) {
+    _simulate_in_batches(params, idx, cloned_reader, req, start_ts);
+  }
+
+  while (req->valid) {
+    result[idx].n_req++;
+    result[idx].n_req_byte += req->obj_size;
+
+    req->clock_time -= start_ts;
+    if (local_cache->get(local_cache, req) == false) {
+      result[idx].n_miss++;
+      result[idx].n_miss_byte += req->obj_size;
+    }
+    read_one_req(cloned_reader, req);
+  }
+
+  _finish_simulation(params, idx, req, &warmup_stat);
+
   free_request(req);
   close_reader(cloned_reader);
 }
 
+/* when the trace is read from a stream, which cannot be cloned, one thread
+ * reads the trace and broadcasts batches of requests to the workers, each
+ * worker simulates a subset of the caches */
+#define SIM_BROADCAST_BATCH_SIZE 4096
+#define SIM_BROADCAST_N_BATCH 8
+
+typedef struct {
+  sim_mt_params_t *params;
+  int n_caches;
+  int n_workers;
+
+  request_t *batches[SIM_BROADCAST_N_BATCH];
+  int batch_n_req[SIM_BROADCAST_N_BATCH];
+  /* the number of workers that have not finished the batch */
+  int batch_n_pending[SIM_BROADCAST_N_BATCH];
+  int64_t n_batch_produced;
+  bool finished;
+  GMutex mtx;
+  GCond cond;
+
+  /* per cache state */
+  int64_t *start_ts;
+  int64_t *last_ts;
+  uint64_t *n_warmup;
+  bool *warmup_done;
+  /* the counters at the end of warmup */
+  cache_stat_t *warmup_stat;
+} sim_broadcast_t;
+
+typedef struct {
+  sim_broadcast_t *bc;
+  int worker_id;
+} sim_broadcast_worker_t;
+
+static inline void _broadcast_simulate_one_req(sim_broadcast_t *bc, int idx,
+                                               request_t *req) {
+  sim_mt_params_t *params = bc->params;
+  cache_stat_t *result = params->result;
+  cache_t *local_cache = params->caches[idx];
+
+  if (bc->start_ts[idx] == -1) bc->start_ts[idx] = req->clock_time;
+  req->clock_time -= bc->start_ts[idx];
+  bc->last_ts[idx] = req->clock_time;
+
+  if (!bc->warmup_done[idx]) {
+    if (bc->n_warmup[idx] < params->n_warmup_req ||
+        req->clock_time < params->warmup_sec) {
+      local_cache->get(local_cache, req);
+      bc->n_warmup[idx] += 1;
+      return;
+    }
+    bc->warmup_done[idx] = true;
+    get_cache_op_stat(local_cache, NULL, &bc->warmup_stat[idx]);
+    result[idx].n_warmup_req += bc->n_warmup[idx];
+    if (params->n_warmup_req > 0 || params->warmup_sec > 0) {
+      INFO("cache %s (size %" PRIu64
+           ") finishes warm up using "
+           "with %" PRIu64 " requests, %.2lf hour trace time\n",
+           local_cache->cache_name, local_cache->cache_size,
+           bc->n_warmup[idx], (double)req->clock_time / 3600.0);
+    }
+  }
+
+  result[idx].n_req++;
+  result[idx].n_req_byte += req->obj_size;
+  if (local_cache->get(local_cache, req) == false) {
+    result[idx].n_miss++;
+    result[idx].n_miss_byte += req->obj_size;
+  }
+}
+
+static gpointer _broadcast_worker(gpointer data) {
+  sim_broadcast_worker_t *worker = (sim_broadcast_worker_t *)data;
+  sim_broadcast_t *bc = worker->bc;
+  sim_mt_params_t *params = bc->params;
+  request_t *req = new_request();
+  set_rand_seed(0);
+
+  for (int idx = worker->worker_id; idx < bc->n_caches; idx += bc->n_workers) {
+    strncpy(params->result[idx].cache_name, params->caches[idx]->cache_name,
+            CACHE_NAME_ARRAY_LEN);
+    if (params->warmup_reader) {
+      _warmup_with_reader(params, idx, req);
+    }
+  }
+
+  for (int64_t seq = 0;; seq++) {
+    int slot = seq % SIM_BROADCAST_N_BATCH;
+    g_mutex_lock(&bc->mtx);
+    while (bc->n_batch_produced <= seq && !bc->finished) {
+      g_cond_wait(&bc->cond, &bc->mtx);
+    }
+    bool has_batch = bc->n_batch_produced > seq;
+    g_mutex_unlock(&bc->mtx);
+    if (!has_batch) break;
+
+    /* run each cache over the whole batch to keep its data in CPU cache */
+    request_t *batch = bc->batches[slot];
+    for (int idx = worker->worker_id; idx < bc->n_caches;
+         idx += bc->n_workers) {
+      for (int i = 0; i < bc->batch_n_req[slot]; i++) {
+        copy_request(req, &batch[i]);
+        _broadcast_simulate_one_req(bc, idx, req);
+      }
+    }
+
+    g_mutex_lock(&bc->mtx);
+    if (--bc->batch_n_pending[slot] == 0) {
+      g_cond_broadcast(&bc->cond);
+    }
+    g_mutex_unlock(&bc->mtx);
+  }
+
+  for (int idx = worker->worker_id; idx < bc->n_caches; idx += bc->n_workers) {
+    req->clock_time = bc->last_ts[idx];
+    if (!bc->warmup_done[idx]) {
+      /* the trace ends in warmup */
+      get_cache_op_stat(params->caches[idx], NULL, &bc->warmup_stat[idx]);
+    }
+    _finish_simulation(params, idx, req, &bc->warmup_stat[idx]);
+  }
+
+  free_request(req);
+  return NULL;
+}
+
+/**
+ * @brief simulate the caches with one pass over the trace, the calling thread
+ * reads the trace and the workers run the caches, this is used when the trace
+ * cannot be cloned, e.g., it is read from a pipe
+ */
+static void _simulate_broadcast(sim_mt_params_t *params, int num_of_caches,
+                                int num_of_threads) {
+  sim_broadcast_t *bc = my_malloc(sim_broadcast_t);
+  memset(bc, 0, sizeof(sim_broadcast_t));
+  bc->params = params;
+  bc->n_caches = num_of_caches;
+  bc->n_workers =
+      num_of_threads < num_of_caches ? num_of_threads : num_of_caches;
+  if (bc->n_workers < 1) bc->n_workers = 1;
+  g_mutex_init(&bc->mtx);
+  g_cond_init(&bc->cond);
+  for (int i = 0; i < SIM_BROADCAST_N_BATCH; i++) {
+    bc->batches[i] = my_malloc_n(request_t, SIM_BROADCAST_BATCH_SIZE);
+    memset(bc->batches[i], 0, sizeof(request_t) * SIM_BROADCAST_BATCH_SIZE);
+  }
+  bc->start_ts = my_malloc_n(int64_t, num_of_caches);
+  bc->last_ts = my_malloc_n(int64_t, num_of_caches);
+  bc->n_warmup = my_malloc_n(uint64_t, num_of_caches);
+  bc->warmup_done = my_malloc_n(bool, num_of_caches);
+  bc->warmup_stat = my_malloc_n(cache_stat_t, num_of_caches);
+  for (int i = 0; i < num_of_caches; i++) {
+    bc->start_ts[i] = -1;
+    bc->last_ts[i] = 0;
+    bc->n_warmup[i] = 0;
+    bc->warmup_done[i] = false;
+  }
+
+  INFO("%s reads the trace once and broadcasts it to %d caches, %d threads\n",
+       __func__, num_of_caches, bc->n_workers);
+
+  GThread **threads = my_malloc_n(GThread *, bc->n_workers);
+  sim_broadcast_worker_t *workers =
+      my_malloc_n(sim_broadcast_worker_t, bc->n_workers);
+  for (int i = 0; i < bc->n_workers; i++) {
+    workers[i].bc = bc;
+    workers[i].worker_id = i;
+    threads[i] = g_thread_new("simulator", _broadcast_worker, &workers[i]);
+  }
+
+  for (int64_t seq = 0;; seq++) {
+    int slot = seq % SIM_BROADCAST_N_BATCH;
+    g_mutex_lock(&bc->mtx);
+    while (bc->batch_n_pending[slot] > 0) {
+      g_cond_wait(&bc->cond, &bc->mtx);
+    }
+    g_mutex_unlock(&bc->mtx);
+
+    int n_req = 0;
+    while (n_req < SIM_BROADCAST_BATCH_SIZE &&
+           read_one_req(params->reader, &bc->batches[slot][n_req]) == 0) {
+      n_req++;
+    }
+    if (n_req == 0) break;
+
+    g_mutex_lock(&bc->mtx);
+    bc->batch_n_req[slot] = n_req;
+    bc->batch_n_pending[slot] = bc->n_workers;
+    bc->n_batch_produced++;
+    g_cond_broadcast(&bc->cond);
+    g_mutex_unlock(&bc->mtx);
+
+    if (n_req < SIM_BROADCAST_BATCH_SIZE) break;
+  }
+
+  g_mutex_lock(&bc->mtx);
+  bc->finished = true;
+  g_cond_broadcast(&bc->cond);
+  g_mutex_unlock(&bc->mtx);
+
+  for (int i = 0; i < bc->n_workers; i++) {
+    g_thread_join(threads[i]);
+  }
+
+  for (int i = 0; i < SIM_BROADCAST_N_BATCH; i++) {
+    my_free(sizeof(request_t) * SIM_BROADCAST_BATCH_SIZE, bc->batches[i]);
+  }
+  my_free(sizeof(int64_t) * num_of_caches, bc->start_ts);
+  my_free(sizeof(int64_t) * num_of_caches, bc->last_ts);
+  my_free(sizeof(uint64_t) * num_of_caches, bc->n_warmup);
+  my_free(sizeof(bool) * num_of_caches, bc->warmup_done);
+  my_free(sizeof(cache_stat_t) * num_of_caches, bc->warmup_stat);
+  my_free(sizeof(GThread *) * bc->n_workers, threads);
+  my_free(sizeof(sim_broadcast_worker_t) * bc->n_workers, workers);
+  g_mutex_clear(&bc->mtx);
+  g_cond_clear(&bc->cond);
+  my_free(sizeof(sim_broadcast_t), bc);
+}
+
 cache_stat_t *simulate_at_multi_sizes_with_step_size(
     reader_t *const reader, const cache_t *cache, uint64_t step_size,
     reader_t *warmup_reader, double warmup_frac, int warmup_sec,
@@ -211,6 +508,19 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader, const cache_t *cache,
   params->progress = &progress;
   g_mutex_init(&(params->mtx));
 
+  if (reader->is_stream) {
+    params->caches = my_malloc_n(cache_t *, num_of_sizes);
+    for (int i = 0; i < num_of_sizes; i++) {
+      params->caches[i] = create_cache_with_new_size(cache, cache_sizes[i]);
+      result[i].cache_size = cache_sizes[i];
+    }
+    _simulate_broadcast(params, num_of_sizes, num_of_threads);
+    g_mutex_clear(&(params->mtx));
+    my_free(sizeof(cache_t *) * num_of_sizes, params->caches);
+    my_free(sizeof(sim_mt_params_t), params);
+    return result;
+  }
+
   // build the thread pool
   GThreadPool *gthread_pool = g_thread_pool_new(
       (GFunc)_simulate, (gpointer)params, num_of_threads, TRUE, NULL);
@@ -293,6 +603,16 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[],
   params->progress = &progress;
   g_mutex_init(&(params->mtx));
 
+  if (reader->is_stream) {
+    for (i = 0; i < num_of_caches; i++) {
+      result[i].cache_size = caches[i]->cache_size;
+    }
+    _simulate_broadcast(params, num_of_caches, num_of_threads);
+    g_mutex_clear(&(params->mtx));
+    my_free(sizeof(sim_mt_params_t), params);
+    return result;
+  }
+
   // build the thread pool
   GThreadPool *gthread_pool = g_thread_pool_new(
       (GFunc)_simulate, (gpointer)params, num_of_threads, TRUE, NULL);
@@ -12,19 +12,99 @@
 
 #include "accessPattern.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <numeric>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 using namespace std;
 
 namespace traceAnalyzer {
 
+ChunkArena::~ChunkArena() {
+  if (fd_ >= 0) {
+    if (data_ != nullptr) munmap(data_, cap_);
+    /* drop the unused tail of the file */
+    if (ftruncate(fd_, (off_t)size_) != 0) {
+      WARN("cannot truncate access stream file: %s\n", strerror(errno));
+    }
+    close(fd_);
+  } else {
+    free(data_);
+  }
+}
+
+void ChunkArena::use_file(const string &path) {
+  assert(cap_ == 0);
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    ERROR("cannot open access stream file %s: %s\n", path.c_str(),
+          strerror(errno));
+  }
+}
+
+void ChunkArena::grow(size_t min_cap) {
+  size_t new_cap = max(max(cap_ * 2, (size_t)1 << 20), min_cap);
+  if (fd_ >= 0) {
+    /* the mapping is shared, so the pages are written back to the file */
+    if (data_ != nullptr) munmap(data_, cap_);
+    if (ftruncate(fd_, (off_t)new_cap) != 0) {
+      ERROR("cannot grow access stream file: %s\n", strerror(errno));
+    }
+    void *p = mmap(nullptr, new_cap, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+      ERROR("cannot map access stream file: %s\n", strerror(errno));
+    }
+    data_ = (uint8_t *)p;
+  } else {
+    data_ = (uint8_t *)realloc(data_, new_cap);
+    if (data_ == nullptr) {
+      ERROR("cannot allocate %zu bytes for access streams\n", new_cap);
+    }
+  }
+  cap_ = new_cap;
+}
+
+uint64_t ChunkArena::alloc(size_t n) {
+  if (size_ + n > cap_) grow(size_ + n);
+  uint64_t offset = size_;
+  /* the grown file is zero-filled, memory is not */
+  if (fd_ < 0) memset(data_ + offset, 0, n);
+  size_ += n;
+  return offset;
+}
+
+void AccessPattern::put_byte(stream_head &h, uint8_t b) {
+  if (h.tail_pos == chunk_size(h.tail_idx)) {
+    /* the tail chunk is full, link a new chunk */
+    uint64_t offset = arena_.alloc(chunk_size(h.tail_idx + 1));
+    uint32_t next = (uint32_t)(offset / 16);
+    memcpy(arena_.at((uint64_t)h.tail * 16), &next, sizeof(next));
+    h.tail = next;
+    h.tail_pos = sizeof(uint32_t);
+    if (h.tail_idx < UINT8_MAX) h.tail_idx += 1;
+  }
+  *arena_.at((uint64_t)h.tail * 16 + h.tail_pos) = b;
+  h.tail_pos += 1;
+}
+
+void AccessPattern::put_varint(stream_head &h, uint32_t v) {
+  while (v >= 0x80) {
+    put_byte(h, (uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  put_byte(h, (uint8_t)v);
+}
+
 void AccessPattern::add_req(const request_t *req) {
   if (n_seen_req_ > 0xfffffff0) {
     if (n_seen_req_ == 0xfffffff0) {
@@ -43,12 +123,107 @@ void AccessPattern::add_req(const request_t *req) {
     return;
   }
 
-  if (access_rtime_map_.find(req->obj_id) == access_rtime_map_.end()) {
-    access_rtime_map_[req->obj_id] = vector<uint32_t>();
-    access_vtime_map_[req->obj_id] = vector<uint32_t>();
+  uint32_t rtime = (uint32_t)(req->clock_time - start_rtime_);
+  uint32_t vtime = (uint32_t)n_seen_req_;
+
+  /* work on a copy of the head because the arena may move when it grows */
+  stream_head h;
+  uint32_t head;
+  auto it = stream_head_.find(req->obj_id);
+  if (it == stream_head_.end()) {
+    head = (uint32_t)(arena_.alloc(chunk_size(0)) / 16);
+    stream_head_.emplace(req->obj_id, head);
+    h.last_rtime = 0;
+    h.last_vtime = 0;
+    h.n_access = 0;
+    h.tail = head;
+    h.tail_pos = head_payload_pos;
+    h.tail_idx = 0;
+    n_obj_ += 1;
+  } else {
+    head = it->second;
+    memcpy(&h, arena_.at((uint64_t)head * 16 + sizeof(uint32_t)), sizeof(h));
+  }
+
+  /* the first delta is from 0 */
+  put_varint(h, rtime - h.last_rtime);
+  put_varint(h, vtime - h.last_vtime);
+  h.last_rtime = rtime;
+  h.last_vtime = vtime;
+  h.n_access += 1;
+  memcpy(arena_.at((uint64_t)head * 16 + sizeof(uint32_t)), &h, sizeof(h));
+}
+
+void AccessPattern::decode(uint32_t head, vector<uint32_t> &rtime,
+                           vector<uint32_t> &vtime) const {
+  rtime.clear();
+  vtime.clear();
+
+  stream_head h;
+  memcpy(&h, arena_.at((uint64_t)head * 16 + sizeof(uint32_t)), sizeof(h));
+
+  uint32_t chunk = head;
+  int chunk_idx = 0;
+  size_t pos = head_payload_pos;
+  auto get_byte = [&]() -> uint8_t {
+    if (pos == chunk_size(chunk_idx)) {
+      memcpy(&chunk, arena_.at((uint64_t)chunk * 16), sizeof(chunk));
+      chunk_idx += 1;
+      pos = sizeof(uint32_t);
+    }
+    return *arena_.at((uint64_t)chunk * 16 + pos++);
+  };
+  auto get_varint = [&]() -> uint32_t {
+    uint32_t v = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t b = get_byte();
+      v |= (uint32_t)(b & 0x7f) << shift;
+      if (b < 0x80) return v;
+    }
+  };
+
+  uint32_t r = 0, v = 0;
+  for (uint32_t i = 0; i < h.n_access; i++) {
+    r += get_varint();
+    v += get_varint();
+    rtime.push_back(r);
+    vtime.push_back(v);
+  }
+}
+
+void AccessPattern::save(ostream &os) const {
+  ckpt_write(os, n_obj_);
+  ckpt_write(os, n_seen_req_);
+  ckpt_write(os, start_rtime_);
+  ckpt_write(os, (uint64_t)arena_.size());
+  os.write((const char *)arena_.at(0), (std::streamsize)arena_.size());
+  ckpt_write(os, (uint64_t)stream_head_.size());
+  for (const auto &p : stream_head_) {
+    ckpt_write(os, p.first);
+    ckpt_write(os, p.second);
+  }
+}
+
+void AccessPattern::load(istream &is) {
+  assert(arena_.size() == 0);
+  ckpt_read(is, n_obj_);
+  ckpt_read(is, n_seen_req_);
+  ckpt_read(is, start_rtime_);
+  uint64_t arena_size, n_stream;
+  ckpt_read(is, arena_size);
+  if (arena_size > 0) {
+    arena_.alloc(arena_size);
+    is.read((char *)arena_.at(0), (std::streamsize)arena_size);
+  }
+  ckpt_read(is, n_stream);
+  stream_head_.reserve(n_stream);
+  for (uint64_t i = 0; i < n_stream; i++) {
+    obj_id_t obj_id;
+    uint32_t head;
+    ckpt_read(is, obj_id);
+    ckpt_read(is, head);
+    stream_head_.emplace(obj_id, head);
   }
-  access_rtime_map_[req->obj_id].push_back(req->clock_time - start_rtime_);
-  access_vtime_map_[req->obj_id].push_back(n_seen_req_);
 }
 
 void AccessPattern::dump(string &path_base) {
@@ -58,48 +233,50 @@ void AccessPattern::dump(string &path_base) {
   ofs << "# access pattern real time, each line stores all the real time of "
          "requests to an object\n";
 
-  // sort the timestamp list by the first timestamp
-  vector<vector<uint32_t> *> sorted_rtime_vec;
-  for (auto &p : access_rtime_map_) {
-    sorted_rtime_vec.push_back(&p.second);
-  }
-  sort(sorted_rtime_vec.begin(), sorted_rtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) {
-         return (*p1).at(0) < (*p2).at(0);
-       });
-
-  for (const auto *p : sorted_rtime_vec) {
-    for (const uint32_t rtime : *p) {
-      ofs << rtime << ",";
-    }
-    ofs << "\n";
-  }
-  ofs << "\n" << endl;
-  ofs.close();
-
-  ofs << "# " << path_base << "\n";
   string ofile_path2 = path_base + ".accessVtime";
   ofstream ofs2(ofile_path2, ios::out | ios::trunc);
+  ofs2 << "# " << path_base << "\n";
   ofs2 << "# access pattern virtual time, each line stores all the virtual "
           "time of requests to an object\n";
-  vector<vector<uint32_t> *> sorted_vtime_vec;
-  for (auto &p : access_vtime_map_) {
-    sorted_vtime_vec.push_back(&(p.second));
-  }
 
-  sort(sorted_vtime_vec.begin(), sorted_vtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) -> bool {
-         return (*p1).at(0) < (*p2).at(0);
-       });
+  // sort the streams by the first access, which is the order of the heads
+  vector<pair<uint32_t, obj_id_t>> sorted_heads;
+  sorted_heads.reserve(stream_head_.size());
+  for (const auto &p : stream_head_) {
+    sorted_heads.emplace_back(p.second, p.first);
+  }
+  sort(sorted_heads.begin(), sorted_heads.end());
 
-  for (const vector<uint32_t> *p : sorted_vtime_vec) {
-    for (const uint32_t vtime : *p) {
+  vector<uint32_t> rtime_vec, vtime_vec;
+  for (const auto &p : sorted_heads) {
+    decode(p.first, rtime_vec, vtime_vec);
+    for (const uint32_t rtime : rtime_vec) {
+      ofs << rtime << ",";
+    }
+    ofs << "\n";
+    for (const uint32_t vtime : vtime_vec) {
       ofs2 << vtime << ",";
     }
     ofs2 << "\n";
   }
-
+  ofs << "\n" << endl;
+  ofs.close();
   ofs2.close();
+
+  if (!stream_path_.empty()) {
+    ofstream ofs_idx(stream_path_ + ".accessStreamIdx",
+                     ios::out | ios::trunc | ios::binary);
+    for (const auto &p : sorted_heads) {
+      uint64_t obj_id = p.second;
+      stream_head h;
+      memcpy(&h, arena_.at((uint64_t)p.first * 16 + sizeof(uint32_t)),
+             sizeof(h));
+      ofs_idx.write((const char *)&obj_id, sizeof(obj_id));
+      ofs_idx.write((const char *)&p.first, sizeof(p.first));
+      ofs_idx.write((const char *)&h.n_access, sizeof(h.n_access));
+    }
+    ofs_idx.close();
+  }
 }
 
 };  // namespace traceAnalyzer
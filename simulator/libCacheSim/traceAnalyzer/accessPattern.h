@@ -10,25 +10,73 @@
  * a bias when we plot the access pattern
  * so we use a static sample ratio
  *
+ * the accesses of a sampled object are stored as a stream of
+ * (delta rtime, delta vtime) varint pairs in a linked list of chunks, the
+ * chunks of all objects are allocated from one append-only arena, so
+ * recording an access does not allocate unless the arena grows
+ *
+ * chunk layout: a chunk starts with the uint32 offset of the next chunk in
+ * 16-byte units (0 if it is the last chunk), followed by the payload, a
+ * varint may span two chunks, the first chunk of an object is 32 bytes and
+ * also holds the stream_head, each following chunk doubles up to 128 bytes
+ *
+ * the arena can be backed by a file (path_base.accessStream) which the
+ * kernel writes back incrementally, the index (path_base.accessStreamIdx)
+ * is written at the end and stores one (uint64 obj_id, uint32 head chunk
+ * offset in 16-byte units, uint32 number of accesses) per object in the
+ * order of the first access, so that the plotting step can mmap both
+ *
  */
 
+#include <string>
+#include <vector>
 
+#include "../dataStructure/robin_hood.h"
 #include "../include/libCacheSim/logging.h"
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 #include "struct.h"
 
 using namespace std;
 
 namespace traceAnalyzer {
+
+/* an append-only byte arena in memory or in a shared file mapping */
+class ChunkArena {
+ public:
+  ChunkArena() = default;
+  ~ChunkArena();
+
+  /* back the arena by the file, must be called before the first alloc */
+  void use_file(const string &path);
+
+  /* allocate n zeroed bytes, n is a multiple of 16, returns the offset,
+   * the data may move */
+  uint64_t alloc(size_t n);
+
+  inline uint8_t *at(uint64_t offset) const { return data_ + offset; }
+
+  size_t size() const { return size_; }
+
+ private:
+  uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t cap_ = 0;
+  int fd_ = -1;
+
+  void grow(size_t min_cap);
+};
+
 class AccessPattern {
  public:
   /**
    *
-   * @param n_req the total number of requests in the trace
-   * @param n_obj the number of objects we would like to sample
+   * @param sample_ratio sample 1/sample_ratio objects
+   * @param stream_path if not empty, back the access streams by this file
    */
-  explicit AccessPattern(int sample_ratio = 1001)
-      : sample_ratio_(sample_ratio) {
+  explicit AccessPattern(int sample_ratio = 1001,
+                         const string &stream_path = "")
+      : sample_ratio_(sample_ratio), stream_path_(stream_path) {
 
     if (sample_ratio_ < 1) {
       ERROR(
@@ -37,6 +85,8 @@ class AccessPattern {
           sample_ratio_);
       sample_ratio_ = 1;
     }
+
+    if (!stream_path_.empty()) arena_.use_file(stream_path_ + ".accessStream");
   };
 
   ~AccessPattern() = default;
@@ -49,13 +99,50 @@ class AccessPattern {
 
   void dump(string &path_base);
 
+  /* only an arena in memory can be checkpointed */
+  void save(ostream &os) const;
+
+  void load(istream &is);
+
  private:
+  /* the state of a stream, stored in its first chunk */
+  struct stream_head {
+    uint32_t last_rtime;
+    uint32_t last_vtime;
+    uint32_t n_access;
+    /* the last chunk in 16-byte units */
+    uint32_t tail;
+    /* the next byte to write in the tail chunk */
+    uint8_t tail_pos;
+    /* the index of the tail chunk in the list, decides its size */
+    uint8_t tail_idx;
+  } __attribute__((packed));
+
   int64_t n_obj_ = 0;
   int64_t n_seen_req_ = 0;
   int sample_ratio_ = 1001;
+  string stream_path_;
 
   int64_t start_rtime_ = -1;
-  unordered_map<obj_id_t, vector<uint32_t>> access_rtime_map_;
-  unordered_map<obj_id_t, vector<uint32_t>> access_vtime_map_;
+
+  ChunkArena arena_;
+  /* object -> the first chunk of its stream in 16-byte units, the first
+   * chunks are allocated in the order of the first access */
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> stream_head_;
+
+  static inline size_t chunk_size(int idx) {
+    return (size_t)32 << (idx < 2 ? idx : 2);
+  }
+
+  /* the payload of the first chunk starts after the next offset and head */
+  static constexpr size_t head_payload_pos =
+      sizeof(uint32_t) + sizeof(stream_head);
+
+  void put_byte(stream_head &h, uint8_t b);
+  void put_varint(stream_head &h, uint32_t v);
+
+  /* decode the stream into the absolute rtime and vtime of the accesses */
+  void decode(uint32_t head, vector<uint32_t> &rtime,
+              vector<uint32_t> &vtime) const;
 };
 }  // namespace traceAnalyzer
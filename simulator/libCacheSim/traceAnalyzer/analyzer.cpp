@@ -3,13 +3,37 @@
 //
 
 #include <algorithm>  // std::make_heap, std::pop_heap, std::push_heap, std::sort_heap
+#include <thread>
 #include <vector>  // std::vector
 
 #include "analyzer.h"
 #include "utils/include/utils.h"
 
 void traceAnalyzer::TraceAnalyzer::initialize() {
-  obj_map_.reserve(DEFAULT_PREALLOC_N_OBJ);
+  /* the experimental modules, the sketches, the file-backed access streams
+   * and the simulated caches are not checkpointed */
+  bool resume = !resume_path_.empty();
+  if (resume || !checkpoint_path_.empty()) {
+    if (option_.lifetime || option_.prob_at_age ||
+        option_.create_future_reuse_ccdf || option_.size_change ||
+        option_.scan_detector || sketch_ || access_pattern_stream_ ||
+        !caches_.empty()) {
+      ERROR(
+          "checkpoint only supports the ttl, reqRate, size, reuse, "
+          "accessPattern, popularity, popularityDecay and footprint "
+          "analysis\n");
+    }
+  }
+
+  partitions_ = std::vector<obj_partition_t>(n_partition_);
+  double prealloc_n_obj = DEFAULT_PREALLOC_N_OBJ;
+  if (sketch_) {
+    prealloc_n_obj = std::min(prealloc_n_obj, (double)sketch_n_obj_);
+  }
+  for (auto &partition : partitions_) {
+    partition.obj_map.reserve(prealloc_n_obj / n_partition_);
+    if (sketch_) partition.sketch = new SketchStat(time_window_);
+  }
 
   op_stat_ = new OpStat();
 
@@ -22,20 +46,29 @@ void traceAnalyzer::TraceAnalyzer::initialize() {
   }
 
   if (option_.access_pattern) {
-    access_stat_ = new AccessPattern(access_pattern_sample_ratio_inv_);
+    access_stat_ = new AccessPattern(access_pattern_sample_ratio_inv_,
+                                     access_pattern_stream_ ? output_path_ : "");
   }
 
   if (option_.size) {
-    size_stat_ = new SizeDistribution(output_path_, time_window_);
+    size_stat_ = new SizeDistribution(output_path_, time_window_, resume);
   }
 
   if (option_.reuse) {
-    reuse_stat_ = new ReuseDistribution(output_path_, time_window_);
+    reuse_stat_ = new ReuseDistribution(output_path_, time_window_, resume);
   }
 
   if (option_.popularity_decay) {
     popularity_decay_stat_ =
-        new PopularityDecay(output_path_, time_window_, warmup_time_);
+        new PopularityDecay(output_path_, time_window_, warmup_time_, resume);
+  }
+
+  if (option_.footprint) {
+    if (sketch_) {
+      WARN("footprint is not supported in sketch mode\n");
+    } else {
+      footprint_ = new Footprint();
+    }
   }
 
   if (option_.create_future_reuse_ccdf) {
@@ -54,7 +87,19 @@ void traceAnalyzer::TraceAnalyzer::initialize() {
     size_change_distribution_ = new SizeChangeDistribution();
   }
 
-  // scan_detector_ = new ScanDetector(reader_, output_path, 100);
+  if (option_.scan_detector) {
+    scan_detector_ = new ScanDetector(output_path_, 100);
+  }
+
+  if (sketch_ && !caches_.empty()) {
+    ERROR(
+        "the simulated caches need every request and cannot run in sketch "
+        "mode\n");
+  }
+  for (cache_t *cache : caches_) {
+    cache_sims_.push_back(new CacheSim(cache, time_window_, sim_cache_warmup_time_));
+  }
+  caches_.clear();
 }
 
 void traceAnalyzer::TraceAnalyzer::cleanup() {
@@ -66,6 +111,7 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   delete access_stat_;
   delete popularity_stat_;
   delete popularity_decay_stat_;
+  delete footprint_;
 
   delete prob_at_age_;
   delete lifetime_stat_;
@@ -77,6 +123,14 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
 
   delete scan_detector_;
 
+  for (auto sim : cache_sims_) {
+    delete sim;
+  }
+
+  for (auto &partition : partitions_) {
+    delete partition.sketch;
+  }
+
   if (n_hit_cnt_ != nullptr) {
     delete[] n_hit_cnt_;
   }
@@ -85,139 +139,269 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   }
 }
 
-void traceAnalyzer::TraceAnalyzer::run() {
-  if (has_run_) return;
-
-  request_t *req = new_request();
-  read_one_req(reader_, req);
-  start_ts_ = req->clock_time;
-  int32_t curr_time_window_idx = 0;
-  int next_time_window_ts = time_window_;
-
-  int64_t n = 0;
-  /* going through the trace */
-  do {
-    DEBUG_ASSERT(req->obj_size != 0);
-
-    // change real time to relative time
-    req->clock_time -= start_ts_;
+/**
+ * @brief the consumers of enriched requests, one per enabled module
+ */
+std::vector<traceAnalyzer::batch_consumer_t>
+traceAnalyzer::TraceAnalyzer::module_consumers() {
+  std::vector<batch_consumer_t> consumers;
+  consumers.push_back(module_consumer(op_stat_));
+  if (ttl_stat_ != nullptr) consumers.push_back(module_consumer(ttl_stat_));
+  /* in sketch mode, the request rate is filled from the sketches of all
+   * requests */
+  if (req_rate_stat_ != nullptr && !sketch_)
+    consumers.push_back(module_consumer(req_rate_stat_));
+  if (size_stat_ != nullptr) consumers.push_back(module_consumer(size_stat_));
+  if (reuse_stat_ != nullptr) consumers.push_back(module_consumer(reuse_stat_));
+  if (access_stat_ != nullptr)
+    consumers.push_back(module_consumer(access_stat_));
+  if (popularity_decay_stat_ != nullptr)
+    consumers.push_back(module_consumer(popularity_decay_stat_));
+  if (footprint_ != nullptr) consumers.push_back(module_consumer(footprint_));
+  if (prob_at_age_ != nullptr)
+    consumers.push_back(module_consumer(prob_at_age_));
+  if (lifetime_stat_ != nullptr)
+    consumers.push_back(module_consumer(lifetime_stat_));
+  if (create_future_reuse_ != nullptr)
+    consumers.push_back(module_consumer(create_future_reuse_));
+  if (size_change_distribution_ != nullptr)
+    consumers.push_back(module_consumer(size_change_distribution_));
+  if (scan_detector_ != nullptr)
+    consumers.push_back(module_consumer(scan_detector_));
+  /* one consumer per cache so that the caches are simulated in parallel */
+  for (auto sim : cache_sims_) {
+    consumers.push_back(
+        [sim](request_t *reqs, int n) { sim->add_batch(reqs, n); });
+  }
 
-    while (req->clock_time >= next_time_window_ts) {
-      curr_time_window_idx += 1;
-      next_time_window_ts += time_window_;
-    }
+  return consumers;
+}
 
-    if (curr_time_window_idx != time_to_window_idx(req->clock_time)) {
-      ERROR(
-          "The data is not ordered by time, please sort the trace first!"
-          "Current time %ld requested object %lu, obj size %lu\n",
-          (long)(req->clock_time + start_ts_), (unsigned long)req->obj_id,
-          (long)req->obj_size);
+/**
+ * @brief fill in the fields of the request used in trace analysis from the
+ * per-object state, and update the state, the object must belong to the
+ * partition
+ *
+ * @param vtime the index of the request in the trace, starting from 1
+ */
+void traceAnalyzer::TraceAnalyzer::enrich_req(obj_partition_t &partition,
+                                              request_t *req, int64_t vtime) {
+  /* the position in the trace, which stays correct when the stream is
+   * sampled */
+  req->n_req = vtime - 1;
+
+  if (partition.sketch != nullptr) {
+    partition.sketch->add_req(req);
+    if (!obj_sampled(req->obj_id)) {
+      /* not tracked and not forwarded to the modules */
+      req->valid = false;
+      return;
     }
+  }
 
-    DEBUG_ASSERT(curr_time_window_idx == time_to_window_idx(req->clock_time));
-
-    n_req_ += 1;
-    sum_obj_size_req += req->obj_size;
-
-    auto it = obj_map_.find(req->obj_id);
-    if (it == obj_map_.end()) {
-      /* the first request to the object */
-      req->compulsory_miss =
-          true; /* whether the object is seen for the first time */
+  int32_t curr_time_window_idx = time_to_window_idx(req->clock_time);
+  obj_info_map_type &obj_map = partition.obj_map;
+
+  auto it = obj_map.find(req->obj_id);
+  if (it == obj_map.end()) {
+    /* the first request to the object */
+    req->compulsory_miss =
+        true; /* whether the object is seen for the first time */
+    req->overwrite = false;
+    req->first_seen_in_window = true;
+    req->create_rtime = (int32_t)req->clock_time;
+    req->prev_size = -1;
+    //      req->last_seen_window_idx = curr_time_window_idx;
+
+    req->vtime_since_last_access = -1;
+    req->rtime_since_last_access = -1;
+
+    struct obj_info obj_info;
+    obj_info.create_rtime = (int32_t)req->clock_time;
+    obj_info.freq = 1;
+    obj_info.obj_size = (obj_size_t)req->obj_size;
+    obj_info.last_access_rtime = (int32_t)req->clock_time;
+    obj_info.last_access_vtime = vtime;
+
+    obj_map[req->obj_id] = obj_info;
+    partition.sum_obj_size_obj += req->obj_size;
+
+  } else {
+    req->compulsory_miss = false;
+    req->first_seen_in_window =
+        (time_to_window_idx(it->second.last_access_rtime) !=
+         curr_time_window_idx);
+    req->create_rtime = it->second.create_rtime;
+    if (req->op == OP_SET || req->op == OP_REPLACE || req->op == OP_CAS) {
+      req->overwrite = true;
+    } else {
       req->overwrite = false;
-      req->first_seen_in_window = true;
-      req->create_rtime = (int32_t)req->clock_time;
-      req->prev_size = -1;
-      //      req->last_seen_window_idx = curr_time_window_idx;
-
-      req->vtime_since_last_access = -1;
-      req->rtime_since_last_access = -1;
-
-      struct obj_info obj_info;
-      obj_info.create_rtime = (int32_t)req->clock_time;
-      obj_info.freq = 1;
-      obj_info.obj_size = (obj_size_t)req->obj_size;
-      obj_info.last_access_rtime = (int32_t)req->clock_time;
-      obj_info.last_access_vtime = n_req_;
-
-      obj_map_[req->obj_id] = obj_info;
-      sum_obj_size_obj += req->obj_size;
+    }
+    req->vtime_since_last_access = vtime - it->second.last_access_vtime;
+    req->rtime_since_last_access =
+        (int64_t)(req->clock_time) - it->second.last_access_rtime;
+
+    assert(req->vtime_since_last_access > 0);
+    assert(req->rtime_since_last_access >= 0);
+
+    req->prev_size = it->second.obj_size;
+    it->second.obj_size = req->obj_size;
+    it->second.freq += 1;
+    it->second.last_access_vtime = vtime;
+    it->second.last_access_rtime = (int32_t)(req->clock_time);
+  }
+}
 
-    } else {
-      req->compulsory_miss = false;
-      req->first_seen_in_window =
-          (time_to_window_idx(it->second.last_access_rtime) !=
-           curr_time_window_idx);
-      req->create_rtime = it->second.create_rtime;
-      if (req->op == OP_SET || req->op == OP_REPLACE || req->op == OP_CAS) {
-        req->overwrite = true;
+/**
+ * @brief in sketch mode, halve the sample rate until the sampled objects fit
+ * in sketch_n_obj_ and drop the objects that are no longer sampled, the
+ * enrichment workers must be idle
+ */
+void traceAnalyzer::TraceAnalyzer::lower_sample_rate(
+    WorkerGroup &enrich_workers) {
+  auto n_sampled_obj = [this]() {
+    int64_t n = 0;
+    for (const auto &partition : partitions_) n += partition.obj_map.size();
+    return n;
+  };
+  auto drop_unsampled = [this](int p) {
+    obj_info_map_type &obj_map = partitions_[p].obj_map;
+    for (auto it = obj_map.begin(); it != obj_map.end();) {
+      if (obj_sampled(it->first)) {
+        ++it;
       } else {
-        req->overwrite = false;
+        it = obj_map.erase(it);
       }
-      req->vtime_since_last_access =
-          (int64_t)n_req_ - it->second.last_access_vtime;
-      req->rtime_since_last_access =
-          (int64_t)(req->clock_time) - it->second.last_access_rtime;
-
-      assert(req->vtime_since_last_access > 0);
-      assert(req->rtime_since_last_access >= 0);
-
-      req->prev_size = it->second.obj_size;
-      it->second.obj_size = req->obj_size;
-      it->second.freq += 1;
-      it->second.last_access_vtime = n_req_;
-      it->second.last_access_rtime = (int32_t)(req->clock_time);
     }
+  };
 
-    op_stat_->add_req(req);
-
-    if (ttl_stat_ != nullptr) {
-      ttl_stat_->add_req(req);
+  while (n_sampled_obj() > sketch_n_obj_ && sample_shift_ < 63) {
+    sample_shift_ += 1;
+    if (n_partition_ > 1) {
+      enrich_workers.dispatch(drop_unsampled);
+      enrich_workers.wait();
+    } else {
+      drop_unsampled(0);
     }
+    INFO("sketch mode: sample 1/%lld of the objects\n",
+         (long long)(1LL << sample_shift_));
+  }
+}
 
-    if (req_rate_stat_ != nullptr) {
-      req_rate_stat_->add_req(req);
-    }
+void traceAnalyzer::TraceAnalyzer::run() {
+  if (has_run_) return;
 
-    if (size_stat_ != nullptr) {
-      size_stat_->add_req(req);
-    }
+  /* the enrichment stage runs on this thread and broadcasts batches of
+   * enriched requests to the modules, each on its own thread */
+  std::vector<batch_consumer_t> consumers = module_consumers();
+  ReqBatchRing ring((int)consumers.size());
+  std::vector<std::thread> workers;
+  for (int i = 0; i < (int)consumers.size(); i++) {
+    workers.emplace_back([&ring, &consumers, i]() {
+      request_t *reqs;
+      int n;
+      while (ring.consume(i, &reqs, &n)) {
+        consumers[i](reqs, n);
+        ring.release(i);
+      }
+    });
+  }
 
-    if (reuse_stat_ != nullptr) {
-      reuse_stat_->add_req(req);
-    }
+  /* each enrichment worker owns a hash partition of the objects */
+  WorkerGroup enrich_workers(n_partition_ > 1 ? n_partition_ : 0);
 
-    if (access_stat_ != nullptr) {
-      access_stat_->add_req(req);
-    }
+  int32_t curr_time_window_idx = 0;
+  int next_time_window_ts = time_window_;
+  if (!resume_path_.empty()) {
+    /* continue from the last request of the checkpointed run */
+    load_checkpoint();
+    curr_time_window_idx = time_to_window_idx(end_ts_ - start_ts_);
+    next_time_window_ts = (curr_time_window_idx + 1) * time_window_;
+  }
+  int64_t n_req_before = n_req_;
 
-    if (popularity_decay_stat_ != nullptr) {
-      popularity_decay_stat_->add_req(req);
-    }
+  request_t *req = new_request();
+  read_one_req(reader_, req);
+  if (resume_path_.empty()) start_ts_ = req->clock_time;
 
-    if (prob_at_age_ != nullptr) {
-      prob_at_age_->add_req(req);
-    }
+  /* read the next batch of requests into the slot */
+  auto read_batch = [&](request_t *batch) -> int {
+    int n = 0;
+    while (req->valid && n < ring.batch_size_) {
+      DEBUG_ASSERT(req->obj_size != 0);
 
-    if (lifetime_stat_ != nullptr) {
-      lifetime_stat_->add_req(req);
-    }
+      // change real time to relative time
+      req->clock_time -= start_ts_;
 
-    if (create_future_reuse_ != nullptr) {
-      create_future_reuse_->add_req(req);
-    }
+      while (req->clock_time >= next_time_window_ts) {
+        curr_time_window_idx += 1;
+        next_time_window_ts += time_window_;
+      }
+
+      if (curr_time_window_idx != time_to_window_idx(req->clock_time)) {
+        ERROR(
+            "The data is not ordered by time, please sort the trace first!"
+            "Current time %ld requested object %lu, obj size %lu\n",
+            (long)(req->clock_time + start_ts_), (unsigned long)req->obj_id,
+            (long)req->obj_size);
+      }
+
+      DEBUG_ASSERT(curr_time_window_idx ==
+                   time_to_window_idx(req->clock_time));
 
-    if (size_change_distribution_ != nullptr) {
-      size_change_distribution_->add_req(req);
+      sum_obj_size_req += req->obj_size;
+      batch[n++] = *req;
+      read_one_req(reader_, req);
     }
-    if (scan_detector_ != nullptr) {
-      scan_detector_->add_req(req);
+    return n;
+  };
+
+  /* going through the trace, the workers enrich a batch while this thread
+   * reads the next one */
+  request_t *batch = ring.acquire();
+  int n_batch_req = read_batch(batch);
+  while (n_batch_req > 0) {
+    int64_t base_vtime = n_req_;
+    if (n_partition_ > 1) {
+      enrich_workers.dispatch([this, batch, n_batch_req, base_vtime](int p) {
+        for (int i = 0; i < n_batch_req; i++) {
+          if (obj_partition_idx(batch[i].obj_id) == p) {
+            enrich_req(partitions_[p], &batch[i], base_vtime + i + 1);
+          }
+        }
+      });
+    } else {
+      for (int i = 0; i < n_batch_req; i++) {
+        enrich_req(partitions_[0], &batch[i], base_vtime + i + 1);
+      }
     }
+    n_req_ += n_batch_req;
+
+    request_t *next_batch = ring.acquire(1);
+    int n_next_batch_req = read_batch(next_batch);
+
+    if (n_partition_ > 1) enrich_workers.wait();
+    if (sketch_) {
+      /* only the requests to the sampled objects reach the modules */
+      n_batch_req = (int)(std::remove_if(
+                              batch, batch + n_batch_req,
+                              [](const request_t &r) { return !r.valid; }) -
+                          batch);
+      lower_sample_rate(enrich_workers);
+    }
+    ring.publish(n_batch_req);
+    batch = next_batch;
+    n_batch_req = n_next_batch_req;
+  }
+  ring.close();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (n_req_ > n_req_before) end_ts_ = req->clock_time + start_ts_;
 
-    read_one_req(reader_, req);
-  } while (req->valid);
-  end_ts_ = req->clock_time + start_ts_;
+  if (!checkpoint_path_.empty()) {
+    save_checkpoint();
+  }
 
   /* processing */
   post_processing();
@@ -280,23 +464,35 @@ void traceAnalyzer::TraceAnalyzer::run() {
     scan_detector_->dump(output_path_);
   }
 
+  if (footprint_ != nullptr) {
+    footprint_->dump(output_path_);
+  }
+
+  if (!cache_sims_.empty()) {
+    dump_miss_ratio(cache_sims_, output_path_, time_window_);
+  }
+
+  if (sketch_) {
+    partitions_[0].sketch->dump(output_path_);
+  }
+
   has_run_ = true;
 }
 
 string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   stat_ss_.clear();
-  double cold_miss_ratio = (double)obj_map_.size() / (double)n_req_;
+  double cold_miss_ratio = (double)n_obj_ / (double)n_req_;
   double byte_cold_miss_ratio =
       (double)sum_obj_size_obj / (double)sum_obj_size_req;
   int mean_obj_size_req = (int)((double)sum_obj_size_req / (double)n_req_);
   int mean_obj_size_obj =
-      (int)((double)sum_obj_size_obj / (double)obj_map_.size());
-  double freq_mean = (double)n_req_ / (double)obj_map_.size();
+      (int)((double)sum_obj_size_obj / (double)n_obj_);
+  double freq_mean = (double)n_req_ / (double)n_obj_;
   int64_t time_span = end_ts_ - start_ts_;
 
   stat_ss_ << setprecision(4) << fixed << "dat: " << reader_->trace_path << "\n"
            << "number of requests: " << n_req_
-           << ", number of objects: " << obj_map_.size() << "\n"
+           << ", number of objects: " << n_obj_ << "\n"
            << "number of req GiB: " << (double)sum_obj_size_req / (double)GiB
            << ", number of obj GiB: " << (double)sum_obj_size_obj / (double)GiB
            << "\n"
@@ -318,7 +514,7 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   stat_ss_ << "X-hit (number of obj accessed X times): ";
   for (int i = 0; i < track_n_hit_; i++) {
     stat_ss_ << n_hit_cnt_[i] << "("
-             << (double)n_hit_cnt_[i] / (double)obj_map_.size() << "), ";
+             << (double)n_hit_cnt_[i] / (double)n_obj_ << "), ";
   }
   stat_ss_ << "\n";
 
@@ -334,6 +530,25 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
 
   if (scan_detector_ != nullptr) stat_ss_ << *scan_detector_;
 
+  if (footprint_ != nullptr) stat_ss_ << *footprint_;
+
+  for (auto sim : cache_sims_) {
+    stat_ss_ << *sim;
+  }
+
+  if (sketch_) {
+    int64_t n_sampled_obj = 0;
+    for (const auto &partition : partitions_) {
+      n_sampled_obj += (int64_t)partition.obj_map.size();
+    }
+    stat_ss_ << "sketch: sampled 1/" << (1LL << sample_shift_)
+             << " of the objects (" << n_sampled_obj
+             << " objects), the number of objects, X-hit, obj GiB and the "
+                "object rate are estimated, the request rate counts every "
+                "request, the other analyses use the sampled requests\n";
+    stat_ss_ << *partitions_[0].sketch;
+  }
+
   return stat_ss_.str();
 }
 
@@ -346,17 +561,62 @@ void traceAnalyzer::TraceAnalyzer::post_processing() {
   memset(n_hit_cnt_, 0, sizeof(uint64_t) * track_n_hit_);
   memset(popular_cnt_, 0, sizeof(uint64_t) * track_n_popular_);
 
-  for (auto it : obj_map_) {
-    if (it.second.freq <= track_n_hit_) {
-      n_hit_cnt_[it.second.freq - 1] += 1;
+  for (const auto &partition : partitions_) {
+    n_obj_ += (int64_t)partition.obj_map.size();
+    sum_obj_size_obj += partition.sum_obj_size_obj;
+    for (const auto &it : partition.obj_map) {
+      if (it.second.freq <= track_n_hit_) {
+        n_hit_cnt_[it.second.freq - 1] += 1;
+      }
     }
   }
 
-  if (option_.popularity) {
-    popularity_stat_ = new Popularity(obj_map_);
-    auto sorted_freq = popularity_stat_->get_sorted_freq();
+  if (sketch_) {
+    /* scale the sampled objects up to the trace, the number of objects comes
+     * from the sketch */
+    SketchStat *sketch = partitions_[0].sketch;
+    for (auto &partition : partitions_) partition.sketch->finish();
+    for (int i = 1; i < n_partition_; i++) {
+      sketch->merge(*partitions_[i].sketch);
+    }
+
+    double scale = ldexp(1.0, sample_shift_);
+    n_obj_ = (int64_t)sketch->n_obj();
+    sum_obj_size_obj = 0;
+    for (const auto &partition : partitions_) {
+      for (const auto &it : partition.obj_map) {
+        sum_obj_size_obj += it.second.obj_size;
+      }
+    }
+    sum_obj_size_obj = (uint64_t)((double)sum_obj_size_obj * scale);
+    for (int i = 0; i < track_n_hit_; i++) {
+      n_hit_cnt_[i] = (uint64_t)((double)n_hit_cnt_[i] * scale);
+    }
+
+    if (req_rate_stat_ != nullptr) sketch->fill_req_rate(req_rate_stat_);
+
+    auto top = sketch->top(track_n_popular_);
     for (int i = 0; i < track_n_popular_; i++) {
-      popular_cnt_[i] = sorted_freq[i];
+      popular_cnt_[i] = top[i];
     }
   }
+
+  if (option_.popularity) {
+    popularity_stat_ = new Popularity(partitions_);
+    if (!sketch_) {
+      auto top_freq = popularity_stat_->get_top_freq(track_n_popular_);
+      for (int i = 0; i < track_n_popular_; i++) {
+        popular_cnt_[i] = top_freq[i];
+      }
+    }
+  }
+
+  if (scan_detector_ != nullptr) {
+    /* the stat is generated before the dump */
+    scan_detector_->finish();
+  }
+
+  if (footprint_ != nullptr) {
+    footprint_->finish(partitions_, n_req_);
+  }
 }
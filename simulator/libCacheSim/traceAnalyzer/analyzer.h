@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -20,12 +21,16 @@
 
 #include "../include/libCacheSim/reader.h"
 #include "accessPattern.h"
+#include "cacheSim.h"
+#include "footprint.h"
 #include "op.h"
+#include "pipeline.h"
 #include "popularity.h"
 #include "popularityDecay.h"
 #include "reqRate.h"
 #include "reuse.h"
 #include "size.h"
+#include "sketch.h"
 #include "struct.h"
 #include "ttl.h"
 
@@ -56,6 +61,10 @@ typedef struct analysis_option {
   bool prob_at_age;
 
   bool size_change;
+  /* footprint and the miss ratio curves derived from it */
+  bool footprint;
+  /* needs an oracle trace with the next access vtime */
+  bool scan_detector;
 } analysis_option_t;
 
 typedef struct analysis_param {
@@ -66,6 +75,26 @@ typedef struct analysis_param {
   int warmup_time;
   double access_pattern_sample_ratio;
   int access_pattern_sample_ratio_inv;
+  /* back the access pattern streams by a file for plotting with mmap */
+  bool access_pattern_stream;
+  /* the number of threads that enrich requests, each owns a hash partition
+   * of the objects */
+  int n_enrich_thread;
+  /* bounded-memory mode, only a hash sample of at most sketch_n_obj objects
+   * is tracked and analyzed, the trace-wide stat comes from sketches */
+  bool sketch;
+  int64_t sketch_n_obj;
+  /* caches simulated on the request stream, owned by the analyzer */
+  int n_cache;
+  cache_t **caches;
+  /* the caches count the miss ratio after this warmup, the analyzer's
+   * warmup_time is too long for most traces to simulate */
+  int sim_cache_warmup_time;
+  /* write the state to the checkpoint at the end of the trace, and resume
+   * from a checkpoint to process only the requests after it, NULL to
+   * disable */
+  const char *checkpoint_path;
+  const char *resume_path;
 } analysis_param_t;
 
 static analysis_param_t default_param() {
@@ -76,6 +105,15 @@ static analysis_param_t default_param() {
   param.warmup_time = 86400;
   param.access_pattern_sample_ratio = 0.01;
   param.access_pattern_sample_ratio_inv = 101;
+  param.access_pattern_stream = false;
+  param.n_enrich_thread = 4;
+  param.sketch = false;
+  param.sketch_n_obj = 1 << 22;
+  param.n_cache = 0;
+  param.caches = nullptr;
+  param.sim_cache_warmup_time = 0;
+  param.checkpoint_path = nullptr;
+  param.resume_path = nullptr;
 
   return param;
 };
@@ -93,6 +131,8 @@ static struct analysis_option default_option() {
   option.prob_at_age = false;
   option.size_change = false;
   option.lifetime = false;
+  option.scan_detector = false;
+  option.footprint = false;
 
   return option;
 };
@@ -109,10 +149,21 @@ class TraceAnalyzer {
         option_(option),
         access_pattern_sample_ratio_inv_(
             params.access_pattern_sample_ratio_inv),
+        access_pattern_stream_(params.access_pattern_stream),
         track_n_popular_(params.track_n_popular),
         track_n_hit_(params.track_n_hit),
         time_window_(params.time_window),
-        warmup_time_(params.warmup_time) {
+        warmup_time_(params.warmup_time),
+        n_partition_(std::max(params.n_enrich_thread, 1)),
+        sketch_(params.sketch),
+        sketch_n_obj_(params.sketch_n_obj),
+        caches_(params.caches, params.caches + params.n_cache),
+        sim_cache_warmup_time_(params.sim_cache_warmup_time),
+        checkpoint_path_(params.checkpoint_path == nullptr
+                             ? ""
+                             : params.checkpoint_path),
+        resume_path_(params.resume_path == nullptr ? ""
+                                                   : params.resume_path) {
     if (warmup_time_ % time_window_ != 0) {
       /* the popularityDecay computation needs warmup time to be multiple of
        * time_window */
@@ -150,9 +201,26 @@ class TraceAnalyzer {
   int track_n_hit_;
   // the sampling ratio used in access pattern analysis
   int access_pattern_sample_ratio_inv_;
+  // whether the access pattern streams are backed by a file
+  bool access_pattern_stream_;
+  // the number of object partitions and enrichment threads
+  int n_partition_;
+  // sketch mode and the max number of sampled objects
+  bool sketch_;
+  int64_t sketch_n_obj_;
+  // sketch mode samples the objects with a hash below 2^(64 - sample_shift_)
+  int sample_shift_ = 0;
+  // the caches to simulate, each is moved into a CacheSim
+  std::vector<cache_t *> caches_;
+  // the warmup of the simulated caches in seconds
+  int sim_cache_warmup_time_;
+  // where to write the checkpoint and where to resume from, empty if unused
+  string checkpoint_path_;
+  string resume_path_;
 
   /* stat */
   int64_t n_req_ = 0;
+  int64_t n_obj_ = 0;
 
   /* number of one-hit, two-hit ... */
   uint64_t *n_hit_cnt_ = nullptr;
@@ -166,7 +234,8 @@ class TraceAnalyzer {
    * an object is requested, we ignore for now */
   //  uint64_t sum_req_size_req = 0, sum_req_size_obj = 0;
 
-  obj_info_map_type obj_map_;
+  /* the objects partitioned by hash, see obj_partition_idx */
+  std::vector<obj_partition_t> partitions_;
 
  private:
   reader_t *reader_ = nullptr;
@@ -182,6 +251,7 @@ class TraceAnalyzer {
   AccessPattern *access_stat_ = nullptr;
   Popularity *popularity_stat_ = nullptr;
   PopularityDecay *popularity_decay_stat_ = nullptr;
+  Footprint *footprint_ = nullptr;
 
   ProbAtAge *prob_at_age_ = nullptr;
   LifetimeDistribution *lifetime_stat_ = nullptr;
@@ -191,14 +261,39 @@ class TraceAnalyzer {
   // WriteFutureReuseDistribution *write_future_reuse_stat_ = nullptr;
   SizeChangeDistribution *size_change_distribution_ = nullptr;
   ScanDetector *scan_detector_ = nullptr;
+  std::vector<CacheSim *> cache_sims_;
 
   string output_path_;
 
   void post_processing();
 
+  std::vector<batch_consumer_t> module_consumers();
+
+  void enrich_req(obj_partition_t &partition, request_t *req, int64_t vtime);
+
+  void lower_sample_rate(WorkerGroup &enrich_workers);
+
+  /* write the state after the last request to checkpoint_path_ */
+  void save_checkpoint();
+
+  /* restore the state from resume_path_ and move the reader to the first
+   * request after the checkpoint */
+  void load_checkpoint();
+
   string gen_stat_str();
 
   inline int time_to_window_idx(uint32_t rtime) { return rtime / time_window_; }
+
+  inline int obj_partition_idx(obj_id_t obj_id) const {
+    /* use the high bits of a multiplicative hash, the hash table of a
+     * partition uses its own hash */
+    return (int)(((obj_id * 0x9E3779B97F4A7C15ULL) >> 32) % n_partition_);
+  }
+
+  inline bool obj_sampled(obj_id_t obj_id) const {
+    return sample_shift_ == 0 ||
+           sketch_hash(obj_id, SAMPLE_HASH_SEED) >> (64 - sample_shift_) == 0;
+  }
 };
 
 };  // namespace traceAnalyzer
@@ -0,0 +1,88 @@
+#include "cacheSim.h"
+
+#include <fstream>
+
+namespace traceAnalyzer {
+
+using namespace std;
+
+CacheSim::~CacheSim() { cache_->cache_free(cache_); }
+
+void CacheSim::add_batch(const request_t *reqs, int n) {
+  if (cache_->get_batch != nullptr) {
+    if (n > hits_cap_) {
+      hits_.reset(new bool[n]);
+      hits_cap_ = n;
+    }
+    cache_->get_batch(cache_, reqs, n, hits_.get());
+  }
+
+  for (int i = 0; i < n; i++) {
+    const request_t *req = &reqs[i];
+    bool hit = cache_->get_batch != nullptr ? hits_[i]
+                                            : cache_->get(cache_, req);
+
+    /* clock_time is relative to the start of the trace */
+    size_t window_idx = (size_t)req->clock_time / time_window_;
+    if (window_idx >= window_n_req_.size()) {
+      window_n_req_.resize(window_idx + 1, 0);
+      window_n_miss_.resize(window_idx + 1, 0);
+      window_n_byte_.resize(window_idx + 1, 0);
+      window_n_miss_byte_.resize(window_idx + 1, 0);
+    }
+
+    window_n_req_[window_idx] += 1;
+    window_n_byte_[window_idx] += req->obj_size;
+    if (!hit) {
+      window_n_miss_[window_idx] += 1;
+      window_n_miss_byte_[window_idx] += req->obj_size;
+    }
+
+    /* the first warmup_time seconds warm the cache up */
+    if (req->clock_time >= warmup_time_) {
+      n_req_ += 1;
+      n_byte_ += req->obj_size;
+      if (!hit) {
+        n_miss_ += 1;
+        n_miss_byte_ += req->obj_size;
+      }
+    }
+  }
+}
+
+void CacheSim::dump(ostream &os) const {
+  os << "# " << cache_->cache_name << " " << cache_->cache_size
+     << " request miss ratio\n";
+  for (size_t i = 0; i < window_n_req_.size(); i++) {
+    os << (window_n_req_[i] == 0
+               ? 0
+               : (double)window_n_miss_[i] / (double)window_n_req_[i])
+       << ",";
+  }
+  os << "\n";
+
+  os << "# " << cache_->cache_name << " " << cache_->cache_size
+     << " byte miss ratio\n";
+  for (size_t i = 0; i < window_n_byte_.size(); i++) {
+    os << (window_n_byte_[i] == 0
+               ? 0
+               : (double)window_n_miss_byte_[i] / (double)window_n_byte_[i])
+       << ",";
+  }
+  os << "\n";
+}
+
+void dump_miss_ratio(const vector<CacheSim *> &sims, const string &path_base,
+                     int time_window) {
+  ofstream ofs(path_base + ".missRatio_w" + to_string(time_window),
+               ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# miss ratio - time window " << time_window
+      << " second, the i-th value is the i-th window\n";
+  for (const auto sim : sims) {
+    sim->dump(ofs);
+  }
+  ofs.close();
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * simulate a cache on the request stream of the analyzer, so that the trace
+ * is read once for both analysis and simulation
+ *
+ * the miss ratio of each time window is recorded, window i covers
+ * [i * time_window, (i + 1) * time_window) of the trace, the same as the
+ * windows of reqRate, reuse and popularityDecay, so the outputs can be joined
+ * by the window index
+ *
+ * the overall miss ratio counts the requests after the first warmup_time
+ * seconds of the trace, the same as cachesim, the warmup is separate from the
+ * analyzer's warmup and defaults to 0
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/libCacheSim/cache.h"
+#include "../include/libCacheSim/request.h"
+
+namespace traceAnalyzer {
+
+class CacheSim {
+ public:
+  CacheSim() = delete;
+  /* the cache is owned and freed by CacheSim */
+  explicit CacheSim(cache_t *cache, int time_window, int warmup_time)
+      : cache_(cache), time_window_(time_window), warmup_time_(warmup_time) {};
+  ~CacheSim();
+
+  /* serve a batch of requests in order */
+  void add_batch(const request_t *reqs, int n);
+
+  /* append the per-window miss ratios to the output */
+  void dump(std::ostream &os) const;
+
+  /* the requests and misses after warmup */
+  int64_t n_req() const { return n_req_; }
+  int64_t n_miss() const { return n_miss_; }
+  int64_t n_byte() const { return n_byte_; }
+  int64_t n_miss_byte() const { return n_miss_byte_; }
+
+  friend std::ostream &operator<<(std::ostream &os, const CacheSim &sim) {
+    os << "cache " << sim.cache_->cache_name << " size "
+       << sim.cache_->cache_size << ": ";
+    if (sim.n_req_ == 0) {
+      os << "miss ratio n/a, no request after " << sim.warmup_time_
+         << " sec warmup\n";
+      return os;
+    }
+    os << "miss ratio " << (double)sim.n_miss_ / (double)sim.n_req_
+       << ", byte miss ratio "
+       << (double)sim.n_miss_byte_ / (double)std::max(sim.n_byte_, (int64_t)1)
+       << "\n";
+    return os;
+  }
+
+ private:
+  cache_t *cache_;
+  const int time_window_;
+  const int warmup_time_;
+
+  /* after warmup */
+  int64_t n_req_ = 0;
+  int64_t n_miss_ = 0;
+  int64_t n_byte_ = 0;
+  int64_t n_miss_byte_ = 0;
+
+  /* per time window, including warmup */
+  std::vector<uint32_t> window_n_req_{};
+  std::vector<uint32_t> window_n_miss_{};
+  std::vector<uint64_t> window_n_byte_{};
+  std::vector<uint64_t> window_n_miss_byte_{};
+
+  /* the hit of each request in the batch given to get_batch */
+  std::unique_ptr<bool[]> hits_{};
+  int hits_cap_ = 0;
+};
+
+/* write the per-window miss ratios of all caches to
+ * path_base.missRatio_w<time_window> */
+void dump_miss_ratio(const std::vector<CacheSim *> &sims,
+                     const std::string &path_base, int time_window);
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,178 @@
+//
+// save the analyzer state after the last request of a trace and resume from
+// it when the trace has grown, the outputs of the resumed run are the same as
+// analyzing the whole trace again
+//
+
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "analyzer.h"
+
+namespace traceAnalyzer {
+
+/* the position after the last read request in the trace file, -1 if the
+ * reader cannot seek (compressed or streamed traces) */
+static int64_t trace_read_pos(reader_t *reader) {
+  if (reader->is_stream || reader->is_zstd_file) return -1;
+  if (reader->trace_format == BINARY_TRACE_FORMAT) {
+    return (int64_t)reader->mmap_offset;
+  }
+  if (reader->trace_format == TXT_TRACE_FORMAT && reader->file != NULL) {
+    return (int64_t)ftell(reader->file);
+  }
+  return -1;
+}
+
+/* move the reader to the position returned by trace_read_pos, or skip the
+ * first n_req requests if the position is unknown */
+static void trace_seek(reader_t *reader, int64_t pos, int64_t n_req) {
+  if (pos >= 0 && trace_read_pos(reader) >= 0) {
+    if ((size_t)pos > reader->file_size) {
+      ERROR("the trace is shorter than the checkpoint, %zu < %lld bytes\n",
+            reader->file_size, (long long)pos);
+    }
+    if (reader->trace_format == BINARY_TRACE_FORMAT) {
+      reader->mmap_offset = (size_t)pos;
+    } else {
+      fseek(reader->file, pos, SEEK_SET);
+    }
+    reader->n_read_req = n_req;
+    return;
+  }
+
+  /* read through the analyzed part of the trace */
+  request_t *req = new_request();
+  for (int64_t i = 0; i < n_req; i++) {
+    if (read_one_req(reader, req) != 0) {
+      ERROR("the trace is shorter than the checkpoint, %lld < %lld requests\n",
+            (long long)i, (long long)n_req);
+    }
+  }
+  free_request(req);
+}
+
+void TraceAnalyzer::save_checkpoint() {
+  string tmp_path = checkpoint_path_ + ".tmp";
+  ofstream ofs(tmp_path, ios::out | ios::trunc | ios::binary);
+  if (!ofs) {
+    ERROR("cannot open checkpoint %s\n", tmp_path.c_str());
+  }
+
+  ckpt_write(ofs, (uint64_t)CHECKPOINT_MAGIC);
+  ckpt_write(ofs, (uint32_t)CHECKPOINT_VERSION);
+  ckpt_write(ofs, option_);
+  ckpt_write(ofs, time_window_);
+  ckpt_write(ofs, warmup_time_);
+  ckpt_write(ofs, access_pattern_sample_ratio_inv_);
+
+  ckpt_write(ofs, trace_read_pos(reader_));
+  ckpt_write(ofs, n_req_);
+  ckpt_write(ofs, start_ts_);
+  ckpt_write(ofs, end_ts_);
+  ckpt_write(ofs, sum_obj_size_req);
+
+  /* the objects of all partitions, a resumed run can use another number of
+   * partitions */
+  uint64_t n_obj = 0, sum_obj_size_obj = 0;
+  for (const auto &partition : partitions_) {
+    n_obj += partition.obj_map.size();
+    sum_obj_size_obj += partition.sum_obj_size_obj;
+  }
+  ckpt_write(ofs, sum_obj_size_obj);
+  ckpt_write(ofs, n_obj);
+  for (const auto &partition : partitions_) {
+    for (const auto &p : partition.obj_map) {
+      ckpt_write(ofs, p.first);
+      ckpt_write(ofs, p.second);
+    }
+  }
+
+  op_stat_->save(ofs);
+  if (ttl_stat_ != nullptr) ttl_stat_->save(ofs);
+  if (req_rate_stat_ != nullptr) req_rate_stat_->save(ofs);
+  if (size_stat_ != nullptr) size_stat_->save(ofs);
+  if (reuse_stat_ != nullptr) reuse_stat_->save(ofs);
+  if (access_stat_ != nullptr) access_stat_->save(ofs);
+  if (popularity_decay_stat_ != nullptr) popularity_decay_stat_->save(ofs);
+  if (footprint_ != nullptr) footprint_->save(ofs);
+
+  ofs.close();
+  if (!ofs) {
+    ERROR("cannot write checkpoint %s\n", tmp_path.c_str());
+  }
+  /* replace the old checkpoint only when the new one is complete */
+  if (rename(tmp_path.c_str(), checkpoint_path_.c_str()) != 0) {
+    ERROR("cannot rename checkpoint to %s: %s\n", checkpoint_path_.c_str(),
+          strerror(errno));
+  }
+  INFO("checkpoint %s: %lld requests, %llu objects\n", checkpoint_path_.c_str(),
+       (long long)n_req_, (unsigned long long)n_obj);
+}
+
+void TraceAnalyzer::load_checkpoint() {
+  ifstream ifs(resume_path_, ios::in | ios::binary);
+  if (!ifs) {
+    ERROR("cannot open checkpoint %s\n", resume_path_.c_str());
+  }
+
+  uint64_t magic;
+  uint32_t version;
+  ckpt_read(ifs, magic);
+  ckpt_read(ifs, version);
+  if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+    ERROR("%s is not a trace analyzer checkpoint of version %d\n",
+          resume_path_.c_str(), CHECKPOINT_VERSION);
+  }
+
+  struct analysis_option option;
+  int time_window, warmup_time, access_pattern_sample_ratio_inv;
+  ckpt_read(ifs, option);
+  ckpt_read(ifs, time_window);
+  ckpt_read(ifs, warmup_time);
+  ckpt_read(ifs, access_pattern_sample_ratio_inv);
+  if (memcmp(&option, &option_, sizeof(option)) != 0 ||
+      time_window != time_window_ || warmup_time != warmup_time_ ||
+      access_pattern_sample_ratio_inv != access_pattern_sample_ratio_inv_) {
+    ERROR(
+        "the checkpoint was taken with different analysis options, time window "
+        "or warmup time\n");
+  }
+
+  int64_t trace_pos;
+  ckpt_read(ifs, trace_pos);
+  ckpt_read(ifs, n_req_);
+  ckpt_read(ifs, start_ts_);
+  ckpt_read(ifs, end_ts_);
+  ckpt_read(ifs, sum_obj_size_req);
+
+  uint64_t sum_obj_size_obj, n_obj;
+  ckpt_read(ifs, sum_obj_size_obj);
+  ckpt_read(ifs, n_obj);
+  partitions_[0].sum_obj_size_obj = sum_obj_size_obj;
+  for (uint64_t i = 0; i < n_obj; i++) {
+    obj_id_t obj_id;
+    struct obj_info info;
+    ckpt_read(ifs, obj_id);
+    ckpt_read(ifs, info);
+    partitions_[obj_partition_idx(obj_id)].obj_map.emplace(obj_id, info);
+  }
+
+  op_stat_->load(ifs);
+  if (ttl_stat_ != nullptr) ttl_stat_->load(ifs);
+  if (req_rate_stat_ != nullptr) req_rate_stat_->load(ifs);
+  if (size_stat_ != nullptr) size_stat_->load(ifs);
+  if (reuse_stat_ != nullptr) reuse_stat_->load(ifs);
+  if (access_stat_ != nullptr) access_stat_->load(ifs);
+  if (popularity_decay_stat_ != nullptr) popularity_decay_stat_->load(ifs);
+  if (footprint_ != nullptr) footprint_->load(ifs);
+
+  trace_seek(reader_, trace_pos, n_req_);
+  INFO("resume from checkpoint %s: %lld requests, %llu objects\n",
+       resume_path_.c_str(), (long long)n_req_, (unsigned long long)n_obj);
+}
+
+}  // namespace traceAnalyzer
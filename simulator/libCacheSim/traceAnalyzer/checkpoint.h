@@ -0,0 +1,57 @@
+#pragma once
+//
+// helpers to write the analyzer state to a binary checkpoint and read it
+// back, so that a later run can resume from the end of the analyzed part of
+// a trace and only process the new requests
+//
+// the checkpoint is a sequence of fields in native byte order, each module
+// writes its state with save and reads it back with load in the same order,
+// a checkpoint is only read by the same build on the same machine
+//
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include "../include/libCacheSim/logging.h"
+
+namespace traceAnalyzer {
+
+#define CHECKPOINT_MAGIC 0x4b50434b5441434cULL /* "LCATCKPK" */
+#define CHECKPOINT_VERSION 2
+
+template <typename T>
+inline void ckpt_write(std::ostream &os, const T &v) {
+  static_assert(std::is_trivially_copyable<T>::value, "");
+  os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T>
+inline void ckpt_read(std::istream &is, T &v) {
+  static_assert(std::is_trivially_copyable<T>::value, "");
+  is.read(reinterpret_cast<char *>(&v), sizeof(T));
+  if (!is) {
+    ERROR("checkpoint is truncated\n");
+  }
+}
+
+template <typename T>
+inline void ckpt_write_vec(std::ostream &os, const std::vector<T> &v) {
+  ckpt_write(os, (uint64_t)v.size());
+  os.write(reinterpret_cast<const char *>(v.data()), sizeof(T) * v.size());
+}
+
+template <typename T>
+inline void ckpt_read_vec(std::istream &is, std::vector<T> &v) {
+  uint64_t n;
+  ckpt_read(is, n);
+  v.resize(n);
+  is.read(reinterpret_cast<char *>(v.data()), sizeof(T) * n);
+  if (!is) {
+    ERROR("checkpoint is truncated\n");
+  }
+}
+
+}  // namespace traceAnalyzer
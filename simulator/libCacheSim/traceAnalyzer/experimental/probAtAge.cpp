@@ -25,8 +25,7 @@ void ProbAtAge::add_req(request_t *req) {
   int pos_access = (int)(req->rtime_since_last_access / time_window_);
   int pos_create = (int)((req->clock_time - req->create_rtime) / time_window_);
 
-  auto p = pair<int32_t, int32_t>(pos_access, pos_create);
-  ac_age_req_cnt_[p] += 1;
+  ac_age_req_cnt_.incr(pos_access, pos_create);
 }
 
 void ProbAtAge::dump(string &path_base) {
@@ -34,10 +33,9 @@ void ProbAtAge::dump(string &path_base) {
                 ios::out | ios::trunc);
   ofs2 << "# " << path_base << "\n";
   ofs2 << "# reuse access age, create age: req_cnt\n";
-  for (auto &p : ac_age_req_cnt_) {
-    ofs2 << p.first.first * time_window_ << "," << p.first.second * time_window_
-         << ":" << p.second << "\n";
-  }
+  ac_age_req_cnt_.for_each([&](int64_t a, int64_t c, uint32_t cnt) {
+    ofs2 << a * time_window_ << "," << c * time_window_ << ":" << cnt << "\n";
+  });
 }
 
 };  // namespace traceAnalyzer
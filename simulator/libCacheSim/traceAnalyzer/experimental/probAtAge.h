@@ -4,10 +4,10 @@
  * which follow probability distribution P(R_ProbAtAge) and P(R_createAge)
  */
 
-#include <unordered_map>
 #include <vector>
 
 #include "../../include/libCacheSim/reader.h"
+#include "../histogram.h"
 #include "../struct.h"
 #include "../utils/include/utils.h"
 
@@ -24,18 +24,13 @@ class ProbAtAge {
 
   void dump(string &path_base);
 
+  void merge(const ProbAtAge &other) {
+    ac_age_req_cnt_.merge(other.ac_age_req_cnt_);
+  }
+
  private:
-  struct pair_hash {
-    template <class T1, class T2>
-    std::size_t operator()(const std::pair<T1, T2> &p) const {
-      auto h1 = std::hash<T1>{}(p.first);
-      auto h2 = std::hash<T2>{}(p.second);
-      return h1 ^ h2;
-    }
-  };
-
-  /* request count for reuse rtime */
-  unordered_map<pair<int32_t, int32_t>, uint32_t, pair_hash> ac_age_req_cnt_;
+  /* request count for (access age, create age) in time windows */
+  Histogram2D<uint32_t> ac_age_req_cnt_{};
 
   const int time_window_;
   const int warmup_rtime_;
@@ -0,0 +1,91 @@
+#include "scanDetector.h"
+
+#include <cstdlib>
+
+namespace traceAnalyzer {
+using namespace std;
+
+ScanDetector::ScanDetector(string &output_path, int max_vtime_diff)
+    : max_vtime_diff_(max_vtime_diff), runs_(max_vtime_diff) {
+  min_scan_size_ = getenv("MIN_SCAN_SIZE") ? atoi(getenv("MIN_SCAN_SIZE")) : 10;
+
+  ofs_scan_.open(output_path + ".scan", ios::out | ios::trunc);
+  ofs_scan_ << "# " << output_path << "\n";
+  ofs_scan_ << "# scans (min scan size " << min_scan_size_
+            << "): start_vtime,end_vtime,n_req\n";
+}
+
+void ScanDetector::close_head() {
+  const scan_run &run = runs_[head_];
+  if (run.n_req > min_scan_size_) {
+    n_scan_ += 1;
+    n_scan_req_ += run.n_req;
+    ofs_scan_ << run.start_vtime << "," << run.last_vtime << "," << run.n_req
+              << "\n";
+  } else {
+    n_non_scan_req_ += run.n_req;
+  }
+  scan_size_cnt_.incr(run.n_req);
+
+  head_ = (head_ + 1) % runs_.size();
+  n_active_ -= 1;
+}
+
+void ScanDetector::add_req(request_t *req) {
+  if (unlikely(req->next_access_vtime == -2)) {
+    std::cout << "the trace does not oracle trace, scan detector needs oracle"
+              << std::endl;
+    abort();
+  }
+
+  if (req->next_access_vtime == -1 || req->next_access_vtime == INT64_MAX) {
+    n_non_scan_req_ += 1;
+    return;
+  }
+
+  /* the position of the request in the trace, set by the analyzer, so that
+   * the detection works on a sampled stream */
+  int64_t curr_vtime = (int64_t)req->n_req;
+
+  for (size_t i = 0; i < n_active_; i++) {
+    scan_run &run = runs_[(head_ + i) % runs_.size()];
+    if (is_part_of_scan(run, curr_vtime, req->next_access_vtime)) {
+      run.n_req += 1;
+      run.last_vtime = curr_vtime;
+      return;
+    }
+  }
+
+  /* the runs are ordered by start time, close the ones that can no longer
+   * grow from the head, and the oldest one if the ring is full */
+  while (n_active_ > 0 && !can_grow(runs_[head_], curr_vtime)) {
+    close_head();
+  }
+  if (n_active_ == runs_.size()) {
+    close_head();
+  }
+
+  runs_[(head_ + n_active_) % runs_.size()] = {
+      curr_vtime, (int64_t)req->next_access_vtime, curr_vtime, 1};
+  n_active_ += 1;
+}
+
+void ScanDetector::finish() {
+  while (n_active_ > 0) close_head();
+  ofs_scan_.flush();
+}
+
+void ScanDetector::dump(string &path_base) {
+  finish();
+  ofs_scan_.close();
+
+  ofstream ofs_ss(path_base + ".scanSize", ios::out | ios::trunc);
+  ofs_ss << "# " << path_base << "\n";
+  ofs_ss << "# scan_size:cnt\n";
+  scan_size_cnt_.for_each([&ofs_ss](int64_t size, uint64_t cnt) {
+    ofs_ss << size << ":" << cnt << "\n";
+  });
+  ofs_ss.close();
+}
+
+}  // namespace traceAnalyzer
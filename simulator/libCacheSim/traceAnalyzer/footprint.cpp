@@ -0,0 +1,176 @@
+#include "footprint.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace traceAnalyzer {
+using namespace std;
+
+/* values below 256 have their own bucket, a larger value x in
+ * [2^k, 2^(k+1)) is in one of the 128 buckets of width 2^(k-7) */
+int Footprint::bucket_idx(int64_t x) {
+  if (x < 256) return (int)x;
+  int k = 63 - __builtin_clzll((uint64_t)x);
+  int shift = k - 7;
+  return 256 + (k - 8) * 128 + (int)((x >> shift) - 128);
+}
+
+int64_t Footprint::bucket_lower_bound(int idx) {
+  if (idx < 256) return idx;
+  int j = idx - 256;
+  int k = j / 128 + 8;
+  return (int64_t)(j % 128 + 128) << (k - 7);
+}
+
+void Footprint::LogSumHistogram::add(int64_t x) {
+  size_t idx = (size_t)bucket_idx(x);
+  if (idx >= cnt.size()) {
+    cnt.resize(idx + 1, 0);
+    sum.resize(idx + 1, 0);
+  }
+  cnt[idx] += 1;
+  sum[idx] += (uint64_t)x;
+}
+
+void Footprint::LogSumHistogram::save(ostream &os) const {
+  ckpt_write_vec(os, cnt);
+  ckpt_write_vec(os, sum);
+}
+
+void Footprint::LogSumHistogram::load(istream &is) {
+  ckpt_read_vec(is, cnt);
+  ckpt_read_vec(is, sum);
+}
+
+void Footprint::add_req(request_t *req) {
+  if (req->vtime_since_last_access < 0) {
+    /* the first access, n_req is the position in the trace from 0 */
+    first_.add((int64_t)req->n_req + 1);
+  } else {
+    reuse_.add(req->vtime_since_last_access);
+  }
+}
+
+void Footprint::finish(const vector<obj_partition_t> &partitions,
+                       int64_t n_req) {
+  n_req_ = n_req;
+  n_obj_ = 0;
+  last_ = LogSumHistogram();
+  for (const auto &partition : partitions) {
+    n_obj_ += (int64_t)partition.obj_map.size();
+    for (const auto &p : partition.obj_map) {
+      last_.add(n_req + 1 - p.second.last_access_vtime);
+    }
+  }
+  if (n_req_ == 0) return;
+
+  /* the count and the sum of the values in the buckets >= b */
+  int n_bucket = bucket_idx(n_req) + 1;
+  auto suffix = [n_bucket](const LogSumHistogram &h, vector<long double> &s0,
+                           vector<long double> &s1) {
+    s0.assign(n_bucket + 1, 0);
+    s1.assign(n_bucket + 1, 0);
+    for (int b = n_bucket - 1; b >= 0; b--) {
+      bool in = b < (int)h.cnt.size();
+      s0[b] = s0[b + 1] + (in ? h.cnt[b] : 0);
+      s1[b] = s1[b + 1] + (in ? h.sum[b] : 0);
+    }
+  };
+  vector<long double> f0, f1, l0, l1, r0, r1;
+  suffix(first_, f0, f1);
+  suffix(last_, l0, l1);
+  suffix(reuse_, r0, r1);
+
+  window_.clear();
+  fp_.clear();
+  lru_mrc_.clear();
+  fifo_mrc_.clear();
+  double last_fifo_size = 0;
+  for (int b = 1; b < n_bucket; b++) {
+    /* x > w is x >= the lower bound of bucket b */
+    int64_t w = bucket_lower_bound(b) - 1;
+    if (w > n_req_) break;
+    long double t = (f1[b] - w * f0[b]) + (l1[b] - w * l0[b]) +
+                    (r1[b] - w * r0[b]);
+    window_.push_back(w);
+    fp_.push_back((double)(n_obj_ - t / (n_req_ - w + 1)));
+
+    /* FIFO, a reuse after t requests hits with probability exp(-t / T), the
+     * mean of a bucket stands for its reuse times */
+    if (w == 0) continue;
+    double n_hit = 0;
+    for (size_t rb = 0; rb < reuse_.cnt.size(); rb++) {
+      if (reuse_.cnt[rb] == 0) continue;
+      double mean_t = (double)reuse_.sum[rb] / (double)reuse_.cnt[rb];
+      n_hit += (double)reuse_.cnt[rb] * exp(-mean_t / (double)w);
+    }
+    double mr = 1 - n_hit / (double)n_req_;
+    double fifo_size = (double)w * mr;
+    if (fifo_size > last_fifo_size) {
+      fifo_mrc_.emplace_back(fifo_size, mr);
+      last_fifo_size = fifo_size;
+    }
+  }
+
+  /* LRU, the slope of the footprint */
+  for (size_t i = 0; i + 1 < window_.size(); i++) {
+    double mr = (fp_[i + 1] - fp_[i]) / (double)(window_[i + 1] - window_[i]);
+    lru_mrc_.emplace_back(fp_[i], mr);
+  }
+}
+
+void Footprint::dump(string &path_base) {
+  ofstream ofs(path_base + ".footprint", ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# footprint: window (requests):fp (objects)\n";
+  for (size_t i = 0; i < window_.size(); i++) {
+    ofs << window_[i] << ":" << fp_[i] << "\n";
+  }
+
+  ofs << "# LRU miss ratio (HOTL): cache size (objects):miss ratio\n";
+  for (const auto &p : lru_mrc_) {
+    ofs << (int64_t)p.first << ":" << p.second << "\n";
+  }
+
+  ofs << "# FIFO miss ratio (random eviction): cache size (objects):miss "
+         "ratio\n";
+  for (const auto &p : fifo_mrc_) {
+    ofs << (int64_t)p.first << ":" << p.second << "\n";
+  }
+  ofs.close();
+}
+
+void Footprint::save(ostream &os) const {
+  first_.save(os);
+  reuse_.save(os);
+}
+
+void Footprint::load(istream &is) {
+  first_.load(is);
+  reuse_.load(is);
+}
+
+ostream &operator<<(ostream &os, const Footprint &fp) {
+  /* the miss ratio of the first point at or above the cache size */
+  auto mr_at = [](const vector<pair<double, double>> &mrc, double size) {
+    for (const auto &p : mrc) {
+      if (p.first >= size) return p.second;
+    }
+    return mrc.empty() ? 1.0 : mrc.back().second;
+  };
+
+  os << "footprint miss ratio at 0.1%, 1%, 10% of the objects: LRU ";
+  for (double r : {0.001, 0.01, 0.1}) {
+    os << setprecision(4) << mr_at(fp.lru_mrc_, r * fp.n_obj_) << ", ";
+  }
+  os << "FIFO ";
+  for (double r : {0.001, 0.01, 0.1}) {
+    os << setprecision(4) << mr_at(fp.fifo_mrc_, r * fp.n_obj_) << ", ";
+  }
+  os << "\n";
+  return os;
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * the average footprint fp(w), the average number of distinct objects in a
+ * window of w requests, for all window lengths, and the miss ratio curves
+ * derived from it, computed in one pass over the trace
+ *
+ * with n requests, m objects, first access time f_i and last access time l_i
+ * of object i and reuse time histogram r(t), the footprint is (Xiang et al.)
+ *    fp(w) = m - (sum_i (f_i - w) I(f_i > w)
+ *                 + sum_i (n + 1 - l_i - w) I(n + 1 - l_i > w)
+ *                 + sum_t (t - w) r(t) I(t > w)) / (n - w + 1)
+ *
+ * the three terms have the form sum_{x > w} (x - w) cnt(x), which only needs
+ * the count and the sum of x over x > w, so each histogram stores the count
+ * and the sum of the values in log buckets (128 linear sub-buckets per power
+ * of two), and fp(w) is exact when w + 1 is the lower bound of a bucket
+ *
+ * the LRU miss ratio at cache size fp(w) is fp(w + 1) - fp(w) (HOTL), the
+ * FIFO miss ratio is approximated by that of random eviction (the same under
+ * the independent reference model), each miss evicts an object with
+ * probability 1 / c, so an object survives t requests with probability
+ * exp(-t / T) where T = c / mr, and
+ *    mr = 1 - sum_t r(t) exp(-t / T) / n, c = T * mr
+ *
+ * the cache sizes are in objects
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
+#include "struct.h"
+
+namespace traceAnalyzer {
+
+class Footprint {
+ public:
+  Footprint() = default;
+  ~Footprint() = default;
+
+  void add_req(request_t *req);
+
+  /* add the last access of every object and compute the curves, n_req is
+   * the number of requests in the trace */
+  void finish(const std::vector<obj_partition_t> &partitions, int64_t n_req);
+
+  void dump(std::string &path_base);
+
+  void save(std::ostream &os) const;
+
+  void load(std::istream &is);
+
+  friend std::ostream &operator<<(std::ostream &os, const Footprint &fp);
+
+ private:
+  /* the count and the sum of the values in log buckets */
+  struct LogSumHistogram {
+    std::vector<uint64_t> cnt;
+    std::vector<uint64_t> sum;
+
+    void add(int64_t x);
+    void save(std::ostream &os) const;
+    void load(std::istream &is);
+  };
+
+  /* first access times, time from the last access to the end, reuse times */
+  LogSumHistogram first_;
+  LogSumHistogram last_;
+  LogSumHistogram reuse_;
+
+  int64_t n_req_ = 0;
+  int64_t n_obj_ = 0;
+
+  /* the window lengths and their footprint */
+  std::vector<int64_t> window_;
+  std::vector<double> fp_;
+
+  /* (cache size, miss ratio) */
+  std::vector<std::pair<double, double>> lru_mrc_;
+  std::vector<std::pair<double, double>> fifo_mrc_;
+
+  static int bucket_idx(int64_t x);
+  static int64_t bucket_lower_bound(int idx);
+};
+
+}  // namespace traceAnalyzer
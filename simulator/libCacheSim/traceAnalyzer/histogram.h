@@ -0,0 +1,256 @@
+#pragma once
+//
+// fixed-bucket histograms used by the analysis modules
+//
+// the modules map a request to an integer bucket (a log or linear bucket of
+// the reuse time, the exact size, the TTL...), the count of a bucket in
+// [min_key, min_key + max_dense) is stored in a dense array which grows on
+// demand, so the common path of add_req is a single indexed increment, the
+// rare buckets beyond the dense range go to an overflow map
+//
+// two histograms with the same min_key can be merged, e.g., when the
+// requests are split across partitions
+//
+// Histogram can be saved to and loaded from an analyzer checkpoint
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/libCacheSim/macro.h"
+#include "checkpoint.h"
+
+namespace traceAnalyzer {
+
+template <typename C = uint32_t>
+class Histogram {
+ public:
+  explicit Histogram(int64_t min_key = 0, int64_t max_dense = 1 << 20)
+      : min_key_(min_key), max_dense_(max_dense) {}
+
+  inline void incr(int64_t key, C n = 1) {
+    uint64_t idx = (uint64_t)(key - min_key_);
+    if (likely(idx < dense_.size())) {
+      n_key_ += dense_[idx] == 0;
+      dense_[idx] += n;
+      return;
+    }
+    incr_slow(key, n);
+  }
+
+  C get(int64_t key) const {
+    uint64_t idx = (uint64_t)(key - min_key_);
+    if (idx < dense_.size()) return dense_[idx];
+    auto it = overflow_.find(key);
+    return it == overflow_.end() ? 0 : it->second;
+  }
+
+  /* the number of buckets with a non-zero count */
+  size_t n_key() const { return n_key_; }
+
+  uint64_t sum() const {
+    uint64_t s = 0;
+    for (C c : dense_) s += c;
+    for (auto &p : overflow_) s += p.second;
+    return s;
+  }
+
+  void merge(const Histogram &other) {
+    if (other.dense_.size() > dense_.size()) dense_.resize(other.dense_.size());
+    /* a plain loop over two arrays, the compiler vectorizes it */
+    C *dst = dense_.data();
+    const C *src = other.dense_.data();
+    size_t n = other.dense_.size();
+    for (size_t i = 0; i < n; i++) dst[i] += src[i];
+    for (auto &p : other.overflow_) overflow_[p.first] += p.second;
+    recount();
+  }
+
+  /* call f(key, count) on every non-zero bucket in the order of the key */
+  template <typename F>
+  void for_each(F f) const {
+    std::vector<std::pair<int64_t, C>> sorted(overflow_.begin(),
+                                              overflow_.end());
+    std::sort(sorted.begin(), sorted.end());
+    /* overflow buckets are either below or above the dense range */
+    auto it = sorted.begin();
+    for (; it != sorted.end() && it->first < min_key_; ++it)
+      f(it->first, it->second);
+    for (size_t i = 0; i < dense_.size(); i++) {
+      if (dense_[i] != 0) f(min_key_ + (int64_t)i, dense_[i]);
+    }
+    for (; it != sorted.end(); ++it) f(it->first, it->second);
+  }
+
+  void clear() {
+    dense_.clear();
+    overflow_.clear();
+    n_key_ = 0;
+  }
+
+  void save(std::ostream &os) const {
+    ckpt_write_vec(os, dense_);
+    ckpt_write(os, (uint64_t)overflow_.size());
+    for (auto &p : overflow_) {
+      ckpt_write(os, p.first);
+      ckpt_write(os, p.second);
+    }
+  }
+
+  void load(std::istream &is) {
+    ckpt_read_vec(is, dense_);
+    uint64_t n;
+    ckpt_read(is, n);
+    overflow_.clear();
+    for (uint64_t i = 0; i < n; i++) {
+      int64_t key;
+      C c;
+      ckpt_read(is, key);
+      ckpt_read(is, c);
+      overflow_[key] = c;
+    }
+    recount();
+  }
+
+ private:
+  const int64_t min_key_;
+  const int64_t max_dense_;
+  std::vector<C> dense_;
+  std::unordered_map<int64_t, C> overflow_;
+  size_t n_key_ = 0;
+
+  void incr_slow(int64_t key, C n) {
+    int64_t idx = key - min_key_;
+    if (idx >= 0 && idx < max_dense_) {
+      /* grow geometrically so that the resize cost is amortized */
+      int64_t new_size = std::max(idx + 1, (int64_t)dense_.size() * 2);
+      dense_.resize(std::min(std::max(new_size, (int64_t)64), max_dense_), 0);
+      n_key_ += dense_[idx] == 0;
+      dense_[idx] += n;
+      return;
+    }
+    C &c = overflow_[key];
+    n_key_ += c == 0;
+    c += n;
+  }
+
+  void recount() {
+    n_key_ = overflow_.size();
+    for (C c : dense_) n_key_ += c != 0;
+  }
+};
+
+/* a histogram over (x, y) buckets, the dense part is a row-major grid of
+ * [min_x, min_x + max_dense_x) x [min_y, min_y + max_dense_y) that grows on
+ * demand */
+template <typename C = uint32_t>
+class Histogram2D {
+ public:
+  explicit Histogram2D(int64_t min_x = 0, int64_t min_y = 0,
+                       int64_t max_dense_x = 2048, int64_t max_dense_y = 2048)
+      : min_x_(min_x),
+        min_y_(min_y),
+        max_dense_x_(max_dense_x),
+        max_dense_y_(max_dense_y) {}
+
+  inline void incr(int64_t x, int64_t y, C n = 1) {
+    uint64_t ix = (uint64_t)(x - min_x_), iy = (uint64_t)(y - min_y_);
+    if (likely(ix < n_row_ && iy < n_col_)) {
+      dense_[ix * n_col_ + iy] += n;
+      return;
+    }
+    incr_slow(x, y, n);
+  }
+
+  C get(int64_t x, int64_t y) const {
+    uint64_t ix = (uint64_t)(x - min_x_), iy = (uint64_t)(y - min_y_);
+    if (ix < n_row_ && iy < n_col_) return dense_[ix * n_col_ + iy];
+    auto it = overflow_.find(pack(x, y));
+    return it == overflow_.end() ? 0 : it->second;
+  }
+
+  void merge(const Histogram2D &other) {
+    grow(other.n_row_, other.n_col_);
+    for (size_t i = 0; i < other.n_row_; i++) {
+      C *dst = &dense_[i * n_col_];
+      const C *src = &other.dense_[i * other.n_col_];
+      for (size_t j = 0; j < other.n_col_; j++) dst[j] += src[j];
+    }
+    for (auto &p : other.overflow_) overflow_[p.first] += p.second;
+  }
+
+  /* call f(x, y, count) on every non-zero bucket in the order of (x, y) */
+  template <typename F>
+  void for_each(F f) const {
+    std::vector<std::pair<std::pair<int64_t, int64_t>, C>> sorted;
+    sorted.reserve(overflow_.size());
+    for (auto &p : overflow_) sorted.push_back({unpack(p.first), p.second});
+    std::sort(sorted.begin(), sorted.end());
+
+    /* overflow buckets are outside the grid, interleave them by row */
+    auto it = sorted.begin();
+    for (size_t i = 0; i < n_row_; i++) {
+      int64_t x = min_x_ + (int64_t)i;
+      for (; it != sorted.end() && it->first.first < x; ++it)
+        f(it->first.first, it->first.second, it->second);
+      for (; it != sorted.end() && it->first.first == x &&
+             it->first.second < min_y_;
+           ++it)
+        f(x, it->first.second, it->second);
+      for (size_t j = 0; j < n_col_; j++) {
+        C c = dense_[i * n_col_ + j];
+        if (c != 0) f(x, min_y_ + (int64_t)j, c);
+      }
+    }
+    for (; it != sorted.end(); ++it)
+      f(it->first.first, it->first.second, it->second);
+  }
+
+ private:
+  const int64_t min_x_, min_y_;
+  const int64_t max_dense_x_, max_dense_y_;
+  size_t n_row_ = 0, n_col_ = 0;
+  std::vector<C> dense_;
+  std::unordered_map<uint64_t, C> overflow_;
+
+  static uint64_t pack(int64_t x, int64_t y) {
+    return ((uint64_t)(uint32_t)x << 32u) | (uint32_t)y;
+  }
+  static std::pair<int64_t, int64_t> unpack(uint64_t k) {
+    return {(int32_t)(k >> 32u), (int32_t)(k & 0xffffffffu)};
+  }
+
+  void grow(size_t n_row, size_t n_col) {
+    n_row = std::max(n_row, n_row_);
+    n_col = std::max(n_col, n_col_);
+    if (n_row == n_row_ && n_col == n_col_) return;
+    std::vector<C> dense(n_row * n_col, 0);
+    for (size_t i = 0; i < n_row_; i++) {
+      std::copy(&dense_[i * n_col_], &dense_[i * n_col_] + n_col_,
+                &dense[i * n_col]);
+    }
+    dense_.swap(dense);
+    n_row_ = n_row;
+    n_col_ = n_col;
+  }
+
+  void incr_slow(int64_t x, int64_t y, C n) {
+    int64_t ix = x - min_x_, iy = y - min_y_;
+    if (ix >= 0 && ix < max_dense_x_ && iy >= 0 && iy < max_dense_y_) {
+      auto new_dim = [](int64_t i, size_t cur, int64_t cap) {
+        if (i < (int64_t)cur) return cur;
+        int64_t n = std::max({i + 1, (int64_t)cur * 2, (int64_t)16});
+        return (size_t)std::min(n, cap);
+      };
+      grow(new_dim(ix, n_row_, max_dense_x_), new_dim(iy, n_col_, max_dense_y_));
+      dense_[ix * n_col_ + iy] += n;
+      return;
+    }
+    overflow_[pack(x, y)] += n;
+  }
+};
+
+}  // namespace traceAnalyzer
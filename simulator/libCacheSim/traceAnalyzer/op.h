@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 
 using namespace std;
 
@@ -52,6 +53,16 @@ class OpStat {
     return os;
   }
 
+  void save(ostream& os) const {
+    ckpt_write(os, op_cnt_);
+    ckpt_write(os, overwrite_cnt_);
+  }
+
+  void load(istream& is) {
+    ckpt_read(is, op_cnt_);
+    ckpt_read(is, overwrite_cnt_);
+  }
+
  private:
   uint64_t op_cnt_[OP_INVALID + 1] = {0}; /* the number of requests of an op */
   uint64_t overwrite_cnt_ = 0;
@@ -0,0 +1,136 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace traceAnalyzer {
+
+using namespace std;
+
+ReqBatchRing::ReqBatchRing(int n_consumer, int n_slot, int batch_size)
+    : batch_size_(batch_size),
+      n_slot_(n_slot),
+      n_consumer_(n_consumer),
+      slots_(n_slot),
+      slot_n_req_(n_slot, 0),
+      tails_(n_consumer, 0) {
+  for (int i = 0; i < n_slot_; i++) {
+    slots_[i] = new request_t[batch_size_];
+    memset(slots_[i], 0, sizeof(request_t) * batch_size_);
+  }
+}
+
+ReqBatchRing::~ReqBatchRing() {
+  for (auto slot : slots_) {
+    delete[] slot;
+  }
+}
+
+int64_t ReqBatchRing::min_tail() const {
+  return *min_element(tails_.cbegin(), tails_.cend());
+}
+
+request_t *ReqBatchRing::acquire(int ahead) {
+  unique_lock<mutex> lock(mtx_);
+  not_full_.wait(lock, [this, ahead]() {
+    return n_consumer_ == 0 || head_ + ahead - min_tail() < n_slot_;
+  });
+  return slots_[(head_ + ahead) % n_slot_];
+}
+
+void ReqBatchRing::publish(int n) {
+  {
+    lock_guard<mutex> lock(mtx_);
+    slot_n_req_[head_ % n_slot_] = n;
+    head_ += 1;
+  }
+  not_empty_.notify_all();
+}
+
+void ReqBatchRing::close() {
+  {
+    lock_guard<mutex> lock(mtx_);
+    closed_ = true;
+  }
+  not_empty_.notify_all();
+}
+
+bool ReqBatchRing::consume(int consumer_id, request_t **reqs, int *n) {
+  unique_lock<mutex> lock(mtx_);
+  int64_t seq = tails_[consumer_id];
+  not_empty_.wait(lock, [this, seq]() { return seq < head_ || closed_; });
+  if (seq == head_) {
+    /* closed and drained */
+    return false;
+  }
+
+  *reqs = slots_[seq % n_slot_];
+  *n = slot_n_req_[seq % n_slot_];
+  return true;
+}
+
+void ReqBatchRing::release(int consumer_id) {
+  bool was_slowest;
+  {
+    lock_guard<mutex> lock(mtx_);
+    was_slowest = tails_[consumer_id] == min_tail();
+    tails_[consumer_id] += 1;
+  }
+  /* only the slowest consumer can free a slot */
+  if (was_slowest) not_full_.notify_one();
+}
+
+WorkerGroup::WorkerGroup(int n_worker) : n_worker_(n_worker) {
+  for (int i = 0; i < n_worker_; i++) {
+    workers_.emplace_back(&WorkerGroup::work, this, i);
+  }
+}
+
+WorkerGroup::~WorkerGroup() {
+  {
+    lock_guard<mutex> lock(mtx_);
+    stopped_ = true;
+  }
+  start_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkerGroup::work(int worker_id) {
+  int64_t seen_generation = 0;
+  while (true) {
+    unique_lock<mutex> lock(mtx_);
+    start_.wait(lock, [this, seen_generation]() {
+      return generation_ != seen_generation || stopped_;
+    });
+    if (stopped_) return;
+    seen_generation = generation_;
+    lock.unlock();
+
+    job_(worker_id);
+
+    lock.lock();
+    if (--n_running_ == 0) {
+      lock.unlock();
+      done_.notify_one();
+    }
+  }
+}
+
+void WorkerGroup::dispatch(function<void(int)> job) {
+  {
+    lock_guard<mutex> lock(mtx_);
+    job_ = std::move(job);
+    n_running_ = n_worker_;
+    generation_ += 1;
+  }
+  start_.notify_all();
+}
+
+void WorkerGroup::wait() {
+  unique_lock<mutex> lock(mtx_);
+  done_.wait(lock, [this]() { return n_running_ == 0; });
+}
+
+}  // namespace traceAnalyzer
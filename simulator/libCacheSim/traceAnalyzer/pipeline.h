@@ -0,0 +1,115 @@
+#pragma once
+//
+// a broadcast ring of request batches that connects the enrichment stage of
+// the analyzer to the analysis modules
+//
+// the producer fills a batch of enriched requests and publishes it, every
+// consumer (one thread per module) reads every batch in order, a slot is
+// reused after all consumers have released it, so the slowest module
+// throttles the producer and the pipeline runs at the speed of the slowest
+// stage instead of the sum of all stages
+//
+// the enrichment stage itself can be split across a WorkerGroup, each worker
+// owns a hash partition of the objects and processes its requests of a
+// batch in order, so the per-object state is updated in the same order as
+// by a single thread
+//
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../include/libCacheSim/request.h"
+
+namespace traceAnalyzer {
+
+/* the number of requests in a batch and the number of batches in the ring */
+#define PIPELINE_BATCH_SIZE 4096
+#define PIPELINE_N_SLOT 16
+
+class ReqBatchRing {
+ public:
+  explicit ReqBatchRing(int n_consumer, int n_slot = PIPELINE_N_SLOT,
+                        int batch_size = PIPELINE_BATCH_SIZE);
+  ~ReqBatchRing();
+
+  /* producer, get the slot after the next ahead slots to fill, blocks until
+   * every consumer has released it, ahead < the number of slots */
+  request_t *acquire(int ahead = 0);
+  /* producer, publish the slot returned by acquire with n requests */
+  void publish(int n);
+  /* producer, no more batches, consumers return false once drained */
+  void close();
+
+  /* consumer, get the next batch, return false if the ring is closed and
+   * the consumer has read all batches */
+  bool consume(int consumer_id, request_t **reqs, int *n);
+  /* consumer, release the batch returned by consume */
+  void release(int consumer_id);
+
+  const int batch_size_;
+
+ private:
+  const int n_slot_;
+  const int n_consumer_;
+  std::vector<request_t *> slots_;
+  std::vector<int> slot_n_req_;
+
+  /* the number of published batches */
+  int64_t head_ = 0;
+  /* the number of batches each consumer has released */
+  std::vector<int64_t> tails_;
+  bool closed_ = false;
+
+  std::mutex mtx_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  int64_t min_tail() const;
+};
+
+/* a fixed set of threads that run one job at a time, with a barrier */
+class WorkerGroup {
+ public:
+  explicit WorkerGroup(int n_worker);
+  ~WorkerGroup();
+
+  /* start job(worker_id) on every worker and return */
+  void dispatch(std::function<void(int worker_id)> job);
+  /* wait until every worker has finished the dispatched job */
+  void wait();
+
+  const int n_worker_;
+
+ private:
+  std::vector<std::thread> workers_;
+  std::function<void(int)> job_;
+  /* incremented on every dispatch */
+  int64_t generation_ = 0;
+  int n_running_ = 0;
+  bool stopped_ = false;
+
+  std::mutex mtx_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+
+  void work(int worker_id);
+};
+
+/* a consumer that processes a batch of requests */
+typedef std::function<void(request_t *reqs, int n)> batch_consumer_t;
+
+/* wrap a module with add_req into a batch consumer, the module call is
+ * inlined in the loop, so there is one indirect call per batch */
+template <typename Module>
+static batch_consumer_t module_consumer(Module *module) {
+  return [module](request_t *reqs, int n) {
+    for (int i = 0; i < n; i++) {
+      module->add_req(&reqs[i]);
+    }
+  };
+}
+
+}  // namespace traceAnalyzer
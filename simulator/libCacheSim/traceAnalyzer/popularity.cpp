@@ -6,7 +6,7 @@
 #include <cmath>
 #include <fstream>
 #include <numeric>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 
 #include "struct.h"
@@ -15,8 +15,11 @@
 namespace traceAnalyzer {
 using namespace std;
 
+/* frequencies up to this are counted in the dense part of the histogram */
+#define FREQ_DENSE_MAX (1 << 16)
+
 void Popularity::dump(string &path_base) {
-  if (freq_vec_.empty()) {
+  if (freq_desc_.empty()) {
     assert(!has_run);
     ERROR("popularity has not been computed\n");
     return;
@@ -27,65 +30,85 @@ void Popularity::dump(string &path_base) {
   ofs << "# " << path_base << "\n";
   ofs << "# freq (sorted):cnt - for Zipf plot\n";
 
-  /* convert sorted freq list to freq:cnt list sorted by freq (to save some
-   * space) */
-  uint32_t last_freq = freq_vec_[0];
-  uint32_t freq_cnt = 0;
-  for (auto &cnt : freq_vec_) {
-    if (cnt == last_freq) {
-      freq_cnt += 1;
-    } else {
-      ofs << last_freq << ":" << freq_cnt << "\n";
-      freq_cnt = 1;
-      last_freq = cnt;
-    }
+  for (const auto &p : freq_desc_) {
+    ofs << p.first << ":" << p.second << "\n";
   }
-  ofs << last_freq << ":" << freq_cnt << "\n";
   ofs.close();
 }
 
-void Popularity::run(obj_info_map_type &obj_map) {
-  /* freq_vec_ is a sorted vec of obj frequency */
-  freq_vec_.reserve(obj_map.size());
-  for (const auto &p : obj_map) {
-    freq_vec_.push_back(p.second.freq);
+vector<uint32_t> Popularity::get_top_freq(int n) const {
+  vector<uint32_t> top;
+  top.reserve(n);
+  for (const auto &p : freq_desc_) {
+    for (uint64_t i = 0; i < p.second && (int)top.size() < n; i++) {
+      top.push_back(p.first);
+    }
+    if ((int)top.size() == n) break;
+  }
+  top.resize(n, 0);
+  return top;
+}
+
+void Popularity::run(const std::vector<obj_partition_t> &partitions) {
+  /* count the objects of each frequency, one thread per partition, the
+   * number of distinct frequencies is small even for a large trace */
+  vector<Histogram<uint64_t>> partition_freq_cnt(
+      partitions.size(), Histogram<uint64_t>(1, FREQ_DENSE_MAX));
+  vector<thread> threads;
+  for (size_t i = 0; i < partitions.size(); i++) {
+    threads.emplace_back([&partitions, &partition_freq_cnt, i]() {
+      for (const auto &p : partitions[i].obj_map) {
+        partition_freq_cnt[i].incr(p.second.freq);
+      }
+    });
   }
-  sort(freq_vec_.begin(), freq_vec_.end(), greater<>());
+  for (auto &t : threads) t.join();
 
-  if (obj_map.size() < 200) {
-    fit_fail_reason_ = "popularity: too few objects (" +
-                       to_string(obj_map.size()) +
+  Histogram<uint64_t> freq_cnt(1, FREQ_DENSE_MAX);
+  for (const auto &h : partition_freq_cnt) freq_cnt.merge(h);
+  freq_cnt.for_each([this](int64_t freq, uint64_t cnt) {
+    freq_desc_.emplace_back((uint32_t)freq, cnt);
+    n_obj_ += cnt;
+  });
+  reverse(freq_desc_.begin(), freq_desc_.end());
+
+  if (n_obj_ < 200) {
+    fit_fail_reason_ = "popularity: too few objects (" + to_string(n_obj_) +
                        "), skip the popularity computation";
     WARN("%s\n", fit_fail_reason_.c_str());
     return;
   }
 
-  if (freq_vec_[0] < 200) {
+  if (freq_desc_[0].first < 200) {
     fit_fail_reason_ = "popularity: the most popular object has " +
-                       to_string(freq_vec_[0]) + " requests ";
+                       to_string(freq_desc_[0].first) + " requests ";
     WARN("%s\n", fit_fail_reason_.c_str());
   }
 
-  /* calculate Zipf alpha using linear regression */
-  vector<double> log_freq(obj_map.size());
-  vector<double> log_rank(obj_map.size());
-
-  int i = 0;
-  for_each(log_freq.begin(), log_freq.end(),
-           [&](double &item) { item = log(freq_vec_[i++]); });
-  i = 0;
-  for_each(log_rank.begin(), log_rank.end(), [&](double &item) {
-    ++i;
-    item = log(i);
-  });
+  /* calculate Zipf alpha using linear regression of log(freq) on log(rank),
+   * the objects with the same freq take consecutive ranks, so the sums are
+   * accumulated per freq */
+  double s_x = 0, s_y = 0, s_xx = 0, s_xy = 0;
+  uint64_t rank = 0;
+  for (const auto &p : freq_desc_) {
+    double log_freq = log(p.first);
+    double s_log_rank = 0, s_log_rank2 = 0;
+    for (uint64_t i = 0; i < p.second; i++) {
+      double log_rank = log(++rank);
+      s_log_rank += log_rank;
+      s_log_rank2 += log_rank * log_rank;
+    }
+    s_x += s_log_rank;
+    s_xx += s_log_rank2;
+    s_y += (double)p.second * log_freq;
+    s_xy += log_freq * s_log_rank;
+  }
 
   /* TODO: a better linear regression with intercept and R2 */
-  slope_ = -PopularityUtils::slope(log_rank, log_freq);
+  double n = (double)n_obj_;
+  slope_ = -(n * s_xy - s_x * s_y) / (n * s_xx - s_x * s_x);
 
   has_run = true;
 }
 
-vector<uint32_t> freq_vec_{};
-double slope_, intercept_, r2_;
-bool has_run = false;
 };  // namespace traceAnalyzer
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/logging.h"
+#include "histogram.h"
 #include "struct.h"
 #include "utils/include/linReg.h"
 
@@ -34,11 +35,13 @@ class Popularity {
   Popularity() { has_run = false; };
   ~Popularity() = default;
 
-  explicit Popularity(obj_info_map_type &obj_map) { run(obj_map); };
+  explicit Popularity(const std::vector<obj_partition_t> &partitions) {
+    run(partitions);
+  };
 
   friend std::ostream &operator<<(std::ostream &os,
                                   const Popularity &popularity) {
-    if (popularity.freq_vec_.empty()) {
+    if (popularity.freq_desc_.empty()) {
       ERROR("popularity has not been computed\n");
       return os;
     }
@@ -54,16 +57,20 @@ class Popularity {
     return os;
   }
 
-  std::vector<uint32_t> &get_sorted_freq() { return freq_vec_; }
+  /* the frequency of the n most popular objects, 0 if fewer objects */
+  std::vector<uint32_t> get_top_freq(int n) const;
 
   void dump(std::string &path_base);
 
   std::string fit_fail_reason_ = "";
 
  private:
-  void run(obj_info_map_type &obj_map);
+  void run(const std::vector<obj_partition_t> &partitions);
 
-  std::vector<uint32_t> freq_vec_{};
+  /* (freq, the number of objects with the freq) in descending freq, this is
+   * the rank-frequency curve with ties collapsed */
+  std::vector<std::pair<uint32_t, uint64_t>> freq_desc_{};
+  uint64_t n_obj_ = 0;
   double slope_ = -1, intercept_ = -1, r2_ = -1;
   bool has_run = false;
 };
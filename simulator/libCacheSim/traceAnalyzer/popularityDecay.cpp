@@ -8,20 +8,25 @@
 namespace traceAnalyzer {
 using namespace std;
 
-void PopularityDecay::turn_on_stream_dump(string &path_base) {
+void PopularityDecay::turn_on_stream_dump(string &path_base, bool resume) {
+  auto mode = resume ? ios::out | ios::app : ios::out | ios::trunc;
 #ifdef USE_REQ_METRIC
   stream_dump_req_ofs.open(
       path_base + ".popularityDecay_w" + to_string(time_window_) + "_req",
-      ios::out | ios::trunc);
-  stream_dump_req_ofs << "# " << path_base << "\n";
-  stream_dump_req_ofs
-      << "# req_cnt for new object in prev N windows (time window "
-      << time_window_ << ")\n";
+      mode);
+  if (!resume) {
+    stream_dump_req_ofs << "# " << path_base << "\n";
+    stream_dump_req_ofs
+        << "# req_cnt for new object in prev N windows (time window "
+        << time_window_ << ")\n";
+  }
 #endif
 
   stream_dump_obj_ofs.open(
       path_base + ".popularityDecay_w" + to_string(time_window_) + "_obj",
-      ios::out | ios::trunc);
+      mode);
+  if (resume) return;
+
   stream_dump_obj_ofs << "# " << path_base << "\n";
   stream_dump_obj_ofs
       << "# obj_cnt for new object in prev N windows (time window "
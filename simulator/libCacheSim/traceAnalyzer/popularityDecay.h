@@ -37,6 +37,7 @@
 
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 #include "struct.h"
 
 // #define USE_REQ_METRIC 1
@@ -49,13 +50,14 @@ class PopularityDecay {
   int warmup_rtime_;
   int time_window_;
 
+  /* resume appends to the per-window output of the checkpointed run */
   PopularityDecay(std::string &path_base, int time_window = 300,
-                  int warmup_rtime = 7200)
+                  int warmup_rtime = 7200, bool resume = false)
       : time_window_(time_window), warmup_rtime_(warmup_rtime) {
     n_req_per_window.resize(1, 0);
     n_obj_per_window.resize(1, 0);
     idx_shift = (int)((double)warmup_rtime / time_window);
-    turn_on_stream_dump(path_base);
+    turn_on_stream_dump(path_base, resume);
   };
 
   ~PopularityDecay() {
@@ -65,7 +67,7 @@ class PopularityDecay {
     stream_dump_obj_ofs.close();
   }
 
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool resume);
 
   void add_req(const request_t *req);
 
@@ -73,6 +75,18 @@ class PopularityDecay {
 
   void dump(std::string &path_base) { ; }
 
+  void save(std::ostream &os) const {
+    ckpt_write(os, next_window_ts_);
+    ckpt_write_vec(os, n_req_per_window);
+    ckpt_write_vec(os, n_obj_per_window);
+  }
+
+  void load(std::istream &is) {
+    ckpt_read(is, next_window_ts_);
+    ckpt_read_vec(is, n_req_per_window);
+    ckpt_read_vec(is, n_obj_per_window);
+  }
+
  private:
   int64_t next_window_ts_ = -1;
   /** how many of requests (objects) in current window are requesting objects
@@ -12,18 +12,8 @@ void ReqRate::add_req(request_t *req) {
 
   assert(next_window_ts_ != -1);
 
-  window_n_req_ += 1;
-  window_n_byte_ += req->obj_size;
-  if (req->first_seen_in_window) window_n_obj_ += 1;
-
-  //    if (window_seen_obj_.find(req->obj_id) == window_seen_obj_.end()) {
-  //      window_seen_obj_.insert(req->obj_id);
-  //    }
-
-  if (req->compulsory_miss) {
-    window_compulsory_miss_obj_ += 1;
-  }
-
+  /* close the windows before the request, so the request is counted in the
+   * same window as the other modules */
   while (req->clock_time >= next_window_ts_) {
     req_rate_.push_back(window_n_req_);
     byte_rate_.push_back(window_n_byte_);
@@ -36,6 +26,51 @@ void ReqRate::add_req(request_t *req) {
     //      window_seen_obj_.clear();
     next_window_ts_ += time_window_;
   }
+
+  window_n_req_ += 1;
+  window_n_byte_ += req->obj_size;
+  if (req->first_seen_in_window) window_n_obj_ += 1;
+
+  //    if (window_seen_obj_.find(req->obj_id) == window_seen_obj_.end()) {
+  //      window_seen_obj_.insert(req->obj_id);
+  //    }
+
+  if (req->compulsory_miss) {
+    window_compulsory_miss_obj_ += 1;
+  }
+}
+
+void ReqRate::add_window(uint32_t n_req, uint64_t n_byte, uint32_t n_obj,
+                         uint32_t n_first_seen_obj) {
+  req_rate_.push_back(n_req);
+  byte_rate_.push_back(n_byte);
+  obj_rate_.push_back(n_obj);
+  first_seen_obj_rate_.push_back(n_first_seen_obj);
+  obj_estimated_ = true;
+}
+
+void ReqRate::save(ostream &os) const {
+  ckpt_write(os, next_window_ts_);
+  ckpt_write(os, window_n_req_);
+  ckpt_write(os, window_n_byte_);
+  ckpt_write(os, window_n_obj_);
+  ckpt_write(os, window_compulsory_miss_obj_);
+  ckpt_write_vec(os, req_rate_);
+  ckpt_write_vec(os, byte_rate_);
+  ckpt_write_vec(os, obj_rate_);
+  ckpt_write_vec(os, first_seen_obj_rate_);
+}
+
+void ReqRate::load(istream &is) {
+  ckpt_read(is, next_window_ts_);
+  ckpt_read(is, window_n_req_);
+  ckpt_read(is, window_n_byte_);
+  ckpt_read(is, window_n_obj_);
+  ckpt_read(is, window_compulsory_miss_obj_);
+  ckpt_read_vec(is, req_rate_);
+  ckpt_read_vec(is, byte_rate_);
+  ckpt_read_vec(is, obj_rate_);
+  ckpt_read_vec(is, first_seen_obj_rate_);
 }
 
 void ReqRate::dump(const string &path_base) {
@@ -54,14 +89,16 @@ void ReqRate::dump(const string &path_base) {
   }
   ofs << "\n";
 
-  ofs << "# obj rate - time window " << time_window_ << " second\n";
+  const char *estimated = obj_estimated_ ? " (estimated)" : "";
+  ofs << "# obj rate - time window " << time_window_ << " second" << estimated
+      << "\n";
   for (auto &n_obj : obj_rate_) {
     ofs << n_obj / time_window_ << ",";
   }
   ofs << "\n";
 
   ofs << "# first seen obj (cold miss) rate - time window " << time_window_
-      << " second\n";
+      << " second" << estimated << "\n";
   for (auto &n_obj : first_seen_obj_rate_) {
     ofs << n_obj / time_window_ << ",";
   }
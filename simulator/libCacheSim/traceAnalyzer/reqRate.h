@@ -8,6 +8,7 @@
 
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/request.h"
+#include "checkpoint.h"
 
 namespace traceAnalyzer {
 
@@ -19,8 +20,17 @@ class ReqRate {
 
   void add_req(request_t *req);
 
+  /* add a closed window counted elsewhere, used in sketch mode, where the
+   * number of objects in a window is estimated */
+  void add_window(uint32_t n_req, uint64_t n_byte, uint32_t n_obj,
+                  uint32_t n_first_seen_obj);
+
   void dump(const std::string &path_base);
 
+  void save(std::ostream &os) const;
+
+  void load(std::istream &is);
+
   friend std::ostream &operator<<(std::ostream &os, const ReqRate &rr) {
     if (rr.req_rate_.size() < 10) {
       WARN("request rate not enough window (%zu window)\n",
@@ -42,8 +52,10 @@ class ReqRate {
     min =
         (double)*std::min_element(rr.obj_rate_.cbegin(), rr.obj_rate_.cend()) /
         rr.time_window_;
-    os << std::fixed << "object rate min " << min << " obj/s, max " << max
-       << " obj/s, window " << rr.time_window_ << "s\n";
+    os << std::fixed << "object rate "
+       << (rr.obj_estimated_ ? "(estimated) " : "") << "min " << min
+       << " obj/s, max " << max << " obj/s, window " << rr.time_window_
+       << "s\n";
 
     return os;
   }
@@ -66,5 +78,7 @@ class ReqRate {
   std::vector<uint32_t> obj_rate_{};
   /* used to calculate cold miss ratio over time */
   std::vector<uint32_t> first_seen_obj_rate_{};
+  /* the object rates are estimated by a sketch */
+  bool obj_estimated_ = false;
 };
 }  // namespace traceAnalyzer
\ No newline at end of file
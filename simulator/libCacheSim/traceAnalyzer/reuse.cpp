@@ -20,8 +20,8 @@ void ReuseDistribution::add_req(request_t *req) {
   }
 
   if (req->rtime_since_last_access < 0) {
-    reuse_rtime_req_cnt_[-1] += 1;
-    reuse_vtime_req_cnt_[-1] += 1;
+    reuse_rtime_req_cnt_.incr(-1);
+    reuse_vtime_req_cnt_.incr(-1);
 
     return;
   }
@@ -29,8 +29,8 @@ void ReuseDistribution::add_req(request_t *req) {
   int pos_rt = (int)(req->rtime_since_last_access / rtime_granularity_);
   int pos_vt = (int)(log(double(req->vtime_since_last_access)) / log_log_base_);
 
-  reuse_rtime_req_cnt_[pos_rt] += 1;
-  reuse_vtime_req_cnt_[pos_vt] += 1;
+  reuse_rtime_req_cnt_.incr(pos_rt);
+  reuse_vtime_req_cnt_.incr(pos_vt);
 
   //    switch (req->op) {
   //      case OP_GET:
@@ -68,14 +68,12 @@ void ReuseDistribution::dump(string &path_base) {
   ofs << "# " << path_base << "\n";
   ofs << "# reuse real time: freq (time granularity " << rtime_granularity_
       << ")\n";
-  for (auto &p : reuse_rtime_req_cnt_) {
-    ofs << p.first << ":" << p.second << "\n";
-  }
+  reuse_rtime_req_cnt_.for_each(
+      [&ofs](int64_t pos, uint32_t cnt) { ofs << pos << ":" << cnt << "\n"; });
 
   ofs << "# reuse virtual time: freq (log base " << log_base_ << ")\n";
-  for (auto &p : reuse_vtime_req_cnt_) {
-    ofs << p.first << ":" << p.second << "\n";
-  }
+  reuse_vtime_req_cnt_.for_each(
+      [&ofs](int64_t pos, uint32_t cnt) { ofs << pos << ":" << cnt << "\n"; });
   ofs.close();
 
   //    if (std::accumulate(reuse_rtime_req_cnt_read_.begin(),
@@ -88,19 +86,37 @@ void ReuseDistribution::dump(string &path_base) {
   //    rtime_granularity_ << ")\n";
 }
 
-void ReuseDistribution::turn_on_stream_dump(string &path_base) {
+void ReuseDistribution::save(ostream &os) const {
+  reuse_rtime_req_cnt_.save(os);
+  reuse_vtime_req_cnt_.save(os);
+  ckpt_write(os, next_window_ts_);
+  ckpt_write_vec(os, window_reuse_rtime_req_cnt_);
+  ckpt_write_vec(os, window_reuse_vtime_req_cnt_);
+}
+
+void ReuseDistribution::load(istream &is) {
+  reuse_rtime_req_cnt_.load(is);
+  reuse_vtime_req_cnt_.load(is);
+  ckpt_read(is, next_window_ts_);
+  ckpt_read_vec(is, window_reuse_rtime_req_cnt_);
+  ckpt_read_vec(is, window_reuse_vtime_req_cnt_);
+}
+
+void ReuseDistribution::turn_on_stream_dump(string &path_base, bool resume) {
   stream_dump_rt_ofs.open(
       path_base + ".reuseWindow_w" + to_string(time_window_) + "_rt",
-      ios::out | ios::trunc);
+      resume ? ios::out | ios::app : ios::out | ios::trunc);
+  stream_dump_vt_ofs.open(
+      path_base + ".reuseWindow_w" + to_string(time_window_) + "_vt",
+      resume ? ios::out | ios::app : ios::out | ios::trunc);
+  if (resume) return;
+
   stream_dump_rt_ofs << "# " << path_base << "\n";
   stream_dump_rt_ofs
       << "# reuse real time distribution per window (time granularity ";
   stream_dump_rt_ofs << rtime_granularity_ << ", time window " << time_window_
                      << ")\n";
 
-  stream_dump_vt_ofs.open(
-      path_base + ".reuseWindow_w" + to_string(time_window_) + "_vt",
-      ios::out | ios::trunc);
   stream_dump_vt_ofs << "# " << path_base << "\n";
   stream_dump_vt_ofs
       << "# reuse virtual time distribution per window (log base " << log_base_;
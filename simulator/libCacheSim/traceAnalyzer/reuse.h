@@ -9,19 +9,21 @@
 #include <vector>
 
 #include "../include/libCacheSim/reader.h"
+#include "histogram.h"
 #include "struct.h"
 #include "utils/include/utils.h"
 
 namespace traceAnalyzer {
 class ReuseDistribution {
  public:
+  /* resume appends to the per-window output of the checkpointed run */
   explicit ReuseDistribution(std::string output_path, int time_window = 300,
-                             int rtime_granularity = 5,
+                             bool resume = false, int rtime_granularity = 5,
                              int vtime_granularity = 1000)
       : time_window_(time_window),
         rtime_granularity_(rtime_granularity),
         vtime_granularity_(vtime_granularity) {
-    turn_on_stream_dump(output_path);
+    turn_on_stream_dump(output_path, resume);
   };
 
   ~ReuseDistribution() {
@@ -33,14 +35,20 @@ class ReuseDistribution {
 
   void dump(std::string &path_base);
 
- private:
-  /* request count for reuse rtime/vtime */
-  std::unordered_map<int32_t, uint32_t> reuse_rtime_req_cnt_;
-  std::unordered_map<int32_t, uint32_t> reuse_vtime_req_cnt_;
+  void save(std::ostream &os) const;
+
+  void load(std::istream &is);
 
-  std::unordered_map<int32_t, uint32_t> reuse_rtime_req_cnt_read_;
-  std::unordered_map<int32_t, uint32_t> reuse_rtime_req_cnt_write_;
-  std::unordered_map<int32_t, uint32_t> reuse_rtime_req_cnt_delete_;
+  /* add the whole-trace counts of another instance */
+  void merge(const ReuseDistribution &other) {
+    reuse_rtime_req_cnt_.merge(other.reuse_rtime_req_cnt_);
+    reuse_vtime_req_cnt_.merge(other.reuse_vtime_req_cnt_);
+  }
+
+ private:
+  /* request count for reuse rtime/vtime, bucket -1 is the first access */
+  Histogram<uint32_t> reuse_rtime_req_cnt_{-1};
+  Histogram<uint32_t> reuse_vtime_req_cnt_{-1};
 
   /* used to plot reuse distribution heatmap */
   const double log_base_ = 1.5;
@@ -56,7 +64,7 @@ class ReuseDistribution {
   std::ofstream stream_dump_rt_ofs;
   std::ofstream stream_dump_vt_ofs;
 
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool resume);
 
   void stream_dump_window_reuse_distribution();
 };
@@ -15,11 +15,11 @@ void SizeDistribution::add_req(request_t *req) {
   }
 
   /* request count */
-  obj_size_req_cnt_[req->obj_size] += 1;
+  obj_size_req_cnt_.incr(req->obj_size);
 
   /* object count */
   if (req->compulsory_miss) {
-    obj_size_obj_cnt_[req->obj_size] += 1;
+    obj_size_obj_cnt_.incr(req->obj_size);
   }
 
   if (time_window_ <= 0) return;
@@ -59,28 +59,44 @@ void SizeDistribution::dump(string &path_base) {
   ofstream ofs(path_base + ".size", ios::out | ios::trunc);
   ofs << "# " << path_base << "\n";
   ofs << "# object_size: req_cnt\n";
-  for (auto &p : obj_size_req_cnt_) {
-    ofs << p.first << ":" << p.second << "\n";
-  }
+  obj_size_req_cnt_.for_each(
+      [&ofs](int64_t sz, uint32_t cnt) { ofs << sz << ":" << cnt << "\n"; });
 
   ofs << "# object_size: obj_cnt\n";
-  for (auto &p : obj_size_obj_cnt_) {
-    ofs << p.first << ":" << p.second << "\n";
-  }
+  obj_size_obj_cnt_.for_each(
+      [&ofs](int64_t sz, uint32_t cnt) { ofs << sz << ":" << cnt << "\n"; });
   ofs.close();
 }
 
-void SizeDistribution::turn_on_stream_dump(string &path_base) {
+void SizeDistribution::save(ostream &os) const {
+  obj_size_req_cnt_.save(os);
+  obj_size_obj_cnt_.save(os);
+  ckpt_write(os, next_window_ts_);
+  ckpt_write_vec(os, window_obj_size_req_cnt_);
+  ckpt_write_vec(os, window_obj_size_obj_cnt_);
+}
+
+void SizeDistribution::load(istream &is) {
+  obj_size_req_cnt_.load(is);
+  obj_size_obj_cnt_.load(is);
+  ckpt_read(is, next_window_ts_);
+  ckpt_read_vec(is, window_obj_size_req_cnt_);
+  ckpt_read_vec(is, window_obj_size_obj_cnt_);
+}
+
+void SizeDistribution::turn_on_stream_dump(string &path_base, bool resume) {
   ofs_stream_req.open(
       path_base + ".sizeWindow_w" + to_string(time_window_) + "_req",
-      ios::out | ios::trunc);
+      resume ? ios::out | ios::app : ios::out | ios::trunc);
+  ofs_stream_obj.open(
+      path_base + ".sizeWindow_w" + to_string(time_window_) + "_obj",
+      resume ? ios::out | ios::app : ios::out | ios::trunc);
+  if (resume) return;
+
   ofs_stream_req << "# " << path_base << "\n";
   ofs_stream_req << "# object_size: req_cnt (time window " << time_window_
                  << ", log_base " << LOG_BASE << ", size_base " << 1 << ")\n";
 
-  ofs_stream_obj.open(
-      path_base + ".sizeWindow_w" + to_string(time_window_) + "_obj",
-      ios::out | ios::trunc);
   ofs_stream_obj << "# " << path_base << "\n";
   ofs_stream_obj << "# object_size: obj_cnt (time window " << time_window_
                  << ", log_base " << LOG_BASE << ", size_base " << 1 << ")\n";
@@ -10,6 +10,7 @@
 
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/reader.h"
+#include "histogram.h"
 #include "struct.h"
 
 namespace traceAnalyzer {
@@ -23,12 +24,11 @@ class SizeDistribution {
    */
  public:
   SizeDistribution() = default;
-  explicit SizeDistribution(std::string &output_path, int time_window)
+  /* resume appends to the per-window output of the checkpointed run */
+  explicit SizeDistribution(std::string &output_path, int time_window,
+                            bool resume = false)
       : time_window_(time_window) {
-    obj_size_req_cnt_.reserve(1e6);
-    obj_size_obj_cnt_.reserve(1e6);
-
-    turn_on_stream_dump(output_path);
+    turn_on_stream_dump(output_path, resume);
   };
 
   ~SizeDistribution() {
@@ -40,10 +40,21 @@ class SizeDistribution {
 
   void dump(std::string &path_base);
 
+  /* add the whole-trace counts of another instance */
+  void merge(const SizeDistribution &other) {
+    obj_size_req_cnt_.merge(other.obj_size_req_cnt_);
+    obj_size_obj_cnt_.merge(other.obj_size_obj_cnt_);
+  }
+
+  void save(std::ostream &os) const;
+
+  void load(std::istream &is);
+
  private:
-  /* request/object count of certain size, size->count */
-  std::unordered_map<obj_size_t, uint32_t> obj_size_req_cnt_;
-  std::unordered_map<obj_size_t, uint32_t> obj_size_obj_cnt_;
+  /* request/object count of certain size, size->count, sizes up to 1 MiB
+   * are counted in the dense part */
+  Histogram<uint32_t> obj_size_req_cnt_{0};
+  Histogram<uint32_t> obj_size_obj_cnt_{0};
 
   /* used to plot size distribution heatmap */
   const double LOG_BASE = 1.5;
@@ -57,7 +68,7 @@ class SizeDistribution {
   std::ofstream ofs_stream_req;
   std::ofstream ofs_stream_obj;
 
-  void turn_on_stream_dump(std::string &path_base);
+  void turn_on_stream_dump(std::string &path_base, bool resume);
 
   void stream_dump();
 };
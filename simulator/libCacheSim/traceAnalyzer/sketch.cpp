@@ -0,0 +1,290 @@
+#include "sketch.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace traceAnalyzer {
+
+using namespace std;
+
+double HyperLogLog::estimate() const {
+  double m = (double)registers_.size();
+  double alpha = 0.7213 / (1.0 + 1.079 / m);
+  double sum = 0;
+  int n_zero = 0;
+  for (uint8_t r : registers_) {
+    sum += ldexp(1.0, -(int)r);
+    n_zero += r == 0;
+  }
+  double est = alpha * m * m / sum;
+  if (est <= 2.5 * m && n_zero > 0) {
+    /* linear counting for small cardinalities */
+    est = m * log(m / n_zero);
+  }
+  return est;
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i] = max(registers_[i], other.registers_[i]);
+  }
+}
+
+double HyperLogLog::rel_error() const {
+  return 1.04 / sqrt((double)registers_.size());
+}
+
+void SpaceSaving::swap_counter(size_t i, size_t j) {
+  swap(heap_[i], heap_[j]);
+  pos_[heap_[i].obj_id] = (uint32_t)i;
+  pos_[heap_[j].obj_id] = (uint32_t)j;
+}
+
+void SpaceSaving::sift_down(size_t i) {
+  while (true) {
+    size_t smallest = i, l = 2 * i + 1, r = 2 * i + 2;
+    if (l < heap_.size() && heap_[l].cnt < heap_[smallest].cnt) smallest = l;
+    if (r < heap_.size() && heap_[r].cnt < heap_[smallest].cnt) smallest = r;
+    if (smallest == i) return;
+    swap_counter(i, smallest);
+    i = smallest;
+  }
+}
+
+void SpaceSaving::add(obj_id_t obj_id) {
+  auto it = pos_.find(obj_id);
+  if (it != pos_.end()) {
+    uint32_t i = it->second;
+    heap_[i].cnt += 1;
+    sift_down(i);
+    return;
+  }
+
+  if (heap_.size() < k_) {
+    /* a new counter of 1 is never larger than its parent */
+    heap_.push_back({obj_id, 1});
+    pos_[obj_id] = (uint32_t)(heap_.size() - 1);
+    size_t i = heap_.size() - 1;
+    while (i > 0 && heap_[(i - 1) / 2].cnt > heap_[i].cnt) {
+      swap_counter(i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+    return;
+  }
+
+  /* replace the smallest counter, the new object inherits its count */
+  pos_.erase(heap_[0].obj_id);
+  max_error_ = heap_[0].cnt;
+  heap_[0].obj_id = obj_id;
+  heap_[0].cnt += 1;
+  pos_[obj_id] = 0;
+  sift_down(0);
+}
+
+void SpaceSaving::merge(const SpaceSaving &other) {
+  for (const auto &c : other.heap_) {
+    heap_.push_back(c);
+    pos_[c.obj_id] = (uint32_t)(heap_.size() - 1);
+  }
+  k_ += other.k_;
+  for (size_t i = heap_.size() / 2; i-- > 0;) sift_down(i);
+  /* each object is only counted in one sketch */
+  max_error_ = max(max_error_, other.max_error_);
+}
+
+vector<uint64_t> SpaceSaving::top(int n) const {
+  vector<uint64_t> cnt;
+  cnt.reserve(heap_.size());
+  for (const auto &c : heap_) cnt.push_back(c.cnt);
+  sort(cnt.begin(), cnt.end(), greater<uint64_t>());
+  cnt.resize(n, 0);
+  return cnt;
+}
+
+size_t KllSketch::capacity(size_t level) const {
+  /* lower levels get geometrically smaller compactors */
+  size_t depth = levels_.size() - 1 - level;
+  return max((size_t)8, (size_t)ceil(k_ * pow(2.0 / 3.0, (double)depth)));
+}
+
+void KllSketch::compress() {
+  for (size_t h = 0; h < levels_.size(); h++) {
+    if (levels_[h].size() < capacity(h)) continue;
+    if (h + 1 == levels_.size()) levels_.emplace_back();
+
+    vector<double> &level = levels_[h];
+    sort(level.begin(), level.end());
+    /* keep one item if the level has an odd number of items */
+    double kept = 0;
+    bool keep = level.size() % 2 == 1;
+    if (keep) {
+      kept = level.back();
+      level.pop_back();
+    }
+
+    /* promote every other item with a random offset */
+    rng_ ^= rng_ << 13u;
+    rng_ ^= rng_ >> 7u;
+    rng_ ^= rng_ << 17u;
+    size_t offset = rng_ & 1u;
+    for (size_t i = offset; i < level.size(); i += 2) {
+      levels_[h + 1].push_back(level[i]);
+    }
+    level.clear();
+    if (keep) level.push_back(kept);
+  }
+}
+
+void KllSketch::merge(const KllSketch &other) {
+  while (levels_.size() < other.levels_.size()) levels_.emplace_back();
+  for (size_t h = 0; h < other.levels_.size(); h++) {
+    levels_[h].insert(levels_[h].end(), other.levels_[h].begin(),
+                      other.levels_[h].end());
+  }
+  n_ += other.n_;
+  compress();
+}
+
+double KllSketch::quantile(double q) const {
+  vector<pair<double, uint64_t>> items;
+  uint64_t total_weight = 0;
+  for (size_t h = 0; h < levels_.size(); h++) {
+    for (double v : levels_[h]) {
+      items.emplace_back(v, 1ULL << h);
+      total_weight += 1ULL << h;
+    }
+  }
+  if (items.empty()) return 0;
+
+  sort(items.begin(), items.end());
+  uint64_t target = (uint64_t)(q * (double)total_weight);
+  uint64_t cum = 0;
+  for (auto &item : items) {
+    cum += item.second;
+    if (cum > target) return item.first;
+  }
+  return items.back().first;
+}
+
+double KllSketch::rank_error() const { return 2.296 / pow(k_, 0.9723); }
+
+void SketchStat::add_req(const request_t *req) {
+  uint64_t hash = sketch_hash(req->obj_id, HLL_HASH_SEED);
+
+  int64_t window_idx = (int64_t)req->clock_time / time_window_;
+  if (window_idx != window_idx_) {
+    finish();
+    wss_.resize(window_idx, 0);
+    new_obj_.resize(window_idx, 0);
+    window_idx_ = window_idx;
+  }
+  n_obj_.add(hash);
+  window_n_obj_.add(hash);
+
+  if ((int64_t)window_n_req_.size() <= window_idx) {
+    window_n_req_.resize(window_idx + 1, 0);
+    window_n_byte_.resize(window_idx + 1, 0);
+  }
+  window_n_req_[window_idx] += 1;
+  window_n_byte_[window_idx] += req->obj_size;
+
+  top_.add(req->obj_id);
+  size_.add((double)req->obj_size);
+  if (req->ttl > 0) ttl_.add((double)req->ttl);
+}
+
+void SketchStat::finish() {
+  if ((int64_t)wss_.size() <= window_idx_) wss_.resize(window_idx_ + 1, 0);
+  wss_[window_idx_] += window_n_obj_.estimate();
+  window_n_obj_.clear();
+
+  /* the objects first seen in the window grow the trace-wide estimate */
+  if ((int64_t)new_obj_.size() <= window_idx_) {
+    new_obj_.resize(window_idx_ + 1, 0);
+  }
+  double n_obj = n_obj_.estimate();
+  new_obj_[window_idx_] += max(0.0, n_obj - n_obj_at_window_start_);
+  n_obj_at_window_start_ = n_obj;
+}
+
+void SketchStat::merge(const SketchStat &other) {
+  n_obj_.merge(other.n_obj_);
+  /* the partitions have disjoint objects, so the working sets add up */
+  if (wss_.size() < other.wss_.size()) wss_.resize(other.wss_.size(), 0);
+  for (size_t i = 0; i < other.wss_.size(); i++) wss_[i] += other.wss_[i];
+  if (new_obj_.size() < other.new_obj_.size()) {
+    new_obj_.resize(other.new_obj_.size(), 0);
+  }
+  for (size_t i = 0; i < other.new_obj_.size(); i++) {
+    new_obj_[i] += other.new_obj_[i];
+  }
+  if (window_n_req_.size() < other.window_n_req_.size()) {
+    window_n_req_.resize(other.window_n_req_.size(), 0);
+    window_n_byte_.resize(other.window_n_byte_.size(), 0);
+  }
+  for (size_t i = 0; i < other.window_n_req_.size(); i++) {
+    window_n_req_[i] += other.window_n_req_[i];
+    window_n_byte_[i] += other.window_n_byte_[i];
+  }
+  top_.merge(other.top_);
+  size_.merge(other.size_);
+  ttl_.merge(other.ttl_);
+}
+
+ostream &operator<<(ostream &os, const SketchStat &stat) {
+  stringstream ss;
+  const double q[] = {0.1, 0.5, 0.9, 0.99};
+
+  ss << fixed << setprecision(4)
+     << "sketch: number of objects (HyperLogLog) error +-"
+     << stat.n_obj_.rel_error() * 100 << "%, working set per window error +-"
+     << stat.window_n_obj_.rel_error() * 100 << "%\n";
+  ss << "sketch: freq of the most popular obj (Space-Saving) over-estimated by "
+        "at most "
+     << stat.top_.max_error() << "\n";
+
+  ss << "sketch: object size (weighted by req) p10/p50/p90/p99: ";
+  for (int i = 0; i < 4; i++) {
+    ss << (i == 0 ? "" : "/") << (int64_t)stat.size_.quantile(q[i]);
+  }
+  ss << ", rank error +-" << stat.size_.rank_error() * 100 << "%\n";
+
+  if (stat.ttl_.n() > 0) {
+    ss << "sketch: TTL p10/p50/p90/p99: ";
+    for (int i = 0; i < 4; i++) {
+      ss << (i == 0 ? "" : "/") << (int64_t)stat.ttl_.quantile(q[i]);
+    }
+    ss << ", rank error +-" << stat.ttl_.rank_error() * 100 << "%\n";
+  }
+
+  os << ss.str();
+  return os;
+}
+
+void SketchStat::dump(const string &path_base) const {
+  ofstream ofs(path_base + ".wss_w" + to_string(time_window_),
+               ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# working set size (number of objects, HyperLogLog) - time window "
+      << time_window_ << " second\n";
+  for (double n_obj : wss_) {
+    ofs << (int64_t)n_obj << ",";
+  }
+  ofs << "\n";
+  ofs.close();
+}
+
+void SketchStat::fill_req_rate(ReqRate *req_rate) const {
+  /* the last window is still open when the trace ends */
+  for (size_t i = 0; i + 1 < window_n_req_.size(); i++) {
+    double n_obj = i < wss_.size() ? wss_[i] : 0;
+    double n_new_obj = i < new_obj_.size() ? new_obj_[i] : 0;
+    req_rate->add_window((uint32_t)window_n_req_[i], window_n_byte_[i],
+                         (uint32_t)llround(n_obj),
+                         (uint32_t)llround(n_new_obj));
+  }
+}
+
+}  // namespace traceAnalyzer
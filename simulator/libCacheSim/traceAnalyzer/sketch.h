@@ -0,0 +1,172 @@
+#pragma once
+//
+// fixed-memory sketches used by the sketch mode of the analyzer
+//
+// in sketch mode, only a hash sample of the objects (SHARDS) keeps per-object
+// state and is forwarded to the analysis modules, while every request updates
+// a SketchStat of its partition, which estimates the number of objects and
+// the per-window working set (HyperLogLog), counts the requests and bytes of
+// every window exactly, and estimates the frequency of the most popular
+// objects (Space-Saving) and the quantiles of the object size and TTL (KLL)
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../dataStructure/robin_hood.h"
+#include "../include/libCacheSim/request.h"
+#include "reqRate.h"
+
+namespace traceAnalyzer {
+
+/* the seeds of the object sampling hash and the HyperLogLog hash */
+#define SAMPLE_HASH_SEED 0ULL
+#define HLL_HASH_SEED 0x5bd1e995ULL
+
+/* splitmix64 finalizer, the seed decorrelates the sampling hash from the
+ * sketch hashes */
+static inline uint64_t sketch_hash(uint64_t x, uint64_t seed) {
+  x += seed + 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30u)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27u)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31u);
+}
+
+class HyperLogLog {
+ public:
+  /* 2^p registers, the relative standard error is 1.04 / sqrt(2^p) */
+  explicit HyperLogLog(int p = 14) : p_(p), registers_(1u << p, 0) {}
+
+  inline void add(uint64_t hash) {
+    uint32_t idx = hash >> (64 - p_);
+    uint64_t w = hash << p_;
+    uint8_t rank = w == 0 ? 64 - p_ + 1 : __builtin_clzll(w) + 1;
+    if (rank > registers_[idx]) registers_[idx] = rank;
+  }
+
+  double estimate() const;
+
+  /* both sketches must have the same p */
+  void merge(const HyperLogLog &other);
+
+  void clear() { std::fill(registers_.begin(), registers_.end(), 0); }
+
+  double rel_error() const;
+
+ private:
+  const int p_;
+  std::vector<uint8_t> registers_;
+};
+
+/* the most frequent objects with k counters, the count of an object is
+ * over-estimated by at most the smallest counter, which is at most n / k */
+class SpaceSaving {
+ public:
+  explicit SpaceSaving(int k = 1024) : k_(k) { pos_.reserve(k); }
+
+  void add(obj_id_t obj_id);
+
+  /* add the counters of a sketch over a disjoint set of objects */
+  void merge(const SpaceSaving &other);
+
+  /* the estimated count of the n most frequent objects, descending */
+  std::vector<uint64_t> top(int n) const;
+
+  uint64_t max_error() const { return max_error_; }
+
+ private:
+  struct counter {
+    obj_id_t obj_id;
+    uint64_t cnt;
+  };
+
+  size_t k_;
+  /* a min-heap on cnt */
+  std::vector<counter> heap_;
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> pos_;
+  uint64_t max_error_ = 0;
+
+  void sift_down(size_t i);
+  void swap_counter(size_t i, size_t j);
+};
+
+/* quantiles with a normalized rank error of about 2.3 / k^0.97 */
+class KllSketch {
+ public:
+  explicit KllSketch(int k = 200) : k_(k), levels_(1) {}
+
+  inline void add(double v) {
+    levels_[0].push_back(v);
+    n_ += 1;
+    if (levels_[0].size() >= capacity(0)) compress();
+  }
+
+  void merge(const KllSketch &other);
+
+  double quantile(double q) const;
+
+  uint64_t n() const { return n_; }
+
+  double rank_error() const;
+
+ private:
+  const int k_;
+  uint64_t n_ = 0;
+  uint64_t rng_ = 0x2545F4914F6CDD1DULL;
+  /* the items at level h have a weight of 2^h */
+  std::vector<std::vector<double>> levels_;
+
+  size_t capacity(size_t level) const;
+  void compress();
+};
+
+/* the sketches of one object partition */
+class SketchStat {
+ public:
+  explicit SketchStat(int time_window, int n_counter = 1024, int kll_k = 200)
+      : time_window_(time_window), top_(n_counter), size_(kll_k), ttl_(kll_k) {}
+
+  void add_req(const request_t *req);
+
+  /* close the current window, call before merge and report */
+  void finish();
+
+  /* add the sketches of another partition */
+  void merge(const SketchStat &other);
+
+  double n_obj() const { return n_obj_.estimate(); }
+
+  std::vector<uint64_t> top(int n) const { return top_.top(n); }
+
+  /* print the estimates and their error bounds */
+  friend std::ostream &operator<<(std::ostream &os, const SketchStat &stat);
+
+  /* dump the working set size of every window */
+  void dump(const std::string &path_base) const;
+
+  /* add the closed windows to a request rate module, the requests and bytes
+   * are counted from every request, the objects are estimated */
+  void fill_req_rate(ReqRate *req_rate) const;
+
+ private:
+  const int time_window_;
+  HyperLogLog n_obj_{14};
+  HyperLogLog window_n_obj_{12};
+  int64_t window_idx_ = 0;
+  /* the estimated number of objects in each window */
+  std::vector<double> wss_;
+  /* the estimated number of objects first seen in each window */
+  std::vector<double> new_obj_;
+  double n_obj_at_window_start_ = 0;
+  /* the number of requests and bytes in each window */
+  std::vector<uint64_t> window_n_req_;
+  std::vector<uint64_t> window_n_byte_;
+  SpaceSaving top_;
+  KllSketch size_;
+  KllSketch ttl_;
+};
+
+}  // namespace traceAnalyzer
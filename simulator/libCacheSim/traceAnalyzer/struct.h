@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include "../dataStructure/robin_hood.h"
 #include "../include/config.h"
@@ -10,6 +11,8 @@ typedef uint32_t obj_size_t;
 // typedef int32_t time_t;
 
 namespace traceAnalyzer {
+class SketchStat;
+
 struct obj_info {
   int64_t last_access_vtime;
   obj_size_t obj_size;
@@ -21,4 +24,13 @@ struct obj_info {
 using obj_info_map_type =
     robin_hood::unordered_flat_map<obj_id_t, struct obj_info>;
 
+/* the objects of a hash partition, owned by one enrichment thread, aligned
+ * so that the partitions do not share cache lines */
+typedef struct alignas(64) obj_partition {
+  obj_info_map_type obj_map;
+  uint64_t sum_obj_size_obj = 0;
+  /* the sketches of all requests of the partition, sketch mode only */
+  SketchStat *sketch = nullptr;
+} obj_partition_t;
+
 }  // namespace traceAnalyzer
@@ -14,18 +14,11 @@ namespace traceAnalyzer {
 using namespace std;
 
 void TtlStat::add_req(request_t *req) {
-  printf("req->ttl: %d\n", req->ttl);
-  
   if (req->ttl > 0) {
-    auto it = ttl_cnt_.find(req->ttl);
-    if (it == ttl_cnt_.end()) {
-      ttl_cnt_[req->ttl] = 1;
-      if ((!too_many_ttl_) && ttl_cnt_.size() > 1000000) {
-        too_many_ttl_ = true;
-        WARN("there are too many TTLs (%zu) in the trace\n", ttl_cnt_.size());
-      }
-    } else {
-      it->second += 1;
+    ttl_cnt_.incr(req->ttl);
+    if (unlikely(ttl_cnt_.n_key() > 1000000) && !too_many_ttl_) {
+      too_many_ttl_ = true;
+      WARN("there are too many TTLs (%zu) in the trace\n", ttl_cnt_.n_key());
     }
   }
 }
@@ -38,9 +31,8 @@ void TtlStat::dump(const string &path_base) {
     return;
   } else {
     ofs << "# TTL: req_cnt\n";
-    for (auto &p : ttl_cnt_) {
-      ofs << p.first << ":" << p.second << "\n";
-    }
+    ttl_cnt_.for_each(
+        [&ofs](int64_t t, uint32_t cnt) { ofs << t << ":" << cnt << "\n"; });
   }
   ofs.close();
 }
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/request.h"
+#include "histogram.h"
 
 namespace traceAnalyzer {
 
@@ -23,22 +24,18 @@ class TtlStat {
   friend std::ostream& operator<<(std::ostream& os, const TtlStat& ttl) {
     std::stringstream stat_ss;
 
-    std::cout << "TTL: " << ttl.ttl_cnt_.size() << " different TTLs, ";
-    uint64_t n_req = std::accumulate(
-        std::begin(ttl.ttl_cnt_), std::end(ttl.ttl_cnt_), 0ULL,
-        [](uint64_t value,
-           const std::unordered_map<int32_t, uint32_t>::value_type& p) {
-          return value + p.second;
-        });
-
-    if (ttl.ttl_cnt_.size() > 1) {
-      stat_ss << "TTL: " << ttl.ttl_cnt_.size() << " different TTLs, ";
-      for (auto it : ttl.ttl_cnt_) {
-        if (it.second > (size_t)((double)n_req * 0.01)) {
-          stat_ss << it.first << ":" << it.second << "("
-                  << (double)it.second / (double)n_req << "), ";
+    size_t n_ttl = ttl.ttl_cnt_.n_key();
+    std::cout << "TTL: " << n_ttl << " different TTLs, ";
+    uint64_t n_req = ttl.ttl_cnt_.sum();
+
+    if (n_ttl > 1) {
+      stat_ss << "TTL: " << n_ttl << " different TTLs, ";
+      ttl.ttl_cnt_.for_each([&stat_ss, n_req](int64_t t, uint32_t cnt) {
+        if (cnt > (size_t)((double)n_req * 0.01)) {
+          stat_ss << t << ":" << cnt << "(" << (double)cnt / (double)n_req
+                  << "), ";
         }
-      }
+      });
       stat_ss << "\n";
     }
     os << stat_ss.str();
@@ -48,9 +45,27 @@ class TtlStat {
 
   void dump(const std::string& filename);
 
+  /* add the counts of another instance */
+  void merge(const TtlStat& other) {
+    ttl_cnt_.merge(other.ttl_cnt_);
+    too_many_ttl_ = too_many_ttl_ || other.too_many_ttl_ ||
+                    ttl_cnt_.n_key() > 1000000;
+  }
+
+  void save(std::ostream& os) const {
+    ttl_cnt_.save(os);
+    ckpt_write(os, too_many_ttl_);
+  }
+
+  void load(std::istream& is) {
+    ttl_cnt_.load(is);
+    ckpt_read(is, too_many_ttl_);
+  }
+
  private:
-  /* the number of requests have ttl value */
-  std::unordered_map<int32_t, uint32_t> ttl_cnt_{};
+  /* the number of requests have ttl value, TTLs up to ~12 days are
+   * counted in the dense part */
+  Histogram<uint32_t> ttl_cnt_{0};
   bool too_many_ttl_ = false;
 };
 }  // namespace traceAnalyzer
\ No newline at end of file
@@ -5,6 +5,7 @@
 #endif
 
 #include "../../include/libCacheSim/reader.h"
+#include "../generalReader/streamReader.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +42,9 @@ static inline char *_read_bytes_zstd(reader_t *reader) {
 
 static inline char *read_bytes(reader_t *reader) {
   char *start = NULL;
+  if (reader->is_stream) {
+    return stream_reader_read_bytes(reader->stream_reader_p, reader->item_size);
+  }
 #ifdef SUPPORT_ZSTD_TRACE
   if (reader->is_zstd_file) {
     start = _read_bytes_zstd(reader);
@@ -17,6 +17,7 @@
 
 #include <string.h>
 
+#include "../customizedReader/binaryUtils.h"
 #include "readerInternal.h"
 
 #ifdef __cplusplus
@@ -120,18 +121,21 @@ int binaryReader_setup(reader_t *const reader) {
           fmt_str, params->n_fields);
   }
 
-  ssize_t data_region_size = reader->file_size - reader->trace_start_offset;
-  if (data_region_size % reader->item_size != 0) {
-    WARN(
-        "trace file size %lu - %lu is not multiple of item size %lu, mod %lu\n",
-        (unsigned long)reader->file_size,
-        (unsigned long)reader->trace_start_offset,
-        (unsigned long)reader->item_size,
-        (unsigned long)reader->file_size % reader->item_size);
+  if (!reader->is_stream) {
+    ssize_t data_region_size = reader->file_size - reader->trace_start_offset;
+    if (data_region_size % reader->item_size != 0) {
+      WARN(
+          "trace file size %lu - %lu is not multiple of item size %lu, mod "
+          "%lu\n",
+          (unsigned long)reader->file_size,
+          (unsigned long)reader->trace_start_offset,
+          (unsigned long)reader->item_size,
+          (unsigned long)reader->file_size % reader->item_size);
+    }
+
+    reader->n_total_req = (uint64_t)data_region_size / (reader->item_size);
   }
 
-  reader->n_total_req = (uint64_t)data_region_size / (reader->item_size);
-
   char output[1024];
   int n = snprintf(
       output, 1024,
@@ -212,7 +216,11 @@ static inline int64_t read_data(char *src, char format) {
 int binary_read_one_req(reader_t *reader, request_t *req) {
   binary_params_t *params = (binary_params_t *)reader->reader_params;
 
-  char *start = (reader->mapped_file + reader->mmap_offset);
+  char *start = read_bytes(reader);
+  if (start == NULL) {
+    req->valid = false;
+    return 1;
+  }
 
   /* read object id */
   req->obj_id = read_data(start + params->obj_id_offset, params->obj_id_format);
@@ -247,7 +255,6 @@ int binary_read_one_req(reader_t *reader, request_t *req) {
                                        params->next_access_vtime_format);
   }
 
-  (reader->mmap_offset) += reader->item_size;
   return 0;
 }
 
@@ -14,6 +14,7 @@
 #include "../../dataStructure/hash/hash.h"
 #include "libcsv.h"
 #include "readerInternal.h"
+#include "streamReader.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +46,16 @@ static int count_occurrence(const char *str, const char c) {
  */
 static int read_first_line(const reader_t *reader, char *in_buf,
                            const size_t in_buf_size) {
+  if (reader->is_stream) {
+    /* the stream cannot be opened again, peek the line from the buffer */
+    char *line;
+    size_t read_size = stream_reader_peek_line(reader->stream_reader_p, &line);
+    read_size = read_size > in_buf_size - 1 ? in_buf_size - 1 : read_size;
+    memcpy(in_buf, line, read_size);
+    in_buf[read_size] = '\0';
+    return read_size;
+  }
+
   FILE *ifile = fopen(reader->trace_path, "r");
   char *buf = NULL;
   size_t n = 0;
@@ -163,6 +174,11 @@ static bool csv_detect_header(const reader_t *reader) {
  * @return bool
  */
 bool check_delimiter(const reader_t *reader, char delimiter) {
+  if (reader->is_stream) {
+    /* the first line has been consumed after setup */
+    return true;
+  }
+
   FILE *ifile = fopen(reader->trace_path, "r");
   char *buf = NULL;
   bool is_delimiter_correct = true;
@@ -91,6 +91,14 @@ int LCSReader_setup(reader_t *reader) {
         header->item_size, (int)reader->item_size);
   }
 
+  /* the number of objects is only known from the header */
+  if (header->n_obj > 0) reader->n_total_obj = header->n_obj;
+
+  if (reader->is_stream) {
+    /* the stream size is unknown, but the header has the number of requests */
+    reader->n_total_req = header->n_req;
+  }
+
   return 0;
 }
 
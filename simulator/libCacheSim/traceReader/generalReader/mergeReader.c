@@ -0,0 +1,282 @@
+//
+//  a reader that merges several traces (tenants) into one trace ordered by
+//  timestamp, each request is tagged with the index of its source in
+//  req->tenant_id, this is used to simulate caches shared by multiple tenants
+//
+//  each source is read in blocks and the sources are merged using a min-heap
+//  keyed on the (rescaled) timestamp of the next request of each source
+//
+//  mergeReader.c
+//  libCacheSim
+//
+
+#include "mergeReader.h"
+
+#include <string.h>
+
+#include "../../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint64_t _splitmix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/* objects from different sources are different objects, the id is mixed
+ * with a seed of the source, splitmix64 is a bijection, so the ids of one
+ * source never collide and ids of any width are supported, the ids of two
+ * sources collide with a probability of about n_obj^2 / 2^64 */
+static inline obj_id_t _merge_obj_id(obj_id_t obj_id, int src) {
+  return _splitmix64(obj_id ^ _splitmix64((uint64_t)src));
+}
+
+static inline request_t *_head_req(const merge_reader_params_t *params,
+                                   int src) {
+  return &params->blocks[src][params->block_pos[src]];
+}
+
+/* ties are broken by the source index so the merge is deterministic */
+static inline bool _heap_less(const merge_reader_params_t *params, int a,
+                              int b) {
+  int64_t ta = _head_req(params, a)->clock_time;
+  int64_t tb = _head_req(params, b)->clock_time;
+  return ta < tb || (ta == tb && a < b);
+}
+
+static void _heap_sift_down(merge_reader_params_t *params, int pos) {
+  int *heap = params->heap;
+  while (true) {
+    int smallest = pos, l = 2 * pos + 1, r = 2 * pos + 2;
+    if (l < params->heap_size && _heap_less(params, heap[l], heap[smallest]))
+      smallest = l;
+    if (r < params->heap_size && _heap_less(params, heap[r], heap[smallest]))
+      smallest = r;
+    if (smallest == pos) break;
+    int tmp = heap[pos];
+    heap[pos] = heap[smallest];
+    heap[smallest] = tmp;
+    pos = smallest;
+  }
+}
+
+static void _heap_sift_up(merge_reader_params_t *params, int pos) {
+  int *heap = params->heap;
+  while (pos > 0) {
+    int parent = (pos - 1) / 2;
+    if (!_heap_less(params, heap[pos], heap[parent])) break;
+    int tmp = heap[pos];
+    heap[pos] = heap[parent];
+    heap[parent] = tmp;
+    pos = parent;
+  }
+}
+
+/**
+ * read the next block of requests from a source and rescale the timestamps
+ * @return the number of requests read
+ */
+static int _fill_block(reader_t *reader, int src) {
+  merge_reader_params_t *params = (merge_reader_params_t *)reader->reader_params;
+  reader_t *source = params->sources[src];
+  request_t *block = params->blocks[src];
+  double rate_scale = params->rate_scales[src];
+  int n = 0;
+
+  while (n < MERGE_READER_BLOCK_SIZE) {
+    request_t *req = &block[n];
+    if (read_one_req(source, req) != 0) break;
+
+    if (params->start_times[src] == -1) {
+      params->start_times[src] = req->clock_time;
+    }
+    int64_t rel_time = req->clock_time - params->start_times[src];
+    if (rate_scale != 1.0) {
+      rel_time = (int64_t)((double)rel_time / rate_scale);
+    }
+    req->clock_time = rel_time;
+    req->tenant_id = src;
+    req->obj_id = _merge_obj_id(req->obj_id, src);
+    /* the future is different in the merged trace */
+    req->next_access_vtime = -2;
+    n++;
+  }
+
+  params->block_pos[src] = 0;
+  params->block_len[src] = n;
+  return n;
+}
+
+static void _merge_start(reader_t *reader) {
+  merge_reader_params_t *params = (merge_reader_params_t *)reader->reader_params;
+  params->heap_size = 0;
+  for (int i = 0; i < params->n_sources; i++) {
+    if (_fill_block(reader, i) > 0) {
+      params->heap[params->heap_size++] = i;
+      _heap_sift_up(params, params->heap_size - 1);
+    }
+  }
+  params->started = true;
+}
+
+int merge_read_one_req(reader_t *reader, request_t *req) {
+  merge_reader_params_t *params = (merge_reader_params_t *)reader->reader_params;
+  if (unlikely(!params->started)) {
+    _merge_start(reader);
+  }
+
+  if (params->heap_size == 0) {
+    req->valid = false;
+    return 1;
+  }
+
+  int src = params->heap[0];
+  copy_request(req, _head_req(params, src));
+  req->valid = true;
+
+  params->block_pos[src] += 1;
+  if (params->block_pos[src] >= params->block_len[src] &&
+      _fill_block(reader, src) == 0) {
+    /* the source is exhausted */
+    params->heap[0] = params->heap[--params->heap_size];
+  }
+  if (params->heap_size > 0) {
+    _heap_sift_down(params, 0);
+  }
+
+  return 0;
+}
+
+void merge_reset_reader(reader_t *reader) {
+  merge_reader_params_t *params = (merge_reader_params_t *)reader->reader_params;
+  for (int i = 0; i < params->n_sources; i++) {
+    reset_reader(params->sources[i]);
+    params->start_times[i] = -1;
+  }
+  params->heap_size = 0;
+  params->started = false;
+}
+
+/**
+ * @brief setup a reader that merges the given readers by timestamp
+ *
+ * @param readers the readers to merge, the merge reader takes the ownership
+ * @param n_readers
+ * @param rate_scales the request rate of each reader is multiplied by the
+ *  scale, e.g., 2 means the requests arrive twice as fast, NULL means 1
+ * @param init_params only cap_at_n_req, ignore_obj_size and sampler are used
+ * @return reader_t*
+ */
+reader_t *setup_merge_reader(reader_t **readers, int n_readers,
+                             const double *rate_scales,
+                             const reader_init_param_t *init_params) {
+  assert(n_readers > 0);
+  reader_t *const reader = (reader_t *)malloc(sizeof(reader_t));
+  memset(reader, 0, sizeof(reader_t));
+
+  reader->trace_type = MERGE_TRACE;
+  reader->trace_format = VIRTUAL_TRACE_FORMAT;
+  reader->read_direction = READ_FORWARD;
+  reader->last_req_clock_time = -1;
+  reader->cap_at_n_req = -1;
+  if (init_params != NULL) {
+    memcpy(&reader->init_params, init_params, sizeof(reader_init_param_t));
+    reader->init_params.binary_fmt_str = NULL;
+    reader->init_params.sampler = NULL;
+    reader->ignore_obj_size = init_params->ignore_obj_size;
+    reader->cap_at_n_req = init_params->cap_at_n_req;
+    if (init_params->sampler != NULL)
+      reader->sampler = init_params->sampler->clone(init_params->sampler);
+  }
+
+  merge_reader_params_t *params =
+      (merge_reader_params_t *)malloc(sizeof(merge_reader_params_t));
+  memset(params, 0, sizeof(merge_reader_params_t));
+  params->n_sources = n_readers;
+  params->sources = (reader_t **)malloc(sizeof(reader_t *) * n_readers);
+  params->rate_scales = (double *)malloc(sizeof(double) * n_readers);
+  params->start_times = (int64_t *)malloc(sizeof(int64_t) * n_readers);
+  params->blocks = (request_t **)malloc(sizeof(request_t *) * n_readers);
+  params->block_pos = (int *)malloc(sizeof(int) * n_readers);
+  params->block_len = (int *)malloc(sizeof(int) * n_readers);
+  params->heap = (int *)malloc(sizeof(int) * n_readers);
+
+  /* the trace path is the paths of the sources joined by + */
+  size_t path_len = 1;
+  for (int i = 0; i < n_readers; i++) {
+    path_len += strlen(readers[i]->trace_path) + 1;
+  }
+  reader->trace_path = (char *)malloc(path_len);
+  reader->trace_path[0] = '\0';
+
+  bool n_total_req_known = true;
+  for (int i = 0; i < n_readers; i++) {
+    params->sources[i] = readers[i];
+    params->rate_scales[i] = rate_scales == NULL ? 1.0 : rate_scales[i];
+    if (params->rate_scales[i] <= 0) {
+      ERROR("rate scale of source %d must be positive, given %lf\n", i,
+            params->rate_scales[i]);
+      abort();
+    }
+    params->start_times[i] = -1;
+    params->blocks[i] = (request_t *)malloc(sizeof(request_t) *
+                                            MERGE_READER_BLOCK_SIZE);
+    memset(params->blocks[i], 0, sizeof(request_t) * MERGE_READER_BLOCK_SIZE);
+    params->block_pos[i] = 0;
+    params->block_len[i] = 0;
+
+    if (readers[i]->n_total_req == 0) n_total_req_known = false;
+    reader->n_total_req += readers[i]->n_total_req;
+
+    if (i > 0) strcat(reader->trace_path, "+");
+    strcat(reader->trace_path, readers[i]->trace_path);
+  }
+  if (!n_total_req_known) reader->n_total_req = 0;
+
+  reader->reader_params = params;
+  return reader;
+}
+
+reader_t *clone_merge_reader(const reader_t *reader_in) {
+  merge_reader_params_t *params =
+      (merge_reader_params_t *)reader_in->reader_params;
+  reader_t **sources = (reader_t **)malloc(sizeof(reader_t *) * params->n_sources);
+  for (int i = 0; i < params->n_sources; i++) {
+    sources[i] = clone_reader(params->sources[i]);
+  }
+
+  reader_t *reader = setup_merge_reader(sources, params->n_sources,
+                                        params->rate_scales,
+                                        &reader_in->init_params);
+  if (reader_in->sampler != NULL && reader->sampler == NULL) {
+    reader->sampler = reader_in->sampler->clone(reader_in->sampler);
+  }
+  reader->cap_at_n_req = reader_in->cap_at_n_req;
+  reader->ignore_obj_size = reader_in->ignore_obj_size;
+  reader->cloned = true;
+  free(sources);
+  return reader;
+}
+
+void merge_close_reader(reader_t *reader) {
+  merge_reader_params_t *params = (merge_reader_params_t *)reader->reader_params;
+  for (int i = 0; i < params->n_sources; i++) {
+    close_reader(params->sources[i]);
+    free(params->blocks[i]);
+  }
+  free(params->sources);
+  free(params->rate_scales);
+  free(params->start_times);
+  free(params->blocks);
+  free(params->block_pos);
+  free(params->block_len);
+  free(params->heap);
+}
+
+#ifdef __cplusplus
+}
+#endif
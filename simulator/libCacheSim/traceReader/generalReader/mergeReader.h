@@ -0,0 +1,45 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "../../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of requests read from each source at a time */
+#define MERGE_READER_BLOCK_SIZE 4096
+
+typedef struct {
+  int n_sources;
+  reader_t **sources;
+  /* the request rate of a source is multiplied by rate_scale */
+  double *rate_scales;
+  /* the timestamp of the first request of each source, used to align the
+   * sources so that they all start at time 0 */
+  int64_t *start_times;
+
+  /* each source has a block of requests, block_pos is the next request */
+  request_t **blocks;
+  int *block_pos;
+  int *block_len;
+
+  /* min-heap of source indexes ordered by the time of the next request */
+  int *heap;
+  int heap_size;
+  bool started;
+} merge_reader_params_t;
+
+int merge_read_one_req(reader_t *reader, request_t *req);
+
+void merge_reset_reader(reader_t *reader);
+
+reader_t *clone_merge_reader(const reader_t *reader);
+
+void merge_close_reader(reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,154 @@
+//
+//  read trace from a pipe or stdin, e.g., zstdcat trace.zst | cachesim - ...
+//
+//  streamReader.c
+//  libCacheSim
+//
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "streamReader.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../include/libCacheSim/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+stream_reader_t *create_stream_reader(int fd, size_t buf_size) {
+  stream_reader_t *reader = malloc(sizeof(stream_reader_t));
+  reader->fd = fd;
+  reader->buf_size = buf_size;
+  reader->buf = malloc(buf_size);
+  if (reader->buf == NULL) {
+    ERROR("cannot allocate %zu bytes for stream reader\n", buf_size);
+    exit(1);
+  }
+  reader->read_pos = 0;
+  reader->write_pos = 0;
+  reader->eof = false;
+  reader->file = NULL;
+
+  return reader;
+}
+
+void free_stream_reader(stream_reader_t *reader) {
+  if (reader->fd != STDIN_FILENO) {
+    close(reader->fd);
+  }
+  free(reader->buf);
+  free(reader);
+}
+
+/**
+ * make sure at least n_byte unread bytes are in the buffer unless the stream
+ * ends, a read may return fewer bytes than asked when reading from a pipe, so
+ * we keep reading until we have enough
+ *
+ * @return the number of unread bytes in the buffer
+ */
+static size_t _fill(stream_reader_t *reader, size_t n_byte) {
+  if (n_byte > reader->buf_size) {
+    ERROR("stream reader buffer %zu is smaller than %zu\n", reader->buf_size,
+          n_byte);
+    abort();
+  }
+
+  if (reader->read_pos + n_byte > reader->buf_size) {
+    size_t n_left = reader->write_pos - reader->read_pos;
+    memmove(reader->buf, reader->buf + reader->read_pos, n_left);
+    reader->read_pos = 0;
+    reader->write_pos = n_left;
+  }
+
+  while (!reader->eof && reader->write_pos - reader->read_pos < n_byte) {
+    ssize_t sz = read(reader->fd, reader->buf + reader->write_pos,
+                      reader->buf_size - reader->write_pos);
+    if (sz > 0) {
+      reader->write_pos += sz;
+    } else if (sz == 0) {
+      reader->eof = true;
+    } else if (errno != EINTR) {
+      ERROR("fail to read from stream: %s\n", strerror(errno));
+      abort();
+    }
+  }
+
+  return reader->write_pos - reader->read_pos;
+}
+
+char *stream_reader_read_bytes(stream_reader_t *reader, size_t n_byte) {
+  size_t n_avail = _fill(reader, n_byte);
+  if (n_avail < n_byte) {
+    if (n_avail > 0) {
+      WARN("stream ends with a partial record of %zu bytes\n", n_avail);
+      reader->read_pos = reader->write_pos;
+    }
+    return NULL;
+  }
+
+  char *start = reader->buf + reader->read_pos;
+  reader->read_pos += n_byte;
+  return start;
+}
+
+size_t stream_reader_peek_line(stream_reader_t *reader, char **line_start) {
+  size_t n_avail = reader->write_pos - reader->read_pos;
+  char *line_end = NULL;
+  while (true) {
+    line_end = memchr(reader->buf + reader->read_pos, '\n', n_avail);
+    if (line_end != NULL || reader->eof || n_avail == reader->buf_size) break;
+    n_avail = _fill(reader, n_avail + 1);
+  }
+
+  *line_start = reader->buf + reader->read_pos;
+  if (line_end == NULL) return n_avail;
+  return line_end - *line_start + 1;
+}
+
+static ssize_t _stream_file_read(void *cookie, char *buf, size_t size) {
+  stream_reader_t *reader = (stream_reader_t *)cookie;
+  size_t n_avail = _fill(reader, 1);
+  size_t sz = n_avail < size ? n_avail : size;
+  memcpy(buf, reader->buf + reader->read_pos, sz);
+  reader->read_pos += sz;
+  return sz;
+}
+
+static int _stream_file_close(void *cookie) { return 0; }
+
+#if defined(__APPLE__)
+static int _stream_file_read_bsd(void *cookie, char *buf, int size) {
+  return (int)_stream_file_read(cookie, buf, size);
+}
+#endif
+
+FILE *stream_reader_fopen(stream_reader_t *reader) {
+#if defined(__APPLE__)
+  reader->file =
+      funopen(reader, _stream_file_read_bsd, NULL, NULL, _stream_file_close);
+#else
+  cookie_io_functions_t funcs = {.read = _stream_file_read,
+                                 .write = NULL,
+                                 .seek = NULL,
+                                 .close = _stream_file_close};
+  reader->file = fopencookie(reader, "r", funcs);
+#endif
+  if (reader->file == NULL) {
+    ERROR("cannot open stream: %s\n", strerror(errno));
+    exit(1);
+  }
+
+  return reader->file;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the size of the buffer between the file descriptor and the reader */
+#define STREAM_READER_BUF_SIZE (64 * 1024 * 1024)
+
+/* read a trace from a pipe or stdin, which cannot be mmaped or rewound,
+ * data is read into a large buffer and the unread bytes are moved to the
+ * front of the buffer when a record does not fit at the end */
+typedef struct stream_reader {
+  int fd;
+  char *buf;
+  size_t buf_size;
+  /* the next unread byte */
+  size_t read_pos;
+  /* the end of the data in buf */
+  size_t write_pos;
+  bool eof;
+  /* used by csv and txt trace, reads go through the buffer */
+  FILE *file;
+} stream_reader_t;
+
+stream_reader_t *create_stream_reader(int fd, size_t buf_size);
+
+void free_stream_reader(stream_reader_t *reader);
+
+/* read n_byte, return a pointer to the data which is valid until the next
+ * read, or NULL at the end of the stream */
+char *stream_reader_read_bytes(stream_reader_t *reader, size_t n_byte);
+
+/* get the next line without consuming it, return the length of the line
+ * including the line ending, 0 at the end of the stream */
+size_t stream_reader_peek_line(stream_reader_t *reader, char **line_start);
+
+/* open a FILE that reads from the stream, this is used by the csv and txt
+ * readers which use getline */
+FILE *stream_reader_fopen(stream_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
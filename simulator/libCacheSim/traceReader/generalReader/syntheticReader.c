@@ -0,0 +1,547 @@
+//
+//  a reader that generates a synthetic workload on the fly instead of reading
+//  a trace file, the workload is described by a string such as
+//  "zipf:alpha=0.9,n_obj=1e8,n_req=1e10,size=lognormal,size_mu=8"
+//
+//  object popularity is sampled from an alias table (O(1) per request),
+//  and the workload can be mixed with scans, loops, one-hit wonders and
+//  popularity shifts over time
+//
+//  syntheticReader.c
+//  libCacheSim
+//
+
+#include "syntheticReader.h"
+
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTHETIC_MIN_LAST_POS_TABLE_SIZE 1024
+
+/**************** random number generation ****************/
+static inline uint64_t _splitmix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+static inline uint64_t _rotl(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/* xoshiro256**, each reader has its own state so that clones and resets
+ * generate the same workload */
+static inline uint64_t _next_rand(uint64_t *s) {
+  const uint64_t result = _rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = _rotl(s[3], 45);
+  return result;
+}
+
+static inline double _next_rand_double(uint64_t *s) {
+  return (double)(_next_rand(s) >> 11) * 0x1.0p-53;
+}
+
+/* a uniform integer in [0, n) without division */
+static inline uint64_t _bounded(uint64_t r, uint64_t n) {
+  return (uint64_t)(((__uint128_t)r * n) >> 64);
+}
+
+static void _seed_rng(synthetic_reader_params_t *params) {
+  uint64_t x = params->seed;
+  for (int i = 0; i < 4; i++) {
+    x = _splitmix64(x);
+    params->rng[i] = x;
+  }
+}
+
+/**************** workload ****************/
+/* build the alias table using Vose's method */
+static void _build_alias_table(synthetic_reader_params_t *params) {
+  int64_t n = params->n_obj;
+  if (n > UINT32_MAX) {
+    ERROR("synthetic zipf workload supports at most %u objects\n", UINT32_MAX);
+    exit(1);
+  }
+
+  double *q = (double *)malloc(sizeof(double) * n);
+  uint32_t *work = (uint32_t *)malloc(sizeof(uint32_t) * n);
+  params->alias_prob = (uint32_t *)malloc(sizeof(uint32_t) * n);
+  params->alias_idx = (uint32_t *)malloc(sizeof(uint32_t) * n);
+  params->alias_n_ref = (int32_t *)malloc(sizeof(int32_t));
+  if (q == NULL || work == NULL || params->alias_prob == NULL ||
+      params->alias_idx == NULL || params->alias_n_ref == NULL) {
+    ERROR("cannot allocate alias table for %ld objects\n", (long)n);
+    exit(1);
+  }
+  *params->alias_n_ref = 1;
+
+  double sum = 0;
+  for (int64_t i = 0; i < n; i++) {
+    q[i] = pow((double)(i + 1), -params->alpha);
+    sum += q[i];
+  }
+
+  /* small slots are pushed from the front of work, large from the back */
+  int64_t n_small = 0, large_start = n;
+  for (int64_t i = 0; i < n; i++) {
+    q[i] = q[i] * (double)n / sum;
+    if (q[i] < 1.0) {
+      work[n_small++] = (uint32_t)i;
+    } else {
+      work[--large_start] = (uint32_t)i;
+    }
+  }
+
+  while (n_small > 0 && large_start < n) {
+    uint32_t s = work[--n_small];
+    uint32_t l = work[large_start];
+    params->alias_prob[s] = (uint32_t)(q[s] * 4294967296.0);
+    params->alias_idx[s] = l;
+    q[l] = (q[l] + q[s]) - 1.0;
+    if (q[l] < 1.0) {
+      large_start++;
+      work[n_small++] = l;
+    }
+  }
+  /* the remaining slots have probability 1 up to rounding errors */
+  while (large_start < n) {
+    uint32_t l = work[large_start++];
+    params->alias_prob[l] = UINT32_MAX;
+    params->alias_idx[l] = l;
+  }
+  while (n_small > 0) {
+    uint32_t s = work[--n_small];
+    params->alias_prob[s] = UINT32_MAX;
+    params->alias_idx[s] = s;
+  }
+
+  free(q);
+  free(work);
+}
+
+static inline int64_t _sample_rank(synthetic_reader_params_t *params) {
+  uint64_t r = _next_rand(params->rng);
+  if (params->dist == SYNTHETIC_UNIFORM) {
+    return (int64_t)_bounded(r, params->n_obj);
+  }
+
+  /* the high bits choose the slot and the low bits decide the alias */
+  uint64_t slot = ((r >> 32) * (uint64_t)params->n_obj) >> 32;
+  if ((uint32_t)r < params->alias_prob[slot]) {
+    return (int64_t)slot;
+  }
+  return params->alias_idx[slot];
+}
+
+static inline int64_t _obj_size(const synthetic_reader_params_t *params,
+                                obj_id_t obj_id) {
+  if (params->size_dist == SYNTHETIC_SIZE_FIXED) {
+    return params->obj_size;
+  }
+
+  /* the size is a function of obj_id so that it does not change between
+   * requests, Box-Muller transform of two uniforms derived from obj_id */
+  uint64_t h = _splitmix64(obj_id ^ params->seed);
+  double u1 = ((double)(h >> 11) + 0.5) * 0x1.0p-53;
+  double u2 = (double)(_splitmix64(h) >> 11) * 0x1.0p-53;
+  double z = sqrt(-2.0 * log(u1)) * cos(2 * M_PI * u2);
+  double size = exp(params->size_mu + params->size_sigma * z);
+  if (size < 1) return 1;
+  if (size > params->size_max) return params->size_max;
+  return (int64_t)size;
+}
+
+/* objects [0, n_obj) follow the popularity distribution,
+ * [n_obj, n_obj + loop_len) are the loop objects, and the one-hit wonders
+ * use the ids after them */
+static void _gen_one_req(synthetic_reader_params_t *params,
+                         synthetic_req_t *req) {
+  int64_t vtime = params->n_gen++;
+  obj_id_t obj_id;
+
+  if (params->scan_left > 0) {
+    obj_id = params->scan_pos;
+    params->scan_pos = (params->scan_pos + 1) % params->n_obj;
+    params->scan_left--;
+  } else {
+    double u = _next_rand_double(params->rng);
+    if (u < params->p_one_hit) {
+      obj_id = params->n_obj + params->loop_len + params->n_one_hit++;
+    } else if ((u -= params->p_one_hit) < params->p_loop) {
+      obj_id = params->n_obj + params->loop_pos;
+      params->loop_pos = (params->loop_pos + 1) % params->loop_len;
+    } else if ((u -= params->p_loop) < params->p_scan) {
+      obj_id = _bounded(_next_rand(params->rng), params->n_obj);
+      params->scan_pos = (obj_id + 1) % params->n_obj;
+      params->scan_left = params->scan_len - 1;
+    } else {
+      int64_t rank = _sample_rank(params);
+      if (params->shift_every > 0) {
+        int64_t shift = (vtime / params->shift_every) * params->shift_step;
+        rank = (rank + shift) % params->n_obj;
+      }
+      obj_id = rank;
+    }
+  }
+
+  req->clock_time = (int64_t)((double)vtime / params->req_rate);
+  req->obj_id = obj_id;
+  req->obj_size = _obj_size(params, obj_id);
+  req->next_access_vtime = INT64_MAX;
+}
+
+/**************** lookahead window ****************/
+static inline uint64_t _last_pos_slot(const synthetic_reader_params_t *params,
+                                      obj_id_t obj_id) {
+  return _splitmix64(obj_id) & params->last_pos_mask;
+}
+
+/* record that obj_id is requested at vtime, return its previous position
+ * or -1 if it is not in the table */
+static int64_t _update_last_pos(synthetic_reader_params_t *params,
+                                obj_id_t obj_id, int64_t vtime) {
+  uint64_t slot = _last_pos_slot(params, obj_id);
+  while (params->last_pos[slot] != -1) {
+    if (params->last_pos_obj[slot] == obj_id) {
+      int64_t prev = params->last_pos[slot];
+      params->last_pos[slot] = vtime;
+      return prev;
+    }
+    slot = (slot + 1) & params->last_pos_mask;
+  }
+  params->last_pos_obj[slot] = obj_id;
+  params->last_pos[slot] = vtime;
+  params->n_insert_since_rebuild++;
+  return -1;
+}
+
+/* drop the objects that are no longer in the window,
+ * the table has at most 2 * lookahead entries between rebuilds */
+static void _rebuild_last_pos(synthetic_reader_params_t *params) {
+  memset(params->last_pos, 0xff,
+         sizeof(int64_t) * (params->last_pos_mask + 1));
+  params->n_insert_since_rebuild = 0;
+  for (int64_t v = params->n_out; v < params->n_gen; v++) {
+    _update_last_pos(params, params->window[v % params->lookahead].obj_id, v);
+  }
+  params->n_insert_since_rebuild = 0;
+}
+
+static void _fill_window(synthetic_reader_params_t *params) {
+  while (params->n_gen < params->n_req &&
+         params->n_gen - params->n_out < params->lookahead) {
+    if (params->n_insert_since_rebuild >= params->lookahead) {
+      _rebuild_last_pos(params);
+    }
+
+    int64_t vtime = params->n_gen;
+    synthetic_req_t *req = &params->window[vtime % params->lookahead];
+    _gen_one_req(params, req);
+    int64_t prev = _update_last_pos(params, req->obj_id, vtime);
+    if (prev >= params->n_out) {
+      /* vtime is the reference count which starts from 1 */
+      params->window[prev % params->lookahead].next_access_vtime = vtime + 1;
+    }
+  }
+}
+
+/**************** parameters ****************/
+static void _set_default_params(synthetic_reader_params_t *params) {
+  params->dist = SYNTHETIC_ZIPF;
+  params->alpha = 1.0;
+  params->n_obj = 1000000;
+  params->n_req = 10000000;
+  params->seed = 42;
+  params->req_rate = 1.0;
+  params->size_dist = SYNTHETIC_SIZE_FIXED;
+  params->obj_size = 1;
+  params->size_mu = 8;
+  params->size_sigma = 1;
+  params->size_max = 1LL << 30;
+  params->scan_len = 1000;
+  params->loop_len = 1000;
+}
+
+static void _parse_params(synthetic_reader_params_t *params,
+                          const char *spec) {
+  if (strncasecmp(spec, "synthetic:", 10) == 0) spec += 10;
+
+  char *spec_copy = strdup(spec);
+  char *param_str = strchr(spec_copy, ':');
+  if (param_str != NULL) *param_str++ = '\0';
+
+  if (strcasecmp(spec_copy, "zipf") == 0) {
+    params->dist = SYNTHETIC_ZIPF;
+  } else if (strcasecmp(spec_copy, "uniform") == 0) {
+    params->dist = SYNTHETIC_UNIFORM;
+  } else {
+    ERROR("unknown synthetic workload %s, supported: zipf, uniform\n",
+          spec_copy);
+    exit(1);
+  }
+
+  while (param_str != NULL && param_str[0] != '\0') {
+    char *key = strsep(&param_str, ",");
+    char *value = strchr(key, '=');
+    if (value == NULL) {
+      ERROR("synthetic workload parameter %s has no value\n", key);
+      exit(1);
+    }
+    *value++ = '\0';
+    for (char *c = key; *c != '\0'; c++) {
+      if (*c == '-') *c = '_';
+    }
+
+    /* numbers can be written as 1e8 */
+    double v = strtod(value, NULL);
+    if (strcasecmp(key, "alpha") == 0) {
+      params->alpha = v;
+    } else if (strcasecmp(key, "n_obj") == 0) {
+      params->n_obj = (int64_t)v;
+    } else if (strcasecmp(key, "n_req") == 0) {
+      params->n_req = (int64_t)v;
+    } else if (strcasecmp(key, "seed") == 0) {
+      params->seed = strtoull(value, NULL, 0);
+    } else if (strcasecmp(key, "req_rate") == 0) {
+      params->req_rate = v;
+    } else if (strcasecmp(key, "size") == 0) {
+      if (strcasecmp(value, "lognormal") == 0) {
+        params->size_dist = SYNTHETIC_SIZE_LOGNORMAL;
+      } else {
+        params->size_dist = SYNTHETIC_SIZE_FIXED;
+        params->obj_size = (int64_t)v;
+      }
+    } else if (strcasecmp(key, "size_mu") == 0) {
+      params->size_mu = v;
+    } else if (strcasecmp(key, "size_sigma") == 0) {
+      params->size_sigma = v;
+    } else if (strcasecmp(key, "size_max") == 0) {
+      params->size_max = (int64_t)v;
+    } else if (strcasecmp(key, "scan_ratio") == 0) {
+      params->scan_ratio = v;
+    } else if (strcasecmp(key, "scan_len") == 0) {
+      params->scan_len = (int64_t)v;
+    } else if (strcasecmp(key, "loop_ratio") == 0) {
+      params->loop_ratio = v;
+    } else if (strcasecmp(key, "loop_len") == 0) {
+      params->loop_len = (int64_t)v;
+    } else if (strcasecmp(key, "one_hit_ratio") == 0) {
+      params->one_hit_ratio = v;
+    } else if (strcasecmp(key, "shift_every") == 0) {
+      params->shift_every = (int64_t)v;
+    } else if (strcasecmp(key, "shift_step") == 0) {
+      params->shift_step = (int64_t)v;
+    } else if (strcasecmp(key, "lookahead") == 0) {
+      params->lookahead = (int64_t)v;
+    } else {
+      ERROR("unknown synthetic workload parameter %s\n", key);
+      exit(1);
+    }
+  }
+  free(spec_copy);
+
+  if (params->n_obj <= 0 || params->n_req <= 0 || params->req_rate <= 0 ||
+      params->obj_size <= 0 || params->scan_len <= 0 ||
+      params->loop_len <= 0 || params->lookahead < 0) {
+    ERROR("invalid synthetic workload parameters %s\n", spec);
+    exit(1);
+  }
+  if (params->scan_ratio < 0 || params->loop_ratio < 0 ||
+      params->one_hit_ratio < 0 ||
+      params->scan_ratio + params->loop_ratio + params->one_hit_ratio > 1) {
+    ERROR("scan_ratio + loop_ratio + one_hit_ratio should be in [0, 1]\n");
+    exit(1);
+  }
+  if (params->shift_every > 0 && params->shift_step == 0) {
+    params->shift_step = params->n_obj / 10 + 1;
+  }
+
+  /* a scan emits scan_len requests, so it starts less often than
+   * scan_ratio, other choices emit one request */
+  double l = (double)params->scan_len;
+  params->p_scan = params->scan_ratio / (l - params->scan_ratio * (l - 1));
+  double n_req_per_choice = 1 + params->p_scan * (l - 1);
+  params->p_one_hit = params->one_hit_ratio * n_req_per_choice;
+  params->p_loop = params->loop_ratio * n_req_per_choice;
+}
+
+static void _reset_state(synthetic_reader_params_t *params) {
+  _seed_rng(params);
+  params->n_gen = 0;
+  params->n_out = 0;
+  params->scan_pos = 0;
+  params->scan_left = 0;
+  params->loop_pos = 0;
+  params->n_one_hit = 0;
+  if (params->lookahead > 0) {
+    memset(params->last_pos, 0xff,
+           sizeof(int64_t) * (params->last_pos_mask + 1));
+    params->n_insert_since_rebuild = 0;
+  }
+}
+
+static void _alloc_window(synthetic_reader_params_t *params) {
+  if (params->lookahead == 0) return;
+
+  params->window = (synthetic_req_t *)malloc(sizeof(synthetic_req_t) *
+                                             params->lookahead);
+  uint64_t table_size = next_power_of_2_v2(params->lookahead * 4);
+  if (table_size < SYNTHETIC_MIN_LAST_POS_TABLE_SIZE)
+    table_size = SYNTHETIC_MIN_LAST_POS_TABLE_SIZE;
+  params->last_pos_mask = table_size - 1;
+  params->last_pos_obj = (obj_id_t *)malloc(sizeof(obj_id_t) * table_size);
+  params->last_pos = (int64_t *)malloc(sizeof(int64_t) * table_size);
+}
+
+static reader_t *_new_synthetic_reader(const char *spec,
+                                       const reader_init_param_t *init_params) {
+  reader_t *const reader = (reader_t *)malloc(sizeof(reader_t));
+  memset(reader, 0, sizeof(reader_t));
+
+  reader->trace_type = SYNTHETIC_TRACE;
+  reader->trace_format = VIRTUAL_TRACE_FORMAT;
+  reader->read_direction = READ_FORWARD;
+  reader->last_req_clock_time = -1;
+  reader->cap_at_n_req = -1;
+  reader->trace_path = strdup(spec);
+  if (init_params != NULL) {
+    memcpy(&reader->init_params, init_params, sizeof(reader_init_param_t));
+    reader->init_params.binary_fmt_str = NULL;
+    reader->init_params.sampler = NULL;
+    reader->ignore_obj_size = init_params->ignore_obj_size;
+    reader->cap_at_n_req = init_params->cap_at_n_req;
+    if (init_params->sampler != NULL)
+      reader->sampler = init_params->sampler->clone(init_params->sampler);
+  }
+
+  return reader;
+}
+
+/**************** reader interface ****************/
+reader_t *setup_synthetic_reader(const char *spec,
+                                 const reader_init_param_t *init_params) {
+  reader_t *reader = _new_synthetic_reader(spec, init_params);
+
+  synthetic_reader_params_t *params =
+      (synthetic_reader_params_t *)malloc(sizeof(synthetic_reader_params_t));
+  memset(params, 0, sizeof(synthetic_reader_params_t));
+  _set_default_params(params);
+  _parse_params(params, spec);
+  if (params->dist == SYNTHETIC_ZIPF) {
+    _build_alias_table(params);
+  }
+  _alloc_window(params);
+  _reset_state(params);
+
+  reader->n_total_req = params->n_req;
+  reader->reader_params = params;
+
+  INFO(
+      "synthetic workload %s: %ld objects, %ld requests, alpha %.4lf, "
+      "scan %.4lf, loop %.4lf, one-hit %.4lf, lookahead %ld\n",
+      params->dist == SYNTHETIC_ZIPF ? "zipf" : "uniform",
+      (long)params->n_obj, (long)params->n_req, params->alpha,
+      params->scan_ratio, params->loop_ratio, params->one_hit_ratio,
+      (long)params->lookahead);
+
+  return reader;
+}
+
+int synthetic_read_one_req(reader_t *reader, request_t *req) {
+  synthetic_reader_params_t *params =
+      (synthetic_reader_params_t *)reader->reader_params;
+
+  if (params->n_out >= params->n_req) {
+    req->valid = false;
+    return 1;
+  }
+
+  synthetic_req_t one_req;
+  synthetic_req_t *sreq = &one_req;
+  if (params->lookahead > 0) {
+    _fill_window(params);
+    sreq = &params->window[params->n_out % params->lookahead];
+  } else {
+    _gen_one_req(params, sreq);
+    /* the future is unknown without the lookahead window */
+    sreq->next_access_vtime = -2;
+  }
+  params->n_out++;
+
+  req->clock_time = sreq->clock_time;
+  req->obj_id = sreq->obj_id;
+  req->obj_size = sreq->obj_size;
+  req->next_access_vtime = sreq->next_access_vtime;
+  req->op = OP_GET;
+  req->valid = true;
+
+  return 0;
+}
+
+void synthetic_reset_reader(reader_t *reader) {
+  _reset_state((synthetic_reader_params_t *)reader->reader_params);
+}
+
+reader_t *clone_synthetic_reader(const reader_t *reader_in) {
+  synthetic_reader_params_t *params_in =
+      (synthetic_reader_params_t *)reader_in->reader_params;
+  reader_t *reader =
+      _new_synthetic_reader(reader_in->trace_path, &reader_in->init_params);
+  if (reader_in->sampler != NULL && reader->sampler == NULL) {
+    reader->sampler = reader_in->sampler->clone(reader_in->sampler);
+  }
+  reader->cap_at_n_req = reader_in->cap_at_n_req;
+  reader->ignore_obj_size = reader_in->ignore_obj_size;
+  reader->n_total_req = reader_in->n_total_req;
+
+  /* the alias table is shared, the generator state is not */
+  synthetic_reader_params_t *params =
+      (synthetic_reader_params_t *)malloc(sizeof(synthetic_reader_params_t));
+  memcpy(params, params_in, sizeof(synthetic_reader_params_t));
+  if (params->alias_n_ref != NULL) {
+    __atomic_fetch_add(params->alias_n_ref, 1, __ATOMIC_RELAXED);
+  }
+  params->window = NULL;
+  params->last_pos_obj = NULL;
+  params->last_pos = NULL;
+  _alloc_window(params);
+  _reset_state(params);
+
+  reader->reader_params = params;
+  reader->cloned = true;
+  return reader;
+}
+
+void synthetic_close_reader(reader_t *reader) {
+  synthetic_reader_params_t *params =
+      (synthetic_reader_params_t *)reader->reader_params;
+  if (params->alias_n_ref != NULL &&
+      __atomic_sub_fetch(params->alias_n_ref, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(params->alias_prob);
+    free(params->alias_idx);
+    free(params->alias_n_ref);
+  }
+  free(params->window);
+  free(params->last_pos_obj);
+  free(params->last_pos);
+  /* params is freed in close_reader */
+}
+
+#ifdef __cplusplus
+}
+#endif
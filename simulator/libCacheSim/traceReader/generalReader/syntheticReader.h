@@ -0,0 +1,103 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "../../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  SYNTHETIC_ZIPF,
+  SYNTHETIC_UNIFORM,
+} synthetic_dist_e;
+
+typedef enum {
+  SYNTHETIC_SIZE_FIXED,
+  SYNTHETIC_SIZE_LOGNORMAL,
+} synthetic_size_dist_e;
+
+/* a generated request kept in the lookahead window */
+typedef struct {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int64_t next_access_vtime;
+} synthetic_req_t;
+
+typedef struct {
+  /* popularity distribution of the objects */
+  synthetic_dist_e dist;
+  double alpha;
+  int64_t n_obj;
+  int64_t n_req;
+  uint64_t seed;
+  /* requests per second, used to compute clock_time */
+  double req_rate;
+
+  synthetic_size_dist_e size_dist;
+  int64_t obj_size;
+  double size_mu;
+  double size_sigma;
+  int64_t size_max;
+
+  /* the fraction of requests from scans, loops and one-hit wonders */
+  double scan_ratio;
+  int64_t scan_len;
+  double loop_ratio;
+  int64_t loop_len;
+  double one_hit_ratio;
+  /* every shift_every requests, the popularity ranks move by shift_step */
+  int64_t shift_every;
+  int64_t shift_step;
+
+  /* probability of each choice made when not in a scan, computed from the
+   * ratios above so that the ratios are the fraction of requests */
+  double p_one_hit;
+  double p_loop;
+  double p_scan;
+
+  /* alias table of the zipf distribution, read-only after setup and
+   * shared with cloned readers,
+   * prob is the probability of keeping the sampled slot in 2^-32 */
+  uint32_t *alias_prob;
+  uint32_t *alias_idx;
+  /* the number of readers sharing the alias table, the last one to close
+   * frees it, so the original can be closed before its clones */
+  int32_t *alias_n_ref;
+
+  /* generator state */
+  uint64_t rng[4];
+  int64_t n_gen;
+  int64_t n_out;
+  int64_t scan_pos;
+  int64_t scan_left;
+  int64_t loop_pos;
+  int64_t n_one_hit;
+
+  /* when lookahead > 0, requests are generated lookahead requests ahead so
+   * that next_access_vtime can be computed, reuses farther than the window
+   * are reported as no future access */
+  int64_t lookahead;
+  synthetic_req_t *window;
+  /* open-addressing table from obj_id to its last position in the window,
+   * rebuilt every lookahead requests to drop positions out of the window */
+  obj_id_t *last_pos_obj;
+  int64_t *last_pos;
+  uint64_t last_pos_mask;
+  int64_t n_insert_since_rebuild;
+} synthetic_reader_params_t;
+
+int synthetic_read_one_req(reader_t *reader, request_t *req);
+
+void synthetic_reset_reader(reader_t *reader);
+
+reader_t *clone_synthetic_reader(const reader_t *reader);
+
+void synthetic_close_reader(reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -25,7 +25,10 @@
 #include "customizedReader/wikiBin.h"
 #include "generalReader/lcs.h"
 #include "generalReader/libcsv.h"
+#include "generalReader/mergeReader.h"
 #include "generalReader/readerInternal.h"
+#include "generalReader/streamReader.h"
+#include "generalReader/syntheticReader.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +46,14 @@ reader_t *setup_reader(const char *const trace_path,
                        const reader_init_param_t *const init_params) {
   static bool _info_printed = false;
 
+  if (trace_type == MERGE_TRACE) {
+    ERROR("merge trace should be created using setup_merge_reader\n");
+    abort();
+  }
+  if (trace_type == SYNTHETIC_TRACE) {
+    return setup_synthetic_reader(trace_path, init_params);
+  }
+
   int fd;
   struct stat st;
   reader_t *const reader = (reader_t *)malloc(sizeof(reader_t));
@@ -52,6 +63,8 @@ reader_t *setup_reader(const char *const trace_path,
    * currently zstd reader only supports a few binary trace */
   reader->is_zstd_file = false;
   reader->zstd_reader_p = NULL;
+  reader->is_stream = false;
+  reader->stream_reader_p = NULL;
 #ifdef SUPPORT_ZSTD_TRACE
   size_t slen = strlen(trace_path);
   if (strncmp(trace_path + (slen - 4), ".zst", 4) == 0 ||
@@ -67,6 +80,7 @@ reader_t *setup_reader(const char *const trace_path,
   reader->trace_format = INVALID_TRACE_FORMAT;
   reader->trace_type = trace_type;
   reader->n_total_req = 0;
+  reader->n_total_obj = 0;
   reader->n_read_req = 0;
   reader->ignore_size_zero_req = true;
   reader->ignore_obj_size = false;
@@ -101,7 +115,10 @@ reader_t *setup_reader(const char *const trace_path,
   assert(trace_path != NULL);
   reader->trace_path = strdup(trace_path);
 
-  if ((fd = open(trace_path, O_RDONLY)) < 0) {
+  /* "-" reads the trace from stdin */
+  if (strcmp(trace_path, "-") == 0) {
+    fd = STDIN_FILENO;
+  } else if ((fd = open(trace_path, O_RDONLY)) < 0) {
     ERROR("Unable to open '%s', %s\n", trace_path, strerror(errno));
     exit(1);
   }
@@ -113,8 +130,29 @@ reader_t *setup_reader(const char *const trace_path,
   }
   reader->file_size = st.st_size;
 
-  if (reader->trace_type == CSV_TRACE ||
-      reader->trace_type == PLAIN_TXT_TRACE) {
+  /* pipes and character devices cannot be mmaped or rewound */
+  if (!S_ISREG(st.st_mode) && !reader->is_zstd_file) {
+    if (trace_type == VSCSI_TRACE) {
+      ERROR("%s trace cannot be read from a stream\n",
+            g_trace_type_name[trace_type]);
+    }
+    reader->is_stream = true;
+    reader->file_size = 0;
+    reader->stream_reader_p = create_stream_reader(fd, STREAM_READER_BUF_SIZE);
+    if (!_info_printed) {
+      VERBOSE("reading trace from a stream\n");
+    }
+  }
+
+  if (reader->is_stream) {
+    if (reader->trace_type == CSV_TRACE ||
+        reader->trace_type == PLAIN_TXT_TRACE) {
+      reader->file = stream_reader_fopen(reader->stream_reader_p);
+      reader->line_buf_size = MAX_LINE_LEN;
+      reader->line_buf = (char *)malloc(reader->line_buf_size);
+    }
+  } else if (reader->trace_type == CSV_TRACE ||
+             reader->trace_type == PLAIN_TXT_TRACE) {
     reader->file = fopen(reader->trace_path, "rb");
     if (reader->file == 0) {
       ERROR("Failed to open %s: %s\n", reader->trace_path, strerror(errno));
@@ -232,7 +270,8 @@ reader_t *setup_reader(const char *const trace_path,
       abort();
   }
 
-  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file) {
+  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file &&
+      !reader->is_stream) {
     ssize_t data_region_size = reader->file_size - reader->trace_start_offset;
     if (data_region_size % reader->item_size != 0) {
       WARN(
@@ -260,7 +299,8 @@ reader_t *setup_reader(const char *const trace_path,
     reader->n_total_req = 0;
   }
 
-  close(fd);
+  /* the stream reader owns the fd */
+  if (!reader->is_stream) close(fd);
   return reader;
 }
 
@@ -320,7 +360,8 @@ reader_t *setup_reader(const char *const trace_path,
  * @return 0 if success, 1 if end of file
  */
 int read_one_req(reader_t *const reader, request_t *const req) {
-  if (reader->mmap_offset >= reader->file_size) {
+  if (reader->trace_format != VIRTUAL_TRACE_FORMAT && !reader->is_stream &&
+      reader->mmap_offset >= reader->file_size) {
     DEBUG("read_one_req: end of file, current mmap_offset %zu, file size %zu\n",
           reader->mmap_offset, reader->file_size);
     req->valid = false;
@@ -425,6 +466,12 @@ int read_one_req(reader_t *const reader, request_t *const req) {
       case VALPIN_TRACE:
         status = valpin_read_one_req(reader, req);
         break;
+      case MERGE_TRACE:
+        status = merge_read_one_req(reader, req);
+        break;
+      case SYNTHETIC_TRACE:
+        status = synthetic_read_one_req(reader, req);
+        break;
       default:
         ERROR(
             "cannot recognize reader obj_id_type, given reader obj_id_type: "
@@ -473,6 +520,10 @@ int read_one_req(reader_t *const reader, request_t *const req) {
  * @return int
  */
 int go_back_one_req(reader_t *const reader) {
+  if (reader->is_stream) {
+    ERROR("cannot read backward from a stream\n");
+  }
+
   switch (reader->trace_format) {
     case TXT_TRACE_FORMAT:;
       ssize_t curr_offset = ftell(reader->file);
@@ -606,6 +657,11 @@ int skip_n_req(reader_t *reader, const int N) {
 }
 
 void reset_reader(reader_t *const reader) {
+  if (reader->is_stream) {
+    WARN_ONCE("cannot rewind a trace read from a stream\n");
+    return;
+  }
+
   /* rewind the reader back to beginning */
   long curr_offset = 0;
   if (reader->trace_type == PLAIN_TXT_TRACE) {
@@ -614,6 +670,10 @@ void reset_reader(reader_t *const reader) {
   } else if (reader->trace_type == CSV_TRACE) {
     csv_reset_reader(reader);
     curr_offset = ftell(reader->file);
+  } else if (reader->trace_type == MERGE_TRACE) {
+    merge_reset_reader(reader);
+  } else if (reader->trace_type == SYNTHETIC_TRACE) {
+    synthetic_reset_reader(reader);
   } else {
     reader->mmap_offset = reader->trace_start_offset;
     curr_offset = reader->mmap_offset;
@@ -631,9 +691,13 @@ void reset_reader(reader_t *const reader) {
 uint64_t get_num_of_req(reader_t *const reader) {
   if (reader->n_total_req > 0) return reader->n_total_req;
 
+  /* the number of requests in a stream is unknown until it is read */
+  if (reader->is_stream) return 0;
+
   uint64_t n_req = 0;
 
-  if (reader->trace_format == TXT_TRACE_FORMAT || reader->is_zstd_file) {
+  if (reader->trace_format == TXT_TRACE_FORMAT ||
+      reader->trace_format == VIRTUAL_TRACE_FORMAT || reader->is_zstd_file) {
     reader_t *reader_copy = clone_reader(reader);
     reader_copy->mmap_offset = 0;
     request_t *req = new_request();
@@ -649,9 +713,20 @@ uint64_t get_num_of_req(reader_t *const reader) {
 }
 
 reader_t *clone_reader(const reader_t *const reader_in) {
+  if (reader_in->trace_type == MERGE_TRACE) {
+    return clone_merge_reader(reader_in);
+  } else if (reader_in->trace_type == SYNTHETIC_TRACE) {
+    return clone_synthetic_reader(reader_in);
+  }
+
+  if (reader_in->is_stream) {
+    ERROR("cannot clone a reader that reads from a stream\n");
+  }
+
   reader_t *reader = setup_reader(reader_in->trace_path, reader_in->trace_type,
                                   &reader_in->init_params);
   reader->n_total_req = reader_in->n_total_req;
+  reader->n_total_obj = reader_in->n_total_obj;
 
   if (reader->trace_format != TXT_TRACE_FORMAT) {
     munmap(reader->mapped_file, reader->file_size);
@@ -686,6 +761,10 @@ int close_reader(reader_t *const reader) {
     if (reader->init_params.binary_fmt_str != NULL) {
       free(reader->init_params.binary_fmt_str);
     }
+  } else if (reader->trace_type == MERGE_TRACE) {
+    merge_close_reader(reader);
+  } else if (reader->trace_type == SYNTHETIC_TRACE) {
+    synthetic_close_reader(reader);
   }
 
 #ifdef SUPPORT_ZSTD_TRACE
@@ -694,6 +773,10 @@ int close_reader(reader_t *const reader) {
   }
 #endif
 
+  if (reader->is_stream) {
+    free_stream_reader(reader->stream_reader_p);
+  }
+
   if (!reader->cloned) {
     if (reader->mapped_file != NULL) {
       munmap(reader->mapped_file, reader->file_size);
@@ -727,6 +810,12 @@ void reader_set_read_pos(reader_t *const reader, double pos) {
    */
   if (pos > 1) pos = 1;
 
+  if (reader->trace_format == VIRTUAL_TRACE_FORMAT || reader->is_stream) {
+    ERROR("cannot set read position of %s\n",
+          g_trace_type_name[reader->trace_type]);
+    abort();
+  }
+
   size_t offset = (double)reader->file_size * pos;
   if (reader->trace_format == TXT_TRACE_FORMAT) {
     fseek(reader->file, offset, SEEK_SET);
@@ -107,6 +107,17 @@ static reader_t *setup_vscsi_reader_with_ignored_obj_size(void) {
   return reader_vscsi;
 }
 
+static reader_t *setup_oracleGeneralBin_reader_with_ignored_obj_size(void) {
+  char data_path[1024];
+  reader_init_param_t *init_params = g_new0(reader_init_param_t, 1);
+  init_params->ignore_obj_size = true;
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.bin");
+  reader_t *reader_oracle =
+      setup_reader(data_path, ORACLE_GENERAL_TRACE, init_params);
+  g_free(init_params);
+  return reader_oracle;
+}
+
 static reader_t *setup_vscsi_reader(void) {
   char data_path[1024];
   _detect_data_path(data_path, "cloudPhysicsIO.vscsi");
@@ -0,0 +1,186 @@
+//
+// tests of the concurrent cache engine of concurrentSim
+//
+
+#include "../libCacheSim/bin/concurrentSim/concurrentCache.h"
+#include "common.h"
+
+#define CC_CACHE_SIZE 5000
+
+typedef struct {
+  obj_id_t *obj_ids;
+  int64_t n_req;
+} cc_trace_t;
+
+typedef struct {
+  concurrent_cache_t *cache;
+  const cc_trace_t *trace;
+  int thread_id;
+  int n_thread;
+} cc_worker_t;
+
+static cc_trace_t *load_trace(reader_t *reader) {
+  cc_trace_t *trace = g_new0(cc_trace_t, 1);
+  trace->obj_ids = g_new(obj_id_t, get_num_of_req(reader));
+  request_t *req = new_request();
+  reset_reader(reader);
+  while (read_one_req(reader, req) == 0) {
+    trace->obj_ids[trace->n_req++] = req->obj_id;
+  }
+  reset_reader(reader);
+  free_request(req);
+  return trace;
+}
+
+/* the misses of a single-threaded cache in libCacheSim with unit size */
+static uint64_t run_reference(cache_t *cache, const cc_trace_t *trace) {
+  request_t *req = new_request();
+  uint64_t n_miss = 0;
+  for (int64_t i = 0; i < trace->n_req; i++) {
+    req->obj_id = trace->obj_ids[i];
+    req->obj_size = 1;
+    req->clock_time = i;
+    if (!cache->get(cache, req)) n_miss++;
+  }
+  free_request(req);
+  cache->cache_free(cache);
+  return n_miss;
+}
+
+/* each thread replays every n_thread-th request as concurrentSim does */
+static void *worker(void *data) {
+  cc_worker_t *w = (cc_worker_t *)data;
+  for (int64_t i = w->thread_id; i < w->trace->n_req; i += w->n_thread) {
+    concurrent_cache_get(w->cache, w->thread_id, w->trace->obj_ids[i]);
+  }
+  concurrent_cache_flush(w->cache, w->thread_id);
+  return NULL;
+}
+
+/* run the trace with n_thread threads, check the cache as --verify does,
+ * and return the misses */
+static uint64_t run_concurrent(cc_algo_e algo, cc_params_t params,
+                               const cc_trace_t *trace) {
+  concurrent_cache_t *cache = create_concurrent_cache(algo, params);
+  pthread_t threads[params.n_thread];
+  cc_worker_t workers[params.n_thread];
+  for (int i = 0; i < params.n_thread; i++) {
+    workers[i] = (cc_worker_t){.cache = cache,
+                               .trace = trace,
+                               .thread_id = i,
+                               .n_thread = params.n_thread};
+    pthread_create(&threads[i], NULL, worker, &workers[i]);
+  }
+
+  uint64_t n_get = 0, n_miss = 0;
+  for (int i = 0; i < params.n_thread; i++) {
+    pthread_join(threads[i], NULL);
+    n_get += cache->threads[i].n_get;
+    n_miss += cache->threads[i].n_miss;
+  }
+  g_assert_cmpint(n_get, ==, trace->n_req);
+
+  int64_t n_obj = concurrent_cache_check(cache);
+  g_assert_cmpint(n_obj, >, 0);
+  g_assert_cmpint(n_obj, <=, params.cache_size);
+
+  free_concurrent_cache(cache);
+  return n_miss;
+}
+
+static cc_params_t default_params(int n_thread) {
+  cc_params_t params = {.cache_size = CC_CACHE_SIZE,
+                        .n_thread = n_thread,
+                        .batch_size = 32,
+                        .delay_ratio = 0.1,
+                        .prob = 0.5,
+                        .n_bit_counter = 1};
+  return params;
+}
+
+/* with one thread, lru and clock evict the same objects as LRU and Clock */
+static void test_concurrent_cache_single_thread(gconstpointer user_data) {
+  const cc_trace_t *trace = (const cc_trace_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CC_CACHE_SIZE,
+                                     .hashpower = 16};
+
+  uint64_t n_miss_lru = run_reference(LRU_init(cc_params, NULL), trace);
+  g_assert_cmpint(run_concurrent(CC_LRU, default_params(1), trace), ==,
+                  n_miss_lru);
+
+  uint64_t n_miss_clock = run_reference(Clock_init(cc_params, NULL), trace);
+  g_assert_cmpint(run_concurrent(CC_CLOCK, default_params(1), trace), ==,
+                  n_miss_clock);
+
+  /* the lazy variants promote less and stay close to LRU on this trace */
+  for (cc_algo_e algo = CC_LRU_BATCH; algo <= CC_LRU_PROB; algo++) {
+    uint64_t n_miss = run_concurrent(algo, default_params(1), trace);
+    g_assert_cmpfloat((double)n_miss, <, n_miss_lru * 1.02);
+    g_assert_cmpfloat((double)n_miss, >, n_miss_lru * 0.98);
+  }
+}
+
+/* with many threads the hash table and the queue stay consistent, and the
+ * misses stay close to the sequential LRU */
+static void test_concurrent_cache_stress(gconstpointer user_data) {
+  const cc_trace_t *trace = (const cc_trace_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CC_CACHE_SIZE,
+                                     .hashpower = 16};
+  uint64_t n_miss_lru = run_reference(LRU_init(cc_params, NULL), trace);
+
+  for (cc_algo_e algo = CC_LRU; algo <= CC_LRU_PROB; algo++) {
+    for (int n_thread = 2; n_thread <= 8; n_thread *= 2) {
+      uint64_t n_miss = run_concurrent(algo, default_params(n_thread), trace);
+      g_assert_cmpfloat((double)n_miss, <, n_miss_lru * 1.05);
+      g_assert_cmpfloat((double)n_miss, >, n_miss_lru * 0.95);
+    }
+  }
+}
+
+/* clock-lockfree with one thread is the same as Clock with the same n-bit
+ * counter, with many threads the slots and the hash table stay consistent */
+static void test_concurrent_cache_clock_lockfree(gconstpointer user_data) {
+  const cc_trace_t *trace = (const cc_trace_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CC_CACHE_SIZE,
+                                     .hashpower = 16};
+
+  for (int n_bit = 1; n_bit <= 2; n_bit++) {
+    char clock_params[64];
+    snprintf(clock_params, sizeof(clock_params), "n-bit-counter=%d", n_bit);
+    uint64_t n_miss_clock =
+        run_reference(Clock_init(cc_params, clock_params), trace);
+
+    cc_params_t params = default_params(1);
+    params.n_bit_counter = n_bit;
+    g_assert_cmpint(run_concurrent(CC_CLOCK_LOCKFREE, params, trace), ==,
+                    n_miss_clock);
+
+    for (int n_thread = 2; n_thread <= 16; n_thread *= 2) {
+      params.n_thread = n_thread;
+      uint64_t n_miss = run_concurrent(CC_CLOCK_LOCKFREE, params, trace);
+      /* the interleaving changes the order, not the working set */
+      g_assert_cmpfloat((double)n_miss, <, n_miss_clock * 1.05);
+      g_assert_cmpfloat((double)n_miss, >, n_miss_clock * 0.95);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  reader_t *reader = setup_oracleGeneralBin_reader();
+  cc_trace_t *trace = load_trace(reader);
+  close_reader(reader);
+
+  g_test_add_data_func("/libCacheSim/concurrent_cache_single_thread", trace,
+                       test_concurrent_cache_single_thread);
+  g_test_add_data_func("/libCacheSim/concurrent_cache_stress", trace,
+                       test_concurrent_cache_stress);
+  g_test_add_data_func("/libCacheSim/concurrent_cache_clock_lockfree", trace,
+                       test_concurrent_cache_clock_lockfree);
+
+  int ret = g_test_run();
+  g_free(trace->obj_ids);
+  g_free(trace);
+  return ret;
+}
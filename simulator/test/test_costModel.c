@@ -0,0 +1,87 @@
+//
+// tests of the cost model of promotions
+//
+
+#include "../libCacheSim/include/libCacheSim/costModel.h"
+#include "common.h"
+
+#define COST_EPS 1e-6
+
+/* 1000 requests, 200 misses, 500 promotions of which 100 are reinsertions,
+ * with the default costs:
+ * the critical section is
+ *   200 misses * (lock 40 + 2 splices * 20)      = 16000
+ *   400 promotions on hit * lock 40              = 16000
+ *   (400 promotions + 100 reinsertions) * 20     = 10000
+ *   (200 misses + 100 reinsertions) * scan 5     =  1500
+ * the parallel part is
+ *   800 hits * 50 + 200 misses * 200 + 400 metadata writes * 2 = 80800
+ * so cpu 124.3 ns/req, critical section 43.5 ns/req, X(1) = 1000 / 124.3 */
+static cache_stat_t _test_stat(void) {
+  cache_stat_t stat;
+  memset(&stat, 0, sizeof(stat));
+  stat.n_req = 1000;
+  stat.n_miss = 200;
+  stat.n_promotion = 500;
+  stat.n_reinsertion = 100;
+  return stat;
+}
+
+static void test_cost_model_amdahl(gconstpointer user_data) {
+  cost_model_params_t params = default_cost_model_params();
+  cache_stat_t stat = _test_stat();
+  cost_estimate_t est = estimate_cost(&params, &stat);
+
+  g_assert_cmpfloat(fabs(est.cpu_ns_per_req - 124.3), <, COST_EPS);
+  g_assert_cmpfloat(fabs(est.cs_ns_per_req - 43.5), <, COST_EPS);
+  g_assert_cmpfloat(fabs(est.throughput_1 - 1000.0 / 124.3), <, COST_EPS);
+  /* Amdahl, sigma = 43.5 / 124.3, X(16) = 16 X(1) / (1 + 15 sigma) */
+  g_assert_cmpfloat(fabs(est.throughput_n - 20.597322348), <, COST_EPS);
+
+  /* one thread has no contention */
+  params.n_thread = 1;
+  est = estimate_cost(&params, &stat);
+  g_assert_cmpfloat(fabs(est.throughput_n - est.throughput_1), <, COST_EPS);
+}
+
+static void test_cost_model_usl(gconstpointer user_data) {
+  cost_model_params_t params = default_cost_model_params();
+  parse_cost_model_params("kappa=0.001", &params);
+  cache_stat_t stat = _test_stat();
+  cost_estimate_t est = estimate_cost(&params, &stat);
+
+  /* X(16) = 16 X(1) / (1 + 15 sigma + 0.001 * 16 * 15) */
+  g_assert_cmpfloat(fabs(est.cpu_ns_per_req - 124.3), <, COST_EPS);
+  g_assert_cmpfloat(fabs(est.throughput_n - 19.835563181), <, COST_EPS);
+}
+
+static void test_cost_model_batch(gconstpointer user_data) {
+  cost_model_params_t params = default_cost_model_params();
+  cache_stat_t stat = _test_stat();
+  /* the 400 promotions on hit take the lock 50 times,
+   * the critical section drops by 350 * 40 = 14000 */
+  stat.n_promotion_batch = 50;
+  cost_estimate_t est = estimate_cost(&params, &stat);
+
+  g_assert_cmpfloat(fabs(est.cpu_ns_per_req - 110.3), <, COST_EPS);
+  g_assert_cmpfloat(fabs(est.cs_ns_per_req - 29.5), <, COST_EPS);
+  g_assert_cmpfloat(fabs(est.throughput_n - 28.943560058), <, COST_EPS);
+
+  stat.n_req = 0;
+  est = estimate_cost(&params, &stat);
+  g_assert_cmpfloat(est.cpu_ns_per_req, ==, 0);
+  g_assert_cmpfloat(est.throughput_n, ==, 0);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/cost_model_amdahl", NULL,
+                       test_cost_model_amdahl);
+  g_test_add_data_func("/libCacheSim/cost_model_usl", NULL,
+                       test_cost_model_usl);
+  g_test_add_data_func("/libCacheSim/cost_model_batch", NULL,
+                       test_cost_model_batch);
+
+  return g_test_run();
+}
@@ -5,6 +5,11 @@
 #include "../libCacheSim/utils/include/mymath.h"
 #include "common.h"
 
+#if HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+#include "../libCacheSim/dataStructure/hashtable/hashtable.h"
+#include "../libCacheSim/traceReader/generalReader/lcs.h"
+#endif
+
 static const uint64_t g_req_cnt_true = 113872, g_req_byte_true = 4368040448;
 
 static void _verify_profiler_results(const cache_stat_t *res,
@@ -44,6 +49,75 @@ static void print_results(const cache_t *cache, const cache_stat_t *res) {
   printf("};\n");
 }
 
+#if HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+#define DENSE_TRACE_PATH "cloudPhysicsIO.dense.lcs"
+
+/* the direct index hashtable needs dense obj_id, so we remap the obj_id of the
+ * test trace in the order of first access as traceConv --remap-obj-id, and
+ * write a LCS trace, which has the number of objects in the header */
+static reader_t *setup_dense_lcs_reader(void) {
+  struct {
+    uint32_t clock_time;
+    uint64_t obj_id;
+    uint32_t obj_size;
+    int64_t next_access_vtime;
+  } __attribute__((packed)) og_req;
+
+  reader_t *reader = setup_oracleGeneralBin_reader();
+  FILE *ofile = fopen(DENSE_TRACE_PATH, "wb");
+  g_assert_nonnull(ofile);
+
+  lcs_trace_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.start_magic = LCS_TRACE_START_MAGIC;
+  header.end_magic = LCS_TRACE_END_MAGIC;
+  header.time_field = 1;
+  header.obj_id_field = 2;
+  header.obj_size_field = 3;
+  header.next_access_vtime_field = 4;
+  header.item_size = sizeof(og_req);
+  header.n_fields = 4;
+  memcpy(header.format, "<IQIQ", 5);
+  /* the header is written again after we have the trace stat */
+  fwrite(&header, sizeof(header), 1, ofile);
+
+  GHashTable *dense_obj_id =
+      g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+  request_t *req = new_request();
+  while (read_one_req(reader, req) == 0) {
+    int64_t *id = g_hash_table_lookup(dense_obj_id, &req->obj_id);
+    if (id == NULL) {
+      int64_t *key = g_new(int64_t, 1);
+      id = g_new(int64_t, 1);
+      *key = (int64_t)req->obj_id;
+      *id = g_hash_table_size(dense_obj_id);
+      g_hash_table_insert(dense_obj_id, key, id);
+    }
+    og_req.clock_time = req->clock_time;
+    og_req.obj_id = *id;
+    og_req.obj_size = req->obj_size;
+    og_req.next_access_vtime = req->next_access_vtime;
+    fwrite(&og_req, sizeof(og_req), 1, ofile);
+    header.n_req += 1;
+  }
+  header.n_obj = g_hash_table_size(dense_obj_id);
+  g_hash_table_destroy(dense_obj_id);
+  free_request(req);
+  close_reader(reader);
+
+  fseek(ofile, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, ofile);
+  fclose(ofile);
+
+  return setup_reader(DENSE_TRACE_PATH, LCS_TRACE, NULL);
+}
+
+static void dense_lcs_teardown(gpointer data) {
+  close_reader((reader_t *)data);
+  remove(DENSE_TRACE_PATH);
+}
+#endif
+
 static void test_LRU(gconstpointer user_data) {
   uint64_t miss_cnt_true[] = {93374, 89783, 83572, 81722,
                               72494, 72104, 71972, 71704};
@@ -51,10 +125,20 @@ static void test_LRU(gconstpointer user_data) {
                                3100927488, 3078128640, 3075403776, 3061662720};
 
   reader_t *reader = (reader_t *)user_data;
-  common_cache_params_t cc_params = {
-      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE,
+                                     .hashpower = 20,
+                                     .default_ttl = DEFAULT_TTL,
+                                     .n_obj = (int64_t)reader->n_total_obj};
   cache_t *cache = create_test_cache("LRU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
+#if HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+  /* the table is presized to the number of objects in the header */
+  g_assert_cmpuint(reader->n_total_obj, >, 0);
+  g_assert_cmpuint(hashsize(cache->hashtable->hashpower), >=,
+                   reader->n_total_obj);
+  g_assert_cmpuint(hashsize(cache->hashtable->hashpower - 1), <,
+                   reader->n_total_obj);
+#endif
   cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
       reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
 
@@ -72,8 +156,10 @@ static void test_Clock(gconstpointer user_data) {
                                3256760832, 3091688448, 3074241024, 2697378816};
 
   reader_t *reader = (reader_t *)user_data;
-  common_cache_params_t cc_params = {
-      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE,
+                                     .hashpower = 20,
+                                     .default_ttl = DEFAULT_TTL,
+                                     .n_obj = (int64_t)reader->n_total_obj};
   cache_t *cache = create_test_cache("Clock", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
   cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
@@ -93,8 +179,10 @@ static void test_FIFO(gconstpointer user_data) {
                                3093146112, 3079525888, 3079210496, 3077547520};
 
   reader_t *reader = (reader_t *)user_data;
-  common_cache_params_t cc_params = {
-      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE,
+                                     .hashpower = 20,
+                                     .default_ttl = DEFAULT_TTL,
+                                     .n_obj = (int64_t)reader->n_total_obj};
   cache_t *cache = create_test_cache("FIFO", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
   cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
@@ -539,6 +627,509 @@ static void test_LIRS(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* the miss counts of PredClock in modes 1, 2 and 3 with unit object size,
+ * the candidates are scored in batches, the counts are the same as those of
+ * scoring one object at a time */
+static void test_PredClock(gconstpointer user_data) {
+  const int64_t cache_sizes[] = {1000, 4000, 16000};
+  const int64_t miss_cnt_true[3][3] = {
+      {94748, 92781, 73481},
+      {95520, 92910, 72732},
+      {94735, 92780, 73481},
+  };
+
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request();
+  for (int mode = 1; mode <= 3; mode++) {
+    char params[32];
+    snprintf(params, sizeof(params), "mode=%d", mode);
+    for (int i = 0; i < 3; i++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[i],
+                                         .hashpower = 20,
+                                         .default_ttl = DEFAULT_TTL};
+      cache_t *cache = PredClock_init(cc_params, params);
+      int64_t n_miss = 0;
+      reset_reader(reader);
+      while (read_one_req(reader, req) == 0) {
+        req->obj_size = 1;
+        if (!cache->get(cache, req)) n_miss += 1;
+      }
+      g_assert_cmpint(n_miss, ==, miss_cnt_true[mode - 1][i]);
+      cache->cache_free(cache);
+    }
+  }
+  free_request(req);
+  reset_reader(reader);
+}
+
+/* the learned predictors see age and reuse distance divided by the expected
+ * reuse distance, a linear model 1 - age and a one level tree on age both
+ * retain the candidates younger than the expected reuse distance, as the
+ * age predictor with scaler 1 does */
+static void test_predictor(gconstpointer user_data) {
+  const char *linear_path = "test_predictor_linear.txt";
+  const char *gbdt_path = "test_predictor_gbdt.txt";
+  FILE *f = fopen(linear_path, "w");
+  fprintf(f, "linear 1 -1 0 0 0 0\n");
+  fclose(f);
+  f = fopen(gbdt_path, "w");
+  /* two trees, the second one does not change the sign */
+  fprintf(f, "gbdt 2 1\n%d 1.0\n1 -1\n%d 100\n0.5 0.5\n", PRED_FEAT_AGE,
+          PRED_FEAT_FREQ);
+  fclose(f);
+
+  predictor_t age, linear, gbdt;
+  predictor_init_age(&age, 1.0);
+  predictor_load(&linear, linear_path);
+  predictor_load(&gbdt, gbdt_path);
+  g_assert_cmpint(linear.kind, ==, PREDICTOR_LINEAR);
+  g_assert_cmpint(gbdt.kind, ==, PREDICTOR_GBDT);
+  g_assert_cmpint(gbdt.n_tree, ==, 2);
+
+  pred_batch_t batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.n = PRED_BATCH_SIZE - 1;
+  batch.expected_reuse_distance = 100;
+  for (int i = 0; i < batch.n; i++) {
+    batch.feat[PRED_FEAT_AGE][i] = i * 15 + 1;
+    batch.feat[PRED_FEAT_FREQ][i] = i % 3;
+  }
+
+  uint8_t retain_age[PRED_BATCH_SIZE], retain_linear[PRED_BATCH_SIZE],
+      retain_gbdt[PRED_BATCH_SIZE];
+  predictor_score_batch(&age, &batch, retain_age);
+  predictor_score_batch(&linear, &batch, retain_linear);
+  predictor_score_batch(&gbdt, &batch, retain_gbdt);
+  for (int i = 0; i < batch.n; i++) {
+    bool young = batch.feat[PRED_FEAT_AGE][i] < 100;
+    g_assert_cmpint(retain_age[i], ==, young);
+    g_assert_cmpint(retain_linear[i], ==, young);
+    g_assert_cmpint(retain_gbdt[i], ==, young);
+  }
+
+  remove(linear_path);
+  remove(gbdt_path);
+}
+
+/* the promotion budget caps the promotions per request over the trace, the
+ * cache holds 10% of the objects and ignores the object size */
+static void test_promotion_budget(gconstpointer user_data) {
+  const char *params[] = {
+      "promotion=Prob,prob=1,promotion-budget=0.02",
+      "promotion=Batch,promotion-budget=0.02",
+      "promotion=Delay,promotion-budget=0.02",
+      "promotion=AGE,promotion-budget=0.02",
+  };
+  const double budget = 0.02, tolerance = 1.1;
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = 5000, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  for (int i = 0; i < 5; i++) {
+    cache_t *cache = i < 4 ? PromoQueue_init(cc_params, params[i])
+                           : DelayFR_init(cc_params, "promotion-budget=0.01");
+    double cache_budget = i < 4 ? budget : 0.01;
+    request_t *req = new_request();
+    int64_t n_req = 0;
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      req->obj_size = 1;
+      cache->get(cache, req);
+      n_req += 1;
+    }
+    double rate = (double)cache->n_promotion / (double)n_req;
+    printf("%s %s: %.4lf promotions per request\n", cache->cache_name,
+           i < 4 ? params[i] : "", rate);
+    g_assert_cmpfloat(rate, <=, cache_budget * tolerance);
+    /* the budget does not disable promotion */
+    g_assert_cmpint(cache->n_promotion, >, 0);
+    free_request(req);
+    cache->cache_free(cache);
+  }
+  reset_reader(reader);
+}
+
+/* budget-epsilon keeps the miss ratio within epsilon of the policy without
+ * the budget, which the budget alone does not */
+static void test_promotion_budget_epsilon(gconstpointer user_data) {
+  const char *policies[] = {
+      "promotion=Prob,prob=1",
+      "promotion=Delay,delay-time=1",
+      "promotion=Batch,batch-size=1",
+  };
+  const double budget = 0.005, epsilon = 0.005;
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = 500, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+  for (int i = 0; i < 3; i++) {
+    char params[3][256];
+    snprintf(params[0], sizeof(params[0]), "%s", policies[i]);
+    snprintf(params[1], sizeof(params[1]), "%s,promotion-budget=%g",
+             policies[i], budget);
+    snprintf(params[2], sizeof(params[2]),
+             "%s,promotion-budget=%g,budget-epsilon=%g", policies[i], budget,
+             epsilon);
+    double miss_ratio[3];
+    int64_t n_promotion[3];
+    for (int j = 0; j < 3; j++) {
+      cache_t *cache = PromoQueue_init(cc_params, params[j]);
+      int64_t n_req = 0, n_miss = 0;
+      reset_reader(reader);
+      while (read_one_req(reader, req) == 0) {
+        req->obj_size = 1;
+        n_miss += !cache->get(cache, req);
+        n_req += 1;
+      }
+      miss_ratio[j] = (double)n_miss / (double)n_req;
+      n_promotion[j] = cache->n_promotion;
+      cache->cache_free(cache);
+    }
+    g_assert_cmpfloat(miss_ratio[1] - miss_ratio[0], >, epsilon);
+    g_assert_cmpfloat(miss_ratio[2] - miss_ratio[0], <=, epsilon);
+    /* the guard spends promotions only where the budget alone loses hits */
+    g_assert_cmpint(n_promotion[2], >, n_promotion[1]);
+    g_assert_cmpint(n_promotion[2], <, n_promotion[0]);
+  }
+  free_request(req);
+  reset_reader(reader);
+}
+
+/* get_batch of lpFIFO_shards runs each shard on the thread that owns it,
+ * so it hits the same requests as the sequential get */
+static void test_lpFIFO_shards_batch(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = 5000, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *seq = lpFIFO_shards_init(cc_params, "n-shards=4,n-thread=0");
+  cache_t *par = lpFIFO_shards_init(cc_params, "n-shards=4,n-thread=4");
+
+  const int batch_size = 1000;
+  request_t *reqs = malloc(sizeof(request_t) * batch_size);
+  bool *hits = malloc(sizeof(bool) * batch_size);
+  int64_t n_hit_seq = 0, n_hit_par = 0;
+  int n = 0;
+  reset_reader(reader);
+  while (read_one_req(reader, &reqs[n]) == 0) {
+    reqs[n].obj_size = 1;
+    if (++n < batch_size) continue;
+    for (int i = 0; i < n; i++) n_hit_seq += seq->get(seq, &reqs[i]);
+    par->get_batch(par, reqs, n, hits);
+    for (int i = 0; i < n; i++) n_hit_par += hits[i];
+    n = 0;
+  }
+  for (int i = 0; i < n; i++) n_hit_seq += seq->get(seq, &reqs[i]);
+  par->get_batch(par, reqs, n, hits);
+  for (int i = 0; i < n; i++) n_hit_par += hits[i];
+
+  g_assert_cmpint(par->n_req, ==, seq->n_req);
+  g_assert_cmpint(n_hit_seq, >, 0);
+  g_assert_cmpint(n_hit_par, ==, n_hit_seq);
+  g_assert_cmpint(par->get_occupied_byte(par), ==,
+                  seq->get_occupied_byte(seq));
+
+  /* a cache that never serves a batch starts no thread */
+  cache_t *idle = lpFIFO_shards_init(cc_params, "n-shards=4,n-thread=4");
+  idle->cache_free(idle);
+
+  free(reqs);
+  free(hits);
+  seq->cache_free(seq);
+  par->cache_free(par);
+  reset_reader(reader);
+}
+
+/* a model of lpFIFO_batch that buffers every hit with the insertion it
+ * belongs to, and replays the buffer in order at the flush, an entry is
+ * stale if the object was evicted since it was buffered */
+typedef struct {
+  obj_id_t obj_id;
+  int64_t n_insert;
+  int64_t last_flush;
+  GList *link;
+} batch_ref_obj_t;
+
+typedef struct {
+  obj_id_t obj_id;
+  int64_t n_insert;
+} batch_ref_hit_t;
+
+static void _batch_ref_run(reader_t *reader, int64_t cache_size,
+                           int64_t batch_size, int64_t *n_miss,
+                           int64_t *n_promotion) {
+  GHashTable *objs = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+                                           g_free);
+  GQueue *queue = g_queue_new();
+  GArray *buffer = g_array_new(FALSE, FALSE, sizeof(batch_ref_hit_t));
+  int64_t n_insert = 0, prev_flush = 0, n_flush = 0;
+  request_t *req = new_request();
+  *n_miss = *n_promotion = 0;
+
+  reset_reader(reader);
+  while (read_one_req(reader, req) == 0) {
+    batch_ref_obj_t *obj = g_hash_table_lookup(objs, &req->obj_id);
+    if (obj != NULL) {
+      batch_ref_hit_t hit = {obj->obj_id, obj->n_insert};
+      g_array_append_val(buffer, hit);
+      if (n_insert - prev_flush < batch_size) continue;
+
+      n_flush += 1;
+      for (guint i = 0; i < buffer->len; i++) {
+        batch_ref_hit_t *h = &g_array_index(buffer, batch_ref_hit_t, i);
+        batch_ref_obj_t *o = g_hash_table_lookup(objs, &h->obj_id);
+        if (o == NULL || o->n_insert != h->n_insert) continue;
+        if (o->last_flush != n_flush) *n_promotion += 1;
+        o->last_flush = n_flush;
+        g_queue_unlink(queue, o->link);
+        g_queue_push_head_link(queue, o->link);
+      }
+      g_array_set_size(buffer, 0);
+      prev_flush = n_insert;
+      continue;
+    }
+
+    *n_miss += 1;
+    if ((int64_t)g_queue_get_length(queue) == cache_size) {
+      batch_ref_obj_t *victim = g_queue_pop_tail(queue);
+      g_hash_table_remove(objs, &victim->obj_id);
+    }
+    obj = g_new0(batch_ref_obj_t, 1);
+    obj->obj_id = req->obj_id;
+    obj->n_insert = ++n_insert;
+    g_queue_push_head(queue, obj);
+    obj->link = queue->head;
+    g_hash_table_insert(objs, &obj->obj_id, obj);
+  }
+
+  reset_reader(reader);
+  free_request(req);
+  g_array_free(buffer, TRUE);
+  g_queue_free(queue);
+  g_hash_table_destroy(objs);
+}
+
+/* lpFIFO_batch keeps one slot per object hit in a batch, and promotes in
+ * the order of the last hit, it must miss and promote as the model that
+ * replays every buffered hit */
+static void test_lpFIFO_batch(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const int64_t cache_sizes[] = {500, 5000, 20000};
+  const int64_t batch_sizes[] = {1, 100, 2000};
+
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[i],
+                                         .hashpower = 20,
+                                         .default_ttl = DEFAULT_TTL};
+      char params[64];
+      snprintf(params, sizeof(params), "batch-size=%ld",
+               (long)batch_sizes[j]);
+      cache_t *cache = lpFIFO_batch_init(cc_params, params);
+      request_t *req = new_request();
+      int64_t n_miss = 0;
+      reset_reader(reader);
+      while (read_one_req(reader, req) == 0) {
+        req->obj_size = 1;
+        if (!cache->get(cache, req)) n_miss += 1;
+      }
+
+      int64_t n_miss_ref, n_promotion_ref;
+      _batch_ref_run(reader, cache_sizes[i], batch_sizes[j], &n_miss_ref,
+                     &n_promotion_ref);
+      g_assert_cmpint(n_miss, ==, n_miss_ref);
+      g_assert_cmpint(cache->n_promotion, ==, n_promotion_ref);
+      free_request(req);
+      cache->cache_free(cache);
+    }
+  }
+  reset_reader(reader);
+}
+
+/* an object hit many times in a batch is promoted once, and the flush puts
+ * the most recently hit object at the head */
+static void test_lpFIFO_batch_dedup(gconstpointer user_data) {
+  common_cache_params_t cc_params = {
+      .cache_size = 10, .hashpower = 8, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = lpFIFO_batch_init(cc_params, "batch-size=10");
+  request_t *req = new_request();
+  req->obj_size = 1;
+
+#define BATCH_GET(id) (req->obj_id = (id), cache->get(cache, req))
+#define BATCH_IN_CACHE(id) \
+  (req->obj_id = (id), cache->find(cache, req, false) != NULL)
+  for (obj_id_t id = 1; id <= 5; id++) g_assert_false(BATCH_GET(id));
+  for (int i = 0; i < 100; i++) {
+    g_assert_true(BATCH_GET(2));
+    g_assert_true(BATCH_GET(1));
+  }
+  for (obj_id_t id = 6; id <= 10; id++) g_assert_false(BATCH_GET(id));
+  /* the 10th insertion has happened, this hit flushes the batch */
+  g_assert_true(BATCH_GET(3));
+  g_assert_cmpint(cache->n_promotion, ==, 3);
+  g_assert_cmpint(cache->n_promotion_batch, ==, 1);
+
+  /* the queue from the tail is 4 .. 10, 2, 1, 3 */
+  for (obj_id_t id = 11; id <= 17; id++) g_assert_false(BATCH_GET(id));
+  g_assert_true(BATCH_IN_CACHE(2));
+  g_assert_false(BATCH_IN_CACHE(10));
+  g_assert_false(BATCH_GET(18));
+  g_assert_false(BATCH_IN_CACHE(2));
+  g_assert_true(BATCH_IN_CACHE(1));
+#undef BATCH_GET
+#undef BATCH_IN_CACHE
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+/* the promotion variants of ARC and TwoQ and the promotion queue, the miss
+ * counts are pinned so that a change of the queue implementation that
+ * changes the eviction decisions is caught, Prob draws from rand, so the
+ * caches are run one at a time from the same seed */
+static void test_promo_variants(gconstpointer user_data) {
+  typedef struct {
+    cache_t *(*init)(const common_cache_params_t, const char *);
+    const char *params;
+    uint64_t miss_cnt_true[3];
+  } promo_variant_t;
+  const promo_variant_t variants[] = {
+      {ARC_LRU_init, NULL, {82956, 74297, 64772}},
+      {ARC_Prob_init, NULL, {82956, 74297, 64726}},
+      {ARC_Delay_init, NULL, {82956, 74297, 64824}},
+      {ARC_Batch_init, NULL, {82956, 74297, 64824}},
+      {ARC_FR_init, NULL, {82956, 74297, 64737}},
+      {ARC_promo_init, "promotion=AGE", {82956, 74297, 64737}},
+      {ARC_promo_init,
+       "promotion=Delay,delay-time=1000",
+       {82956, 74297, 64772}},
+      {ARC_promo_init,
+       "promotion=Batch,batch-size=1000",
+       {82956, 74297, 64774}},
+      {TwoQ_LRU_init, NULL, {83567, 77039, 72074}},
+      {TwoQ_Prob_init, NULL, {83567, 77054, 72106}},
+      {TwoQ_Delay_init, NULL, {83567, 77072, 72194}},
+      {TwoQ_Batch_init, NULL, {83567, 77072, 72194}},
+      {TwoQ_FR_init, NULL, {83567, 77039, 72049}},
+      {TwoQ_promo_init, "promotion=AGE", {83567, 77039, 72049}},
+      {TwoQ_promo_init,
+       "promotion=Delay,delay-time=1000",
+       {83567, 77039, 72074}},
+      {TwoQ_promo_init,
+       "promotion=Batch,batch-size=1000",
+       {83567, 77039, 72074}},
+      {PromoQueue_init, "promotion=LRU", {89783, 81722, 71704}},
+      {PromoQueue_init, "promotion=Prob", {89567, 82695, 71881}},
+      {PromoQueue_init, "promotion=Delay", {89386, 84025, 72140}},
+      {PromoQueue_init, "promotion=Batch", {89386, 84025, 72140}},
+      {PromoQueue_init, "promotion=FR", {89775, 81328, 64456}},
+      {PromoQueue_init, "promotion=AGE", {89775, 81328, 64456}},
+      {PromoQueue_init,
+       "promotion=Delay,delay-time=1000",
+       {89780, 81723, 71707}},
+      {PromoQueue_init,
+       "promotion=Batch,batch-size=1000",
+       {89465, 81754, 71711}},
+  };
+  const uint64_t cache_sizes[] = {256 * MiB, 512 * MiB, 1024 * MiB};
+
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request();
+  for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+    uint64_t miss_cnt[3];
+    char name[CACHE_NAME_ARRAY_LEN];
+    for (int j = 0; j < 3; j++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[j],
+                                         .hashpower = 20,
+                                         .default_ttl = DEFAULT_TTL};
+      cache_t *cache = variants[i].init(cc_params, variants[i].params);
+      strncpy(name, cache->cache_name, CACHE_NAME_ARRAY_LEN - 1);
+      name[CACHE_NAME_ARRAY_LEN - 1] = '\0';
+      srand(0);
+      miss_cnt[j] = 0;
+      reset_reader(reader);
+      while (read_one_req(reader, req) == 0) {
+        if (!cache->get(cache, req)) miss_cnt[j] += 1;
+      }
+      cache->cache_free(cache);
+    }
+    printf("%s uint64_t miss_cnt_true[] = {%lu, %lu, %lu};\n", name,
+           (unsigned long)miss_cnt[0], (unsigned long)miss_cnt[1],
+           (unsigned long)miss_cnt[2]);
+    for (int j = 0; j < 3; j++) {
+      g_assert_cmpuint(miss_cnt[j], ==, variants[i].miss_cnt_true[j]);
+    }
+  }
+  free_request(req);
+  reset_reader(reader);
+}
+
+/* the simulator empties each cache at the end of the trace, which evicts from
+ * ARC and TwoQ after one of their queues is empty */
+static void test_promo_variants_multi_size(gconstpointer user_data) {
+  cache_t *(*inits[])(const common_cache_params_t, const char *) = {
+      ARC_LRU_init,   ARC_Prob_init,   ARC_Delay_init,   ARC_Batch_init,
+      ARC_FR_init,    TwoQ_LRU_init,   TwoQ_Prob_init,   TwoQ_Delay_init,
+      TwoQ_Batch_init, TwoQ_FR_init};
+  const uint64_t cache_sizes[] = {20 * MiB, 97 * MiB, 194 * MiB};
+
+  reader_t *reader = (reader_t *)user_data;
+  for (size_t i = 0; i < sizeof(inits) / sizeof(inits[0]); i++) {
+    cache_t *caches[3];
+    for (int j = 0; j < 3; j++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[j],
+                                         .hashpower = 20,
+                                         .default_ttl = DEFAULT_TTL};
+      caches[j] = inits[i](cc_params, NULL);
+    }
+    cache_stat_t *res =
+        simulate_with_multi_caches(reader, caches, 3, NULL, 0, 0, 1, true);
+    for (int j = 0; j < 3; j++) {
+      g_assert_cmpuint(res[j].n_req, ==, res[0].n_req);
+      g_assert_cmpuint(res[j].n_miss, >, 0);
+      if (j > 0) g_assert_cmpuint(res[j].n_miss, <=, res[j - 1].n_miss);
+    }
+    g_assert_cmpuint(res[0].n_req, >, 0);
+    g_free(res);
+  }
+  reset_reader(reader);
+}
+
+/* the promotion count includes the reinsertions at eviction, as in Clock, but
+ * not the ones made when the simulator empties the cache at the end, so it is
+ * the same as before ARC and TwoQ used promo_queue_t (unit size objects) */
+static void test_promo_variants_promotion_cnt(gconstpointer user_data) {
+  typedef struct {
+    cache_t *(*init)(const common_cache_params_t, const char *);
+    int64_t n_promotion_true[2];
+  } promo_variant_t;
+  const promo_variant_t variants[] = {
+      {ARC_LRU_init, {17514, 19172}},  {ARC_Delay_init, {1543, 922}},
+      {ARC_Batch_init, {2153, 1848}},  {ARC_FR_init, {2429, 1655}},
+      {TwoQ_LRU_init, {12550, 10166}}, {TwoQ_Delay_init, {171, 155}},
+      {TwoQ_Batch_init, {130, 0}},     {TwoQ_FR_init, {0, 0}},
+  };
+  const uint64_t cache_sizes[] = {489, 2448};
+  reader_t *reader = setup_oracleGeneralBin_reader_with_ignored_obj_size();
+  for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+    cache_t *caches[2];
+    for (int j = 0; j < 2; j++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[j],
+                                         .hashpower = 20,
+                                         .default_ttl = DEFAULT_TTL};
+      caches[j] = variants[i].init(cc_params, NULL);
+    }
+    cache_stat_t *res =
+        simulate_with_multi_caches(reader, caches, 2, NULL, 0, 0, 1, true);
+    for (int j = 0; j < 2; j++) {
+      g_assert_cmpint(res[j].n_promotion, ==, variants[i].n_promotion_true[j]);
+      g_assert_cmpint(res[j].n_reinsertion, <=, res[j].n_promotion);
+    }
+    g_free(res);
+  }
+  close_reader(reader);
+}
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -548,6 +1139,19 @@ int main(int argc, char *argv[]) {
 
   reader_t *reader;
 
+#if HASHTABLE_TYPE == DIRECT_INDEX_HASHTABLE
+  /* the direct index hashtable only works with dense obj_id, so we only run
+   * the algorithms whose results do not depend on the obj_id on a remapped
+   * trace */
+  reader = setup_dense_lcs_reader();
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRU", reader, test_LRU);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_Clock", reader, test_Clock);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_FIFO", reader, test_FIFO);
+  g_test_add_data_func_full("/libCacheSim/empty", reader, empty_test,
+                            dense_lcs_teardown);
+  return g_test_run();
+#endif
+
   // do not use these two because object size change over time and
   // not all algorithms can handle the object size change correctly
   // reader = setup_csv_reader_obj_num();
@@ -559,6 +1163,25 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_S3FIFO", reader, test_S3FIFO);
   g_test_add_data_func("/libCacheSim/cacheAlgo_QDLP_FIFO", reader,
                        test_QDLP_FIFO);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_PredClock", reader,
+                       test_PredClock);
+  g_test_add_data_func("/libCacheSim/predictor", NULL, test_predictor);
+  g_test_add_data_func("/libCacheSim/promotion_budget", reader,
+                       test_promotion_budget);
+  g_test_add_data_func("/libCacheSim/promotion_budget_epsilon", reader,
+                       test_promotion_budget_epsilon);
+  g_test_add_data_func("/libCacheSim/promotion_variants", reader,
+                       test_promo_variants);
+  g_test_add_data_func("/libCacheSim/promotion_variants_multi_size", reader,
+                       test_promo_variants_multi_size);
+  g_test_add_data_func("/libCacheSim/promotion_variants_promotion_cnt", NULL,
+                       test_promo_variants_promotion_cnt);
+  g_test_add_data_func("/libCacheSim/lpFIFO_shards_batch", reader,
+                       test_lpFIFO_shards_batch);
+  g_test_add_data_func("/libCacheSim/lpFIFO_batch", reader,
+                       test_lpFIFO_batch);
+  g_test_add_data_func("/libCacheSim/lpFIFO_batch_dedup", NULL,
+                       test_lpFIFO_batch_dedup);
 
   g_test_add_data_func("/libCacheSim/cacheAlgo_LRU", reader, test_LRU);
   g_test_add_data_func("/libCacheSim/cacheAlgo_SLRU", reader, test_SLRU);
@@ -0,0 +1,167 @@
+//
+// tests of the log-structured flash tier
+//
+
+#include "../libCacheSim/dataStructure/hashtable/hashtable.h"
+#include "common.h"
+
+#define FLASH_CACHE_SIZE 5000
+
+/* run the trace with unit object size, so the cache holds a fixed number of
+ * objects and every insertion writes one byte to the tier */
+static int64_t _run_trace(reader_t *reader, cache_t *cache, int64_t *n_miss) {
+  request_t *req = new_request();
+  int64_t n_req = 0;
+  *n_miss = 0;
+  reset_reader(reader);
+  while (read_one_req(reader, req) == 0) {
+    req->obj_size = 1;
+    if (!cache->get(cache, req)) *n_miss += 1;
+    n_req += 1;
+  }
+  free_request(req);
+  reset_reader(reader);
+  return n_req;
+}
+
+/* the device holds exactly the objects in the cache, every write is an
+ * insertion or a rewrite, and the free segments never run out */
+static void _check_invariants(cache_t *cache, int64_t n_miss) {
+  flash_tier_t *flash = cache->flash;
+  int64_t valid_byte = 0, used_byte = 0;
+  for (int32_t i = 0; i < flash->n_segment; i++) {
+    valid_byte += flash->segments[i].valid_byte;
+    used_byte += flash->segments[i].used_byte;
+  }
+  g_assert_cmpint(valid_byte, ==, cache->get_occupied_byte(cache));
+  g_assert_cmpint(used_byte, <=, flash->n_segment * flash->segment_size);
+  g_assert_cmpint(flash->n_free_segment, >=, 0);
+  g_assert_cmpint(flash->stat.n_host_write_byte - flash->stat.n_rewrite_byte,
+                  ==, n_miss);
+}
+
+static cache_t *_create_cache_with_flash(const char *algo, double op) {
+  common_cache_params_t cc_params = {.cache_size = FLASH_CACHE_SIZE,
+                                     .hashpower = 16,
+                                     .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache(algo, cc_params, NULL, NULL);
+  flash_params_t params = default_flash_params();
+  params.enabled = true;
+  params.over_provision = op;
+  attach_flash_tier(cache, &params);
+  return cache;
+}
+
+/* FIFO evicts in write order, a victim segment has no valid object, so
+ * garbage collection moves nothing */
+static void test_flash_fifo_write_amp(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  cache_t *cache = _create_cache_with_flash("FIFO", 0.1);
+
+  int64_t n_miss;
+  int64_t n_req = _run_trace(reader, cache, &n_miss);
+  flash_estimate_t est =
+      estimate_flash(&cache->flash->params, &cache->flash->stat, n_req);
+
+  g_assert_cmpint(cache->flash->stat.n_gc, >, 0);
+  g_assert_cmpint(cache->flash->stat.n_gc_write_byte, ==, 0);
+  g_assert_cmpfloat(est.write_amp, ==, 1.0);
+  _check_invariants(cache, n_miss);
+  cache->cache_free(cache);
+}
+
+/* the sub-caches of S3FIFO write to the tier, the small and the main FIFO
+ * interleave, and Sieve evicts out of write order, so a victim segment has
+ * valid objects to move, Clock rewrites the objects it keeps and evicts in
+ * write order */
+static void test_flash_gc_full_log(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const char *algos[] = {"S3-FIFO", "Sieve", "Clock"};
+  const double ops[] = {0.05, 0.2};
+
+  for (int i = 0; i < 3; i++) {
+    double last_write_amp = 0;
+    for (int j = 0; j < 2; j++) {
+      cache_t *cache = _create_cache_with_flash(algos[i], ops[j]);
+      int64_t n_miss;
+      int64_t n_req = _run_trace(reader, cache, &n_miss);
+      flash_estimate_t est =
+          estimate_flash(&cache->flash->params, &cache->flash->stat, n_req);
+      printf("%s op %.2lf: write amp %.4lf, %ld gc\n", cache->cache_name,
+             ops[j], est.write_amp, (long)cache->flash->stat.n_gc);
+
+      g_assert_cmpint(cache->flash->stat.n_host_write_byte, >, 0);
+      g_assert_cmpint(cache->flash->stat.n_gc, >, 0);
+      g_assert_cmpfloat(est.write_amp, >=, 1.0);
+      _check_invariants(cache, n_miss);
+      if (i < 2) {
+        g_assert_cmpint(cache->flash->stat.n_gc_write_byte, >, 0);
+        /* more over-provisioning leaves fewer valid objects in a victim */
+        if (j > 0) g_assert_cmpfloat(est.write_amp, <, last_write_amp);
+      }
+      if (i != 1) g_assert_cmpint(cache->flash->stat.n_rewrite_byte, >, 0);
+      last_write_amp = est.write_amp;
+      cache->cache_free(cache);
+    }
+  }
+}
+
+/* a clone gets its own tier, freeing one cache keeps the other's */
+static void test_flash_clone(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  cache_t *cache = _create_cache_with_flash("S3-FIFO", 0.1);
+  cache_t *clone = clone_cache(cache);
+  g_assert_true(clone->flash != NULL);
+  g_assert_true(clone->flash != cache->flash);
+  cache->cache_free(cache);
+
+  int64_t n_miss;
+  _run_trace(reader, clone, &n_miss);
+  _check_invariants(clone, n_miss);
+  clone->cache_free(clone);
+}
+
+/* an object that is not written to the tier, e.g., one created directly in
+ * the hashtable, is not the live copy in segment 0 */
+static void test_flash_new_obj_not_live(gconstpointer user_data) {
+  cache_t *cache = _create_cache_with_flash("FIFO", 0.1);
+  flash_tier_t *flash = cache->flash;
+  request_t *req = new_request();
+  req->obj_size = 1;
+
+  req->obj_id = 1;
+  cache->insert(cache, req);
+  cache_obj_t *written = hashtable_find_obj_id(cache->hashtable, 1);
+  g_assert_cmpint(written->flash_seg_id, ==, 0);
+  g_assert_cmpint(flash->segments[0].valid_byte, ==, 1);
+
+  req->obj_id = 2;
+  cache_obj_t *obj = hashtable_insert(cache->hashtable, req);
+  g_assert_cmpint(obj->flash_seg_id, ==, -1);
+  flash_tier_access(cache, 0, obj);
+  g_assert_cmpint(flash->stat.n_read, ==, 0);
+  flash_tier_remove(cache, obj);
+  g_assert_cmpint(flash->segments[0].valid_byte, ==, 1);
+  hashtable_delete(cache->hashtable, obj);
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  g_test_add_data_func("/libCacheSim/flash_new_obj_not_live", NULL,
+                       test_flash_new_obj_not_live);
+
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func("/libCacheSim/flash_fifo_write_amp", reader,
+                       test_flash_fifo_write_amp);
+  g_test_add_data_func("/libCacheSim/flash_gc_full_log", reader,
+                       test_flash_gc_full_log);
+  g_test_add_data_func_full("/libCacheSim/flash_clone", reader,
+                            test_flash_clone, test_teardown);
+
+  return g_test_run();
+}
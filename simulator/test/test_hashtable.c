@@ -0,0 +1,92 @@
+//
+// tests of the direct index hash table
+//
+
+#include "../libCacheSim/dataStructure/hashtable/directIndexHashTable.h"
+#include "common.h"
+
+#define N_TEST_OBJ 1000
+
+static void _count_obj(cache_obj_t *cache_obj, void *user_data) {
+  int64_t *cnt = (int64_t *)user_data;
+  cnt[0] += 1;
+  cnt[1] += (int64_t)cache_obj->obj_id;
+}
+
+static void test_direct_index_hashtable(gconstpointer user_data) {
+  hashtable_t *hashtable = create_direct_index_hashtable(4);
+  request_t *req = new_request();
+
+  /* the table grows with the largest obj_id */
+  for (obj_id_t i = 0; i < N_TEST_OBJ; i += 2) {
+    req->obj_id = i;
+    req->obj_size = i + 1;
+    cache_obj_t *obj = direct_index_hashtable_insert(hashtable, req);
+    g_assert_cmpint(obj->obj_id, ==, i);
+  }
+  g_assert_cmpint(hashtable->n_obj, ==, N_TEST_OBJ / 2);
+  g_assert_cmpint(hashsize(hashtable->hashpower), >=, N_TEST_OBJ);
+
+  for (obj_id_t i = 0; i < N_TEST_OBJ; i++) {
+    req->obj_id = i;
+    cache_obj_t *obj = direct_index_hashtable_find(hashtable, req);
+    if (i % 2 == 0) {
+      g_assert_nonnull(obj);
+      g_assert_cmpint(obj->obj_size, ==, i + 1);
+      g_assert_true(direct_index_hashtable_find_obj(hashtable, obj) == obj);
+    } else {
+      g_assert_null(obj);
+    }
+  }
+  /* beyond the end of the table */
+  g_assert_null(direct_index_hashtable_find_obj_id(hashtable, 1ULL << 20));
+
+  int64_t cnt[2] = {0, 0};
+  direct_index_hashtable_foreach(hashtable, _count_obj, cnt);
+  g_assert_cmpint(cnt[0], ==, N_TEST_OBJ / 2);
+  g_assert_cmpint(cnt[1], ==, (N_TEST_OBJ - 2) * (N_TEST_OBJ / 2) / 2);
+
+  for (int i = 0; i < 100; i++) {
+    cache_obj_t *obj = direct_index_hashtable_rand_obj(hashtable);
+    g_assert_cmpint(obj->obj_id % 2, ==, 0);
+  }
+
+  /* the three ways of deleting */
+  cache_obj_t *obj = direct_index_hashtable_find_obj_id(hashtable, 0);
+  direct_index_hashtable_delete(hashtable, obj);
+  g_assert_null(direct_index_hashtable_find_obj_id(hashtable, 0));
+  g_assert_true(direct_index_hashtable_delete_obj_id(hashtable, 2));
+  g_assert_false(direct_index_hashtable_delete_obj_id(hashtable, 2));
+  g_assert_false(direct_index_hashtable_delete_obj_id(hashtable, 3));
+  obj = direct_index_hashtable_find_obj_id(hashtable, 4);
+  g_assert_true(direct_index_hashtable_try_delete(hashtable, obj));
+  g_assert_cmpint(hashtable->n_obj, ==, N_TEST_OBJ / 2 - 3);
+
+  cnt[0] = cnt[1] = 0;
+  direct_index_hashtable_foreach(hashtable, _count_obj, cnt);
+  g_assert_cmpint(cnt[0], ==, N_TEST_OBJ / 2 - 3);
+
+  /* a f table indexes the objects owned by the main table */
+  hashtable_t *hashtable_f = create_direct_index_hashtable(4);
+  for (obj_id_t i = 6; i < N_TEST_OBJ; i += 2) {
+    obj = direct_index_hashtable_find_obj_id(hashtable, i);
+    direct_index_hashtable_f_insert_obj(hashtable_f, obj);
+  }
+  g_assert_true(direct_index_hashtable_find_obj_id(hashtable_f, 6) ==
+                direct_index_hashtable_find_obj_id(hashtable, 6));
+  free_direct_index_hashtable_f(hashtable_f);
+  g_assert_cmpint(direct_index_hashtable_find_obj_id(hashtable, 6)->obj_size,
+                  ==, 7);
+
+  free_request(req);
+  free_direct_index_hashtable(hashtable);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/direct_index_hashtable", NULL,
+                       test_direct_index_hashtable);
+
+  return g_test_run();
+}
@@ -29,6 +29,44 @@ void test_profilerLRU_basic(gconstpointer user_data) {
   g_free(mr);
 }
 
+void test_promotion_oracle(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  int64_t cache_sizes[2] = {100, 1000};
+
+  promotion_oracle_result_t *results =
+      get_optimal_promotion(reader, cache_sizes, 2, true);
+  request_t *req = new_request();
+  for (int i = 0; i < 2; i++) {
+    /* every target hit is a hit */
+    g_assert_cmpint(results[i].n_req - results[i].n_miss, >=,
+                    results[i].n_target_hit);
+
+    int64_t n_promotion = 0;
+    for (int64_t j = 0; j < results[i].n_req; j++) {
+      n_promotion += results[i].promotion[j];
+    }
+    g_assert_cmpint(n_promotion, ==, results[i].n_promotion);
+
+    /* Belady with unit size objects cannot have fewer misses */
+    common_cache_params_t cc_params = default_common_cache_params();
+    cc_params.cache_size = cache_sizes[i];
+    cache_t *cache = Belady_init(cc_params, NULL);
+    int64_t n_miss = 0;
+    read_one_req(reader, req);
+    while (req->valid) {
+      req->obj_size = 1;
+      if (!cache->get(cache, req)) n_miss++;
+      read_one_req(reader, req);
+    }
+    reset_reader(reader);
+    cache->cache_free(cache);
+    g_assert_cmpint(results[i].n_miss, <=, n_miss);
+  }
+
+  free_request(req);
+  free_promotion_oracle_result(results, 2);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
@@ -57,5 +95,9 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/test_profilerLRU_basic_vscsi", reader,
                        test_profilerLRU_basic);
 
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func("/libCacheSim/test_promotion_oracle", reader,
+                       test_promotion_oracle);
+
   return g_test_run();
 }
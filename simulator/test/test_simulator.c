@@ -183,6 +183,8 @@ static void test_simulator_with_warmup2(gconstpointer user_data) {
     g_assert_cmpuint(res[i].n_miss, ==, miss_cnt_true[i]);
     g_assert_cmpuint(res[i].n_req_byte, ==, req_byte_true);
     g_assert_cmpuint(res[i].n_miss_byte, ==, miss_byte_true[i]);
+    /* LRU promotes on every hit, the warmup is not counted */
+    g_assert_cmpint(res[i].n_promotion, ==, res[i].n_req - res[i].n_miss);
   }
   g_free(res);
 
@@ -0,0 +1,70 @@
+//
+// tests of the single-producer single-consumer queue
+//
+
+#include "../libCacheSim/dataStructure/spscQueue.h"
+#include "common.h"
+
+#define N_TEST_VALUE 1000000
+
+/* the capacity is rounded up, a full queue rejects a push, and the values
+ * come out in order across the wrap around */
+static void test_spsc_queue_bound(gconstpointer user_data) {
+  spsc_queue_t *q = spsc_queue_new(5);
+  int32_t v;
+  g_assert_cmpint(q->mask, ==, 7);
+  g_assert_false(spsc_queue_try_pop(q, &v));
+
+  int32_t next_push = 0, next_pop = 0;
+  for (int round = 0; round < 10; round++) {
+    while (spsc_queue_try_push(q, next_push)) next_push++;
+    g_assert_cmpint(next_push - next_pop, ==, 8);
+    /* pop a few so that the next round wraps around */
+    for (int i = 0; i < 3; i++) {
+      g_assert_true(spsc_queue_try_pop(q, &v));
+      g_assert_cmpint(v, ==, next_pop++);
+    }
+  }
+  while (spsc_queue_try_pop(q, &v)) g_assert_cmpint(v, ==, next_pop++);
+  g_assert_cmpint(next_pop, ==, next_push);
+
+  spsc_queue_free(q);
+}
+
+static void *producer(void *data) {
+  spsc_queue_t *q = (spsc_queue_t *)data;
+  for (int32_t i = 0; i < N_TEST_VALUE; i++) spsc_queue_push(q, i);
+  return NULL;
+}
+
+/* a small queue between two threads keeps every value in order */
+static void test_spsc_queue_threads(gconstpointer user_data) {
+  spsc_queue_t *q = spsc_queue_new(64);
+  pthread_t thread;
+  pthread_create(&thread, NULL, producer, q);
+
+  int32_t v, expected = 0;
+  while (expected < N_TEST_VALUE) {
+    if (!spsc_queue_try_pop(q, &v)) {
+      sched_yield();
+      continue;
+    }
+    if (v != expected) g_assert_cmpint(v, ==, expected);
+    expected++;
+  }
+  pthread_join(thread, NULL);
+  g_assert_false(spsc_queue_try_pop(q, &v));
+
+  spsc_queue_free(q);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/spsc_queue_bound", NULL,
+                       test_spsc_queue_bound);
+  g_test_add_data_func("/libCacheSim/spsc_queue_threads", NULL,
+                       test_spsc_queue_threads);
+
+  return g_test_run();
+}
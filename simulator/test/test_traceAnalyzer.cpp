@@ -0,0 +1,909 @@
+//
+// tests of the trace analyzer modules
+//
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../libCacheSim/traceAnalyzer/accessPattern.h"
+#include "../libCacheSim/traceAnalyzer/analyzer.h"
+#include "../libCacheSim/traceAnalyzer/cacheSim.h"
+#include "../libCacheSim/traceAnalyzer/histogram.h"
+#include "../libCacheSim/traceAnalyzer/pipeline.h"
+#include "../libCacheSim/traceAnalyzer/sketch.h"
+#include "common.h"
+
+using namespace traceAnalyzer;
+
+/* the simulated caches of the analyzer count the same requests and misses as
+ * the simulator, with and without warmup */
+static void test_cache_sim(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const uint64_t cache_sizes[] = {64 * MiB, 256 * MiB, 1024 * MiB};
+  const int warmup_secs[] = {0, 3600};
+
+  for (int warmup_sec : warmup_secs) {
+    for (const char *algo : {"LRU", "FIFO"}) {
+      cache_t *caches[3];
+      std::vector<CacheSim *> sims;
+      for (int i = 0; i < 3; i++) {
+        common_cache_params_t cc_params = {.cache_size = cache_sizes[i],
+                                           .hashpower = 20};
+        caches[i] = create_test_cache(algo, cc_params, reader, NULL);
+        sims.push_back(new CacheSim(
+            create_test_cache(algo, cc_params, reader, NULL), 300, warmup_sec));
+      }
+      cache_stat_t *res = simulate_with_multi_caches(reader, caches, 3, NULL, 0,
+                                                     warmup_sec, 1, true);
+
+      /* the analyzer gives the requests in batches with the time relative to
+       * the start of the trace */
+      reset_reader(reader);
+      std::vector<request_t> batch(1024);
+      request_t *req = new_request();
+      int64_t start_ts = -1;
+      int n = 0;
+      while (read_one_req(reader, req) == 0) {
+        if (start_ts < 0) start_ts = req->clock_time;
+        batch[n] = *req;
+        batch[n].clock_time -= start_ts;
+        if (++n == (int)batch.size()) {
+          for (auto sim : sims) sim->add_batch(batch.data(), n);
+          n = 0;
+        }
+      }
+      for (auto sim : sims) sim->add_batch(batch.data(), n);
+      free_request(req);
+      reset_reader(reader);
+
+      for (int i = 0; i < 3; i++) {
+        g_assert_cmpint(sims[i]->n_req(), ==, res[i].n_req);
+        g_assert_cmpint(sims[i]->n_miss(), ==, res[i].n_miss);
+        g_assert_cmpint(sims[i]->n_byte(), ==, res[i].n_req_byte);
+        g_assert_cmpint(sims[i]->n_miss_byte(), ==, res[i].n_miss_byte);
+        delete sims[i];
+      }
+      g_assert_cmpint(res[0].n_req, >, 0);
+      g_free(res);
+    }
+  }
+}
+
+#define RING_N_REQ 100003
+
+/* every consumer reads every request in order through a ring much smaller
+ * than the stream, the producer fills the next slot ahead as the analyzer
+ * does, and a slot is not reused while a slow consumer still reads it */
+static void test_pipeline_ring(gconstpointer user_data) {
+  const int n_consumer = 3;
+  ReqBatchRing ring(n_consumer, 2, 8);
+  std::vector<int64_t> n_seen(n_consumer, 0);
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < n_consumer; i++) {
+    consumers.emplace_back([&ring, &n_seen, i]() {
+      request_t *reqs;
+      int n;
+      int64_t expected = 0;
+      while (ring.consume(i, &reqs, &n)) {
+        g_assert_cmpint(n, >, 0);
+        g_assert_cmpint(n, <=, ring.batch_size_);
+        /* the last consumer is slow */
+        if (i == n_consumer - 1) std::this_thread::yield();
+        for (int j = 0; j < n; j++) {
+          if ((int64_t)reqs[j].obj_id != expected + j)
+            g_assert_cmpint(reqs[j].obj_id, ==, expected + j);
+        }
+        expected += n;
+        ring.release(i);
+      }
+      n_seen[i] = expected;
+    });
+  }
+
+  /* batches of varying sizes */
+  int64_t next_id = 0;
+  request_t *batch = ring.acquire();
+  while (next_id < RING_N_REQ) {
+    int n = (int)std::min<int64_t>(next_id % ring.batch_size_ + 1,
+                                   RING_N_REQ - next_id);
+    for (int j = 0; j < n; j++) batch[j].obj_id = next_id++;
+    request_t *next_batch = ring.acquire(1);
+    ring.publish(n);
+    batch = next_batch;
+  }
+  ring.close();
+
+  for (auto &t : consumers) t.join();
+  for (int i = 0; i < n_consumer; i++) {
+    g_assert_cmpint(n_seen[i], ==, RING_N_REQ);
+  }
+}
+
+/* every dispatched job runs once on every worker before wait returns, and a
+ * group without workers returns at once */
+static void test_pipeline_worker_group(gconstpointer user_data) {
+  const int n_worker = 4, n_round = 2000;
+  WorkerGroup group(n_worker);
+  std::vector<int64_t> n_run(n_worker, 0);
+  std::atomic<int64_t> sum(0);
+
+  for (int r = 0; r < n_round; r++) {
+    group.dispatch([&n_run, &sum, r](int worker_id) {
+      n_run[worker_id] += 1;
+      sum += r;
+    });
+    group.wait();
+    for (int i = 0; i < n_worker; i++) g_assert_cmpint(n_run[i], ==, r + 1);
+  }
+  g_assert_cmpint(sum.load(), ==,
+                  (int64_t)n_worker * n_round * (n_round - 1) / 2);
+
+  WorkerGroup empty(0);
+  empty.dispatch([](int worker_id) { g_assert_not_reached(); });
+  empty.wait();
+}
+
+/* a histogram with a small dense range matches an ordered map for keys
+ * below, in and above the dense range, after merge and after a checkpoint
+ * round trip */
+static void test_histogram(gconstpointer user_data) {
+  const int64_t min_key = -10, max_dense = 100;
+  Histogram<uint32_t> hist[2] = {Histogram<uint32_t>(min_key, max_dense),
+                                 Histogram<uint32_t>(min_key, max_dense)};
+  std::map<int64_t, uint64_t> ref[2];
+
+  srand(42);
+  for (int h = 0; h < 2; h++) {
+    /* the second histogram has a larger dense part */
+    int64_t range = h == 0 ? 50 : 400;
+    for (int i = 0; i < 20000; i++) {
+      int64_t key = min_key - 20 + rand() % range;
+      uint32_t n = 1 + rand() % 3;
+      hist[h].incr(key, n);
+      ref[h][key] += n;
+    }
+  }
+
+  auto check = [](const Histogram<uint32_t> &hist,
+                  const std::map<int64_t, uint64_t> &ref) {
+    uint64_t sum = 0;
+    for (auto &p : ref) {
+      g_assert_cmpint(hist.get(p.first), ==, p.second);
+      sum += p.second;
+    }
+    g_assert_cmpint(hist.get(-1000), ==, 0);
+    g_assert_cmpint(hist.get(1000), ==, 0);
+    g_assert_cmpint(hist.n_key(), ==, ref.size());
+    g_assert_cmpint(hist.sum(), ==, sum);
+
+    auto it = ref.begin();
+    hist.for_each([&it, &ref](int64_t key, uint32_t c) {
+      g_assert_true(it != ref.end());
+      g_assert_cmpint(key, ==, it->first);
+      g_assert_cmpint(c, ==, it->second);
+      ++it;
+    });
+    g_assert_true(it == ref.end());
+  };
+  check(hist[0], ref[0]);
+  check(hist[1], ref[1]);
+
+  hist[0].merge(hist[1]);
+  for (auto &p : ref[1]) ref[0][p.first] += p.second;
+  check(hist[0], ref[0]);
+
+  std::stringstream ss;
+  hist[0].save(ss);
+  Histogram<uint32_t> loaded(min_key, max_dense);
+  loaded.incr(5);
+  loaded.load(ss);
+  check(loaded, ref[0]);
+
+  loaded.clear();
+  check(loaded, {});
+}
+
+/* a 2D histogram matches an ordered map in and out of its grid, and after
+ * merging a histogram with a larger grid */
+static void test_histogram_2d(gconstpointer user_data) {
+  Histogram2D<uint32_t> hist[2] = {Histogram2D<uint32_t>(-2, 0, 20, 10),
+                                   Histogram2D<uint32_t>(-2, 0, 20, 10)};
+  std::map<std::pair<int64_t, int64_t>, uint64_t> ref[2];
+
+  srand(42);
+  for (int h = 0; h < 2; h++) {
+    int64_t range = h == 0 ? 8 : 30;
+    for (int i = 0; i < 20000; i++) {
+      int64_t x = -5 + rand() % range, y = -3 + rand() % range;
+      hist[h].incr(x, y);
+      ref[h][{x, y}] += 1;
+    }
+  }
+  hist[0].merge(hist[1]);
+  for (auto &p : ref[1]) ref[0][p.first] += p.second;
+
+  for (auto &p : ref[0]) {
+    g_assert_cmpint(hist[0].get(p.first.first, p.first.second), ==, p.second);
+  }
+  auto it = ref[0].begin();
+  hist[0].for_each([&it, &ref](int64_t x, int64_t y, uint32_t c) {
+    g_assert_true(it != ref[0].end());
+    g_assert_cmpint(x, ==, it->first.first);
+    g_assert_cmpint(y, ==, it->first.second);
+    g_assert_cmpint(c, ==, it->second);
+    ++it;
+  });
+  g_assert_true(it == ref[0].end());
+}
+
+#define SKETCH_N_ITEM 200000
+
+/* the estimate is within four standard errors for small and large counts,
+ * duplicates do not change it, and the merge estimates the union */
+static void test_sketch_hll(gconstpointer user_data) {
+  for (uint64_t n : {100, 5000, SKETCH_N_ITEM}) {
+    HyperLogLog hll(12), hll_a(12), hll_b(12);
+    for (uint64_t i = 0; i < n; i++) {
+      uint64_t hash = sketch_hash(i, HLL_HASH_SEED);
+      hll.add(hash);
+      hll.add(hash);
+      /* the two halves overlap by a quarter */
+      if (i < n * 5 / 8) hll_a.add(hash);
+      if (i >= n * 3 / 8) hll_b.add(hash);
+    }
+    double bound = 4 * hll.rel_error() * n;
+    g_assert_cmpfloat(fabs(hll.estimate() - n), <, bound);
+    hll_a.merge(hll_b);
+    g_assert_cmpfloat(fabs(hll_a.estimate() - n), <, bound);
+
+    hll.clear();
+    g_assert_cmpfloat(hll.estimate(), ==, 0);
+  }
+}
+
+/* the estimated top counts are bounded by the exact top counts and the max
+ * error, also after merging sketches of two disjoint sets of objects */
+static void test_sketch_space_saving(gconstpointer user_data) {
+  const int n_top = 10;
+  SpaceSaving ss(1024), ss_a(512), ss_b(512);
+  std::map<obj_id_t, uint64_t> exact;
+  for (uint64_t i = 0; i < SKETCH_N_ITEM; i++) {
+    /* object k < 1000 has a share of about 1 / k^2, a third of the requests
+     * go to a long tail of objects */
+    uint64_t r = sketch_hash(i, 1) % 1000000;
+    obj_id_t obj_id = 1000000 / (r + 1) % 1000 + (r % 3 == 0 ? r : 0);
+    exact[obj_id] += 1;
+    ss.add(obj_id);
+    (obj_id % 2 == 0 ? ss_a : ss_b).add(obj_id);
+  }
+  std::vector<uint64_t> exact_top;
+  for (auto &p : exact) exact_top.push_back(p.second);
+  std::sort(exact_top.begin(), exact_top.end(), std::greater<uint64_t>());
+
+  ss_a.merge(ss_b);
+  for (const SpaceSaving *sketch : {&ss, &ss_a}) {
+    std::vector<uint64_t> top = sketch->top(n_top);
+    g_assert_cmpint(sketch->max_error(), <, exact_top[n_top - 1]);
+    for (int i = 0; i < n_top; i++) {
+      g_assert_cmpint(top[i], >=, exact_top[i]);
+      g_assert_cmpint(top[i], <=, exact_top[i] + sketch->max_error());
+    }
+  }
+}
+
+/* the quantiles of a permutation of 0 .. n - 1 are within twice the rank
+ * error, also after merging two sketches */
+static void test_sketch_kll(gconstpointer user_data) {
+  KllSketch kll, kll_a, kll_b;
+  for (uint64_t i = 0; i < SKETCH_N_ITEM; i++) {
+    /* 7919 is coprime with n, so the values are a permutation */
+    double v = (double)(i * 7919 % SKETCH_N_ITEM);
+    kll.add(v);
+    (i % 3 == 0 ? kll_a : kll_b).add(v);
+  }
+  kll_a.merge(kll_b);
+  g_assert_cmpint(kll.n(), ==, SKETCH_N_ITEM);
+  g_assert_cmpint(kll_a.n(), ==, SKETCH_N_ITEM);
+
+  for (const KllSketch *sketch : {&kll, &kll_a}) {
+    for (double q : {0.01, 0.1, 0.5, 0.9, 0.99}) {
+      double rank = sketch->quantile(q) / SKETCH_N_ITEM;
+      g_assert_cmpfloat(fabs(rank - q), <, 2 * sketch->rank_error());
+    }
+  }
+  g_assert_cmpfloat(KllSketch().quantile(0.5), ==, 0);
+}
+
+/* read a file and remove it */
+static std::string read_and_remove(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  g_assert_true(ifs.good());
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  ifs.close();
+  std::filesystem::remove(path);
+  return ss.str();
+}
+
+/* arena chunks keep their content when the arena grows and moves, in memory
+ * and backed by a file */
+static void test_chunk_arena(gconstpointer user_data) {
+  for (bool use_file : {false, true}) {
+    std::vector<uint64_t> offsets;
+    {
+      ChunkArena arena;
+      if (use_file) arena.use_file("test_chunk_arena");
+      for (int i = 0; i < 100000; i++) {
+        size_t n = 16 << (i % 4);
+        uint64_t offset = arena.alloc(n);
+        g_assert_cmpint(offset, ==, arena.size() - n);
+        for (size_t j = 0; j < n; j++) {
+          g_assert_cmpint(*arena.at(offset + j), ==, 0);
+        }
+        memset(arena.at(offset), i % 251, n);
+        offsets.push_back(offset);
+      }
+      for (int i = 0; i < (int)offsets.size(); i++) {
+        size_t n = 16 << (i % 4);
+        g_assert_cmpint(*arena.at(offsets[i]), ==, i % 251);
+        g_assert_cmpint(*arena.at(offsets[i] + n - 1), ==, i % 251);
+      }
+    }
+    if (use_file) {
+      /* the file is truncated to the used size at the end */
+      std::string data = read_and_remove("test_chunk_arena");
+      g_assert_cmpint(data.size(), ==, offsets.back() + (16 << 3));
+      g_assert_cmpint((uint8_t)data[offsets[12345]], ==, 12345 % 251);
+    }
+  }
+}
+
+/* the dumped accesses of the sampled objects are the accesses of a plain
+ * replay, with the deltas spanning chunks, after resuming from a checkpoint
+ * in the middle of the trace, and with the streams backed by a file */
+static void test_access_pattern(gconstpointer user_data) {
+  const int n_req = 60000, sample_ratio = 3;
+  std::vector<request_t> reqs(n_req);
+  std::vector<obj_id_t> first_access_order;
+  std::map<obj_id_t, std::pair<std::string, std::string>> ref;
+  srand(42);
+  int64_t clock_time = 1000;
+  for (int i = 0; i < n_req; i++) {
+    /* mostly short gaps with a few that need a 3- or 4-byte varint */
+    clock_time += rand() % 100 == 0 ? rand() % 4000000 : rand() % 10;
+    reqs[i].clock_time = clock_time;
+    reqs[i].obj_id = rand() % 3000;
+    if (reqs[i].obj_id % sample_ratio != 0) continue;
+    auto &r = ref[reqs[i].obj_id];
+    if (r.first.empty()) first_access_order.push_back(reqs[i].obj_id);
+    r.first += std::to_string(clock_time - 1000) + ",";
+    r.second += std::to_string(i + 1) + ",";
+  }
+  std::string expected_rtime, expected_vtime;
+  for (obj_id_t obj_id : first_access_order) {
+    expected_rtime += ref[obj_id].first + "\n";
+    expected_vtime += ref[obj_id].second + "\n";
+  }
+
+  std::string path_base = "test_access_pattern";
+  auto check_dump = [&](AccessPattern &pattern) {
+    pattern.dump(path_base);
+    std::string rtime = read_and_remove(path_base + ".accessRtime");
+    std::string vtime = read_and_remove(path_base + ".accessVtime");
+    /* skip the two comment lines */
+    for (std::string *s : {&rtime, &vtime}) {
+      for (int i = 0; i < 2; i++) s->erase(0, s->find('\n') + 1);
+    }
+    g_assert_true(rtime == expected_rtime + "\n\n");
+    g_assert_true(vtime == expected_vtime);
+  };
+
+  AccessPattern pattern(sample_ratio);
+  for (int i = 0; i < n_req / 2; i++) pattern.add_req(&reqs[i]);
+  std::stringstream ckpt;
+  pattern.save(ckpt);
+  for (int i = n_req / 2; i < n_req; i++) pattern.add_req(&reqs[i]);
+  check_dump(pattern);
+
+  AccessPattern resumed(sample_ratio);
+  resumed.load(ckpt);
+  for (int i = n_req / 2; i < n_req; i++) resumed.add_req(&reqs[i]);
+  check_dump(resumed);
+
+  {
+    AccessPattern streamed(sample_ratio, path_base);
+    for (int i = 0; i < n_req; i++) streamed.add_req(&reqs[i]);
+    check_dump(streamed);
+  }
+  std::string idx = read_and_remove(path_base + ".accessStreamIdx");
+  g_assert_cmpint(idx.size(), ==, first_access_order.size() * 16);
+  for (size_t i = 0; i < first_access_order.size(); i++) {
+    uint64_t obj_id;
+    uint32_t n_access;
+    memcpy(&obj_id, &idx[i * 16], sizeof(obj_id));
+    memcpy(&n_access, &idx[i * 16 + 12], sizeof(n_access));
+    g_assert_cmpint(obj_id, ==, first_access_order[i]);
+    const std::string &vtime = ref[obj_id].second;
+    g_assert_cmpint(n_access, ==, std::count(vtime.begin(), vtime.end(), ','));
+  }
+  g_assert_cmpint(read_and_remove(path_base + ".accessStream").size(), >, 0);
+}
+
+/* the slope fitted from the frequency histogram of objects split across
+ * partitions is the slope of the regression on every rank, the frequencies
+ * beyond the dense histogram are kept, and the dump and the top frequencies
+ * follow the rank order */
+static void test_popularity_zipf(gconstpointer user_data) {
+  const int n_obj = 20000;
+  const double alpha = 0.8;
+  std::vector<obj_partition_t> partitions(3);
+  std::vector<double> log_rank, log_freq;
+  std::map<uint32_t, uint64_t, std::greater<uint32_t>> freq_cnt;
+  for (int i = 1; i <= n_obj; i++) {
+    uint32_t freq = (uint32_t)std::max(1.0, round(200000 / pow(i, alpha)));
+    obj_info info = {};
+    info.freq = freq;
+    /* the objects are not in rank order in the partitions */
+    obj_id_t obj_id = sketch_hash(i, 0);
+    partitions[obj_id % 3].obj_map[obj_id] = info;
+    log_rank.push_back(log(i));
+    log_freq.push_back(log(freq));
+    freq_cnt[freq] += 1;
+  }
+  double expected_slope = -PopularityUtils::slope(log_rank, log_freq);
+  g_assert_cmpfloat(fabs(expected_slope - alpha), <, 0.05);
+
+  Popularity popularity(partitions);
+  g_assert_true(popularity.fit_fail_reason_.empty());
+  std::stringstream ss;
+  ss << popularity;
+  std::string stat = ss.str();
+  size_t pos = stat.find("slope=");
+  g_assert_true(pos != std::string::npos);
+  double slope = std::stod(stat.substr(pos + 6));
+  g_assert_cmpfloat(fabs(slope - expected_slope), <, 1e-3);
+
+  std::vector<uint32_t> top = popularity.get_top_freq(4);
+  g_assert_cmpint(top[0], ==, 200000);
+  g_assert_cmpint(top[3], ==, (uint32_t)round(200000 / pow(4, alpha)));
+  g_assert_cmpint(popularity.get_top_freq(n_obj + 1)[n_obj], ==, 0);
+
+  std::string path_base = "test_popularity";
+  popularity.dump(path_base);
+  std::string expected_dump =
+      "# " + path_base + "\n# freq (sorted):cnt - for Zipf plot\n";
+  for (auto &p : freq_cnt) {
+    expected_dump +=
+        std::to_string(p.first) + ":" + std::to_string(p.second) + "\n";
+  }
+  g_assert_true(read_and_remove(path_base + ".popularity") == expected_dump);
+
+  /* too few objects to fit */
+  std::vector<obj_partition_t> small(1);
+  for (int i = 0; i < 100; i++) small[0].obj_map[i].freq = 1;
+  g_assert_false(Popularity(small).fit_fail_reason_.empty());
+}
+
+/* the scans in a synthetic stream are found in one pass, the short runs and
+ * the requests between the scans are not scans */
+static void test_scan_detector(gconstpointer user_data) {
+  std::string path_base = "test_scan";
+  std::string expected_scan = "# " + path_base +
+                              "\n# scans (min scan size 10): "
+                              "start_vtime,end_vtime,n_req\n";
+  int64_t n_scan = 0, n_scan_req = 0, n_non_scan_req = 0, n_single = 0;
+  std::map<int64_t, uint64_t> run_size_cnt;
+  {
+    ScanDetector detector(path_base, 100);
+    request_t *req = new_request();
+    int64_t vtime = 0;
+    for (int scan_len : {5, 20, 50, 200, 11, 10, 1000}) {
+      /* requests between the scans, half of them are never reused, the
+       * next accesses of the others are far apart */
+      for (int i = 0; i < 300; i++, vtime++) {
+        req->n_req = vtime;
+        req->next_access_vtime = i % 2 == 0 ? -1 : 1000000 + vtime * 1000;
+        detector.add_req(req);
+        n_non_scan_req += 1;
+        n_single += i % 2;
+      }
+      /* a scan that is repeated later in the same order */
+      int64_t start = vtime;
+      for (int i = 0; i < scan_len; i++, vtime++) {
+        req->n_req = vtime;
+        req->next_access_vtime = 100000000 + start * 10 + i;
+        detector.add_req(req);
+      }
+      run_size_cnt[scan_len] += 1;
+      if (scan_len > 10) {
+        n_scan += 1;
+        n_scan_req += scan_len;
+        expected_scan += std::to_string(start) + "," +
+                         std::to_string(vtime - 1) + "," +
+                         std::to_string(scan_len) + "\n";
+      } else {
+        n_non_scan_req += scan_len;
+      }
+    }
+    run_size_cnt[1] += n_single;
+    free_request(req);
+
+    detector.dump(path_base);
+    std::stringstream ss;
+    ss << detector;
+    g_assert_true(ss.str() == "scanDetector: max_vtime_diff 200, " +
+                                  std::to_string(n_scan) + " scans, " +
+                                  std::to_string(n_scan_req) + "/" +
+                                  std::to_string(n_non_scan_req) +
+                                  " scan/non_scan reqs\n");
+  }
+  g_assert_true(read_and_remove(path_base + ".scan") == expected_scan);
+
+  std::string expected_size = "# " + path_base + "\n# scan_size:cnt\n";
+  for (auto &p : run_size_cnt) {
+    expected_size +=
+        std::to_string(p.first) + ":" + std::to_string(p.second) + "\n";
+  }
+  g_assert_true(read_and_remove(path_base + ".scanSize") == expected_size);
+}
+
+/* run the analyzer, return the stat and the content of every file it writes
+ * keyed by the suffix after output_path, the files and the stat the analyzer
+ * appends to are removed */
+static std::map<std::string, std::string> run_analyzer(
+    reader_t *reader, const std::string &output_path,
+    analysis_option_t option, analysis_param_t param) {
+  reset_reader(reader);
+  TraceAnalyzer *analyzer =
+      new TraceAnalyzer(reader, output_path, option, param);
+  analyzer->run();
+  std::stringstream stat;
+  stat << *analyzer;
+  delete analyzer;
+  reset_reader(reader);
+
+  std::map<std::string, std::string> outputs;
+  outputs["stat"] = stat.str();
+  std::string prefix = output_path + ".";
+  for (auto &entry : std::filesystem::directory_iterator(".")) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) != 0) continue;
+    std::ifstream ifs(entry.path(), std::ios::binary);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    outputs[name.substr(output_path.size())] = ss.str();
+    std::filesystem::remove(entry.path());
+  }
+  std::filesystem::remove("stat");
+  return outputs;
+}
+
+/* the lines of values in a per-window dump, the comment lines are skipped */
+static std::vector<std::vector<double>> read_window_dump(
+    const std::string &dump) {
+  std::vector<std::vector<double>> lines;
+  std::stringstream ifs(dump);
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<double> values;
+    std::stringstream ss(line);
+    std::string v;
+    while (std::getline(ss, v, ',')) values.push_back(std::stod(v));
+    lines.push_back(values);
+  }
+  return lines;
+}
+
+/* run the analyzer and return the request rate dump */
+static std::vector<std::vector<double>> run_req_rate(reader_t *reader,
+                                                     bool sketch) {
+  analysis_option_t option = default_option();
+  option.req_rate = true;
+  analysis_param_t param = default_param();
+  param.sketch = sketch;
+  /* sample about 1/16 of the objects */
+  param.sketch_n_obj = 4096;
+
+  auto outputs = run_analyzer(reader, "test_sketch", option, param);
+  return read_window_dump(outputs[".reqRate_w300"]);
+}
+
+/* the analyzer finds the same scans as a replay of the trace through the
+ * detector, with the enrichment split across threads */
+static void test_scan_detector_trace(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  std::string path_base = "test_scan_trace";
+  {
+    ScanDetector detector(path_base, 100);
+    request_t *req = new_request();
+    reset_reader(reader);
+    for (int64_t vtime = 0; read_one_req(reader, req) == 0; vtime++) {
+      req->n_req = vtime;
+      detector.add_req(req);
+    }
+    reset_reader(reader);
+    free_request(req);
+    detector.dump(path_base);
+  }
+  std::string scan = read_and_remove(path_base + ".scan");
+  std::string scan_size = read_and_remove(path_base + ".scanSize");
+  g_assert_cmpint(std::count(scan_size.begin(), scan_size.end(), '\n'), >, 3);
+
+  analysis_option_t option = default_option();
+  option.scan_detector = true;
+  analysis_param_t param = default_param();
+  for (int n_thread : {1, 4}) {
+    param.n_enrich_thread = n_thread;
+    auto outputs = run_analyzer(reader, path_base, option, param);
+    g_assert_true(outputs[".scan"] == scan);
+    g_assert_true(outputs[".scanSize"] == scan_size);
+    g_assert_true(outputs["stat"].find("scanDetector: ") != std::string::npos);
+  }
+}
+
+/* the average number of distinct objects in the windows of w requests */
+static double brute_force_footprint(const std::vector<obj_id_t> &trace,
+                                    int64_t w) {
+  std::unordered_map<obj_id_t, int> cnt;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < trace.size(); i++) {
+    cnt[trace[i]] += 1;
+    if (i >= (size_t)w) {
+      auto it = cnt.find(trace[i - w]);
+      if (--it->second == 0) cnt.erase(it);
+    }
+    if (i + 1 >= (size_t)w) sum += cnt.size();
+  }
+  return (double)sum / (double)(trace.size() - w + 1);
+}
+
+/* the miss ratio of the first point of a curve at or above the cache size */
+static double mrc_at(const std::vector<std::pair<double, double>> &mrc,
+                     double cache_size) {
+  for (auto &p : mrc) {
+    if (p.first >= cache_size) return p.second;
+  }
+  return mrc.back().second;
+}
+
+/* the footprint is exact at the bucket bounds, and the LRU (HOTL) and FIFO
+ * curves derived from it are close to simulated caches with unit size */
+static void test_footprint(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  analysis_option_t option = default_option();
+  option.footprint = true;
+  auto outputs = run_analyzer(reader, "test_footprint", option,
+                              default_param());
+
+  /* the footprint, the LRU and the FIFO curve, each after a comment line */
+  std::vector<std::pair<double, double>> curves[3];
+  std::stringstream ss(outputs[".footprint"]);
+  std::string line;
+  int section = -1;
+  while (std::getline(ss, line)) {
+    if (line[0] == '#') {
+      if (line.find(":") != std::string::npos) section += 1;
+      continue;
+    }
+    size_t pos = line.find(':');
+    curves[section].emplace_back(std::stod(line.substr(0, pos)),
+                                 std::stod(line.substr(pos + 1)));
+  }
+  for (auto &curve : curves) g_assert_cmpint(curve.size(), >, 10);
+
+  std::vector<obj_id_t> trace;
+  request_t *req = new_request();
+  reset_reader(reader);
+  while (read_one_req(reader, req) == 0) trace.push_back(req->obj_id);
+  reset_reader(reader);
+
+  int n_checked = 0;
+  for (auto &p : curves[0]) {
+    int64_t w = (int64_t)p.first;
+    if (w != 1 && w != 100 && w != 1023 && w != 8191 && w != 65535) continue;
+    double fp = brute_force_footprint(trace, w);
+    g_assert_cmpfloat(fabs(p.second - fp) / fp, <, 1e-5);
+    n_checked += 1;
+  }
+  g_assert_cmpint(n_checked, ==, 5);
+
+  for (const char *algo : {"LRU", "FIFO"}) {
+    const auto &curve = strcmp(algo, "LRU") == 0 ? curves[1] : curves[2];
+    for (uint64_t cache_size : {500, 2000, 8000}) {
+      common_cache_params_t cc_params = {.cache_size = cache_size,
+                                         .hashpower = 16};
+      cache_t *cache = create_test_cache(algo, cc_params, reader, NULL);
+      uint64_t n_miss = 0;
+      for (size_t i = 0; i < trace.size(); i++) {
+        req->obj_id = trace[i];
+        req->obj_size = 1;
+        req->clock_time = (int64_t)i;
+        if (!cache->get(cache, req)) n_miss += 1;
+      }
+      cache->cache_free(cache);
+      double mr = (double)n_miss / (double)trace.size();
+      double mr_fp = mrc_at(curve, (double)cache_size);
+      printf("%s cache size %lu: simulated %.4f, footprint %.4f\n", algo,
+             (unsigned long)cache_size, mr, mr_fp);
+      g_assert_cmpfloat(fabs(mr_fp - mr), <, 0.05);
+    }
+  }
+  free_request(req);
+}
+
+/* the modules that write a file, the scan detector needs an oracle trace */
+static analysis_option_t all_file_option() {
+  analysis_option_t option = default_option();
+  option.req_rate = true;
+  option.access_pattern = true;
+  option.size = true;
+  option.reuse = true;
+  option.popularity = true;
+  option.ttl = true;
+  option.popularity_decay = true;
+  option.footprint = true;
+  return option;
+}
+
+/* the partitioned enrichment updates each object in trace order, so every
+ * output is the same as with a single enrichment thread */
+static void test_enrich_partition(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  analysis_param_t param = default_param();
+  param.n_enrich_thread = 1;
+  auto single = run_analyzer(reader, "test_enrich", all_file_option(), param);
+  g_assert_cmpint(single.size(), >=, 10);
+
+  for (int n_thread : {2, 4, 7}) {
+    param.n_enrich_thread = n_thread;
+    auto partitioned =
+        run_analyzer(reader, "test_enrich", all_file_option(), param);
+    g_assert_cmpint(partitioned.size(), ==, single.size());
+    printf("%d enrichment threads: %zu outputs\n", n_thread,
+           partitioned.size());
+    for (auto &p : single) {
+      g_assert_true(partitioned[p.first] == p.second);
+    }
+  }
+}
+
+/* analyze a trace as it grows, each run resumes from the checkpoint of the
+ * previous one, only reads the new requests and appends the new windows to
+ * the per-window outputs, the outputs of the last run are the same as
+ * analyzing the whole trace at once, also when the runs use different
+ * numbers of enrichment threads */
+static void test_checkpoint_resume(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  analysis_param_t param = default_param();
+  auto full = run_analyzer(reader, "test_resume", all_file_option(), param);
+
+  std::ifstream ifs(reader->trace_path, std::ios::binary);
+  std::stringstream trace;
+  trace << ifs.rdbuf();
+  /* the size of an oracleGeneral request */
+  const size_t req_size = 24;
+  g_assert_cmpint(trace.str().size(), ==, req_size * 113872);
+
+  const std::string ckpt_path[2] = {"test_resume_ckpt0", "test_resume_ckpt1"};
+  const char *prefix_path = "test_resume_prefix.oracleGeneral.bin";
+  int64_t prefix_n_req[2] = {30011, 70001};
+  for (int i = 0; i < 2; i++) {
+    std::ofstream ofs(prefix_path, std::ios::binary | std::ios::trunc);
+    ofs.write(trace.str().data(),
+              (std::streamsize)(prefix_n_req[i] * req_size));
+    ofs.close();
+    reader_t *prefix = setup_reader(prefix_path, ORACLE_GENERAL_TRACE, NULL);
+
+    param.n_enrich_thread = i == 0 ? 1 : 3;
+    param.checkpoint_path = ckpt_path[i].c_str();
+    param.resume_path = i == 0 ? nullptr : ckpt_path[0].c_str();
+    /* keep the outputs for the next run */
+    TraceAnalyzer *analyzer =
+        new TraceAnalyzer(prefix, "test_resume", all_file_option(), param);
+    analyzer->run();
+    delete analyzer;
+    close_reader(prefix);
+  }
+  std::filesystem::remove(prefix_path);
+
+  param.n_enrich_thread = 4;
+  param.checkpoint_path = nullptr;
+  param.resume_path = ckpt_path[1].c_str();
+  auto resumed = run_analyzer(reader, "test_resume", all_file_option(), param);
+  for (auto &path : ckpt_path) std::filesystem::remove(path);
+
+  g_assert_cmpint(full.size(), >=, 10);
+  g_assert_cmpint(resumed.size(), ==, full.size());
+  for (auto &p : full) {
+    g_assert_true(resumed[p.first] == p.second);
+  }
+}
+
+/* in sketch mode, the request and byte rates count every request, and the
+ * object rates are estimated */
+static void test_sketch_req_rate(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  auto exact = run_req_rate(reader, false);
+  auto sketch = run_req_rate(reader, true);
+
+  /* req, byte, obj and first seen obj rate */
+  g_assert_cmpint(exact.size(), ==, 4);
+  g_assert_cmpint(sketch.size(), ==, 4);
+  g_assert_cmpint(exact[0].size(), >, 10);
+  for (int i = 0; i < 4; i++) {
+    g_assert_cmpint(sketch[i].size(), ==, exact[0].size());
+  }
+  for (size_t w = 0; w < exact[0].size(); w++) {
+    g_assert_cmpfloat(sketch[0][w], ==, exact[0][w]);
+    g_assert_cmpfloat(sketch[1][w], ==, exact[1][w]);
+  }
+
+  for (int i = 2; i < 4; i++) {
+    double sum_exact = 0, sum_sketch = 0;
+    for (size_t w = 0; w < exact[i].size(); w++) {
+      sum_exact += exact[i][w];
+      sum_sketch += sketch[i][w];
+    }
+    g_assert_cmpfloat(sum_exact, >, 0);
+    g_assert_cmpfloat(fabs(sum_sketch - sum_exact) / sum_exact, <, 0.05);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_pipeline_ring", NULL,
+                       test_pipeline_ring);
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_pipeline_worker_group",
+                       NULL, test_pipeline_worker_group);
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_histogram", NULL,
+                       test_histogram);
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_histogram_2d", NULL,
+                       test_histogram_2d);
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_sketch_hll", NULL,
+                       test_sketch_hll);
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_sketch_space_saving", NULL,
+                       test_sketch_space_saving);
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_sketch_kll", NULL,
+                       test_sketch_kll);
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_chunk_arena", NULL,
+                       test_chunk_arena);
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_access_pattern", NULL,
+                       test_access_pattern);
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_popularity_zipf", NULL,
+                       test_popularity_zipf);
+
+  g_test_add_data_func("/libCacheSim/traceAnalyzer_scan_detector", NULL,
+                       test_scan_detector);
+
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_cacheSim", reader,
+                            test_cache_sim, NULL);
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_sketch_req_rate",
+                            reader, test_sketch_req_rate, NULL);
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_enrich_partition",
+                            reader, test_enrich_partition, NULL);
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_checkpoint_resume",
+                            reader, test_checkpoint_resume, NULL);
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_footprint", reader,
+                            test_footprint, NULL);
+  g_test_add_data_func_full("/libCacheSim/traceAnalyzer_scan_detector_trace",
+                            reader, test_scan_detector_trace, test_teardown);
+
+  return g_test_run();
+}
@@ -0,0 +1,131 @@
+//
+// tests of the trace converter
+//
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../libCacheSim/bin/traceUtils/internal.hpp"
+#include "../libCacheSim/traceReader/generalReader/lcs.h"
+#include "common.h"
+
+typedef struct {
+  uint32_t clock_time;
+  uint64_t obj_id;
+  uint32_t obj_size;
+  int64_t next_access_vtime;
+} __attribute__((packed)) og_req_t;
+
+static std::vector<char> _read_file(const std::string &path) {
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  g_assert_true(ifs.good());
+  return std::vector<char>(std::istreambuf_iterator<char>(ifs),
+                           std::istreambuf_iterator<char>());
+}
+
+static void _convert_serial(reader_t *reader, const std::string &ofilepath,
+                            bool remove_size_change, bool remap_obj_id,
+                            bool use_lcs_format) {
+  traceConv::convert_to_oracleGeneral(reader, ofilepath, 1, false,
+                                      remove_size_change, remap_obj_id,
+                                      use_lcs_format);
+  /* the serial converter reads the trace backward */
+  reader->read_direction = READ_FORWARD;
+  reset_reader(reader);
+}
+
+static void _convert_parallel(reader_t *reader, const std::string &ofilepath,
+                              int n_thread, bool remove_size_change,
+                              bool remap_obj_id, bool use_lcs_format) {
+  traceConv::convert_to_oracleGeneral_parallel(
+      reader, ofilepath, n_thread, false, remove_size_change, remap_obj_id,
+      use_lcs_format);
+  reset_reader(reader);
+}
+
+/* the number of requests in each chunk, this is the same as the chunking of
+ * convert_to_oracleGeneral_parallel, which uses four chunks per thread */
+static int64_t _chunk_size(int64_t n_req, int n_thread) {
+  int64_t n_chunk = std::min((int64_t)n_thread * 4, n_req);
+  return (n_req + n_chunk - 1) / n_chunk;
+}
+
+/* the number of requests whose next access is in a later chunk, these are
+ * linked by the backward merge across chunks */
+static int64_t _n_req_cross_chunk(const std::vector<char> &data,
+                                  int64_t chunk_size) {
+  const og_req_t *reqs = reinterpret_cast<const og_req_t *>(data.data());
+  int64_t n_req = data.size() / sizeof(og_req_t);
+  int64_t n_cross = 0;
+  for (int64_t i = 0; i < n_req; i++) {
+    if (reqs[i].next_access_vtime == -1) continue;
+    /* next_access_vtime starts from 1 */
+    int64_t next_pos = reqs[i].next_access_vtime - 1;
+    g_assert_cmpint(next_pos, >, i);
+    g_assert_cmpuint(reqs[next_pos].obj_id, ==, reqs[i].obj_id);
+    if (next_pos / chunk_size != i / chunk_size) n_cross++;
+  }
+  return n_cross;
+}
+
+/* the parallel converter writes the same bytes as the serial converter,
+ * including the requests whose reuse interval spans chunk boundaries */
+static void test_parallel_same_as_serial(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const std::string serial_path = "test_traceConv.serial.oracleGeneral";
+  const std::string parallel_path = "test_traceConv.parallel.oracleGeneral";
+  const int n_threads[] = {1, 3, 7};
+  struct {
+    bool remove_size_change;
+    bool remap_obj_id;
+    bool use_lcs_format;
+  } opts[] = {
+      {false, false, false},
+      {true, false, true},
+      {false, true, true},
+  };
+
+  for (auto &opt : opts) {
+    _convert_serial(reader, serial_path, opt.remove_size_change,
+                    opt.remap_obj_id, opt.use_lcs_format);
+    std::vector<char> serial = _read_file(serial_path);
+    size_t header_size = opt.use_lcs_format ? sizeof(lcs_trace_header_t) : 0;
+    g_assert_cmpuint(serial.size(), >, header_size);
+    std::vector<char> reqs(serial.begin() + header_size, serial.end());
+    int64_t n_req = reqs.size() / sizeof(og_req_t);
+    g_assert_cmpint(n_req, ==, get_num_of_req(reader));
+
+    for (int n_thread : n_threads) {
+      g_assert_cmpint(_n_req_cross_chunk(reqs, _chunk_size(n_req, n_thread)),
+                      >, 0);
+
+      _convert_parallel(reader, parallel_path, n_thread,
+                        opt.remove_size_change, opt.remap_obj_id,
+                        opt.use_lcs_format);
+      std::vector<char> parallel = _read_file(parallel_path);
+      g_assert_cmpuint(parallel.size(), ==, serial.size());
+      g_assert_true(parallel == serial);
+    }
+  }
+
+  g_assert_cmpint(remove(serial_path.c_str()), ==, 0);
+  g_assert_cmpint(remove(parallel_path.c_str()), ==, 0);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func_full("/libCacheSim/traceConv_parallel_oracleGeneral",
+                            reader, test_parallel_same_as_serial,
+                            test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/traceConv_parallel_vscsi", reader,
+                            test_parallel_same_as_serial, test_teardown);
+
+  return g_test_run();
+}
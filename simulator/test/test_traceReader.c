@@ -2,6 +2,10 @@
 // Created by Juncheng Yang on 11/19/19.
 //
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
 #include "common.h"
 
 // defined in reader.c file, not in public interface
@@ -134,6 +138,275 @@ void test_reader_more2(gconstpointer user_data) {
   close_reader(cloned_reader);
 }
 
+void test_merge_reader(gconstpointer user_data) {
+  reader_t *sources[2] = {setup_vscsi_reader(), setup_vscsi_reader()};
+  double rate_scales[2] = {1.0, 2.0};
+  reader_t *reader = setup_merge_reader(sources, 2, rate_scales, NULL);
+  request_t *req = new_request();
+
+  g_assert_true(get_num_of_req(reader) == trace_length * 2);
+
+  int64_t last_time = 0, n_req[2] = {0, 0};
+  while (read_one_req(reader, req) == 0) {
+    g_assert_true(req->clock_time >= last_time);
+    last_time = req->clock_time;
+    n_req[req->tenant_id]++;
+  }
+  g_assert_true(n_req[0] == trace_length && n_req[1] == trace_length);
+
+  // reset and cloned readers produce the same interleaving
+  reset_reader(reader);
+  int64_t n_read = 0;
+  while (read_one_req(reader, req) == 0 && req->tenant_id == 0) n_read++;
+  reset_reader(reader);
+  reader_t *cloned_reader = clone_reader(reader);
+  int64_t n_read_cloned = 0;
+  while (read_one_req(cloned_reader, req) == 0 && req->tenant_id == 0)
+    n_read_cloned++;
+  g_assert_true(n_read == n_read_cloned);
+
+  close_reader(cloned_reader);
+  close_reader(reader);
+  free_request(req);
+}
+
+// the ids are remapped per source without overflow, also for ids that use
+// the top bits
+void test_merge_reader_large_id(gconstpointer user_data) {
+  const obj_id_t obj_ids[] = {0,          1,          2,
+                              1ULL << 62, 1ULL << 63, (1ULL << 63) + 1,
+                              UINT64_MAX - 1, UINT64_MAX};
+  const int n_id = sizeof(obj_ids) / sizeof(obj_ids[0]);
+  const char *path = "merge_large_id.txt";
+  FILE *f = fopen(path, "w");
+  for (int i = 0; i < n_id; i++) fprintf(f, "%" PRIu64 "\n", obj_ids[i]);
+  // the same object requested again
+  fprintf(f, "%" PRIu64 "\n", obj_ids[0]);
+  fclose(f);
+
+  reader_init_param_t init_params = {.obj_id_is_num = true};
+  reader_t *sources[2] = {setup_reader(path, PLAIN_TXT_TRACE, &init_params),
+                          setup_reader(path, PLAIN_TXT_TRACE, &init_params)};
+  reader_t *reader = setup_merge_reader(sources, 2, NULL, NULL);
+  request_t *req = new_request();
+
+  obj_id_t merged_ids[2][n_id + 1];
+  int n_req[2] = {0, 0};
+  while (read_one_req(reader, req) == 0) {
+    merged_ids[req->tenant_id][n_req[req->tenant_id]++] = req->obj_id;
+  }
+  g_assert_cmpint(n_req[0], ==, n_id + 1);
+  g_assert_cmpint(n_req[1], ==, n_id + 1);
+
+  for (int s = 0; s < 2; s++) {
+    g_assert_true(merged_ids[s][n_id] == merged_ids[s][0]);
+    for (int i = 0; i < n_id; i++) {
+      for (int j = 0; j < n_id; j++) {
+        g_assert_true(merged_ids[s][i] != merged_ids[1 - s][j]);
+        if (i != j) g_assert_true(merged_ids[s][i] != merged_ids[s][j]);
+      }
+    }
+  }
+
+  close_reader(reader);
+  free_request(req);
+  remove(path);
+}
+
+void test_synthetic_reader(gconstpointer user_data) {
+  reader_t *reader = setup_synthetic_reader(
+      "zipf:alpha=0.8,n_obj=1000,n_req=20000,scan_ratio=0.1,scan_len=50,"
+      "one_hit_ratio=0.1,lookahead=20000",
+      NULL);
+  request_t *req = new_request();
+  int64_t *next_access = malloc(sizeof(int64_t) * 20000);
+  obj_id_t *obj_ids = malloc(sizeof(obj_id_t) * 20000);
+
+  g_assert_true(get_num_of_req(reader) == 20000);
+
+  int64_t n_req = 0;
+  while (read_one_req(reader, req) == 0) {
+    obj_ids[n_req] = req->obj_id;
+    next_access[n_req] = req->next_access_vtime;
+    n_req++;
+  }
+  g_assert_true(n_req == 20000);
+
+  // the lookahead covers the whole trace, so next_access_vtime is exact
+  for (int64_t i = 0; i < n_req; i++) {
+    int64_t j = i + 1;
+    while (j < n_req && obj_ids[j] != obj_ids[i]) j++;
+    g_assert_true(next_access[i] == (j == n_req ? INT64_MAX : j + 1));
+  }
+
+  // reset and cloned readers generate the same requests
+  reset_reader(reader);
+  reader_t *cloned_reader = clone_reader(reader);
+  for (int64_t i = 0; i < n_req; i++) {
+    read_one_req(reader, req);
+    g_assert_true(req->obj_id == obj_ids[i]);
+    read_one_req(cloned_reader, req);
+    g_assert_true(req->obj_id == obj_ids[i]);
+  }
+
+  close_reader(cloned_reader);
+  close_reader(reader);
+  free(next_access);
+  free(obj_ids);
+  free_request(req);
+}
+
+// the clones share the alias table, closing the original first keeps it
+void test_synthetic_reader_close_original_first(gconstpointer user_data) {
+  reader_t *reader = setup_synthetic_reader(
+      "zipf:alpha=0.8,n_obj=1000,n_req=5000", NULL);
+  request_t *req = new_request();
+  obj_id_t *obj_ids = malloc(sizeof(obj_id_t) * 5000);
+
+  int64_t n_req = 0;
+  while (read_one_req(reader, req) == 0) obj_ids[n_req++] = req->obj_id;
+
+  reader_t *cloned_reader = clone_reader(reader);
+  reader_t *cloned_reader2 = clone_reader(cloned_reader);
+  close_reader(reader);
+  for (int64_t i = 0; i < n_req; i++) {
+    read_one_req(cloned_reader, req);
+    g_assert_true(req->obj_id == obj_ids[i]);
+  }
+  close_reader(cloned_reader);
+  for (int64_t i = 0; i < n_req; i++) {
+    read_one_req(cloned_reader2, req);
+    g_assert_true(req->obj_id == obj_ids[i]);
+  }
+  close_reader(cloned_reader2);
+
+  free(obj_ids);
+  free_request(req);
+}
+
+// write the data file to a fifo from a child process, the reader opens the
+// fifo as a stream
+static pid_t _start_fifo_writer(const char *fifo_path, const char *data_name) {
+  char data_path[1024];
+  _detect_data_path(data_path, (char *)data_name);
+  remove(fifo_path);
+  g_assert_cmpint(mkfifo(fifo_path, 0600), ==, 0);
+
+  pid_t pid = fork();
+  g_assert_cmpint(pid, >=, 0);
+  if (pid == 0) {
+    int in_fd = open(data_path, O_RDONLY);
+    int out_fd = open(fifo_path, O_WRONLY);
+    char buf[65536];
+    ssize_t n;
+    while ((n = read(in_fd, buf, sizeof(buf))) > 0) {
+      if (write(out_fd, buf, n) != n) _exit(1);
+    }
+    _exit(n == 0 ? 0 : 1);
+  }
+  return pid;
+}
+
+static void _finish_fifo_writer(const char *fifo_path, pid_t pid) {
+  int status;
+  waitpid(pid, &status, 0);
+  g_assert_true(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  remove(fifo_path);
+}
+
+// a stream gives the same requests as the file it is read from
+static void _verify_stream_reader(reader_t *file_reader, reader_t *reader) {
+  g_assert_true(reader->is_stream);
+  request_t *req = new_request();
+  request_t *req_file = new_request();
+  int64_t n_req = 0;
+  reset_reader(file_reader);
+  while (read_one_req(reader, req) == 0) {
+    g_assert_cmpint(read_one_req(file_reader, req_file), ==, 0);
+    g_assert_true(req->obj_id == req_file->obj_id);
+    g_assert_cmpint(req->obj_size, ==, req_file->obj_size);
+    g_assert_cmpint(req->clock_time, ==, req_file->clock_time);
+    n_req++;
+  }
+  g_assert_cmpint(read_one_req(file_reader, req_file), !=, 0);
+  g_assert_cmpint(n_req, ==, trace_length);
+  reset_reader(file_reader);
+  free_request(req);
+  free_request(req_file);
+}
+
+void test_stream_reader_binary(gconstpointer user_data) {
+  const char *fifo_path = "stream_binary.fifo";
+  pid_t pid =
+      _start_fifo_writer(fifo_path, "cloudPhysicsIO.oracleGeneral.bin");
+  reader_t *reader = setup_reader(fifo_path, ORACLE_GENERAL_TRACE, NULL);
+  reader_t *file_reader = setup_oracleGeneralBin_reader();
+
+  _verify_stream_reader(file_reader, reader);
+
+  close_reader(reader);
+  close_reader(file_reader);
+  _finish_fifo_writer(fifo_path, pid);
+}
+
+void test_stream_reader_csv(gconstpointer user_data) {
+  const char *fifo_path = "stream_csv.fifo";
+  pid_t pid = _start_fifo_writer(fifo_path, "cloudPhysicsIO.csv");
+  reader_init_param_t init_params = {.delimiter = ',',
+                                     .time_field = 2,
+                                     .obj_id_field = 5,
+                                     .obj_size_field = 4,
+                                     .has_header = true,
+                                     .obj_id_is_num = true};
+  reader_t *reader = setup_reader(fifo_path, CSV_TRACE, &init_params);
+  reader_t *file_reader = setup_csv_reader_obj_num();
+
+  _verify_stream_reader(file_reader, reader);
+
+  close_reader(reader);
+  close_reader(file_reader);
+  _finish_fifo_writer(fifo_path, pid);
+}
+
+// a stream cannot be cloned, the simulator reads it once and gives every
+// batch to all caches, the result is the same as simulating the file
+void test_stream_reader_simulate(gconstpointer user_data) {
+  const uint64_t cache_sizes[] = {1 * MiB, 16 * MiB, 256 * MiB};
+  cache_t *caches[2][3];
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 3; j++) {
+      common_cache_params_t cc_params = {.cache_size = cache_sizes[j],
+                                         .hashpower = 16};
+      caches[i][j] = create_test_cache("LRU", cc_params, NULL, NULL);
+    }
+  }
+
+  const char *fifo_path = "stream_simulate.fifo";
+  pid_t pid =
+      _start_fifo_writer(fifo_path, "cloudPhysicsIO.oracleGeneral.bin");
+  reader_t *reader = setup_reader(fifo_path, ORACLE_GENERAL_TRACE, NULL);
+  reader_t *file_reader = setup_oracleGeneralBin_reader();
+  g_assert_true(reader->is_stream);
+
+  cache_stat_t *res_stream = simulate_with_multi_caches(
+      reader, caches[0], 3, NULL, 0, 0, 2, true);
+  cache_stat_t *res_file = simulate_with_multi_caches(
+      file_reader, caches[1], 3, NULL, 0, 0, 2, true);
+  for (int j = 0; j < 3; j++) {
+    g_assert_cmpint(res_stream[j].n_req, ==, trace_length);
+    g_assert_cmpint(res_stream[j].n_req, ==, res_file[j].n_req);
+    g_assert_cmpint(res_stream[j].n_miss, ==, res_file[j].n_miss);
+    g_assert_cmpint(res_stream[j].n_miss_byte, ==, res_file[j].n_miss_byte);
+  }
+  g_assert_cmpint(res_stream[0].n_miss, >, res_stream[2].n_miss);
+
+  g_free(res_stream);
+  g_free(res_file);
+  close_reader(reader);
+  close_reader(file_reader);
+  _finish_fifo_writer(fifo_path, pid);
+}
+
 void test_twr(gconstpointer user_data) {
   reader_t *reader = setup_reader("/Users/junchengy/twr.sbin", TWR_TRACE, NULL);
   gint64 n_req = get_num_of_req(reader);
@@ -210,6 +483,20 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func_full("/libCacheSim/reader_more2_oracleGeneral", reader,
                             test_reader_more2, test_teardown);
 
+  g_test_add_data_func("/libCacheSim/reader_merge", NULL, test_merge_reader);
+  g_test_add_data_func("/libCacheSim/reader_merge_large_id", NULL,
+                       test_merge_reader_large_id);
+  g_test_add_data_func("/libCacheSim/reader_synthetic", NULL,
+                       test_synthetic_reader);
+  g_test_add_data_func("/libCacheSim/reader_synthetic_close_original_first",
+                       NULL, test_synthetic_reader_close_original_first);
+
+  g_test_add_data_func("/libCacheSim/reader_stream_binary", NULL,
+                       test_stream_reader_binary);
+  g_test_add_data_func("/libCacheSim/reader_stream_csv", NULL,
+                       test_stream_reader_csv);
+  g_test_add_data_func("/libCacheSim/reader_stream_simulate", NULL,
+                       test_stream_reader_simulate);
   // g_test_add_data_func("/libCacheSim/test_twr", NULL, test_twr);
   return g_test_run();
 }
\ No newline at end of file